@@ -17,7 +17,11 @@
  *=========================================================================*/
 
 // Custom
-#include "Helpers/HelpersOutput.h"
+#include "Utilities/IndirectPriorityQueue.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
 
 // Pixel descriptors
 #include "PixelDescriptors/ImagePatchPixelDescriptor.h"
@@ -27,28 +31,28 @@
 #include "Visitors/DescriptorVisitors/ImagePatchDescriptorVisitor.hpp"
 #include "Visitors/DescriptorVisitors/FeatureVectorPrecomputedPCLNormalsDescriptorVisitor.hpp"
 #include "Visitors/DescriptorVisitors/CompositeDescriptorVisitor.hpp"
+#include "Visitors/DescriptorVisitors/IndexUpdateDescriptorVisitor.hpp"
 
 // Inpainting visitors
-#include "Visitors/InpaintingVisitor.hpp"
+#include "Visitors/InpaintingVisitors/InpaintingVisitor.hpp"
+#include "Visitors/AcceptanceVisitors/DefaultAcceptanceVisitor.hpp"
 
 // Nearest neighbors
-#include "NearestNeighbor/LinearSearchBestProperty.hpp"
-#include "NearestNeighbor/LinearSearchKNNProperty.hpp"
-#include "NearestNeighbor/LinearSearchCriteriaProperty.hpp"
-#include "NearestNeighbor/TwoStepNearestNeighbor.hpp"
+#include "NearestNeighbor/LinearSearchBest/Property.hpp"
+#include "NearestNeighbor/LocalitySensitiveHashKNN.hpp"
+#include "NearestNeighbor/ThresholdBestWrapper.hpp"
 
 // Initializers
 #include "Initializers/InitializeFromMaskImage.hpp"
 #include "Initializers/InitializePriority.hpp"
 
 // Inpainters
-#include "Inpainters/MaskedGridPatchInpainter.hpp"
-#include "Inpainters/HoleListPatchInpainter.hpp"
+#include "Inpainters/PatchInpainter.hpp"
 
 // Difference functions
-#include "DifferenceFunctions/ImagePatchDifference.hpp"
-#include "DifferenceFunctions/FeatureVectorDifference.hpp"
-#include "DifferenceFunctions/FeatureVectorAngleDifference.hpp"
+#include "DifferenceFunctions/Patch/ImagePatchDifference.hpp"
+#include "DifferenceFunctions/Pixel/SumSquaredPixelDifference.hpp"
+#include "DifferenceFunctions/Other/FeatureVectorAngleDifference.hpp"
 
 // Inpainting
 #include "Algorithms/InpaintingAlgorithm.hpp"
@@ -58,6 +62,7 @@
 
 // ITK
 #include "itkImageFileReader.h"
+#include "itkVectorImage.h"
 
 // PCL
 #include <pcl/io/pcd_io.h>
@@ -66,34 +71,33 @@
 // Boost
 #include <boost/graph/grid_graph.hpp>
 #include <boost/property_map/property_map.hpp>
-#include <boost/graph/detail/d_ary_heap.hpp>
 
-// Debug
-#include "Helpers/HelpersOutput.h"
+// STL
+#include <memory>
 
-// Run with: Data/trashcan.mha Data/trashcan_mask.mha 15 Data/trashcan.vtp Intensity filled.mha
+// Run with: Data/trashcan.mha Data/trashcan_mask.mha 15 Data/trashcan.pcd filled.mha
 int main(int argc, char *argv[])
 {
   // Verify arguments
   if(argc != 6)
-    {
-    std::cerr << "Required arguments: image.mha imageMask.mha patch_half_width normals.pcd output.mha" << std::endl;
+  {
+    std::cerr << "Required arguments: image.mha imageMask.mha patchHalfWidth normals.pcd output.mha" << std::endl;
     std::cerr << "Input arguments: ";
     for(int i = 1; i < argc; ++i)
-      {
+    {
       std::cerr << argv[i] << " ";
-      }
-    return EXIT_FAILURE;
     }
+    return EXIT_FAILURE;
+  }
 
   // Parse arguments
   std::string imageFilename = argv[1];
   std::string maskFilename = argv[2];
 
-  std::stringstream ssPatchRadius;
-  ssPatchRadius << argv[3];
-  unsigned int patch_half_width = 0;
-  ssPatchRadius >> patch_half_width;
+  std::stringstream ssPatchHalfWidth;
+  ssPatchHalfWidth << argv[3];
+  unsigned int patchHalfWidth = 0;
+  ssPatchHalfWidth >> patchHalfWidth;
 
   std::string normalsFileName = argv[4];
 
@@ -102,21 +106,20 @@ int main(int argc, char *argv[])
   // Output arguments
   std::cout << "Reading image: " << imageFilename << std::endl;
   std::cout << "Reading mask: " << maskFilename << std::endl;
-  std::cout << "Patch half width: " << patch_half_width << std::endl;
+  std::cout << "Patch half width: " << patchHalfWidth << std::endl;
   std::cout << "Reading normals: " << normalsFileName << std::endl;
   std::cout << "Output: " << outputFilename << std::endl;
 
   pcl::PointCloud<pcl::Normal>::Ptr cloudNormals(new pcl::PointCloud<pcl::Normal>);
-
-  if (pcl::io::loadPCDFile<pcl::Normal> (normalsFileName, *cloudNormals) == -1) //* load the file
+  if(pcl::io::loadPCDFile<pcl::Normal>(normalsFileName, *cloudNormals) == -1)
   {
-    PCL_ERROR ("Couldn't read file test_pcd.pcd \n");
-    return (-1);
+    std::cerr << "Could not read " << normalsFileName << std::endl;
+    return EXIT_FAILURE;
   }
-  
-  typedef FloatVectorImageType ImageType;
 
-  typedef  itk::ImageFileReader<ImageType> ImageReaderType;
+  typedef itk::VectorImage<float, 2> ImageType;
+
+  typedef itk::ImageFileReader<ImageType> ImageReaderType;
   ImageReaderType::Pointer imageReader = ImageReaderType::New();
   imageReader->SetFileName(imageFilename);
   imageReader->Update();
@@ -135,99 +138,96 @@ int main(int argc, char *argv[])
 
   // Create the graph
   typedef boost::grid_graph<2> VertexListGraphType;
-  boost::array<std::size_t, 2> graphSideLengths = { { imageReader->GetOutput()->GetLargestPossibleRegion().GetSize()[0],
-                                                      imageReader->GetOutput()->GetLargestPossibleRegion().GetSize()[1] } };
-  VertexListGraphType graph(graphSideLengths);
+  boost::array<std::size_t, 2> graphSideLengths = { { image->GetLargestPossibleRegion().GetSize()[0],
+                                                      image->GetLargestPossibleRegion().GetSize()[1] } };
+  std::shared_ptr<VertexListGraphType> graph(new VertexListGraphType(graphSideLengths));
   typedef boost::graph_traits<VertexListGraphType>::vertex_descriptor VertexDescriptorType;
 
-  // Get the index map
-  typedef boost::property_map<VertexListGraphType, boost::vertex_index_t>::const_type IndexMapType;
-  IndexMapType indexMap(get(boost::vertex_index, graph));
-
-  // Create the priority map
-  typedef boost::vector_property_map<float, IndexMapType> PriorityMapType;
-  PriorityMapType priorityMap(num_vertices(graph), indexMap);
-
-  // Create the node fill status map. Each pixel is either filled (true) or not filled (false).
-  typedef boost::vector_property_map<bool, IndexMapType> FillStatusMapType;
-  FillStatusMapType fillStatusMap(num_vertices(graph), indexMap);
+  // Queue
+  typedef IndirectPriorityQueue<VertexListGraphType> BoundaryNodeQueueType;
+  std::shared_ptr<BoundaryNodeQueueType> boundaryNodeQueue(new BoundaryNodeQueueType(*graph));
 
-  // Create the boundary status map. A node is on the current boundary if this property is true. 
-  // This property helps the boundaryNodeQueue because we can mark here if a node has become no longer
-  // part of the boundary, so when the queue is popped we can check this property to see if it should
-  // actually be processed.
-  typedef boost::vector_property_map<bool, IndexMapType> BoundaryStatusMapType;
-  BoundaryStatusMapType boundaryStatusMap(num_vertices(graph), indexMap);
+  // Create the descriptor maps. This is where the data for each pixel is stored.
+  typedef boost::vector_property_map<ImagePatchPixelDescriptorType,
+      BoundaryNodeQueueType::IndexMapType> ImagePatchDescriptorMapType;
+  std::shared_ptr<ImagePatchDescriptorMapType> imagePatchDescriptorMap(new
+      ImagePatchDescriptorMapType(num_vertices(*graph), *(boundaryNodeQueue->GetIndexMap())));
 
-  // Create the descriptor map. This is where the data for each pixel is stored.
-  typedef boost::vector_property_map<ImagePatchPixelDescriptorType, IndexMapType> ImagePatchDescriptorMapType;
-  ImagePatchDescriptorMapType imagePatchDescriptorMap(num_vertices(graph), indexMap);
+  typedef boost::vector_property_map<FeatureVectorPixelDescriptorType,
+      BoundaryNodeQueueType::IndexMapType> FeatureVectorDescriptorMapType;
+  std::shared_ptr<FeatureVectorDescriptorMapType> featureVectorDescriptorMap(new
+      FeatureVectorDescriptorMapType(num_vertices(*graph), *(boundaryNodeQueue->GetIndexMap())));
 
-  // Create the descriptor map. This is where the data for each pixel is stored.
-  typedef boost::vector_property_map<FeatureVectorPixelDescriptorType, IndexMapType> FeatureVectorDescriptorMapType;
-  FeatureVectorDescriptorMapType featureVectorDescriptorMap(num_vertices(graph), indexMap);
-
-  // Create the patch inpainter. The inpainter needs to know the status of each pixel to determine if they should be inpainted.
-  typedef MaskedGridPatchInpainter<FillStatusMapType> InpainterType;
-  InpainterType patchInpainter(patch_half_width, fillStatusMap);
+  // Create the patch inpainter.
+  typedef PatchInpainter<ImageType> InpainterType;
+  std::shared_ptr<InpainterType> patchInpainter(new InpainterType(patchHalfWidth, image, mask));
 
   // Create the priority function
   typedef PriorityRandom PriorityType;
-  PriorityType priorityFunction;
+  std::shared_ptr<PriorityType> priorityFunction(new PriorityType);
 
-  // Create the boundary node queue. The priority of each node is used to order the queue.
-  typedef boost::vector_property_map<std::size_t, IndexMapType> IndexInHeapMap;
-  IndexInHeapMap index_in_heap(indexMap);
+  // Create the descriptor visitors
+  typedef ImagePatchDescriptorVisitor<VertexListGraphType, ImageType, ImagePatchDescriptorMapType>
+      ImagePatchDescriptorVisitorType;
+  std::shared_ptr<ImagePatchDescriptorVisitorType> imagePatchDescriptorVisitor(new
+      ImagePatchDescriptorVisitorType(image.GetPointer(), mask, imagePatchDescriptorMap, patchHalfWidth));
 
-  // Create the priority compare functor
-  typedef std::less<float> PriorityCompareType;
-  PriorityCompareType lessThanFunctor;
+  typedef FeatureVectorPrecomputedPCLNormalsDescriptorVisitor<VertexListGraphType, FeatureVectorDescriptorMapType>
+      FeatureVectorDescriptorVisitorType;
+  std::shared_ptr<FeatureVectorDescriptorVisitorType> featureVectorDescriptorVisitor(new
+      FeatureVectorDescriptorVisitorType(*featureVectorDescriptorMap, *cloudNormals));
 
-  typedef boost::d_ary_heap_indirect<VertexDescriptorType, 4, IndexInHeapMap, PriorityMapType, PriorityCompareType> BoundaryNodeQueueType;
-  BoundaryNodeQueueType boundaryNodeQueue(priorityMap, index_in_heap, lessThanFunctor);
+  typedef CompositeDescriptorVisitor<VertexListGraphType> CompositeDescriptorVisitorType;
+  std::shared_ptr<CompositeDescriptorVisitorType> compositeDescriptorVisitor(new CompositeDescriptorVisitorType);
+  compositeDescriptorVisitor->AddVisitor(imagePatchDescriptorVisitor);
+  compositeDescriptorVisitor->AddVisitor(featureVectorDescriptorVisitor);
 
-  // Create the descriptor visitors
-  typedef FeatureVectorPrecomputedPCLNormalsDescriptorVisitor<VertexListGraphType, FeatureVectorDescriptorMapType> FeatureVectorPrecomputedPCLNormalsDescriptorVisitorType;
-  FeatureVectorPrecomputedPCLNormalsDescriptorVisitorType featureVectorPrecomputedPCLNormalsDescriptorVisitor(featureVectorDescriptorMap, *cloudNormals);
+  // Find the candidate source normals with a hash of their directions (which are not oriented consistently)
+  // instead of comparing every normal. The hash is updated as new source descriptors are initialized.
+  typedef LocalitySensitiveHashKNN<FeatureVectorDescriptorMapType, FeatureVectorAngleDifference> NormalSearchType;
+  std::shared_ptr<NormalSearchType> normalSearch(new NormalSearchType(featureVectorDescriptorMap, 1000,
+      LocalitySensitiveHash(LocalitySensitiveHash::HYPERPLANE, 4, 6, 8)));
+  normalSearch->SetUnoriented(true);
 
-  typedef ImagePatchDescriptorVisitor<VertexListGraphType, ImageType, ImagePatchDescriptorMapType> ImagePatchDescriptorVisitorType;
-  ImagePatchDescriptorVisitorType imagePatchDescriptorVisitor(image, mask, imagePatchDescriptorMap, patch_half_width);
+  typedef IndexUpdateDescriptorVisitor<VertexListGraphType, NormalSearchType> IndexUpdateDescriptorVisitorType;
+  std::shared_ptr<IndexUpdateDescriptorVisitorType> indexUpdateDescriptorVisitor(new
+      IndexUpdateDescriptorVisitorType(normalSearch.get()));
+  compositeDescriptorVisitor->AddVisitor(indexUpdateDescriptorVisitor);
 
-  typedef CompositeDescriptorVisitor<VertexListGraphType> CompositeDescriptorVisitorType;
-  CompositeDescriptorVisitorType compositeDescriptorVisitor;
-  compositeDescriptorVisitor.AddVisitor(&imagePatchDescriptorVisitor);
-  compositeDescriptorVisitor.AddVisitor(&featureVectorPrecomputedPCLNormalsDescriptorVisitor);
+  typedef DefaultAcceptanceVisitor<VertexListGraphType> AcceptanceVisitorType;
+  std::shared_ptr<AcceptanceVisitorType> acceptanceVisitor(new AcceptanceVisitorType);
 
   // Create the inpainting visitor
-  typedef InpaintingVisitor<VertexListGraphType, ImageType, BoundaryNodeQueueType, FillStatusMapType,
-                            CompositeDescriptorVisitorType, PriorityType, PriorityMapType, BoundaryStatusMapType> InpaintingVisitorType;
-  InpaintingVisitorType inpaintingVisitor(image, mask, boundaryNodeQueue, fillStatusMap,
-                                          compositeDescriptorVisitor, priorityMap, &priorityFunction, patch_half_width, boundaryStatusMap);
+  typedef InpaintingVisitor<VertexListGraphType, BoundaryNodeQueueType,
+                            CompositeDescriptorVisitorType, AcceptanceVisitorType, PriorityType>
+                            InpaintingVisitorType;
+  std::shared_ptr<InpaintingVisitorType> inpaintingVisitor(new InpaintingVisitorType(mask, boundaryNodeQueue,
+                                          compositeDescriptorVisitor, acceptanceVisitor,
+                                          priorityFunction, patchHalfWidth, "InpaintingVisitor"));
+  inpaintingVisitor->SetAllowNewPatches(true);
 
-  InitializePriority(mask, boundaryNodeQueue, priorityMap, &priorityFunction, boundaryStatusMap);
+  InitializePriority(mask, boundaryNodeQueue.get(), priorityFunction.get());
 
   // Initialize the boundary node queue from the user provided mask image.
-  InitializeFromMaskImage(mask, &inpaintingVisitor, graph, fillStatusMap);
-  std::cout << "PatchBasedInpaintingNonInteractive: There are " << boundaryNodeQueue.size()
-            << " nodes in the boundaryNodeQueue" << std::endl;
-
-  // Create the nearest neighbor finder
-//   typedef LinearSearchKNNProperty<FeatureVectorDescriptorMapType, FeatureVectorAngleDifference> KNNSearchType;
-//   KNNSearchType linearSearchKNN(featureVectorDescriptorMap);
-  typedef LinearSearchCriteriaProperty<FeatureVectorDescriptorMapType, FeatureVectorAngleDifference> ThresholdSearchType;
+  InitializeFromMaskImage<InpaintingVisitorType, VertexDescriptorType>(mask, inpaintingVisitor.get());
+
+  // Compare the patches of the hashed sources whose normals are within this angle of the target normal
   float maximumAngle = 0.34906585; // deg2rad(20)
-  ThresholdSearchType thresholdSearchType(featureVectorDescriptorMap, maximumAngle);
 
-  typedef LinearSearchBestProperty<ImagePatchDescriptorMapType, ImagePatchDifference<ImagePatchPixelDescriptorType> > BestSearchType;
-  BestSearchType linearSearchBest(imagePatchDescriptorMap);
+  typedef ImagePatchDifference<ImagePatchPixelDescriptorType,
+      SumSquaredPixelDifference<ImageType::PixelType> > PatchDifferenceType;
+  typedef LinearSearchBestProperty<ImagePatchDescriptorMapType, PatchDifferenceType> BestSearchType;
+  std::shared_ptr<BestSearchType> linearSearchBest(new BestSearchType(*imagePatchDescriptorMap));
 
-  TwoStepNearestNeighbor<ThresholdSearchType, BestSearchType> twoStepNearestNeighbor(thresholdSearchType, linearSearchBest);
+  typedef ThresholdBestWrapper<NormalSearchType, BestSearchType> TwoStepSearchType;
+  std::shared_ptr<TwoStepSearchType> twoStepSearch(new TwoStepSearchType(normalSearch, maximumAngle,
+                                                                         linearSearchBest));
 
   // Perform the inpainting
-  std::cout << "Performing inpainting...: " << std::endl;
-  inpainting_loop(graph, inpaintingVisitor, boundaryStatusMap, boundaryNodeQueue, twoStepNearestNeighbor, patchInpainter);
+  InpaintingAlgorithm(graph, inpaintingVisitor, boundaryNodeQueue, twoStepSearch, patchInpainter);
+  normalSearch->WriteStatistics(std::cout);
 
-  HelpersOutput::WriteImage<ImageType>(image, outputFilename);
+  ITKHelpers::WriteImage(image.GetPointer(), outputFilename);
 
   return EXIT_SUCCESS;
 }
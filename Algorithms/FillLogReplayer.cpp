@@ -0,0 +1,229 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "FillLogReplayer.h"
+
+// Custom
+#include "Utilities/PixelBitmap.h"
+
+// STL
+#include <cstring>
+
+namespace
+{
+  /** Set (or unset) the bits of all of the pixels of 'region'. */
+  void MarkRegion(PixelBitmap& bitmap, const itk::ImageRegion<2>& region, const bool value)
+  {
+    itk::Index<2> index;
+    for(index[1] = region.GetIndex()[1];
+        index[1] < region.GetIndex()[1] + static_cast<itk::Index<2>::IndexValueType>(region.GetSize()[1]); ++index[1])
+    {
+      for(index[0] = region.GetIndex()[0];
+          index[0] < region.GetIndex()[0] + static_cast<itk::Index<2>::IndexValueType>(region.GetSize()[0]); ++index[0])
+      {
+        if(value)
+        {
+          bitmap.Insert(index);
+        }
+        else
+        {
+          bitmap.Erase(index);
+        }
+      }
+    }
+  }
+}
+
+FillLogReplayer::FillLogReplayer(Mask* const mask) : MaskImage(mask)
+{
+
+}
+
+void FillLogReplayer::Replay(const FillLogReader& fillLog)
+{
+  itk::Size<2> logSize = fillLog.GetImageSize();
+  itk::Size<2> maskSize = this->MaskImage->GetBufferedRegion().GetSize();
+
+  unsigned int scale = maskSize[0] / logSize[0];
+  if(scale == 0 || logSize[0] * scale != maskSize[0] || logSize[1] * scale != maskSize[1])
+  {
+    std::stringstream ss;
+    ss << "FillLogReplayer::Replay: the mask (" << maskSize << ") is not an integer multiple of the size of the image"
+       << " the fill log was written for (" << logSize << ")!";
+    throw std::runtime_error(ss.str());
+  }
+
+  std::vector<TargetSourcePairType> pairs(fillLog.GetNumberOfRecords());
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    const FillLog::Record& record = fillLog.GetRecord(i);
+    itk::Index<2> target = {{record.TargetX, record.TargetY}};
+    itk::Index<2> source = {{record.SourceX, record.SourceY}};
+    pairs[i] = TargetSourcePairType(target, source);
+  }
+
+  Replay(pairs, fillLog.GetPatchRadius(), scale);
+}
+
+void FillLogReplayer::Replay(const std::vector<TargetSourcePairType>& pairs, const unsigned int patchHalfWidth,
+                             const unsigned int scale)
+{
+  std::vector<Patch> patches(pairs.size());
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    patches[i] = CreatePatch(pairs[i].first, pairs[i].second, patchHalfWidth, scale);
+  }
+
+  ApplyPatches(patches);
+}
+
+std::size_t FillLogReplayer::GetNumberOfPatches() const
+{
+  return this->NumberOfPatches;
+}
+
+std::size_t FillLogReplayer::GetNumberOfRuns() const
+{
+  return this->NumberOfRuns;
+}
+
+FillLogReplayer::Patch FillLogReplayer::CreatePatch(const itk::Index<2>& target, const itk::Index<2>& source,
+                                                    const unsigned int patchHalfWidth, const unsigned int scale) const
+{
+  const itk::ImageRegion<2>& fullRegion = this->MaskImage->GetBufferedRegion();
+
+  // At scale k, pixel p of the log covers the k x k block of pixels starting at k*p.
+  const itk::Index<2>::IndexValueType radius = patchHalfWidth;
+  itk::Size<2> patchSize = {{(2 * patchHalfWidth + 1) * scale, (2 * patchHalfWidth + 1) * scale}};
+  itk::Index<2> targetCorner = {{(target[0] - radius) * scale, (target[1] - radius) * scale}};
+  itk::Index<2> sourceCorner = {{(source[0] - radius) * scale, (source[1] - radius) * scale}};
+
+  Patch patch;
+  patch.TargetRegion = itk::ImageRegion<2>(targetCorner, patchSize);
+  patch.TargetRegion.Crop(fullRegion);
+
+  itk::Index<2> croppedSourceCorner = {{sourceCorner[0] + patch.TargetRegion.GetIndex()[0] - targetCorner[0],
+                                        sourceCorner[1] + patch.TargetRegion.GetIndex()[1] - targetCorner[1]}};
+  patch.SourceRegion = itk::ImageRegion<2>(croppedSourceCorner, patch.TargetRegion.GetSize());
+
+  if(!fullRegion.IsInside(patch.SourceRegion))
+  {
+    std::stringstream ss;
+    ss << "FillLogReplayer: the source patch of " << source << " (for target " << target
+       << ") is not inside the image!";
+    throw std::runtime_error(ss.str());
+  }
+
+  return patch;
+}
+
+void FillLogReplayer::ApplyPatches(const std::vector<Patch>& patches)
+{
+  this->NumberOfPatches = patches.size();
+  this->NumberOfRuns = 0;
+
+  // The pixels written (target patches) and read (source patches) by the current run
+  PixelBitmap writtenPixels(this->MaskImage->GetBufferedRegion());
+  PixelBitmap readPixels(this->MaskImage->GetBufferedRegion());
+
+  std::size_t runStart = 0;
+  for(std::size_t patchId = 0; patchId <= patches.size(); ++patchId)
+  {
+    bool endRun = (patchId == patches.size());
+    if(!endRun)
+    {
+      const Patch& patch = patches[patchId];
+      endRun = writtenPixels.CountInRegion(patch.TargetRegion) > 0 ||
+               readPixels.CountInRegion(patch.TargetRegion) > 0 ||
+               writtenPixels.CountInRegion(patch.SourceRegion) > 0;
+    }
+
+    if(endRun && patchId > runStart)
+    {
+      const int runEnd = static_cast<int>(patchId);
+      #pragma omp parallel for
+      for(int i = static_cast<int>(runStart); i < runEnd; ++i) // OpenMP 3 doesn't allow unsigned loop variables
+      {
+        ApplyPatch(patches[i]);
+      }
+
+      for(std::size_t i = runStart; i < patchId; ++i)
+      {
+        MarkRegion(writtenPixels, patches[i].TargetRegion, false);
+        MarkRegion(readPixels, patches[i].SourceRegion, false);
+      }
+
+      runStart = patchId;
+      this->NumberOfRuns++;
+    }
+
+    if(patchId < patches.size())
+    {
+      MarkRegion(writtenPixels, patches[patchId].TargetRegion, true);
+      MarkRegion(readPixels, patches[patchId].SourceRegion, true);
+    }
+  }
+}
+
+void FillLogReplayer::ApplyPatch(const Patch& patch)
+{
+  Mask::PixelType* maskBuffer = this->MaskImage->GetBufferPointer();
+  const Mask::PixelType holeValue = this->MaskImage->GetHoleValue();
+
+  const std::size_t width = patch.TargetRegion.GetSize()[0];
+  const std::size_t height = patch.TargetRegion.GetSize()[1];
+
+  for(std::size_t row = 0; row < height; ++row)
+  {
+    itk::Index<2> targetRowStart = {{patch.TargetRegion.GetIndex()[0],
+                                     patch.TargetRegion.GetIndex()[1] + static_cast<itk::Index<2>::IndexValueType>(row)}};
+    itk::Index<2> sourceRowStart = {{patch.SourceRegion.GetIndex()[0],
+                                     patch.SourceRegion.GetIndex()[1] + static_cast<itk::Index<2>::IndexValueType>(row)}};
+    const std::size_t targetOffset = this->MaskImage->ComputeOffset(targetRowStart);
+    const std::size_t sourceOffset = this->MaskImage->ComputeOffset(sourceRowStart);
+
+    // Copy each span of consecutive hole pixels at once
+    std::size_t x = 0;
+    while(x < width)
+    {
+      if(maskBuffer[targetOffset + x] != holeValue)
+      {
+        ++x;
+        continue;
+      }
+
+      const std::size_t spanStart = x;
+      while(x < width && maskBuffer[targetOffset + x] == holeValue)
+      {
+        ++x;
+      }
+      const std::size_t spanLength = x - spanStart;
+
+      for(std::size_t channelId = 0; channelId < this->Channels.size(); ++channelId)
+      {
+        const Channel& channel = this->Channels[channelId];
+        std::memmove(channel.Buffer + (targetOffset + spanStart) * channel.BytesPerPixel,
+                     channel.Buffer + (sourceOffset + spanStart) * channel.BytesPerPixel,
+                     spanLength * channel.BytesPerPixel);
+      }
+
+      std::memmove(maskBuffer + targetOffset + spanStart, maskBuffer + sourceOffset + spanStart,
+                   spanLength * sizeof(Mask::PixelType));
+    }
+  }
+}
@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef FillLogReplayer_H
+#define FillLogReplayer_H
+
+// Submodules
+#include <Mask/Mask.h>
+
+// Custom
+#include "Utilities/FillLog.h"
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <utility>
+#include <vector>
+
+/**
+\class FillLogReplayer
+\brief This class applies a fill log (the list of target/source pairs of a previous inpainting)
+       directly to a mask and any number of images (channels), without any of the priority,
+       boundary or descriptor work of InpaintingAlgorithm.
+
+       As in ImageAndMaskPatchInpainter, only the pixels of a target patch that are holes when the patch
+       is applied are copied (from the image and the mask of the source patch). The hole pixels of each
+       row are copied as spans with memmove, so the pixel type of a channel does not matter (e.g. the
+       fill of an RGB image can be applied to a depth image or a label image).
+
+       The patches are split into runs of consecutive patches that are independent (no patch in a run
+       writes a pixel that another patch of the run reads or writes), and the patches of each run are
+       applied in parallel. The result is identical to applying the patches one at a time.
+*/
+class FillLogReplayer
+{
+public:
+
+  typedef std::pair<itk::Index<2>, itk::Index<2> > TargetSourcePairType;
+
+  /** 'mask' is the mask of the inpainting. It is updated as the patches are applied, so it must be
+    * the mask from before the inpainting. */
+  explicit FillLogReplayer(Mask* const mask);
+
+  /** Add an image that the fill should be applied to. Its region must be the same as the mask's. */
+  template <typename TImage>
+  void AddChannel(TImage* const image);
+
+  /** Apply all of the records of 'fillLog'. If the mask is k times larger (in both dimensions) than the
+    * image the log was written for, the patches are scaled up by k (e.g. to apply a fill that was computed
+    * on a downsampled image to the full resolution image). */
+  void Replay(const FillLogReader& fillLog);
+
+  /** Apply (target, source) pairs of patches of radius 'patchHalfWidth', scaled up by 'scale'. */
+  void Replay(const std::vector<TargetSourcePairType>& pairs, const unsigned int patchHalfWidth,
+              const unsigned int scale = 1);
+
+  /** Get the number of patches applied by the last Replay(). */
+  std::size_t GetNumberOfPatches() const;
+
+  /** Get the number of runs of independent patches found by the last Replay(). */
+  std::size_t GetNumberOfRuns() const;
+
+private:
+
+  /** The information needed to copy a patch. */
+  struct Patch
+  {
+    /** The target patch, cropped to the image. */
+    itk::ImageRegion<2> TargetRegion;
+
+    /** The source patch (cropped in the same way as the target patch). */
+    itk::ImageRegion<2> SourceRegion;
+  };
+
+  /** A channel is only a buffer (with the same layout as the mask) and the size of its pixels. */
+  struct Channel
+  {
+    char* Buffer;
+    std::size_t BytesPerPixel;
+  };
+
+  /** Compute the regions of a patch. Throws if the source patch is not inside the image. */
+  Patch CreatePatch(const itk::Index<2>& target, const itk::Index<2>& source,
+                    const unsigned int patchHalfWidth, const unsigned int scale) const;
+
+  /** Split 'patches' into runs of independent patches and apply each run in parallel. */
+  void ApplyPatches(const std::vector<Patch>& patches);
+
+  /** Copy the hole pixels of one patch in all of the channels and the mask. */
+  void ApplyPatch(const Patch& patch);
+
+  Mask* MaskImage;
+
+  std::vector<Channel> Channels;
+
+  std::size_t NumberOfPatches = 0;
+
+  std::size_t NumberOfRuns = 0;
+};
+
+#include "FillLogReplayer.hpp"
+
+#endif
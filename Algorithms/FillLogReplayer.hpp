@@ -0,0 +1,50 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef FillLogReplayer_HPP
+#define FillLogReplayer_HPP
+
+#include "FillLogReplayer.h" // Make syntax parser happy
+
+// STL
+#include <sstream>
+#include <stdexcept>
+
+template <typename TImage>
+void FillLogReplayer::AddChannel(TImage* const image)
+{
+  if(image->GetBufferedRegion() != this->MaskImage->GetBufferedRegion())
+  {
+    std::stringstream ss;
+    ss << "FillLogReplayer::AddChannel: the image region " << image->GetBufferedRegion()
+       << " is not the mask region " << this->MaskImage->GetBufferedRegion() << "!";
+    throw std::runtime_error(ss.str());
+  }
+
+  // For an itk::VectorImage the buffer holds the components, for an itk::Image it holds the pixels,
+  // so the size of a pixel is computed from the size of the buffer.
+  std::size_t numberOfPixels = image->GetBufferedRegion().GetNumberOfPixels();
+
+  Channel channel;
+  channel.Buffer = reinterpret_cast<char*>(image->GetBufferPointer());
+  channel.BytesPerPixel = sizeof(typename TImage::InternalPixelType) *
+                          (image->GetPixelContainer()->Size() / numberOfPixels);
+  this->Channels.push_back(channel);
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "IncrementalFill.h"
+
+// Custom
+#include "Utilities/PixelBitmap.h"
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+// STL
+#include <sstream>
+#include <stdexcept>
+
+namespace IncrementalFill
+{
+
+std::size_t FindRefillRegion(const FillLogReader& fillLog, const Mask* const oldMask, const Mask* const newMask,
+                             Mask* const refillMask, std::vector<bool>& keptRecords)
+{
+  const itk::ImageRegion<2> fullRegion = oldMask->GetLargestPossibleRegion();
+  if(newMask->GetLargestPossibleRegion() != fullRegion || fillLog.GetImageSize() != fullRegion.GetSize())
+  {
+    std::stringstream ss;
+    ss << "IncrementalFill::FindRefillRegion: the old mask (" << fullRegion.GetSize() << "), the new mask ("
+       << newMask->GetLargestPossibleRegion().GetSize() << ") and the fill log (" << fillLog.GetImageSize()
+       << ") must be the same size!";
+    throw std::runtime_error(ss.str());
+  }
+
+  // The holes of the previous fill as it is replayed, and the pixels whose values can not be kept
+  PixelBitmap remainingHole(fullRegion);
+  PixelBitmap dirty(fullRegion);
+
+  itk::ImageRegionConstIteratorWithIndex<Mask> maskIterator(oldMask, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    const itk::Index<2>& index = maskIterator.GetIndex();
+    if(oldMask->IsHole(index))
+    {
+      remainingHole.Insert(index);
+    }
+    else if(newMask->IsHole(index))
+    {
+      dirty.Insert(index);
+    }
+    ++maskIterator;
+  }
+
+  const itk::Index<2>::IndexValueType radius = fillLog.GetPatchRadius();
+  const itk::Size<2> patchSize = {{static_cast<itk::Size<2>::SizeValueType>(2 * radius + 1),
+                                   static_cast<itk::Size<2>::SizeValueType>(2 * radius + 1)}};
+
+  std::size_t numberOfKeptRecords = 0;
+  keptRecords.assign(fillLog.GetNumberOfRecords(), false);
+  for(std::size_t recordId = 0; recordId < fillLog.GetNumberOfRecords(); ++recordId)
+  {
+    const FillLog::Record& record = fillLog.GetRecord(recordId);
+
+    // The regions are cropped as in FillLogReplayer::CreatePatch()
+    itk::Index<2> targetCorner = {{record.TargetX - radius, record.TargetY - radius}};
+    itk::ImageRegion<2> targetRegion(targetCorner, patchSize);
+    targetRegion.Crop(fullRegion);
+
+    itk::Index<2> sourceCorner = {{record.SourceX - record.TargetX + targetRegion.GetIndex()[0],
+                                   record.SourceY - record.TargetY + targetRegion.GetIndex()[1]}};
+    itk::ImageRegion<2> sourceRegion(sourceCorner, targetRegion.GetSize());
+    if(!fullRegion.IsInside(sourceRegion))
+    {
+      std::stringstream ss;
+      ss << "IncrementalFill::FindRefillRegion: the source patch of record " << recordId
+         << " is not inside the image!";
+      throw std::runtime_error(ss.str());
+    }
+
+    const bool affected = dirty.CountInRegion(targetRegion) > 0 || dirty.CountInRegion(sourceRegion) > 0;
+    if(!affected)
+    {
+      keptRecords[recordId] = true;
+      numberOfKeptRecords++;
+    }
+
+    if(remainingHole.CountInRegion(targetRegion) == 0)
+    {
+      continue;
+    }
+
+    itk::Index<2> index;
+    for(index[1] = targetRegion.GetIndex()[1];
+        index[1] < targetRegion.GetIndex()[1] + static_cast<itk::Index<2>::IndexValueType>(targetRegion.GetSize()[1]);
+        ++index[1])
+    {
+      for(index[0] = targetRegion.GetIndex()[0];
+          index[0] < targetRegion.GetIndex()[0] + static_cast<itk::Index<2>::IndexValueType>(targetRegion.GetSize()[0]);
+          ++index[0])
+      {
+        if(!remainingHole.Contains(index))
+        {
+          continue;
+        }
+
+        remainingHole.Erase(index);
+        if(affected && newMask->IsHole(index))
+        {
+          dirty.Insert(index);
+        }
+      }
+    }
+  }
+
+  // Every hole pixel of the new mask that is not covered by a kept patch is filled again (including any pixels
+  // that the log never filled, e.g. if it was written by a run that was stopped)
+  refillMask->DeepCopyFrom(newMask);
+
+  itk::ImageRegionConstIteratorWithIndex<Mask> newMaskIterator(newMask, fullRegion);
+  while(!newMaskIterator.IsAtEnd())
+  {
+    const itk::Index<2>& index = newMaskIterator.GetIndex();
+    if(newMask->IsHole(index) && !dirty.Contains(index) && !remainingHole.Contains(index))
+    {
+      refillMask->SetPixel(index, newMask->GetValidValue());
+    }
+    ++newMaskIterator;
+  }
+
+  return numberOfKeptRecords;
+}
+
+} // end namespace
@@ -0,0 +1,55 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef IncrementalFill_H
+#define IncrementalFill_H
+
+// Submodules
+#include <Mask/Mask.h>
+
+// Custom
+#include "Utilities/FillLog.h"
+
+// STL
+#include <vector>
+
+/** Functions to re-inpaint an image after its mask was edited, reusing the previous fill where the edit cannot
+  * have changed it.
+  *
+  * The records of the previous fill log are walked in fill order while the previous mask is filled as
+  * FillLogReplayer would fill it. A pixel is "dirty" if its previous value cannot be trusted with the new mask:
+  * it was valid before and is a hole now (the mask grew), or it is still a hole and it was filled by a patch that
+  * must be redone. A patch must be redone if its target patch or its source patch contains a dirty pixel, as then
+  * the pixels it was compared with or copied from have changed. Every other patch (and the pixels it filled)
+  * is kept. Pixels that were holes and are now valid (the mask shrank) keep their previously filled values.
+  *
+  * Only the dirty pixels are holes in the resulting "refill" mask, so only they are queued and inpainted again.
+  */
+namespace IncrementalFill
+{
+
+/** Find the pixels that must be inpainted again. 'oldMask' is the mask 'fillLog' was written for and 'newMask'
+  * is the edited mask (both of the size of the log). 'refillMask' is set to 'newMask' with every hole pixel that
+  * can be kept marked as valid. 'keptRecords[i]' is set to true if record i of the log is kept.
+  * The number of kept records is returned. */
+std::size_t FindRefillRegion(const FillLogReader& fillLog, const Mask* const oldMask, const Mask* const newMask,
+                             Mask* const refillMask, std::vector<bool>& keptRecords);
+
+} // end namespace
+
+#endif
@@ -31,6 +31,7 @@
 
 // Custom
 #include <BoostHelpers/BoostHelpers.h>
+#include "Utilities/AsyncImageWriter.h"
 
 /** When this function is called, the priority-queue must already be filled with
   * all the boundary nodes (which should also have their boundaryStatusMap set appropriately).
@@ -89,6 +90,9 @@ InpaintingAlgorithm(std::shared_ptr<TVertexListGraph> graph,
     iteration++;
   } // end main iteration loop
 
+  // Make sure all of the debug images from this run are on disk before returning.
+  AsyncImageWriter::GetInstance().Flush();
+
   std::cout << "Inpainting complete after " << iteration
             << " iterations." << std::endl;
   visitor->InpaintingComplete();
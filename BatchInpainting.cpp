@@ -0,0 +1,258 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
+
+// Utilities
+#include "Utilities/BatchManifest.h"
+
+// Drivers
+#include "Drivers/BatchJobInpainting.hpp"
+
+// ITK
+#include "itkCovariantVector.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+
+typedef itk::Image<itk::CovariantVector<int, 3>, 2> OriginalImageType;
+
+/** The result of one job, as written to the report. */
+struct JobReport
+{
+  bool Succeeded = false;
+  std::string Message;
+  itk::Size<2> Size = {{0, 0}};
+  double Seconds = 0;
+  std::size_t ResidentBytes = 0;
+  std::size_t PeakResidentBytes = 0;
+};
+
+/** Read a "VmXXX:  1234 kB" line of /proc/self/status. 0 is returned if it is not available (e.g. not on Linux). */
+std::size_t GetProcessMemory(const std::string& key)
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while(std::getline(status, line))
+  {
+    if(line.compare(0, key.size(), key) == 0)
+    {
+      std::stringstream ss(line.substr(key.size() + 1));
+      std::size_t kilobytes = 0;
+      ss >> kilobytes;
+      return kilobytes * 1024;
+    }
+  }
+  return 0;
+}
+
+/** The images of a worker. They are kept from one job to the next, so a job reuses the pixel buffers of the previous
+  * job of its worker when it is not larger (itk::Image::Allocate() only reallocates when the buffer must grow). */
+struct WorkerState
+{
+  OriginalImageType::Pointer Image = OriginalImageType::New();
+  Mask::Pointer JobMask = Mask::New();
+};
+
+void RunJob(const BatchJob& job, WorkerState& state, JobReport& report)
+{
+  typedef itk::ImageFileReader<OriginalImageType> ImageReaderType;
+  ImageReaderType::Pointer imageReader = ImageReaderType::New();
+  imageReader->SetFileName(job.ImageFileName);
+  imageReader->Update();
+
+  ITKHelpers::DeepCopy(imageReader->GetOutput(), state.Image.GetPointer());
+  state.JobMask->Read(job.MaskFileName);
+
+  report.Size = state.Image->GetLargestPossibleRegion().GetSize();
+
+  BatchJobInpainting(job, state.Image, state.JobMask);
+
+  // See ClassicalImageInpainting.cpp
+  if(Helpers::GetFileExtension(job.OutputFileName) == "png")
+  {
+    ITKHelpers::WriteRGBImage(state.Image.GetPointer(), job.OutputFileName);
+  }
+  else
+  {
+    ITKHelpers::WriteImage(state.Image.GetPointer(), job.OutputFileName);
+  }
+}
+
+} // end anonymous namespace
+
+// Inpaint every image/mask pair of a manifest (see Utilities/BatchManifest.h) in one process, so ITK is only
+// initialized once and the image buffers are reused between jobs. 'numberOfWorkers' jobs run at once, and the
+// 'numberOfThreads' thread budget is divided between them (each job limits OpenMP and ITK to its share).
+// Jobs of the same size should be listed together, as each worker reuses its buffers for its next job.
+// A report with the time and the memory use of every job is written to report.csv. The memory columns are those of
+// the whole process when the job finished, so they include the jobs that were running at the same time.
+// Run with: manifest.csv
+// or, to run 4 jobs at once with 2 threads each: manifest.json 4 8 report.csv
+int main(int argc, char *argv[])
+{
+  // Verify arguments
+  if(argc < 2 || argc > 5)
+  {
+    std::cerr << "Required arguments: manifest.(csv|json) [numberOfWorkers] [numberOfThreads] [report.csv]"
+              << std::endl;
+    std::cerr << "Input arguments: ";
+    for(int i = 1; i < argc; ++i)
+    {
+      std::cerr << argv[i] << " ";
+    }
+    return EXIT_FAILURE;
+  }
+
+  // Parse arguments
+  std::string manifestFileName = argv[1];
+
+  unsigned int numberOfWorkers = 1;
+  if(argc > 2)
+  {
+    std::stringstream ssNumberOfWorkers;
+    ssNumberOfWorkers << argv[2];
+    ssNumberOfWorkers >> numberOfWorkers;
+  }
+
+  unsigned int numberOfThreads = std::thread::hardware_concurrency();
+  if(argc > 3)
+  {
+    std::stringstream ssNumberOfThreads;
+    ssNumberOfThreads << argv[3];
+    ssNumberOfThreads >> numberOfThreads;
+  }
+
+  std::string reportFileName = "report.csv";
+  if(argc > 4)
+  {
+    reportFileName = argv[4];
+  }
+
+  std::vector<BatchJob> jobs;
+  try
+  {
+    jobs = BatchManifest::Read(manifestFileName);
+  }
+  catch(const std::runtime_error& error)
+  {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  unsigned int threadsPerJob = 1;
+  BatchManifest::DivideThreads(numberOfThreads, jobs.size(), numberOfWorkers, threadsPerJob);
+
+  std::cout << "Running " << jobs.size() << " jobs on " << numberOfWorkers << " workers with "
+            << threadsPerJob << " threads each." << std::endl;
+
+  // ITK filters started by any job use at most this job's share of the threads
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(threadsPerJob);
+
+  std::vector<JobReport> reports(jobs.size());
+  std::atomic<unsigned int> nextJob(0);
+  std::mutex outputMutex;
+
+  auto worker = [&]()
+  {
+#ifdef _OPENMP
+    // The OpenMP thread count is a per-thread setting, so it only applies to the parallel regions of this worker
+    omp_set_num_threads(threadsPerJob);
+#endif
+
+    WorkerState state;
+    for(unsigned int jobId = nextJob++; jobId < jobs.size(); jobId = nextJob++)
+    {
+      JobReport& report = reports[jobId];
+      auto start = std::chrono::steady_clock::now();
+      try
+      {
+        RunJob(jobs[jobId], state, report);
+        report.Succeeded = true;
+      }
+      catch(const std::exception& error)
+      {
+        report.Message = error.what();
+      }
+      report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      report.ResidentBytes = GetProcessMemory("VmRSS:");
+      report.PeakResidentBytes = GetProcessMemory("VmHWM:");
+
+      std::lock_guard<std::mutex> lock(outputMutex);
+      std::cout << "Job " << jobId << " (" << jobs[jobId].ImageFileName << ") "
+                << (report.Succeeded ? "finished" : "failed: " + report.Message)
+                << " in " << report.Seconds << "s." << std::endl;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for(unsigned int i = 0; i < numberOfWorkers; ++i)
+  {
+    workers.push_back(std::thread(worker));
+  }
+
+  for(unsigned int i = 0; i < workers.size(); ++i)
+  {
+    workers[i].join();
+  }
+
+  std::ofstream reportFile(reportFileName.c_str());
+  reportFile << "job,image,output,driver,width,height,threads,seconds,residentMB,peakResidentMB,status" << std::endl;
+
+  unsigned int numberOfFailedJobs = 0;
+  for(unsigned int jobId = 0; jobId < jobs.size(); ++jobId)
+  {
+    const JobReport& report = reports[jobId];
+    if(!report.Succeeded)
+    {
+      numberOfFailedJobs++;
+    }
+
+    reportFile << jobId << "," << jobs[jobId].ImageFileName << "," << jobs[jobId].OutputFileName << ","
+               << jobs[jobId].Driver << "," << report.Size[0] << "," << report.Size[1] << ","
+               << threadsPerJob << "," << report.Seconds << ","
+               << report.ResidentBytes / (1024 * 1024) << "," << report.PeakResidentBytes / (1024 * 1024) << ","
+               << (report.Succeeded ? "ok" : "failed") << std::endl;
+  }
+
+  std::cout << jobs.size() - numberOfFailedJobs << " of " << jobs.size() << " jobs succeeded. Report written to "
+            << reportFileName << std::endl;
+
+  return numberOfFailedJobs == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
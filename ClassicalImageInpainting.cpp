@@ -17,6 +17,8 @@
  *=========================================================================*/
 
 // Custom
+#include "Utilities/Checkpoint.h"
+#include "Utilities/FillLog.h"
 #include "Utilities/IndirectPriorityQueue.h"
 
 // Submodules
@@ -64,14 +66,26 @@
 #include <boost/property_map/property_map.hpp>
 
 #include "Drivers/ClassicalImageInpainting.hpp"
+#include "Drivers/PyramidInpainting.hpp"
+#include "Drivers/WorkingSetInpainting.hpp"
 
 // Run with: Data/trashcan.png Data/trashcan.mask 15 filled.png
+// or, to inpaint coarse-to-fine with 3 pyramid levels and a local search radius of 4:
+//           Data/trashcan.png Data/trashcan.mask 15 filled.png 3 4
+// or, to only inpaint the hole bounding box plus a margin of 15 + 100 pixels (without a pyramid):
+//           Data/trashcan.png Data/trashcan.mask 15 filled.png 1 4 100
+// or, to save a checkpoint every 500 iterations or 10 minutes (run the same command again to resume):
+//           Data/trashcan.png Data/trashcan.mask 15 filled.png 1 4 0 trashcan.ckpt 500 600
+// or, to write a fill log (e.g. for IncrementalInpainting), which can not be combined with a checkpoint:
+//           Data/trashcan.png Data/trashcan.mask 15 filled.png 1 4 0 "" 0 0 filled.fill
 int main(int argc, char *argv[])
 {
   // Verify arguments
-  if(argc != 5)
+  if(argc < 5 || argc > 12)
   {
-    std::cerr << "Required arguments: image.png imageMask.mask patchHalfWidth output.png" << std::endl;
+    std::cerr << "Required arguments: image.png imageMask.mask patchHalfWidth output.png"
+              << " [numberOfPyramidLevels] [pyramidSearchRadius] [workingSetSearchRadius (0 = full image)]"
+              << " [checkpoint.ckpt] [checkpointIterations] [checkpointSeconds] [fillLog.fill]" << std::endl;
     std::cerr << "Input arguments: ";
     for(int i = 1; i < argc; ++i)
     {
@@ -91,6 +105,83 @@ int main(int argc, char *argv[])
 
   std::string outputFileName = argv[4];
 
+  unsigned int numberOfPyramidLevels = 1;
+  if(argc > 5)
+  {
+    std::stringstream ssNumberOfPyramidLevels;
+    ssNumberOfPyramidLevels << argv[5];
+    ssNumberOfPyramidLevels >> numberOfPyramidLevels;
+  }
+
+  unsigned int pyramidSearchRadius = 4;
+  if(argc > 6)
+  {
+    std::stringstream ssPyramidSearchRadius;
+    ssPyramidSearchRadius << argv[6];
+    ssPyramidSearchRadius >> pyramidSearchRadius;
+  }
+
+  // By default source patches may come from anywhere, so the whole image is inpainted
+  unsigned int workingSetSearchRadius = WorkingSet::FullImageSearch;
+  if(argc > 7)
+  {
+    std::stringstream ssWorkingSetSearchRadius;
+    ssWorkingSetSearchRadius << argv[7];
+    ssWorkingSetSearchRadius >> workingSetSearchRadius;
+    if(workingSetSearchRadius == 0)
+    {
+      workingSetSearchRadius = WorkingSet::FullImageSearch;
+    }
+  }
+
+  CheckpointSettings checkpointSettings;
+  checkpointSettings.IterationInterval = 500;
+  checkpointSettings.SecondsInterval = 600;
+  if(argc > 8)
+  {
+    checkpointSettings.FileName = argv[8];
+  }
+
+  if(argc > 9)
+  {
+    std::stringstream ssCheckpointIterations;
+    ssCheckpointIterations << argv[9];
+    ssCheckpointIterations >> checkpointSettings.IterationInterval;
+  }
+
+  if(argc > 10)
+  {
+    std::stringstream ssCheckpointSeconds;
+    ssCheckpointSeconds << argv[10];
+    ssCheckpointSeconds >> checkpointSettings.SecondsInterval;
+  }
+
+  std::string fillLogFileName;
+  if(argc > 11)
+  {
+    fillLogFileName = argv[11];
+  }
+
+  if(numberOfPyramidLevels > 1 && !checkpointSettings.FileName.empty())
+  {
+    std::cerr << "Checkpointing is not supported with a pyramid." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(numberOfPyramidLevels > 1 && !fillLogFileName.empty())
+  {
+    std::cerr << "A fill log can not be written with a pyramid." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The fill log is rewritten from the start, so after resuming from a checkpoint it would be missing the patches
+  // that were filled before the checkpoint.
+  if(!checkpointSettings.FileName.empty() && !fillLogFileName.empty())
+  {
+    std::cerr << "A fill log can not be written with a checkpoint." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   // Output arguments
 //  std::cout << "Reading image: " << imageFilename << std::endl;
 //  std::cout << "Reading mask: " << maskFilename << std::endl;
@@ -112,7 +203,45 @@ int main(int argc, char *argv[])
   Mask::Pointer mask = Mask::New();
   mask->Read(maskFilename);
 
-  ClassicalImageInpainting(originalImage, mask, patchHalfWidth);
+  // The fill is logged in the coordinates of the full image, the working set starts at this corner
+  std::unique_ptr<FillLogWriter> fillLogWriter;
+  InpaintingFillCallback fillCallback;
+  if(!fillLogFileName.empty())
+  {
+    fillLogWriter.reset(new FillLogWriter(fillLogFileName, mask->GetLargestPossibleRegion(), patchHalfWidth,
+                                          FillLog::ComputeInputChecksum(originalImage.GetPointer(),
+                                                                        mask.GetPointer())));
+    itk::Index<2> workingRegionCorner =
+        WorkingSet::GetWorkingRegion(mask, patchHalfWidth, workingSetSearchRadius).GetIndex();
+    fillCallback = [&fillLogWriter, workingRegionCorner](const itk::Index<2>& target, const itk::Index<2>& source)
+    {
+      itk::Index<2> fullTarget = {{target[0] + workingRegionCorner[0], target[1] + workingRegionCorner[1]}};
+      itk::Index<2> fullSource = {{source[0] + workingRegionCorner[0], source[1] + workingRegionCorner[1]}};
+      fillLogWriter->Write(fullTarget, fullSource);
+    };
+  }
+
+  auto inpaint = [&](OriginalImageType::Pointer workingImage, Mask::Pointer workingMask)
+  {
+    if(numberOfPyramidLevels > 1)
+    {
+      PyramidInpainting(workingImage, workingMask, patchHalfWidth, numberOfPyramidLevels, pyramidSearchRadius);
+    }
+    else
+    {
+      ClassicalImageInpaintingSettings settings;
+      settings.Checkpointing = checkpointSettings;
+      settings.FillCallback = fillCallback;
+      ClassicalImageInpainting(workingImage, workingMask, patchHalfWidth, settings);
+    }
+  };
+
+  WorkingSetInpainting(originalImage, mask, patchHalfWidth, workingSetSearchRadius, inpaint);
+
+  if(fillLogWriter)
+  {
+    fillLogWriter->Close();
+  }
 
   // If the output filename is a png file, then use the RGBImage writer so that it is first
   // casted to unsigned char. Otherwise, write the file directly.
@@ -22,6 +22,8 @@
 #include <boost/graph/graph_concepts.hpp>
 #include <boost/concept_check.hpp>
 
+#include <vector>
+
 /**
  * This concept-check class defines the functions that a descriptor visitor must have in order to be 
  * used by an inpainting visitor.
@@ -42,6 +44,9 @@ struct DescriptorVisitorConcept
     // Function to initialize a vertex
     visitor.InitializeVertex(u);
 
+    // Function to initialize many vertices at once
+    visitor.InitializeVertices(std::vector<Vertex>(1, u));
+
     // Function called when a vertex has become the target patch
     visitor.DiscoverVertex(u);
   }
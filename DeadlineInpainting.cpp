@@ -0,0 +1,140 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "Utilities/DeadlineController.h"
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
+
+// ITK
+#include "itkImageFileReader.h"
+
+// Drivers
+#include "Drivers/DeadlineInpainting.hpp"
+
+// STL
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Run with: Data/trashcan.png Data/trashcan.mask 15 filled.png 60
+// or, to write the degradations to a report and to start from 200 nearest neighbors, with a local search radius
+// of 50 and a candidate stride of at most 8:
+//           Data/trashcan.png Data/trashcan.mask 15 filled.png 60 report.txt 200 50 8
+int main(int argc, char *argv[])
+{
+  // Verify arguments
+  if(argc < 6 || argc > 10)
+  {
+    std::cerr << "Required arguments: image.png imageMask.mask patchHalfWidth output.png budgetSeconds"
+              << " [report.txt] [numberOfKNN] [localSearchRadius (0 = never search locally)] [maximumStride]"
+              << std::endl;
+    std::cerr << "Input arguments: ";
+    for(int i = 1; i < argc; ++i)
+    {
+      std::cerr << argv[i] << " ";
+    }
+    return EXIT_FAILURE;
+  }
+
+  // Parse arguments
+  std::string imageFilename = argv[1];
+  std::string maskFilename = argv[2];
+
+  std::stringstream ssPatchHalfWidth;
+  ssPatchHalfWidth << argv[3];
+  unsigned int patchHalfWidth = 0;
+  ssPatchHalfWidth >> patchHalfWidth;
+
+  std::string outputFileName = argv[4];
+
+  std::stringstream ssBudget;
+  ssBudget << argv[5];
+  double budgetSeconds = 0.0;
+  ssBudget >> budgetSeconds;
+
+  std::string reportFileName;
+  if(argc > 6)
+  {
+    reportFileName = argv[6];
+  }
+
+  unsigned int numberOfKNN = 100;
+  if(argc > 7)
+  {
+    std::stringstream ssNumberOfKNN;
+    ssNumberOfKNN << argv[7];
+    ssNumberOfKNN >> numberOfKNN;
+  }
+
+  unsigned int localSearchRadius = 100;
+  if(argc > 8)
+  {
+    std::stringstream ssLocalSearchRadius;
+    ssLocalSearchRadius << argv[8];
+    ssLocalSearchRadius >> localSearchRadius;
+  }
+
+  unsigned int maximumStride = 8;
+  if(argc > 9)
+  {
+    std::stringstream ssMaximumStride;
+    ssMaximumStride << argv[9];
+    ssMaximumStride >> maximumStride;
+  }
+
+  typedef itk::Image<itk::CovariantVector<int, 3>, 2> OriginalImageType;
+
+  typedef  itk::ImageFileReader<OriginalImageType> ImageReaderType;
+  ImageReaderType::Pointer imageReader = ImageReaderType::New();
+  imageReader->SetFileName(imageFilename);
+  imageReader->Update();
+
+  OriginalImageType::Pointer originalImage = OriginalImageType::New();
+  ITKHelpers::DeepCopy(imageReader->GetOutput(), originalImage.GetPointer());
+
+  Mask::Pointer mask = Mask::New();
+  mask->Read(maskFilename);
+
+  DeadlineController controller(budgetSeconds, numberOfKNN, localSearchRadius, maximumStride);
+
+  DeadlineInpainting(originalImage, mask.GetPointer(), patchHalfWidth, controller);
+
+  controller.WriteReport(std::cout);
+  if(!reportFileName.empty())
+  {
+    std::ofstream reportFile(reportFileName.c_str());
+    controller.WriteReport(reportFile);
+  }
+
+  // If the output filename is a png file, then use the RGBImage writer so that it is first
+  // casted to unsigned char. Otherwise, write the file directly.
+  if(Helpers::GetFileExtension(outputFileName) == "png")
+  {
+    ITKHelpers::WriteRGBImage(originalImage.GetPointer(), outputFileName);
+  }
+  else
+  {
+    ITKHelpers::WriteImage(originalImage.GetPointer(), outputFileName);
+  }
+
+  return EXIT_SUCCESS;
+}
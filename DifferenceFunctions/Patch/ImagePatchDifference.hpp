@@ -136,6 +136,48 @@ struct ImagePatchDifference
     return totalDifference;
   }
 
+  /** The same as operator()(sourcePatch, targetPatch, targetPixels), but the comparison stops as soon as the
+    * difference is known to be larger than 'bound' (e.g. the difference of the best patch found so far).
+    * The returned value is then only known to be larger than 'bound', not the exact difference. */
+  float operator()(const ImagePatchType& sourcePatch, const ImagePatchType& targetPatch,
+                   const std::vector<typename ImagePatchType::ImageType::PixelType>& targetPixels,
+                   const float bound) const
+  {
+    assert(targetPixels.size() == targetPatch.GetValidOffsetsAddress()->size());
+
+    if(sourcePatch.GetStatus() != ImagePatchType::SOURCE_NODE)
+    {
+      return std::numeric_limits<float>::max();
+    }
+
+    typename ImagePatchType::ImageType* image = targetPatch.GetImage();
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = targetPatch.GetValidOffsetsAddress();
+
+    assert(validOffsets->size() > 0);
+
+    // The average is larger than 'bound' as soon as the sum is larger than this
+    const float totalBound = bound * static_cast<float>(validOffsets->size());
+
+    float totalDifference = 0.0f;
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      typename ImagePatchType::ImageType::PixelType sourcePixel =
+          image->GetPixel(sourcePatch.GetCorner() + *offsetIterator);
+
+      totalDifference += this->PixelDifferenceFunctor(sourcePixel,
+                                                      targetPixels[offsetIterator - validOffsets->begin()]);
+      if(totalDifference > totalBound)
+      {
+        break;
+      }
+    }
+
+    return totalDifference / static_cast<float>(validOffsets->size());
+  }
+
 };
 
 #endif
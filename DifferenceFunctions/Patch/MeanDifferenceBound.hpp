@@ -0,0 +1,172 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef MeanDifferenceBound_hpp
+#define MeanDifferenceBound_hpp
+
+// Custom
+#include "Utilities/SummedAreaTable.h"
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKContainerInterface.h>
+
+// ITK
+#include "itkImageRegion.h"
+#include "itkOffset.h"
+
+// STL
+#include <algorithm>
+#include <vector>
+
+/** A lower bound of the difference that ImagePatchDifference<..., SumSquaredPixelDifference> computes between
+  * a target patch and a source patch. For the n valid pixels of the target patch,
+  *   (1/n) * SSD >= sum over channels c of (mean_s,c - mean_t,c)^2
+  * where both means are taken over the valid offsets of the target (this is the Cauchy-Schwarz inequality).
+  * The target mean is computed once per target in SetTarget(). The valid offsets are split into
+  * rectangles (runs of each row, merged with identical runs of the rows below them), so the source mean only
+  * needs 4 summed area table lookups per rectangle rather than a pass over the patch.
+  */
+template <typename TImage>
+struct MeanDifferenceBound
+{
+  const SummedAreaTable<TImage>* Table;
+
+  /** The valid offsets of the target, as rectangles relative to the patch corner. */
+  std::vector<itk::ImageRegion<2> > Rectangles;
+
+  std::vector<double> TargetMeans;
+
+  double NumberOfValidPixels = 0.0;
+
+  explicit MeanDifferenceBound(const SummedAreaTable<TImage>* const table) : Table(table)
+  {
+
+  }
+
+  /** 'targetPixels' are the values of the target at 'validOffsets' (as used by ImagePatchDifference). */
+  void SetTarget(const std::vector<itk::Offset<2> >& validOffsets,
+                 const std::vector<typename TImage::PixelType>& targetPixels)
+  {
+    const unsigned int numberOfComponents = this->Table->GetNumberOfComponents();
+    this->NumberOfValidPixels = static_cast<double>(validOffsets.size());
+
+    this->TargetMeans.assign(numberOfComponents, 0.0);
+    for(std::size_t pixelId = 0; pixelId < targetPixels.size(); ++pixelId)
+    {
+      for(unsigned int component = 0; component < numberOfComponents; ++component)
+      {
+        this->TargetMeans[component] += Helpers::index(targetPixels[pixelId], component);
+      }
+    }
+
+    for(unsigned int component = 0; component < numberOfComponents; ++component)
+    {
+      this->TargetMeans[component] /= std::max(this->NumberOfValidPixels, 1.0);
+    }
+
+    // Sort the offsets by row, then split each row into runs of consecutive offsets
+    std::vector<itk::Offset<2> > sortedOffsets = validOffsets;
+    std::sort(sortedOffsets.begin(), sortedOffsets.end(),
+              [](const itk::Offset<2>& a, const itk::Offset<2>& b)
+    {
+      return a[1] < b[1] || (a[1] == b[1] && a[0] < b[0]);
+    });
+
+    this->Rectangles.clear();
+    std::vector<itk::ImageRegion<2> > currentRowRuns;
+    std::size_t offsetId = 0;
+    while(offsetId < sortedOffsets.size())
+    {
+      const itk::OffsetValueType row = sortedOffsets[offsetId][1];
+      currentRowRuns.clear();
+      while(offsetId < sortedOffsets.size() && sortedOffsets[offsetId][1] == row)
+      {
+        std::size_t runEnd = offsetId + 1;
+        while(runEnd < sortedOffsets.size() && sortedOffsets[runEnd][1] == row &&
+              sortedOffsets[runEnd][0] == sortedOffsets[runEnd - 1][0] + 1)
+        {
+          ++runEnd;
+        }
+
+        itk::Index<2> runCorner = {{sortedOffsets[offsetId][0], row}};
+        itk::Size<2> runSize = {{static_cast<itk::SizeValueType>(runEnd - offsetId), 1}};
+        currentRowRuns.push_back(itk::ImageRegion<2>(runCorner, runSize));
+        offsetId = runEnd;
+      }
+
+      // A run that continues a rectangle of the row above (same columns) makes it one row taller
+      for(const itk::ImageRegion<2>& run : currentRowRuns)
+      {
+        bool merged = false;
+        for(itk::ImageRegion<2>& rectangle : this->Rectangles)
+        {
+          if(rectangle.GetIndex()[0] == run.GetIndex()[0] && rectangle.GetSize()[0] == run.GetSize()[0] &&
+             rectangle.GetIndex()[1] + static_cast<itk::IndexValueType>(rectangle.GetSize()[1]) == row)
+          {
+            itk::Size<2> tallerSize = {{rectangle.GetSize()[0], rectangle.GetSize()[1] + 1}};
+            rectangle.SetSize(tallerSize);
+            merged = true;
+            break;
+          }
+        }
+
+        if(!merged)
+        {
+          this->Rectangles.push_back(run);
+        }
+      }
+    }
+  }
+
+  /** Get the lower bound of the difference of the source patch with corner 'sourceCorner'. */
+  float operator()(const itk::Index<2>& sourceCorner) const
+  {
+    if(this->Rectangles.empty())
+    {
+      return 0.0f;
+    }
+
+    const unsigned int numberOfComponents = this->Table->GetNumberOfComponents();
+    double sums[16] = {0.0};
+    std::vector<double> largeSums;
+    double* componentSums = sums;
+    if(numberOfComponents > 16)
+    {
+      largeSums.assign(numberOfComponents, 0.0);
+      componentSums = largeSums.data();
+    }
+
+    for(const itk::ImageRegion<2>& rectangle : this->Rectangles)
+    {
+      itk::Index<2> corner = {{sourceCorner[0] + rectangle.GetIndex()[0], sourceCorner[1] + rectangle.GetIndex()[1]}};
+      this->Table->AddSum(itk::ImageRegion<2>(corner, rectangle.GetSize()), componentSums);
+    }
+
+    double bound = 0.0;
+    for(unsigned int component = 0; component < numberOfComponents; ++component)
+    {
+      const double meanDifference = componentSums[component] / this->NumberOfValidPixels -
+                                    this->TargetMeans[component];
+      bound += meanDifference * meanDifference;
+    }
+    return static_cast<float>(bound);
+  }
+};
+
+#endif
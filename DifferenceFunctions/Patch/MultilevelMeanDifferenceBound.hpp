@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef MultilevelMeanDifferenceBound_HPP
+#define MultilevelMeanDifferenceBound_HPP
+
+// Custom
+#include "MeanDifferenceBound.hpp"
+
+// ITK
+#include "itkOffset.h"
+
+// STL
+#include <algorithm>
+#include <vector>
+
+/** A hierarchy of lower bounds of the difference that ImagePatchDifference<..., SumSquaredPixelDifference>
+  * computes, for successive elimination. At level l the bounding box of the valid offsets of the target is split
+  * into 2^l x 2^l blocks (level 0 is the whole patch, level 1 the quadrants, level 2 the sixteenths, ...), and
+  *   (1/n) * SSD >= (1/n) * sum over blocks b of n_b * sum over channels c of (mean_s,b,c - mean_t,b,c)^2
+  * where n_b is the number of valid pixels of the target in block b. Each block is a MeanDifferenceBound over the
+  * same summed area table, and the bound of a level is never smaller than the bound of the level above it.
+  */
+template <typename TImage>
+struct MultilevelMeanDifferenceBound
+{
+  /** The bound of each block of a level, and the fraction of the valid pixels of the target in the block. */
+  struct Level
+  {
+    std::vector<MeanDifferenceBound<TImage> > Blocks;
+    std::vector<double> Weights;
+  };
+
+  const SummedAreaTable<TImage>* Table;
+
+  std::vector<Level> Levels;
+
+  MultilevelMeanDifferenceBound(const SummedAreaTable<TImage>* const table, const unsigned int numberOfLevels) :
+    Table(table), Levels(numberOfLevels)
+  {
+
+  }
+
+  unsigned int GetNumberOfLevels() const
+  {
+    return static_cast<unsigned int>(this->Levels.size());
+  }
+
+  /** 'targetPixels' are the values of the target at 'validOffsets' (as used by ImagePatchDifference). */
+  void SetTarget(const std::vector<itk::Offset<2> >& validOffsets,
+                 const std::vector<typename TImage::PixelType>& targetPixels)
+  {
+    itk::Offset<2> minimumOffset = {{0, 0}};
+    itk::Offset<2> maximumOffset = {{0, 0}};
+    if(!validOffsets.empty())
+    {
+      minimumOffset = validOffsets[0];
+      maximumOffset = validOffsets[0];
+    }
+
+    for(const itk::Offset<2>& offset : validOffsets)
+    {
+      for(unsigned int dimension = 0; dimension < 2; ++dimension)
+      {
+        minimumOffset[dimension] = std::min(minimumOffset[dimension], offset[dimension]);
+        maximumOffset[dimension] = std::max(maximumOffset[dimension], offset[dimension]);
+      }
+    }
+
+    std::vector<itk::Offset<2> > blockOffsets;
+    std::vector<typename TImage::PixelType> blockPixels;
+    for(std::size_t levelId = 0; levelId < this->Levels.size(); ++levelId)
+    {
+      Level& level = this->Levels[levelId];
+      level.Blocks.clear();
+      level.Weights.clear();
+
+      const itk::OffsetValueType blocksPerSide = static_cast<itk::OffsetValueType>(1) << levelId;
+      std::vector<std::size_t> blockIds(validOffsets.size());
+      for(std::size_t pixelId = 0; pixelId < validOffsets.size(); ++pixelId)
+      {
+        std::size_t blockId = 0;
+        for(int dimension = 1; dimension >= 0; --dimension)
+        {
+          const itk::OffsetValueType sideLength = maximumOffset[dimension] - minimumOffset[dimension] + 1;
+          blockId = blockId * blocksPerSide +
+                    (validOffsets[pixelId][dimension] - minimumOffset[dimension]) * blocksPerSide / sideLength;
+        }
+        blockIds[pixelId] = blockId;
+      }
+
+      for(std::size_t blockId = 0; blockId < static_cast<std::size_t>(blocksPerSide * blocksPerSide); ++blockId)
+      {
+        blockOffsets.clear();
+        blockPixels.clear();
+        for(std::size_t pixelId = 0; pixelId < validOffsets.size(); ++pixelId)
+        {
+          if(blockIds[pixelId] == blockId)
+          {
+            blockOffsets.push_back(validOffsets[pixelId]);
+            blockPixels.push_back(targetPixels[pixelId]);
+          }
+        }
+
+        // Blocks without valid pixels do not contribute to the difference
+        if(blockOffsets.empty())
+        {
+          continue;
+        }
+
+        level.Blocks.push_back(MeanDifferenceBound<TImage>(this->Table));
+        level.Blocks.back().SetTarget(blockOffsets, blockPixels);
+        level.Weights.push_back(static_cast<double>(blockOffsets.size()) / validOffsets.size());
+      }
+    }
+  }
+
+  /** Get the lower bound at 'levelId' of the difference of the source patch with corner 'sourceCorner'. */
+  float operator()(const unsigned int levelId, const itk::Index<2>& sourceCorner) const
+  {
+    const Level& level = this->Levels[levelId];
+    double bound = 0.0;
+    for(std::size_t blockId = 0; blockId < level.Blocks.size(); ++blockId)
+    {
+      bound += level.Weights[blockId] * level.Blocks[blockId](sourceCorner);
+    }
+    return static_cast<float>(bound);
+  }
+};
+
+#endif
@@ -0,0 +1,61 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef BatchJobInpainting_HPP
+#define BatchJobInpainting_HPP
+
+// Custom
+#include "Utilities/BatchManifest.h"
+#include "Utilities/WorkingSet.h"
+
+// Drivers
+#include "Drivers/ClassicalImageInpainting.hpp"
+#include "Drivers/PyramidInpainting.hpp"
+#include "Drivers/WorkingSetInpainting.hpp"
+
+/** Inpaint 'image' and 'mask' (which have already been read) with the driver and the settings of 'job'
+  * (see BatchManifest). 'progressCallback' is passed on to the driver. */
+template <typename TImage>
+void BatchJobInpainting(const BatchJob& job, typename itk::SmartPointer<TImage> image, Mask::Pointer mask,
+                        const InpaintingProgressCallback& progressCallback = InpaintingProgressCallback())
+{
+  auto inpaint = [&](typename TImage::Pointer workingImage, Mask::Pointer workingMask)
+  {
+    if(job.Driver == "pyramid")
+    {
+      PyramidInpainting(workingImage, workingMask, job.PatchHalfWidth, job.NumberOfPyramidLevels,
+                        job.PyramidSearchRadius, progressCallback);
+    }
+    else
+    {
+      ClassicalImageInpaintingSettings settings;
+      settings.ProgressCallback = progressCallback;
+      ClassicalImageInpainting(workingImage, workingMask, job.PatchHalfWidth, settings);
+    }
+  };
+
+  unsigned int workingSetSearchRadius = job.WorkingSetSearchRadius;
+  if(workingSetSearchRadius == 0)
+  {
+    workingSetSearchRadius = WorkingSet::FullImageSearch;
+  }
+
+  WorkingSetInpainting(image, mask, job.PatchHalfWidth, workingSetSearchRadius, inpaint);
+}
+
+#endif
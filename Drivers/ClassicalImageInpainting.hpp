@@ -20,7 +20,10 @@
 #define ClassicalImageInpainting_HPP
 
 // Custom
+#include "Utilities/Checkpoint.h"
+#include "Utilities/FillLog.h"
 #include "Utilities/IndirectPriorityQueue.h"
+#include "Utilities/SourcePixelMap.h"
 
 // STL
 #include <memory>
@@ -36,11 +39,19 @@
 
 // Inpainting visitors
 #include "Visitors/InpaintingVisitors/InpaintingVisitor.hpp"
+#include "Visitors/InpaintingVisitors/CompositeInpaintingVisitor.hpp"
+#include "Visitors/InformationVisitors/CheckpointVisitor.hpp"
+#include "Visitors/InformationVisitors/FillCallbackVisitor.hpp"
+#include "Visitors/InformationVisitors/ProgressVisitor.hpp"
 #include "Visitors/AcceptanceVisitors/DefaultAcceptanceVisitor.hpp"
 
 // Nearest neighbors
 #include "NearestNeighbor/LinearSearchBest/Property.hpp"
 #include "NearestNeighbor/LinearSearchBest/FirstAndWrite.hpp"
+#include "NearestNeighbor/SearchRegionBest.hpp"
+
+// Search regions
+#include "SearchRegions/OffsetWindowSearch.hpp"
 
 // Initializers
 #include "Initializers/InitializeFromMaskImage.hpp"
@@ -69,12 +80,47 @@
 #include <boost/graph/grid_graph.hpp>
 #include <boost/property_map/property_map.hpp>
 
+/** The optional parts of a ClassicalImageInpainting() run. The defaults inpaint with an exhaustive search and
+  * nothing else. */
+struct ClassicalImageInpaintingSettings
+{
+  /** If this is given, each target patch is only compared to the source patches within GuessSearchRadius of the
+    * positions it guesses (see OffsetWindowSearch). */
+  const SourcePixelMap::ImageType* SourcePixelGuess = nullptr;
+
+  unsigned int GuessSearchRadius = 0;
+
+  /** If this is given, the pixel that each hole pixel was copied from is stored in it when the inpainting is
+    * complete. */
+  SourcePixelMap::ImageType* SourcePixelMapImage = nullptr;
+
+  /** If this has a file name, the state of the run is saved to it periodically, and if the file already holds a
+    * checkpoint of the same image, mask and patch size, the run continues from it and produces exactly the same
+    * result as an uninterrupted run. */
+  CheckpointSettings Checkpointing;
+
+  /** If this is set, it is called after every iteration (see ProgressVisitor). */
+  InpaintingProgressCallback ProgressCallback;
+
+  /** If this is set, it is given every (target, source) pair (see FillCallbackVisitor). */
+  InpaintingFillCallback FillCallback;
+};
+
 template <typename TImage>
 void ClassicalImageInpainting(typename itk::SmartPointer<TImage> originalImage, Mask* const mask,
-                              const unsigned int patchHalfWidth)
+                              const unsigned int patchHalfWidth,
+                              const ClassicalImageInpaintingSettings& settings = ClassicalImageInpaintingSettings())
 {
   itk::ImageRegion<2> fullRegion = originalImage->GetLargestPossibleRegion();
 
+  // Identify the inputs, so that a checkpoint is only resumed by a run of the same problem
+  std::uint64_t inputChecksum = 0;
+  if(!settings.Checkpointing.FileName.empty())
+  {
+    inputChecksum = FillLog::ComputeInputChecksum(originalImage.GetPointer(), mask);
+    inputChecksum = FillLog::ComputeChecksum(&patchHalfWidth, sizeof(patchHalfWidth), inputChecksum);
+  }
+
   // Blur the image
   typedef TImage BlurredImageType; // Usually the blurred image is the same type as the original image.
   typename BlurredImageType::Pointer blurredImage = BlurredImageType::New();
@@ -150,6 +196,71 @@ void ClassicalImageInpainting(typename itk::SmartPointer<TImage> originalImage,
   // Initialize the boundary node queue from the user provided mask image.
   InitializeFromMaskImage<InpaintingVisitorType, VertexDescriptorType>(mask, inpaintingVisitor.get());
 
+  typedef CompositeInpaintingVisitor<VertexListGraphType> CompositeInpaintingVisitorType;
+  std::shared_ptr<CompositeInpaintingVisitorType> compositeInpaintingVisitor(new CompositeInpaintingVisitorType);
+  compositeInpaintingVisitor->AddVisitor(inpaintingVisitor);
+
+  if(!settings.Checkpointing.FileName.empty())
+  {
+    // Everything that changes during the run. The descriptor map, the graph and the patch statuses are
+    // recreated from the original image and mask above, exactly as in the original run.
+    auto saveState = [=](Checkpoint& checkpoint)
+    {
+      checkpoint.AddValue("InputChecksum", inputChecksum);
+      checkpoint.AddImage("Image", originalImage.GetPointer());
+      checkpoint.AddImage("BlurredImage", blurredImage.GetPointer());
+      checkpoint.AddImage("Mask", mask);
+      priorityFunction->SaveState(checkpoint);
+      boundaryNodeQueue->SaveState(checkpoint);
+      inpaintingVisitor->SaveState(checkpoint);
+    };
+
+    if(settings.Checkpointing.Resume && Checkpoint::IsCheckpoint(settings.Checkpointing.FileName))
+    {
+      Checkpoint checkpoint;
+      checkpoint.Read(settings.Checkpointing.FileName);
+      if(checkpoint.GetValue<std::uint64_t>("InputChecksum") != inputChecksum)
+      {
+        throw std::runtime_error("ClassicalImageInpainting: " + settings.Checkpointing.FileName +
+                                 " is a checkpoint of a different image, mask or patch size!");
+      }
+
+      checkpoint.GetImage("Image", originalImage.GetPointer());
+      checkpoint.GetImage("BlurredImage", blurredImage.GetPointer());
+      checkpoint.GetImage("Mask", mask);
+      priorityFunction->LoadState(checkpoint);
+      boundaryNodeQueue->LoadState(checkpoint);
+      inpaintingVisitor->LoadState(checkpoint);
+
+      std::cout << "Resuming from " << settings.Checkpointing.FileName << " after "
+                << inpaintingVisitor->GetNumberOfFinishedPatches() << " patches." << std::endl;
+    }
+
+    typedef CheckpointVisitor<VertexListGraphType> CheckpointVisitorType;
+    std::shared_ptr<CheckpointVisitorType> checkpointVisitor(
+          new CheckpointVisitorType(saveState, settings.Checkpointing.FileName,
+                                    settings.Checkpointing.IterationInterval, settings.Checkpointing.SecondsInterval));
+    compositeInpaintingVisitor->AddVisitor(checkpointVisitor);
+  }
+
+  if(settings.ProgressCallback)
+  {
+    // This is created after a checkpoint is loaded, so that it counts the hole pixels that are still left
+    typedef ProgressVisitor<VertexListGraphType> ProgressVisitorType;
+    std::shared_ptr<ProgressVisitorType> progressVisitor(
+          new ProgressVisitorType(mask, patchHalfWidth, settings.ProgressCallback,
+                                  inpaintingVisitor->GetNumberOfFinishedPatches()));
+    compositeInpaintingVisitor->AddVisitor(progressVisitor);
+  }
+
+  if(settings.FillCallback)
+  {
+    typedef FillCallbackVisitor<VertexListGraphType> FillCallbackVisitorType;
+    std::shared_ptr<FillCallbackVisitorType> fillCallbackVisitor(
+          new FillCallbackVisitorType(settings.FillCallback));
+    compositeInpaintingVisitor->AddVisitor(fillCallbackVisitor);
+  }
+
   // Create the nearest neighbor finder
   typedef ImagePatchDifference<ImagePatchPixelDescriptorType,
       SumSquaredPixelDifference<typename TImage::PixelType> > PatchDifferenceType;
@@ -160,10 +271,32 @@ void ClassicalImageInpainting(typename itk::SmartPointer<TImage> originalImage,
   std::shared_ptr<BestSearchType> linearSearchBest(new BestSearchType(*imagePatchDescriptorMap));
 
   // Perform the inpainting
-  InpaintingAlgorithm<VertexListGraphType, InpaintingVisitorType,
-                      BoundaryNodeQueueType, BestSearchType,
-                      CompositePatchInpainter>(graph, inpaintingVisitor, boundaryNodeQueue,
-                      linearSearchBest, inpainter);
+  if(settings.SourcePixelGuess)
+  {
+    typedef OffsetWindowSearch<VertexDescriptorType, ImagePatchDescriptorMapType> SearchRegionType;
+    SearchRegionType searchRegion(settings.SourcePixelGuess, patchHalfWidth, settings.GuessSearchRadius,
+                                  *imagePatchDescriptorMap);
+
+    typedef SearchRegionBest<SearchRegionType, BestSearchType> LocalSearchType;
+    std::shared_ptr<LocalSearchType> localSearchBest(new LocalSearchType(searchRegion, linearSearchBest));
+
+    InpaintingAlgorithm<VertexListGraphType, CompositeInpaintingVisitorType,
+                        BoundaryNodeQueueType, LocalSearchType,
+                        CompositePatchInpainter>(graph, compositeInpaintingVisitor, boundaryNodeQueue,
+                        localSearchBest, inpainter);
+  }
+  else
+  {
+    InpaintingAlgorithm<VertexListGraphType, CompositeInpaintingVisitorType,
+                        BoundaryNodeQueueType, BestSearchType,
+                        CompositePatchInpainter>(graph, compositeInpaintingVisitor, boundaryNodeQueue,
+                        linearSearchBest, inpainter);
+  }
+
+  if(settings.SourcePixelMapImage)
+  {
+    ITKHelpers::DeepCopy(inpaintingVisitor->GetSourcePixelMapImage(), settings.SourcePixelMapImage);
+  }
 }
 
 #endif
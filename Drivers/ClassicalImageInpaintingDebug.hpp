@@ -43,11 +43,13 @@
 #include "Visitors/InpaintingVisitors/InpaintingVisitor.hpp"
 #include "Visitors/AcceptanceVisitors/DefaultAcceptanceVisitor.hpp"
 #include "Visitors/InpaintingVisitors/CompositeInpaintingVisitor.hpp"
+#include "Visitors/InpaintingVisitors/KNNCacheInvalidationVisitor.hpp"
 
 // Nearest neighbors
 #include "NearestNeighbor/LinearSearchBest/Property.hpp"
 #include "NearestNeighbor/LinearSearchBest/FirstAndWrite.hpp"
 #include "NearestNeighbor/LinearSearchKNNProperty.hpp"
+#include "NearestNeighbor/CachedKNN.hpp"
 #include "NearestNeighbor/KNNBestWrapper.hpp"
 #include "NearestNeighbor/SortByRGBTextureGradient.hpp"
 
@@ -209,8 +211,29 @@ void ClassicalImageInpaintingDebug(typename itk::SmartPointer<TImage> originalIm
   std::shared_ptr<BestSearchType> linearSearchBest(
         new BestSearchType(*imagePatchDescriptorMap, originalImage, mask));
 
-  typedef KNNBestWrapper<KNNSearchType, BestSearchType> KNNWrapperType;
-  std::shared_ptr<KNNWrapperType> knnWrapper(new KNNWrapperType(knnSearch,
+  // Search for the neighbors of the whole initial boundary in parallel before the loop starts. The cached
+  // neighbors that a filled patch may change are searched for again.
+  typedef CachedKNN<VertexDescriptorType, KNNSearchType> CachedKNNSearchType;
+  std::shared_ptr<CachedKNNSearchType> cachedKNNSearch(new CachedKNNSearchType(knnSearch, patchHalfWidth));
+
+  std::vector<VertexDescriptorType> boundaryNodes = boundaryNodeQueue->GetValidNodes();
+  for(const VertexDescriptorType& boundaryNode : boundaryNodes)
+  {
+    imagePatchDescriptorVisitor->DiscoverVertex(boundaryNode);
+  }
+
+  VertexIteratorType graphBegin;
+  VertexIteratorType graphEnd;
+  tie(graphBegin, graphEnd) = vertices(*graph);
+  cachedKNNSearch->Precompute(graphBegin, graphEnd, boundaryNodes.begin(), boundaryNodes.end());
+
+  typedef KNNCacheInvalidationVisitor<VertexListGraphType, CachedKNNSearchType> KNNCacheInvalidationVisitorType;
+  std::shared_ptr<KNNCacheInvalidationVisitorType> knnCacheInvalidationVisitor(
+        new KNNCacheInvalidationVisitorType(cachedKNNSearch, patchHalfWidth));
+  compositeInpaintingVisitor->AddVisitor(knnCacheInvalidationVisitor);
+
+  typedef KNNBestWrapper<CachedKNNSearchType, BestSearchType> KNNWrapperType;
+  std::shared_ptr<KNNWrapperType> knnWrapper(new KNNWrapperType(cachedKNNSearch,
                                                                 linearSearchBest));
 
   // Perform the inpainting
@@ -228,6 +251,7 @@ void ClassicalImageInpaintingDebug(typename itk::SmartPointer<TImage> originalIm
                                                boundaryNodeQueue,
                                                knnWrapper, inpainter);
 
+  cachedKNNSearch->WriteStatistics(std::cout);
 }
 
 #endif
@@ -0,0 +1,221 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef DeadlineInpainting_HPP
+#define DeadlineInpainting_HPP
+
+// Custom
+#include "Utilities/DeadlineController.h"
+#include "Utilities/IndirectPriorityQueue.h"
+
+// STL
+#include <memory>
+
+// Submodules
+#include <Helpers/Helpers.h>
+
+// Pixel descriptors
+#include "PixelDescriptors/ImagePatchPixelDescriptor.h"
+
+// Descriptor visitors
+#include "Visitors/DescriptorVisitors/ImagePatchDescriptorVisitor.hpp"
+
+// Inpainting visitors
+#include "Visitors/InpaintingVisitors/InpaintingVisitor.hpp"
+#include "Visitors/InpaintingVisitors/CompositeInpaintingVisitor.hpp"
+#include "Visitors/InformationVisitors/ProgressVisitor.hpp"
+#include "Visitors/AcceptanceVisitors/DefaultAcceptanceVisitor.hpp"
+
+// Nearest neighbors
+#include "NearestNeighbor/LinearSearchKNNProperty.hpp"
+#include "NearestNeighbor/LinearSearchBest/HistogramDifference.hpp"
+#include "NearestNeighbor/DeadlineSearchBest.hpp"
+
+// Search regions
+#include "SearchRegions/NeighborhoodSearch.hpp"
+
+// Initializers
+#include "Initializers/InitializeFromMaskImage.hpp"
+#include "Initializers/InitializePriority.hpp"
+
+// Inpainters
+#include "Inpainters/CompositePatchInpainter.hpp"
+#include "Inpainters/PatchInpainter.hpp"
+
+// Difference functions
+#include "DifferenceFunctions/Patch/ImagePatchDifference.hpp"
+#include "DifferenceFunctions/Pixel/SumSquaredPixelDifference.hpp"
+
+// Inpainting
+#include "Algorithms/InpaintingAlgorithm.hpp"
+
+// Priority
+#include "Priority/PriorityCriminisi.h"
+
+// Boost
+#include <boost/graph/grid_graph.hpp>
+#include <boost/property_map/property_map.hpp>
+
+/** Inpaint with a time budget. The best source patch is found in two steps: the K nearest neighbors by SSD,
+  * then the one of those whose histogram is closest to the histogram of the valid part of the target patch
+  * (as in InpaintingHistogram). 'controller' is started when this function is called and is updated after every
+  * iteration, and the search (see DeadlineSearchBest) uses the settings it currently asks for, so the search gets
+  * cheaper as the run falls behind schedule. Afterwards 'controller' holds the degradations that were applied
+  * (see DeadlineController::WriteReport()).
+  * If 'progressCallback' is set, it is called after every iteration (see ProgressVisitor). */
+template <typename TImage>
+void DeadlineInpainting(typename itk::SmartPointer<TImage> originalImage, Mask* const mask,
+                        const unsigned int patchHalfWidth, DeadlineController& controller,
+                        const unsigned int binsPerChannel = 20,
+                        const InpaintingProgressCallback& progressCallback = InpaintingProgressCallback())
+{
+  controller.Start(mask->CountHolePixels(mask->GetLargestPossibleRegion()));
+
+  itk::ImageRegion<2> fullRegion = originalImage->GetLargestPossibleRegion();
+
+  // Blur the image
+  typedef TImage BlurredImageType; // Usually the blurred image is the same type as the original image.
+  typename BlurredImageType::Pointer blurredImage = BlurredImageType::New();
+  float blurVariance = 2.0f;
+  MaskOperations::MaskedBlur(originalImage.GetPointer(), mask, blurVariance, blurredImage.GetPointer());
+
+  typedef ImagePatchPixelDescriptor<TImage> ImagePatchPixelDescriptorType;
+
+  // Create the graph
+  typedef boost::grid_graph<2> VertexListGraphType;
+  boost::array<std::size_t, 2> graphSideLengths = { { fullRegion.GetSize()[0],
+                                                      fullRegion.GetSize()[1] } };
+  std::shared_ptr<VertexListGraphType> graph(new VertexListGraphType(graphSideLengths));
+  typedef boost::graph_traits<VertexListGraphType>::vertex_descriptor VertexDescriptorType;
+
+  // Queue
+  typedef IndirectPriorityQueue<VertexListGraphType> BoundaryNodeQueueType;
+  std::shared_ptr<BoundaryNodeQueueType> boundaryNodeQueue(new BoundaryNodeQueueType(*graph));
+
+  // Create the descriptor map. This is where the data for each pixel is stored.
+  typedef boost::vector_property_map<ImagePatchPixelDescriptorType,
+      BoundaryNodeQueueType::IndexMapType> ImagePatchDescriptorMapType;
+  std::shared_ptr<ImagePatchDescriptorMapType> imagePatchDescriptorMap(new
+      ImagePatchDescriptorMapType(num_vertices(*graph), *(boundaryNodeQueue->GetIndexMap())));
+
+  // Create the patch inpainters
+  typedef PatchInpainter<TImage> OriginalImageInpainterType;
+  std::shared_ptr<OriginalImageInpainterType> originalImagePatchInpainter(new
+      OriginalImageInpainterType(patchHalfWidth, originalImage, mask));
+
+  typedef PatchInpainter<BlurredImageType> BlurredImageInpainterType;
+  std::shared_ptr<BlurredImageInpainterType> blurredImagePatchInpainter(new
+     BlurredImageInpainterType(patchHalfWidth, blurredImage, mask));
+
+  std::shared_ptr<CompositePatchInpainter> inpainter(new CompositePatchInpainter);
+  inpainter->AddInpainter(originalImagePatchInpainter);
+  inpainter->AddInpainter(blurredImagePatchInpainter);
+
+  // Create the priority function
+  typedef PriorityCriminisi<BlurredImageType> PriorityType;
+  std::shared_ptr<PriorityType> priorityFunction(new PriorityType(blurredImage, mask, patchHalfWidth));
+
+  // Create the descriptor visitor
+  typedef ImagePatchDescriptorVisitor<VertexListGraphType, TImage, ImagePatchDescriptorMapType>
+      ImagePatchDescriptorVisitorType;
+  std::shared_ptr<ImagePatchDescriptorVisitorType> imagePatchDescriptorVisitor(new
+      ImagePatchDescriptorVisitorType(originalImage.GetPointer(), mask,
+                                      imagePatchDescriptorMap, patchHalfWidth));
+
+  typedef DefaultAcceptanceVisitor<VertexListGraphType> AcceptanceVisitorType;
+  std::shared_ptr<AcceptanceVisitorType> acceptanceVisitor(new AcceptanceVisitorType);
+
+  // Create the inpainting visitor
+  typedef InpaintingVisitor<VertexListGraphType, BoundaryNodeQueueType,
+                            ImagePatchDescriptorVisitorType, AcceptanceVisitorType, PriorityType>
+                            InpaintingVisitorType;
+  std::shared_ptr<InpaintingVisitorType> inpaintingVisitor(new InpaintingVisitorType(mask, boundaryNodeQueue,
+                                          imagePatchDescriptorVisitor, acceptanceVisitor,
+                                          priorityFunction, patchHalfWidth, "InpaintingVisitor"));
+  inpaintingVisitor->SetAllowNewPatches(false);
+
+  InitializePriority(mask, boundaryNodeQueue.get(), priorityFunction.get());
+
+  // Initialize the boundary node queue from the user provided mask image.
+  InitializeFromMaskImage<InpaintingVisitorType, VertexDescriptorType>(mask, inpaintingVisitor.get());
+
+  typedef CompositeInpaintingVisitor<VertexListGraphType> CompositeInpaintingVisitorType;
+  std::shared_ptr<CompositeInpaintingVisitorType> compositeInpaintingVisitor(new CompositeInpaintingVisitorType);
+  compositeInpaintingVisitor->AddVisitor(inpaintingVisitor);
+
+  // Tell the controller how far the run has come after every iteration
+  auto updateController = [&controller, progressCallback](const unsigned int numberOfFinishedPatches,
+                                                          const unsigned int numberOfHolePixels)
+  {
+    if(controller.Update(numberOfFinishedPatches, numberOfHolePixels))
+    {
+      std::cout << "DeadlineInpainting: " << controller.GetDegradations().back().Description << " after "
+                << controller.GetDegradations().back().Seconds << "s." << std::endl;
+    }
+
+    if(progressCallback)
+    {
+      progressCallback(numberOfFinishedPatches, numberOfHolePixels);
+    }
+  };
+
+  typedef ProgressVisitor<VertexListGraphType> ProgressVisitorType;
+  std::shared_ptr<ProgressVisitorType> progressVisitor(
+        new ProgressVisitorType(mask, patchHalfWidth, updateController));
+  compositeInpaintingVisitor->AddVisitor(progressVisitor);
+
+  // Create the first (KNN) neighbor finder
+  typedef ImagePatchDifference<ImagePatchPixelDescriptorType,
+      SumSquaredPixelDifference<typename TImage::PixelType> > PatchDifferenceType;
+  typedef LinearSearchKNNProperty<ImagePatchDescriptorMapType, PatchDifferenceType> KNNSearchType;
+  std::shared_ptr<KNNSearchType> linearSearchKNN(new KNNSearchType(imagePatchDescriptorMap,
+                                                                   controller.GetSettings().K));
+
+  // Create the second (1-NN) neighbor finder
+  typedef typename std::vector<VertexDescriptorType>::iterator VertexDescriptorVectorIteratorType;
+  typedef LinearSearchBestHistogramDifference<ImagePatchDescriptorMapType, TImage,
+      VertexDescriptorVectorIteratorType> BestSearchType;
+  std::shared_ptr<BestSearchType> linearSearchBest(new BestSearchType(*imagePatchDescriptorMap,
+                                                                      originalImage.GetPointer(), mask));
+  linearSearchBest->SetNumberOfBinsPerDimension(binsPerChannel);
+
+  typename TImage::PixelType rangeMin;
+  rangeMin.Fill(0);
+  typename TImage::PixelType rangeMax;
+  rangeMax.Fill(255);
+  linearSearchBest->SetRangeMin(rangeMin);
+  linearSearchBest->SetRangeMax(rangeMax);
+
+  // Create the search that follows the controller
+  typedef NeighborhoodSearch<VertexDescriptorType, ImagePatchDescriptorMapType> SearchRegionType;
+  SearchRegionType searchRegion(fullRegion, controller.GetLocalSearchRadius(), *imagePatchDescriptorMap);
+
+  typedef DeadlineSearchBest<SearchRegionType, ImagePatchDescriptorMapType,
+                             KNNSearchType, BestSearchType> DeadlineSearchType;
+  std::shared_ptr<DeadlineSearchType> deadlineSearch(new DeadlineSearchType(&controller, searchRegion,
+                                                                            *imagePatchDescriptorMap,
+                                                                            linearSearchKNN, linearSearchBest));
+
+  // Perform the inpainting
+  InpaintingAlgorithm<VertexListGraphType, CompositeInpaintingVisitorType,
+                      BoundaryNodeQueueType, DeadlineSearchType,
+                      CompositePatchInpainter>(graph, compositeInpaintingVisitor, boundaryNodeQueue,
+                      deadlineSearch, inpainter);
+}
+
+#endif
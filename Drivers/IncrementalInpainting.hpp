@@ -0,0 +1,121 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef IncrementalInpainting_HPP
+#define IncrementalInpainting_HPP
+
+// Custom
+#include "Algorithms/IncrementalFill.h"
+#include "Utilities/FillLog.h"
+#include "Utilities/WorkingSet.h"
+
+// Drivers
+#include "Drivers/ClassicalImageInpainting.hpp"
+#include "Drivers/WorkingSetInpainting.hpp"
+
+// Submodules
+#include <Mask/Mask.h>
+
+// STL
+#include <iostream>
+#include <string>
+#include <vector>
+
+/** Re-inpaint 'image', the result of an inpainting with 'oldMask' that was logged to 'fillLog', after the mask was
+  * edited to 'newMask'. Only the pixels that the edit affects (see IncrementalFill::FindRefillRegion()) are
+  * inpainted again, in place, with ClassicalImageInpainting on the working set of 'searchRadius' (see
+  * WorkingSetInpainting), so the priority queue, the descriptors and the other per-pixel structures only cover
+  * the affected part of the image (unless 'searchRadius' is WorkingSet::FullImageSearch).
+  * If 'newFillLogFileName' is not empty, the fill log of the new result is written to it (the kept records in their
+  * original order, then the new ones), so the mask can be edited again.
+  * The number of kept patches is returned.
+  */
+template <typename TImage>
+std::size_t IncrementalInpainting(typename itk::SmartPointer<TImage> image, const Mask* const oldMask,
+                                  const Mask* const newMask, const FillLogReader& fillLog,
+                                  const unsigned int searchRadius, const std::string& newFillLogFileName = "")
+{
+  const itk::ImageRegion<2> fullRegion = newMask->GetLargestPossibleRegion();
+  const unsigned int patchHalfWidth = fillLog.GetPatchRadius();
+
+  // The input of the new fill is the previous result with the new mask
+  std::uint64_t inputChecksum = FillLog::ComputeInputChecksum(image.GetPointer(), newMask);
+
+  Mask::Pointer refillMask = Mask::New();
+  std::vector<bool> keptRecords;
+  std::size_t numberOfKeptRecords = IncrementalFill::FindRefillRegion(fillLog, oldMask, newMask, refillMask,
+                                                                       keptRecords);
+
+  unsigned int numberOfRefillPixels = refillMask->CountHolePixels(fullRegion);
+  std::cout << "IncrementalInpainting: kept " << numberOfKeptRecords << " of " << fillLog.GetNumberOfRecords()
+            << " patches, " << numberOfRefillPixels << " pixels must be inpainted again." << std::endl;
+
+  // The new patches are reported in the coordinates of the working set, which starts at this corner
+  itk::Index<2> workingRegionCorner =
+      WorkingSet::GetWorkingRegion(refillMask, patchHalfWidth, searchRadius).GetIndex();
+
+  std::vector<FillLog::Record> newRecords;
+  auto fillCallback = [&](const itk::Index<2>& target, const itk::Index<2>& source)
+  {
+    FillLog::Record record;
+    record.TargetX = static_cast<std::int32_t>(target[0] + workingRegionCorner[0]);
+    record.TargetY = static_cast<std::int32_t>(target[1] + workingRegionCorner[1]);
+    record.SourceX = static_cast<std::int32_t>(source[0] + workingRegionCorner[0]);
+    record.SourceY = static_cast<std::int32_t>(source[1] + workingRegionCorner[1]);
+    newRecords.push_back(record);
+  };
+
+  if(numberOfRefillPixels > 0)
+  {
+    auto inpaint = [&](typename TImage::Pointer workingImage, Mask::Pointer workingMask)
+    {
+      ClassicalImageInpaintingSettings settings;
+      settings.FillCallback = fillCallback;
+      ClassicalImageInpainting(workingImage, workingMask, patchHalfWidth, settings);
+    };
+
+    WorkingSetInpainting(image, refillMask, patchHalfWidth, searchRadius, inpaint);
+  }
+
+  if(!newFillLogFileName.empty())
+  {
+    FillLogWriter writer(newFillLogFileName, fullRegion, patchHalfWidth, inputChecksum);
+    for(std::size_t recordId = 0; recordId < fillLog.GetNumberOfRecords(); ++recordId)
+    {
+      if(keptRecords[recordId])
+      {
+        const FillLog::Record& record = fillLog.GetRecord(recordId);
+        itk::Index<2> target = {{record.TargetX, record.TargetY}};
+        itk::Index<2> source = {{record.SourceX, record.SourceY}};
+        writer.Write(target, source);
+      }
+    }
+
+    for(std::size_t recordId = 0; recordId < newRecords.size(); ++recordId)
+    {
+      itk::Index<2> target = {{newRecords[recordId].TargetX, newRecords[recordId].TargetY}};
+      itk::Index<2> source = {{newRecords[recordId].SourceX, newRecords[recordId].SourceY}};
+      writer.Write(target, source);
+    }
+    writer.Close();
+  }
+
+  return numberOfKeptRecords;
+}
+
+#endif
@@ -58,6 +58,7 @@
 // Information visitors
 #include "Visitors/InformationVisitors/DisplayVisitor.hpp"
 #include "Visitors/InformationVisitors/FinalImageWriterVisitor.hpp"
+#include "Visitors/InformationVisitors/IterationHistoryVisitor.hpp"
 
 // Inpainting visitors
 #include "Visitors/InpaintingVisitors/InpaintingVisitor.hpp"
@@ -218,9 +219,20 @@ void InteractiveInpaintingGMH(typename itk::SmartPointer<TImage> originalImage,
         new FinalImageWriterVisitorType(originalImage, outputFileName));
 
 
+  // Record every iteration so that the viewer can step backward and forward through them once the
+  // inpainting is complete.
+  std::shared_ptr<PatchDeltaHistory<TImage> > history(
+        new PatchDeltaHistory<TImage>(originalImage.GetPointer(), mask));
+
+  typedef IterationHistoryVisitor<VertexListGraphType, TImage> IterationHistoryVisitorType;
+  std::shared_ptr<IterationHistoryVisitorType> iterationHistoryVisitor(
+        new IterationHistoryVisitorType(history.get(), patchHalfWidth));
+
   typedef CompositeInpaintingVisitor<VertexListGraphType> CompositeInpaintingVisitorType;
   std::shared_ptr<CompositeInpaintingVisitorType> compositeInpaintingVisitor(new CompositeInpaintingVisitorType);
   compositeInpaintingVisitor->AddVisitor(inpaintingVisitor);
+  // The history must be finished before the display visitor reports that the inpainting is complete.
+  compositeInpaintingVisitor->AddVisitor(iterationHistoryVisitor);
   compositeInpaintingVisitor->AddVisitor(displayVisitor);
   compositeInpaintingVisitor->AddVisitor(finalImageWriterVisitor);
 
@@ -263,6 +275,7 @@ void InteractiveInpaintingGMH(typename itk::SmartPointer<TImage> originalImage,
       new BasicViewerWidgetType(originalImage, mask);
 //  std::cout << "basicViewer pointer: " << basicViewer << std::endl;
   basicViewer->ConnectVisitor(displayVisitor.get());
+  basicViewer->SetHistory(history);
 
   // If the acceptance tests fail, prompt the user to select a patch. Pass the basicViewer as the parent so that we can position the top pathces dialog properly.
 //  typedef TopPatchListOrManual<TImage> ManualSearchType;
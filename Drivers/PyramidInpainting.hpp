@@ -0,0 +1,106 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PyramidInpainting_HPP
+#define PyramidInpainting_HPP
+
+// Custom
+#include "Utilities/PyramidHelpers.h"
+#include "Utilities/SourcePixelMap.h"
+
+// Drivers
+#include "Drivers/ClassicalImageInpainting.hpp"
+
+// STL
+#include <iostream>
+#include <vector>
+
+/** Inpaint coarse-to-fine. An image/mask pyramid of (up to) 'numberOfLevels' levels is built (level 0 is
+  * the input). The coarsest level is inpainted with a full search. Each finer level is then inpainted from scratch,
+  * but every target patch is only compared to the source patches within 'searchRadius' of the positions
+  * predicted by the upsampled nearest neighbor field of the level above it, so the finer levels (which have
+  * many more iterations) do very little searching.
+  * Levels that would be smaller than a patch are not created.
+  * If 'progressCallback' is set, it reports the progress of the finest level (see ProgressVisitor).
+  */
+template <typename TImage>
+void PyramidInpainting(typename itk::SmartPointer<TImage> image, Mask* const mask,
+                       const unsigned int patchHalfWidth, const unsigned int numberOfLevels,
+                       const unsigned int searchRadius,
+                       const InpaintingProgressCallback& progressCallback = InpaintingProgressCallback())
+{
+  std::vector<typename TImage::Pointer> images(1, image);
+  std::vector<Mask*> masks(1, mask);
+  std::vector<Mask::Pointer> coarseMasks; // Keep the coarse masks alive
+
+  const unsigned int patchSideLength = 2 * patchHalfWidth + 1;
+  while(images.size() < numberOfLevels)
+  {
+    itk::ImageRegion<2> coarseRegion = PyramidHelpers::GetCoarseRegion(images.back()->GetLargestPossibleRegion());
+    if(coarseRegion.GetSize()[0] < patchSideLength || coarseRegion.GetSize()[1] < patchSideLength)
+    {
+      std::cout << "PyramidInpainting: level " << images.size() << " would be smaller than a patch, using "
+                << images.size() << " levels." << std::endl;
+      break;
+    }
+
+    typename TImage::Pointer coarseImage = TImage::New();
+    PyramidHelpers::DownsampleImage(images.back().GetPointer(), coarseImage.GetPointer());
+    images.push_back(coarseImage);
+
+    Mask::Pointer coarseMask = Mask::New();
+    PyramidHelpers::DownsampleMask(masks.back(), coarseMask);
+    coarseMasks.push_back(coarseMask);
+    masks.push_back(coarseMask);
+  }
+
+  SourcePixelMap::ImageType::Pointer coarserSourcePixelMap;
+  for(int level = static_cast<int>(images.size()) - 1; level >= 0; --level)
+  {
+    std::cout << "PyramidInpainting: inpainting level " << level << " ("
+              << images[level]->GetLargestPossibleRegion().GetSize() << ")" << std::endl;
+
+    SourcePixelMap::ImageType::Pointer sourcePixelMap = SourcePixelMap::ImageType::New();
+
+    ClassicalImageInpaintingSettings settings;
+    settings.SourcePixelMapImage = sourcePixelMap.GetPointer();
+    if(level == 0)
+    {
+      settings.ProgressCallback = progressCallback;
+    }
+
+    if(!coarserSourcePixelMap)
+    {
+      ClassicalImageInpainting(images[level], masks[level], patchHalfWidth, settings);
+    }
+    else
+    {
+      // This must be computed before the level is inpainted, as the inpainting fills the mask
+      SourcePixelMap::ImageType::Pointer sourcePixelGuess = SourcePixelMap::ImageType::New();
+      PyramidHelpers::UpsampleSourcePixelMap(coarserSourcePixelMap, masks[level], sourcePixelGuess);
+
+      settings.SourcePixelGuess = sourcePixelGuess.GetPointer();
+      settings.GuessSearchRadius = searchRadius;
+      ClassicalImageInpainting(images[level], masks[level], patchHalfWidth, settings);
+    }
+
+    coarserSourcePixelMap = sourcePixelMap;
+  }
+}
+
+#endif
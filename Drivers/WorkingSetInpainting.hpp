@@ -0,0 +1,267 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef WorkingSetInpainting_HPP
+#define WorkingSetInpainting_HPP
+
+// Custom
+#include "Inpainters/TiledPatchInpainter.hpp"
+#include "NearestNeighbor/TiledWindowSearchBest.hpp"
+#include "Utilities/SummedAreaTable.h"
+#include "Utilities/TiledImage.h"
+#include "Utilities/TiledMask.h"
+#include "Utilities/WorkingSet.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
+
+// ITK
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+
+/** Inpaint only the working set of the image (see WorkingSet::GetWorkingRegion()): the image and mask are cropped
+  * to the hole bounding box dilated by the patch radius plus 'searchRadius' plus one,
+  * 'inpaint(croppedImage, croppedMask)' is called (e.g. a lambda that calls ClassicalImageInpainting()), and the
+  * filled crop is pasted back into 'image' and 'mask'. Source patches are then only taken from the crop, which contains every source patch within
+  * 'searchRadius' of every target patch.
+  * If 'searchRadius' is WorkingSet::FullImageSearch, the full image is inpainted without copying.
+  */
+template <typename TImage, typename TInpaintingFunctor>
+void WorkingSetInpainting(typename itk::SmartPointer<TImage> image, Mask* const mask,
+                          const unsigned int patchHalfWidth, const unsigned int searchRadius,
+                          TInpaintingFunctor inpaint)
+{
+  itk::ImageRegion<2> workingRegion = WorkingSet::GetWorkingRegion(mask, patchHalfWidth, searchRadius);
+  if(workingRegion == mask->GetLargestPossibleRegion())
+  {
+    inpaint(image, Mask::Pointer(mask));
+    return;
+  }
+
+  std::cout << "WorkingSetInpainting: inpainting the " << workingRegion.GetSize() << " region at "
+            << workingRegion.GetIndex() << " of the " << mask->GetLargestPossibleRegion().GetSize()
+            << " image." << std::endl;
+
+  typename TImage::Pointer croppedImage = TImage::New();
+  WorkingSet::ExtractRegion(image.GetPointer(), workingRegion, croppedImage.GetPointer());
+
+  Mask::Pointer croppedMask = Mask::New();
+  WorkingSet::ExtractMask(mask, workingRegion, croppedMask);
+
+  inpaint(croppedImage, croppedMask);
+
+  WorkingSet::PasteRegion(croppedImage.GetPointer(), workingRegion, image.GetPointer());
+  WorkingSet::PasteRegion<Mask>(croppedMask, workingRegion, mask);
+}
+
+/** A boundary pixel of a tiled mask, and its priority (the fraction of valid pixels in its patch) when it was queued. */
+struct TiledBoundaryPixel
+{
+  float Priority;
+
+  itk::Index<2> Pixel;
+
+  bool operator<(const TiledBoundaryPixel& other) const
+  {
+    return this->Priority < other.Priority;
+  }
+};
+
+typedef std::priority_queue<TiledBoundaryPixel> TiledBoundaryQueue;
+
+/** Get the fraction of valid pixels in a patch (cropped to the image) with 'numberOfHoles' hole pixels. This is the
+  * confidence term of Criminisi's priority when every valid pixel has a confidence of 1. */
+inline float ComputeTiledPriority(const unsigned int numberOfPixels, const unsigned int numberOfHoles)
+{
+  return static_cast<float>(numberOfPixels - numberOfHoles) / static_cast<float>(numberOfPixels);
+}
+
+/** Queue the boundary pixels (hole pixels with a valid 8-neighbor) of 'region' of 'mask' with their current
+  * priority. The mask is read through its tile cache, padded by the patch radius.
+  * \return The number of hole pixels in 'region'. */
+inline std::size_t QueueTiledBoundaryPixels(TiledMask& mask, const itk::ImageRegion<2>& region,
+                                            const unsigned int patchHalfWidth, TiledBoundaryQueue& queue)
+{
+  itk::ImageRegion<2> readRegion = region;
+  readRegion.PadByRadius(std::max(patchHalfWidth, 1u));
+  readRegion.Crop(mask.GetLargestPossibleRegion());
+
+  TiledMask::ImageType::Pointer maskImage = TiledMask::ImageType::New();
+  mask.ReadRegion(readRegion, maskImage);
+
+  // 1 at the hole pixels, so that the holes of a patch are counted from 4 values of the table
+  TiledMask::ImageType::Pointer holes = TiledMask::ImageType::New();
+  holes->SetRegions(maskImage->GetLargestPossibleRegion());
+  holes->Allocate();
+  itk::ImageRegionConstIterator<TiledMask::ImageType> maskIterator(maskImage, maskImage->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<TiledMask::ImageType> holesIterator(holes, holes->GetLargestPossibleRegion());
+  while(!maskIterator.IsAtEnd())
+  {
+    holesIterator.Set(mask.IsHoleValue(maskIterator.Get()) ? 1 : 0);
+    ++maskIterator;
+    ++holesIterator;
+  }
+  SummedAreaTable<TiledMask::ImageType> holeCounts(holes);
+
+  // 'region' in the coordinates of the images that were read (which start at (0,0))
+  itk::Index<2> localCorner = {{region.GetIndex()[0] - readRegion.GetIndex()[0],
+                                region.GetIndex()[1] - readRegion.GetIndex()[1]}};
+  itk::ImageRegion<2> localRegion(localCorner, region.GetSize());
+
+  std::size_t numberOfHoles = 0;
+  itk::ImageRegionConstIteratorWithIndex<TiledMask::ImageType> regionIterator(holes, localRegion);
+  while(!regionIterator.IsAtEnd())
+  {
+    if(regionIterator.Get() == 0)
+    {
+      ++regionIterator;
+      continue;
+    }
+    numberOfHoles++;
+
+    itk::ImageRegion<2> neighborhood = ITKHelpers::GetRegionInRadiusAroundPixel(regionIterator.GetIndex(), 1);
+    neighborhood.Crop(holes->GetLargestPossibleRegion());
+    double neighborhoodHoles = 0.0;
+    holeCounts.AddSum(neighborhood, &neighborhoodHoles);
+    if(neighborhoodHoles < neighborhood.GetNumberOfPixels())
+    {
+      itk::ImageRegion<2> patch = ITKHelpers::GetRegionInRadiusAroundPixel(regionIterator.GetIndex(), patchHalfWidth);
+      patch.Crop(holes->GetLargestPossibleRegion());
+      double patchHoles = 0.0;
+      holeCounts.AddSum(patch, &patchHoles);
+
+      TiledBoundaryPixel boundaryPixel;
+      boundaryPixel.Priority = ComputeTiledPriority(patch.GetNumberOfPixels(), static_cast<unsigned int>(patchHoles));
+      itk::Offset<2> offsetInReadRegion = {{regionIterator.GetIndex()[0], regionIterator.GetIndex()[1]}};
+      boundaryPixel.Pixel = readRegion.GetIndex() + offsetInReadRegion;
+      queue.push(boundaryPixel);
+    }
+    ++regionIterator;
+  }
+
+  return numberOfHoles;
+}
+
+/** Inpaint an image and mask that are not loaded into memory. Every read and write of the search and of the
+  * painting goes through the tile caches of 'tiledImage' and 'tiledMask' (see TiledWindowSearchBest and
+  * TiledPatchInpainter), so only the tiles within 'searchRadius' plus the patch radius of the current target are
+  * loaded, and the filled tiles are written back to the files when they are evicted or flushed.
+  * The mask is first read one tile at a time to find the boundary of the hole. The boundary pixels are then filled
+  * in order of decreasing fraction of valid pixels in their patch, and only the boundary (not the hole) is kept in
+  * memory. 'searchRadius' can not be WorkingSet::FullImageSearch, as then every tile would be read for every target.
+  */
+template <typename TImage>
+void WorkingSetInpainting(TiledImage<TImage>& tiledImage, TiledMask& tiledMask,
+                          const unsigned int patchHalfWidth, const unsigned int searchRadius)
+{
+  if(searchRadius == WorkingSet::FullImageSearch)
+  {
+    throw std::runtime_error("WorkingSetInpainting: a search radius is required to inpaint a tiled image!");
+  }
+
+  const itk::ImageRegion<2> fullRegion = tiledMask.GetLargestPossibleRegion();
+  if(fullRegion != tiledImage.GetLargestPossibleRegion())
+  {
+    throw std::runtime_error("WorkingSetInpainting: the mask and the tiled image must be the same size!");
+  }
+
+  // Find the boundary one tile of the mask at a time
+  TiledBoundaryQueue boundaryQueue;
+  std::size_t numberOfHolePixels = 0;
+  const unsigned int tileSize = tiledMask.GetTileSize();
+  for(unsigned int tileY = 0; tileY < fullRegion.GetSize()[1]; tileY += tileSize)
+  {
+    for(unsigned int tileX = 0; tileX < fullRegion.GetSize()[0]; tileX += tileSize)
+    {
+      itk::Index<2> tileCorner = {{fullRegion.GetIndex()[0] + static_cast<itk::IndexValueType>(tileX),
+                                   fullRegion.GetIndex()[1] + static_cast<itk::IndexValueType>(tileY)}};
+      itk::Size<2> tileSizeInPixels = {{tileSize, tileSize}};
+      itk::ImageRegion<2> tileRegion(tileCorner, tileSizeInPixels);
+      tileRegion.Crop(fullRegion);
+
+      numberOfHolePixels += QueueTiledBoundaryPixels(tiledMask, tileRegion, patchHalfWidth, boundaryQueue);
+    }
+  }
+
+  if(numberOfHolePixels == 0)
+  {
+    std::cout << "WorkingSetInpainting: the mask has no hole, there is nothing to inpaint." << std::endl;
+    return;
+  }
+
+  std::cout << "WorkingSetInpainting: inpainting " << numberOfHolePixels << " hole pixels of the "
+            << fullRegion.GetSize() << " tiled image." << std::endl;
+
+  TiledWindowSearchBest<TImage> searchBest(&tiledImage, &tiledMask, patchHalfWidth, searchRadius);
+  TiledPatchInpainter<TImage> patchInpainter(patchHalfWidth, &tiledImage, &tiledMask);
+
+  while(!boundaryQueue.empty())
+  {
+    TiledBoundaryPixel boundaryPixel = boundaryQueue.top();
+    boundaryQueue.pop();
+
+    // The pixel was filled by an earlier patch
+    if(!tiledMask.IsHole(boundaryPixel.Pixel))
+    {
+      continue;
+    }
+
+    // The priority of the pixel changed since it was queued, and it was queued again with its new priority
+
+    itk::ImageRegion<2> targetRegion = ITKHelpers::GetRegionInRadiusAroundPixel(boundaryPixel.Pixel, patchHalfWidth);
+    targetRegion.Crop(fullRegion);
+    TiledMask::ImageType::Pointer targetMask = TiledMask::ImageType::New();
+    tiledMask.ReadRegion(targetRegion, targetMask);
+    unsigned int numberOfTargetHoles = 0;
+    itk::ImageRegionConstIterator<TiledMask::ImageType> targetMaskIterator(targetMask, targetMask->GetLargestPossibleRegion());
+    while(!targetMaskIterator.IsAtEnd())
+    {
+      numberOfTargetHoles += tiledMask.IsHoleValue(targetMaskIterator.Get()) ? 1 : 0;
+      ++targetMaskIterator;
+    }
+    if(ComputeTiledPriority(targetRegion.GetNumberOfPixels(), numberOfTargetHoles) != boundaryPixel.Priority)
+    {
+      continue;
+    }
+
+    itk::Index<2> sourcePixel = searchBest(boundaryPixel.Pixel);
+    patchInpainter.PaintPatch(boundaryPixel.Pixel, sourcePixel);
+
+    // The priority of the pixels within 2 * patchHalfWidth of the target changed, and the pixels next to the target
+    // patch may have become boundary pixels
+    itk::ImageRegion<2> changedRegion = ITKHelpers::GetRegionInRadiusAroundPixel(boundaryPixel.Pixel,
+                                                                                  2 * patchHalfWidth + 1);
+    changedRegion.Crop(fullRegion);
+    QueueTiledBoundaryPixels(tiledMask, changedRegion, patchHalfWidth, boundaryQueue);
+  }
+
+  if(patchInpainter.GetNumberOfPaintedPixels() != numberOfHolePixels)
+  {
+    throw std::runtime_error("WorkingSetInpainting: some hole pixels could not be reached from the boundary!");
+  }
+}
+
+#endif
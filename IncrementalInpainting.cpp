@@ -0,0 +1,124 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
+
+// Utilities
+#include "Utilities/FillLog.h"
+#include "Utilities/WorkingSet.h"
+
+// Drivers
+#include "Drivers/IncrementalInpainting.hpp"
+
+// ITK
+#include "itkCovariantVector.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+
+// STL
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Re-inpaint a result after its mask was edited, keeping every patch of the previous fill that the edit does not
+// affect. The previous run must have written a fill log (see the fillLog argument of ClassicalImageInpainting).
+// Run with: filled.png Data/trashcan.mask edited.mask filled.fill refilled.png
+// or, to write the fill log of the new result (to edit the mask again) and only search within 100 pixels:
+//           filled.png Data/trashcan.mask edited.mask filled.fill refilled.png refilled.fill 100
+int main(int argc, char *argv[])
+{
+  // Verify arguments
+  if(argc < 6 || argc > 8)
+  {
+    std::cerr << "Required arguments: previousResult.png previousMask.mask newMask.mask previous.fill output.png"
+              << " [output.fill] [searchRadius (0 = full image)]" << std::endl;
+    std::cerr << "Input arguments: ";
+    for(int i = 1; i < argc; ++i)
+    {
+      std::cerr << argv[i] << " ";
+    }
+    return EXIT_FAILURE;
+  }
+
+  // Parse arguments
+  std::string previousResultFileName = argv[1];
+  std::string previousMaskFileName = argv[2];
+  std::string newMaskFileName = argv[3];
+  std::string fillLogFileName = argv[4];
+  std::string outputFileName = argv[5];
+
+  std::string newFillLogFileName;
+  if(argc > 6)
+  {
+    newFillLogFileName = argv[6];
+  }
+
+  unsigned int searchRadius = WorkingSet::FullImageSearch;
+  if(argc > 7)
+  {
+    std::stringstream ssSearchRadius;
+    ssSearchRadius << argv[7];
+    ssSearchRadius >> searchRadius;
+    if(searchRadius == 0)
+    {
+      searchRadius = WorkingSet::FullImageSearch;
+    }
+  }
+
+  typedef itk::Image<itk::CovariantVector<int, 3>, 2> OriginalImageType;
+
+  typedef  itk::ImageFileReader<OriginalImageType> ImageReaderType;
+  ImageReaderType::Pointer imageReader = ImageReaderType::New();
+  imageReader->SetFileName(previousResultFileName);
+  imageReader->Update();
+
+  OriginalImageType::Pointer image = OriginalImageType::New();
+  ITKHelpers::DeepCopy(imageReader->GetOutput(), image.GetPointer());
+
+  Mask::Pointer previousMask = Mask::New();
+  previousMask->Read(previousMaskFileName);
+
+  Mask::Pointer newMask = Mask::New();
+  newMask->Read(newMaskFileName);
+
+  try
+  {
+    FillLogReader fillLog(fillLogFileName);
+    IncrementalInpainting(image, previousMask, newMask, fillLog, searchRadius, newFillLogFileName);
+  }
+  catch(const std::runtime_error& error)
+  {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // See ClassicalImageInpainting.cpp
+  if(Helpers::GetFileExtension(outputFileName) == "png")
+  {
+    ITKHelpers::WriteRGBImage(image.GetPointer(), outputFileName);
+  }
+  else
+  {
+    ITKHelpers::WriteImage(image.GetPointer(), outputFileName);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,10 @@
 #ifndef MaskImagePatchInpainter_HPP
 #define MaskImagePatchInpainter_HPP
 
+// Custom
+#include "Utilities/AsyncImageWriter.h"
+
+// Submodules
 #include <ITKHelpers/ITKHelpers.h>
 
 /**
@@ -95,7 +99,7 @@ public:
 
     if(this->DebugImages)
     {
-      ITKHelpers::WriteSequentialImage(this->MaskImage, "Mask", this->Iteration, 3, "png");
+      AsyncImageWriter::GetInstance().WriteSequentialImage(this->MaskImage, "Mask", this->Iteration, 3, "png");
     }
     this->Iteration++;
   } // end operator()
@@ -23,6 +23,8 @@
 
 #include <Utilities/Debug/Debug.h>
 
+#include "Utilities/AsyncImageWriter.h"
+
 template <typename TImage>
 class PatchInpainter : public PatchInpainterParent, public Debug
 {
@@ -96,16 +98,8 @@ public:
     if(this->GetDebugImages())
     {
       // Write the target patch that was inpainted.
-      try
-      {
-        ITKHelpers::WriteRegion(this->Image.GetPointer(), targetRegion,
-                                Helpers::GetSequentialFileName("TargetPatchBefore", this->Iteration, "png", 3));
-      }
-      catch (...)
-      {
-        ITKHelpers::WriteRegionAsRGBImage(this->Image.GetPointer(), targetRegion,
-                                          Helpers::GetSequentialFileName("TargetPatchBefore", this->Iteration, "png", 3));
-      }
+      AsyncImageWriter::GetInstance().WriteSequentialRegion(this->Image.GetPointer(), targetRegion,
+                                                            "TargetPatchBefore", this->Iteration, 3, "png");
     }
 
     // Iterate over all pixels in the target patch (we must iterate over the target patch, because it may be smaller than the source patch)
@@ -132,30 +126,17 @@ public:
 
     if(this->GetDebugImages())
     {
-      // Write the inpainted image after this iteration. If the writer fails to write the image directly as a png (it would be an unsupported pixel type), then convert it to a supported type before writing.
-      try
-      {
-        ITKHelpers::WriteSequentialImage(this->Image.GetPointer(), this->ImageName, this->Iteration, 3, "png");
-      }
-      catch (...)
-      {
-        ITKHelpers::WriteSequentialRGBImage(this->Image.GetPointer(), this->ImageName, this->Iteration, 3, "png");
-      }
+      // Write the inpainted image after this iteration. If the writer fails to write the image directly as a png
+      // (it would be an unsupported pixel type), then it is converted to a supported type before writing.
+      AsyncImageWriter::GetInstance().WriteSequentialImage(this->Image.GetPointer(), this->ImageName,
+                                                           this->Iteration, 3, "png");
 
       if(this->GetDebugLevel() > 1)
       {
         std::cout << "PatchInpainter debug level: " << this->GetDebugLevel() << std::endl;
         // Write the target patch that was inpainted.
-        try
-        {
-          ITKHelpers::WriteRegion(this->Image.GetPointer(), targetRegion,
-                                  Helpers::GetSequentialFileName("TargetPatchAfter", this->Iteration, "png", 3));
-        }
-        catch (...)
-        {
-          ITKHelpers::WriteRegionAsRGBImage(this->Image.GetPointer(), targetRegion,
-                                            Helpers::GetSequentialFileName("TargetPatchAfter", this->Iteration, "png", 3));
-        }
+        AsyncImageWriter::GetInstance().WriteSequentialRegion(this->Image.GetPointer(), targetRegion,
+                                                              "TargetPatchAfter", this->Iteration, 3, "png");
       }
     }
 
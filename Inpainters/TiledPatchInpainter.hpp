@@ -0,0 +1,111 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef TiledPatchInpainter_HPP
+#define TiledPatchInpainter_HPP
+
+// ITK
+#include "itkIndex.h"
+
+// Parent class
+#include "PatchInpainterParent.h"
+
+// Custom
+#include "Utilities/TiledImage.h"
+#include "Utilities/TiledMask.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+/**
+ * This class is the PatchInpainter of an image and mask that are not loaded into memory: the hole pixels of the
+ * target patch are copied from the source patch and marked as valid through the tile caches, so only the tiles of
+ * the two patches are loaded.
+ */
+template <typename TImage>
+class TiledPatchInpainter : public PatchInpainterParent
+{
+public:
+
+  TiledPatchInpainter(const unsigned int patchHalfWidth, TiledImage<TImage>* const image, TiledMask* const mask) :
+    Image(image), MaskImage(mask), PatchHalfWidth(patchHalfWidth)
+  {
+  }
+
+  void PaintPatch(const itk::Index<2>& targetCenter, const itk::Index<2>& sourceCenter) override
+  {
+    itk::ImageRegion<2> fullRegion = this->Image->GetLargestPossibleRegion();
+
+    itk::ImageRegion<2> fullTargetRegion =
+        ITKHelpers::GetRegionInRadiusAroundPixel(targetCenter, this->PatchHalfWidth);
+    itk::ImageRegion<2> fullSourceRegion =
+        ITKHelpers::GetRegionInRadiusAroundPixel(sourceCenter, this->PatchHalfWidth);
+
+    // Ensure that the source patch will match the target patch after it is cropped (this must be done before cropping the target region)
+    itk::ImageRegion<2> sourceRegion = ITKHelpers::CropRegionAtPosition(fullSourceRegion, fullRegion, fullTargetRegion);
+
+    itk::ImageRegion<2> targetRegion = fullTargetRegion;
+    targetRegion.Crop(fullRegion);
+
+    // Load the tiles of both patches before copying, in the row-major order in which the pixels are visited
+    this->Image->Prefetch(sourceRegion);
+    this->Image->Prefetch(targetRegion);
+    this->MaskImage->Prefetch(targetRegion);
+
+    for(unsigned int y = 0; y < targetRegion.GetSize()[1]; ++y)
+    {
+      for(unsigned int x = 0; x < targetRegion.GetSize()[0]; ++x)
+      {
+        itk::Offset<2> offset = {{static_cast<itk::OffsetValueType>(x), static_cast<itk::OffsetValueType>(y)}};
+        itk::Index<2> targetPixel = targetRegion.GetIndex() + offset;
+
+        // Only paint the pixel if it is currently a hole
+        if(this->MaskImage->IsHole(targetPixel))
+        {
+          this->Image->SetPixel(targetPixel, this->Image->GetPixel(sourceRegion.GetIndex() + offset));
+          this->MaskImage->MarkAsValid(targetPixel);
+          this->NumberOfPaintedPixels++;
+        }
+      }
+    }
+  }
+
+  PatchInpainterParent* DeepCopy() override
+  {
+    return new TiledPatchInpainter<TImage>(*this);
+  }
+
+  /** Get the number of hole pixels that have been painted. */
+  std::size_t GetNumberOfPaintedPixels() const
+  {
+    return this->NumberOfPaintedPixels;
+  }
+
+private:
+
+  /** The tiled image and mask are not owned, and are shared by the deep copies. */
+  TiledImage<TImage>* Image;
+
+  TiledMask* MaskImage;
+
+  unsigned int PatchHalfWidth;
+
+  std::size_t NumberOfPaintedPixels = 0;
+};
+
+#endif
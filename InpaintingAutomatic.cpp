@@ -99,13 +99,19 @@
 #include "Interactive/TopPatchesDialog.h"
 #include "Interactive/PriorityViewerWidget.h"
 
+// Coarse-to-fine
+#include "Drivers/PyramidInpainting.hpp"
+
 // Run with: Data/trashcan.mha Data/trashcan_mask.mha 15 filled.mha
+// Add a number of pyramid levels (> 1) as a 5th argument to inpaint coarse-to-fine without the GUI.
+// Add a file name as a 6th argument (with 1 pyramid level) to write a binary fill log of the inpainting.
 int main(int argc, char *argv[])
 {
   // Verify arguments
-  if(argc != 5)
+  if(argc < 5 || argc > 7)
     {
-    std::cerr << "Required arguments: image.mha imageMask.mha patchHalfWidth output.mha" << std::endl;
+    std::cerr << "Required arguments: image.mha imageMask.mha patchHalfWidth output.mha "
+              << "[numberOfPyramidLevels [log.fill]]" << std::endl;
     std::cerr << "Input arguments: ";
     for(int i = 1; i < argc; ++i)
       {
@@ -152,6 +158,35 @@ int main(int argc, char *argv[])
 
   std::cout << "image has " << image->GetNumberOfComponentsPerPixel() << " components." << std::endl;
 
+  unsigned int numberOfPyramidLevels = 1;
+  if(argc >= 6)
+    {
+    std::stringstream ssNumberOfPyramidLevels;
+    ssNumberOfPyramidLevels << argv[5];
+    ssNumberOfPyramidLevels >> numberOfPyramidLevels;
+    }
+
+  std::string fillLogFilename;
+  if(argc == 7)
+    {
+    fillLogFilename = argv[6];
+    std::cout << "Fill log: " << fillLogFilename << std::endl;
+    }
+
+  if(numberOfPyramidLevels > 1)
+    {
+    if(!fillLogFilename.empty())
+      {
+      std::cerr << "A fill log can not be written with a pyramid." << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const unsigned int pyramidSearchRadius = 4;
+    PyramidInpainting(ImageType::Pointer(image), mask, patchHalfWidth, numberOfPyramidLevels, pyramidSearchRadius);
+    ITKHelpers::WriteImage(image, outputFilename);
+    return EXIT_SUCCESS;
+    }
+
   typedef ImagePatchPixelDescriptor<ImageType> ImagePatchPixelDescriptorType;
 
   // Create the graph
@@ -257,8 +292,6 @@ int main(int argc, char *argv[])
           DebugVisitorType;
   DebugVisitorType debugVisitor(image, mask, patchHalfWidth, boundaryStatusMap, boundaryNodeQueue);
 
-  LoggerVisitor<VertexListGraphType> loggerVisitor("log.txt");
-
   PaintPatchVisitor<VertexListGraphType, ImageType> inpaintRGBVisitor(image,
                                                                       mask.GetPointer(), patchHalfWidth);
 
@@ -268,7 +301,16 @@ int main(int argc, char *argv[])
   //compositeInpaintingVisitor.AddVisitor(&inpaintRGBVisitor);
   compositeInpaintingVisitor.AddVisitor(&displayVisitor);
   compositeInpaintingVisitor.AddVisitor(&debugVisitor);
-  //compositeInpaintingVisitor.AddVisitor(&loggerVisitor);
+
+  // The log must be started before anything is filled so that it records the checksum of the input.
+  typedef LoggerVisitor<VertexListGraphType> LoggerVisitorType;
+  std::shared_ptr<LoggerVisitorType> loggerVisitor;
+  if(!fillLogFilename.empty())
+    {
+    loggerVisitor.reset(new LoggerVisitorType(fillLogFilename, image->GetLargestPossibleRegion(), patchHalfWidth,
+                                              FillLog::ComputeInputChecksum(image, mask.GetPointer())));
+    compositeInpaintingVisitor.AddVisitor(loggerVisitor);
+    }
 
   InitializePriority(mask, boundaryNodeQueue, priorityMap, &priorityFunction, boundaryStatusMap);
 
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Utilities
+#include "Utilities/InpaintingProtocol.h"
+#include "Utilities/UnixSocket.h"
+
+// STL
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// POSIX
+#include <unistd.h>
+
+// Send one request to an InpaintingServer and print every message it sends back, one per line.
+// The image, mask and output paths are made absolute, as the server may run in a different directory.
+// Run with: /tmp/inpainting.sock INPAINT image=Data/trashcan.png mask=Data/trashcan.mask radius=15 output=filled.png
+// or: /tmp/inpainting.sock INPAINT image=a.png mask=a.mask radius=7 driver=pyramid levels=3 output=b.png priority=5
+// or: /tmp/inpainting.sock STATUS
+// or: /tmp/inpainting.sock SHUTDOWN
+int main(int argc, char *argv[])
+{
+  // Verify arguments
+  if(argc < 3)
+  {
+    std::cerr << "Required arguments: socketPath INPAINT|STATUS|SHUTDOWN [key=value ...]" << std::endl;
+    std::cerr << "Input arguments: ";
+    for(int i = 1; i < argc; ++i)
+    {
+      std::cerr << argv[i] << " ";
+    }
+    return EXIT_FAILURE;
+  }
+
+  // Parse arguments
+  std::string socketPath = argv[1];
+
+  InpaintingProtocol::Message request;
+  request.Command = argv[2];
+
+  char workingDirectory[4096];
+  if(getcwd(workingDirectory, sizeof(workingDirectory)) == nullptr)
+  {
+    std::cerr << "Cannot get the working directory." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for(int i = 3; i < argc; ++i)
+  {
+    std::string argument = argv[i];
+    std::size_t separator = argument.find('=');
+    if(separator == std::string::npos || separator == 0)
+    {
+      std::cerr << "'" << argument << "' is not a key=value argument." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::string key = argument.substr(0, separator);
+    std::string value = argument.substr(separator + 1);
+    if((key == "image" || key == "mask" || key == "output") && !value.empty() && value[0] != '/')
+    {
+      value = std::string(workingDirectory) + "/" + value;
+    }
+    request.Values[key] = value;
+  }
+
+  // The server closes the connection after its last message. The job failed if that message is FAILED or ERROR.
+  std::string lastCommand;
+  try
+  {
+    std::unique_ptr<UnixSocket> server = UnixSocket::Connect(socketPath);
+    InpaintingProtocol::WriteMessage(*server, request);
+
+    InpaintingProtocol::Message reply;
+    while(InpaintingProtocol::ReadMessage(*server, reply))
+    {
+      std::cout << InpaintingProtocol::ToString(reply) << std::endl;
+      lastCommand = reply.Command;
+    }
+  }
+  catch(const std::runtime_error& error)
+  {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(lastCommand.empty() || lastCommand == "FAILED" || lastCommand == "ERROR")
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,470 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
+
+// Utilities
+#include "Utilities/BatchManifest.h"
+#include "Utilities/InpaintingProtocol.h"
+#include "Utilities/LRUCache.h"
+#include "Utilities/PriorityJobQueue.h"
+#include "Utilities/UnixSocket.h"
+
+// Drivers
+#include "Drivers/BatchJobInpainting.hpp"
+
+// ITK
+#include "itkCovariantVector.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// POSIX
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+
+typedef itk::Image<itk::CovariantVector<int, 3>, 2> OriginalImageType;
+
+/** A file name, its modification time (in seconds and nanoseconds) and its size, so that a file that has been
+  * rewritten is read again, even within the same second. */
+typedef std::tuple<std::string, long, long, long long> CacheKeyType;
+
+CacheKeyType GetCacheKey(const std::string& fileName)
+{
+  struct stat fileStatus;
+  if(stat(fileName.c_str(), &fileStatus) != 0)
+  {
+    throw std::runtime_error("Cannot read " + fileName);
+  }
+  return CacheKeyType(fileName, static_cast<long>(fileStatus.st_mtim.tv_sec),
+                      static_cast<long>(fileStatus.st_mtim.tv_nsec), static_cast<long long>(fileStatus.st_size));
+}
+
+std::string ToString(const unsigned int value)
+{
+  std::stringstream ss;
+  ss << value;
+  return ss.str();
+}
+
+struct ServerJob
+{
+  unsigned int Id = 0;
+  BatchJob Job;
+  std::shared_ptr<UnixSocket> Client;
+};
+
+/** The images a worker inpaints. They are kept from one job to the next, so that their buffers are reused. */
+struct WorkerState
+{
+  OriginalImageType::Pointer Image = OriginalImageType::New();
+  Mask::Pointer JobMask = Mask::New();
+};
+
+class InpaintingServer
+{
+public:
+
+  InpaintingServer(const std::string& socketPath, const unsigned int numberOfWorkers,
+                   const unsigned int threadsPerJob, const unsigned int numberOfCachedImages) :
+    SocketPath(socketPath), NumberOfWorkers(numberOfWorkers), ThreadsPerJob(threadsPerJob),
+    ImageCache(numberOfCachedImages), MaskCache(numberOfCachedImages)
+  {
+
+  }
+
+  /** Serve requests until a SHUTDOWN request arrives. The jobs that are queued at that time are still run. */
+  void Run()
+  {
+    this->ListeningSocket = UnixSocket::Listen(this->SocketPath);
+    std::cout << "Listening on " << this->SocketPath << " with " << this->NumberOfWorkers << " workers of "
+              << this->ThreadsPerJob << " threads." << std::endl;
+
+    std::vector<std::thread> workers;
+    for(unsigned int i = 0; i < this->NumberOfWorkers; ++i)
+    {
+      workers.push_back(std::thread(&InpaintingServer::Work, this));
+    }
+
+    // Each request is read on its own thread, so a slow client does not hold up the others
+    while(std::unique_ptr<UnixSocket> client = this->ListeningSocket->Accept())
+    {
+      std::shared_ptr<UnixSocket> sharedClient(std::move(client));
+      {
+        std::lock_guard<std::mutex> lock(this->ConnectionMutex);
+        this->NumberOfOpenConnections++;
+      }
+      std::thread(&InpaintingServer::ServeConnection, this, sharedClient).detach();
+    }
+
+    // No job can be pushed after the queue is closed, so wait for the requests that are still being read
+    {
+      std::unique_lock<std::mutex> lock(this->ConnectionMutex);
+      this->ConnectionsClosed.wait(lock, [this]() { return this->NumberOfOpenConnections == 0; });
+    }
+
+    this->Jobs.Close();
+    for(unsigned int i = 0; i < workers.size(); ++i)
+    {
+      workers[i].join();
+    }
+
+    this->ListeningSocket.reset();
+    unlink(this->SocketPath.c_str());
+  }
+
+private:
+
+  std::string SocketPath;
+
+  unsigned int NumberOfWorkers;
+
+  unsigned int ThreadsPerJob;
+
+  std::unique_ptr<UnixSocket> ListeningSocket;
+
+  PriorityJobQueue<ServerJob> Jobs;
+
+  /** Held while a job is pushed and its QUEUED message is sent. */
+  std::mutex QueueMutex;
+
+  /** The number of connections whose request is being read or answered, see ServeConnection(). */
+  unsigned int NumberOfOpenConnections = 0;
+  std::mutex ConnectionMutex;
+  std::condition_variable ConnectionsClosed;
+
+  /** The inputs of recent jobs. The cached objects are never modified, each job inpaints a copy. */
+  LRUCache<CacheKeyType, OriginalImageType::Pointer> ImageCache;
+  LRUCache<CacheKeyType, Mask::Pointer> MaskCache;
+
+  /** Only used while QueueMutex is held. */
+  unsigned int NextJobId = 0;
+
+  std::atomic<unsigned int> NumberOfRunningJobs{0};
+  std::atomic<unsigned int> NumberOfFinishedJobs{0};
+  std::atomic<unsigned int> NumberOfFailedJobs{0};
+
+  /** Send 'message' to a client. A client that has disconnected is not an error, its job is still run. */
+  static void Send(UnixSocket& client, const InpaintingProtocol::Message& message)
+  {
+    try
+    {
+      InpaintingProtocol::WriteMessage(client, message);
+    }
+    catch(const std::runtime_error&)
+    {
+    }
+  }
+
+  static InpaintingProtocol::Message CreateMessage(const std::string& command, const unsigned int jobId)
+  {
+    InpaintingProtocol::Message message;
+    message.Command = command;
+    message.Values["id"] = ToString(jobId);
+    return message;
+  }
+
+  /** Handle the request of 'client' on a thread of its own, and let Run() know when it is done. */
+  void ServeConnection(std::shared_ptr<UnixSocket> client)
+  {
+    try
+    {
+      this->HandleConnection(client);
+    }
+    catch(const std::exception& error)
+    {
+      std::cerr << "InpaintingServer: " << error.what() << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(this->ConnectionMutex);
+    this->NumberOfOpenConnections--;
+    this->ConnectionsClosed.notify_all();
+  }
+
+  /** Read one request. A client that does not send its request is disconnected after a few seconds. */
+  void HandleConnection(std::shared_ptr<UnixSocket> client)
+  {
+    InpaintingProtocol::Message request;
+    try
+    {
+      client->SetReceiveTimeout(5);
+      if(!InpaintingProtocol::ReadMessage(*client, request))
+      {
+        return;
+      }
+    }
+    catch(const std::runtime_error& error)
+    {
+      InpaintingProtocol::Message reply;
+      reply.Command = "ERROR";
+      reply.Values["message"] = error.what();
+      Send(*client, reply);
+      return;
+    }
+
+    if(request.Command == "INPAINT")
+    {
+      InpaintingProtocol::Message reply;
+      try
+      {
+        ServerJob job;
+        job.Job = BatchManifest::CreateJob(request.Values, "request");
+        job.Client = client;
+
+        std::stringstream ssPriority(request.GetValue("priority", "0"));
+        int priority = 0;
+        ssPriority >> priority;
+
+        // A worker waits for this lock before it sends STARTED, so QUEUED is always sent first
+        std::lock_guard<std::mutex> lock(this->QueueMutex);
+        job.Id = this->NextJobId++;
+        std::size_t position = this->Jobs.Push(job, priority);
+        reply = CreateMessage("QUEUED", job.Id);
+        reply.Values["position"] = ToString(position);
+        Send(*client, reply);
+      }
+      catch(const std::runtime_error& error)
+      {
+        reply = InpaintingProtocol::Message();
+        reply.Command = "ERROR";
+        reply.Values["message"] = error.what();
+        Send(*client, reply);
+      }
+    }
+    else if(request.Command == "STATUS")
+    {
+      InpaintingProtocol::Message reply;
+      reply.Command = "STATUS";
+      reply.Values["queued"] = ToString(this->Jobs.GetNumberOfQueuedJobs());
+      reply.Values["running"] = ToString(this->NumberOfRunningJobs);
+      reply.Values["finished"] = ToString(this->NumberOfFinishedJobs);
+      reply.Values["failed"] = ToString(this->NumberOfFailedJobs);
+      reply.Values["cachedImages"] = ToString(this->ImageCache.GetSize());
+      reply.Values["cacheHits"] = ToString(this->ImageCache.GetNumberOfHits());
+      reply.Values["cacheMisses"] = ToString(this->ImageCache.GetNumberOfMisses());
+      Send(*client, reply);
+    }
+    else if(request.Command == "SHUTDOWN")
+    {
+      InpaintingProtocol::Message reply;
+      reply.Command = "BYE";
+      Send(*client, reply);
+      this->ListeningSocket->Shutdown();
+    }
+    else
+    {
+      InpaintingProtocol::Message reply;
+      reply.Command = "ERROR";
+      reply.Values["message"] = "unknown command '" + request.Command + "'";
+      Send(*client, reply);
+    }
+  }
+
+  void Work()
+  {
+#ifdef _OPENMP
+    // The OpenMP thread count is a per-thread setting, so it only applies to the parallel regions of this worker
+    omp_set_num_threads(this->ThreadsPerJob);
+#endif
+
+    WorkerState state;
+    ServerJob job;
+    while(this->Jobs.Pop(job))
+    {
+      this->NumberOfRunningJobs++;
+      {
+        std::lock_guard<std::mutex> lock(this->QueueMutex);
+        Send(*job.Client, CreateMessage("STARTED", job.Id));
+      }
+
+      try
+      {
+        this->RunJob(job, state);
+
+        InpaintingProtocol::Message reply = CreateMessage("DONE", job.Id);
+        reply.Values["output"] = job.Job.OutputFileName;
+        Send(*job.Client, reply);
+        this->NumberOfFinishedJobs++;
+      }
+      catch(const std::exception& error)
+      {
+        InpaintingProtocol::Message reply = CreateMessage("FAILED", job.Id);
+        reply.Values["message"] = error.what();
+        Send(*job.Client, reply);
+        this->NumberOfFailedJobs++;
+      }
+      this->NumberOfRunningJobs--;
+
+      // Closes the connection (unless the job is still referenced elsewhere)
+      job = ServerJob();
+    }
+  }
+
+  void RunJob(const ServerJob& job, WorkerState& state)
+  {
+    CacheKeyType imageKey = GetCacheKey(job.Job.ImageFileName);
+    OriginalImageType::Pointer image;
+    if(!this->ImageCache.Get(imageKey, image))
+    {
+      typedef itk::ImageFileReader<OriginalImageType> ImageReaderType;
+      ImageReaderType::Pointer imageReader = ImageReaderType::New();
+      imageReader->SetFileName(job.Job.ImageFileName);
+      imageReader->Update();
+
+      image = OriginalImageType::New();
+      ITKHelpers::DeepCopy(imageReader->GetOutput(), image.GetPointer());
+      this->ImageCache.Insert(imageKey, image);
+    }
+
+    CacheKeyType maskKey = GetCacheKey(job.Job.MaskFileName);
+    Mask::Pointer mask;
+    if(!this->MaskCache.Get(maskKey, mask))
+    {
+      mask = Mask::New();
+      mask->Read(job.Job.MaskFileName);
+      this->MaskCache.Insert(maskKey, mask);
+    }
+
+    ITKHelpers::DeepCopy(image.GetPointer(), state.Image.GetPointer());
+    state.JobMask->DeepCopyFrom(mask);
+
+    // Report at most 10 times per second, the last iteration is always reported by InpaintingComplete()
+    typedef std::chrono::steady_clock ClockType;
+    ClockType::time_point lastProgressTime = ClockType::now();
+    auto progressCallback = [&](unsigned int iteration, unsigned int remainingHolePixels)
+    {
+      ClockType::time_point now = ClockType::now();
+      if(remainingHolePixels > 0 && now - lastProgressTime < std::chrono::milliseconds(100))
+      {
+        return;
+      }
+      lastProgressTime = now;
+
+      InpaintingProtocol::Message progress = CreateMessage("PROGRESS", job.Id);
+      progress.Values["iteration"] = ToString(iteration);
+      progress.Values["remainingHolePixels"] = ToString(remainingHolePixels);
+      Send(*job.Client, progress);
+    };
+
+    BatchJobInpainting(job.Job, state.Image, state.JobMask, progressCallback);
+
+    // See ClassicalImageInpainting.cpp
+    if(Helpers::GetFileExtension(job.Job.OutputFileName) == "png")
+    {
+      ITKHelpers::WriteRGBImage(state.Image.GetPointer(), job.Job.OutputFileName);
+    }
+    else
+    {
+      ITKHelpers::WriteImage(state.Image.GetPointer(), job.Job.OutputFileName);
+    }
+  }
+};
+
+} // end anonymous namespace
+
+// A long-lived inpainting process. Jobs are submitted over a Unix domain socket (see Utilities/InpaintingProtocol.h
+// and InpaintingClient.cpp), queued by priority and run by 'maxConcurrentJobs' workers, which share the
+// 'numberOfThreads' thread budget. The decoded inputs of the 'numberOfCachedImages' most recently used images and
+// masks are kept, so jobs on the same image do not read and decode it again.
+// Run with: /tmp/inpainting.sock
+// or, to run 2 jobs at once with 4 threads each: /tmp/inpainting.sock 2 8 16
+int main(int argc, char *argv[])
+{
+  // Verify arguments
+  if(argc < 2 || argc > 5)
+  {
+    std::cerr << "Required arguments: socketPath [maxConcurrentJobs] [numberOfThreads] [numberOfCachedImages]"
+              << std::endl;
+    std::cerr << "Input arguments: ";
+    for(int i = 1; i < argc; ++i)
+    {
+      std::cerr << argv[i] << " ";
+    }
+    return EXIT_FAILURE;
+  }
+
+  // Parse arguments
+  std::string socketPath = argv[1];
+
+  unsigned int maxConcurrentJobs = 1;
+  if(argc > 2)
+  {
+    std::stringstream ssMaxConcurrentJobs;
+    ssMaxConcurrentJobs << argv[2];
+    ssMaxConcurrentJobs >> maxConcurrentJobs;
+  }
+
+  unsigned int numberOfThreads = std::thread::hardware_concurrency();
+  if(argc > 3)
+  {
+    std::stringstream ssNumberOfThreads;
+    ssNumberOfThreads << argv[3];
+    ssNumberOfThreads >> numberOfThreads;
+  }
+
+  unsigned int numberOfCachedImages = 8;
+  if(argc > 4)
+  {
+    std::stringstream ssNumberOfCachedImages;
+    ssNumberOfCachedImages << argv[4];
+    ssNumberOfCachedImages >> numberOfCachedImages;
+  }
+
+  // The number of jobs is not known in advance, so assume there are always enough to keep every worker busy
+  unsigned int threadsPerJob = 1;
+  BatchManifest::DivideThreads(numberOfThreads, maxConcurrentJobs, maxConcurrentJobs, threadsPerJob);
+
+  // ITK filters started by any job use at most this job's share of the threads
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(threadsPerJob);
+
+  try
+  {
+    InpaintingServer server(socketPath, maxConcurrentJobs, threadsPerJob, numberOfCachedImages);
+    server.Run();
+  }
+  catch(const std::runtime_error& error)
+  {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -32,6 +32,9 @@
 #include <QMainWindow>
 #include <QThread>
 
+// STL
+#include <memory>
+
 // Submodules
 #include <ITKVTKCamera/ITKVTKCamera.h>
 #include <Mask/Mask.h>
@@ -40,6 +43,7 @@
 #include "Node.h"
 #include "Interactive/Layer.h"
 #include "Interactive/PatchHighlighter.h"
+#include "Utilities/PatchDeltaHistory.h"
 
 class InteractorStyleImageWithDrag;
 
@@ -62,6 +66,15 @@ public slots:
   /** Quit. */
   virtual void on_actionQuit_triggered() = 0;
 
+  /** Show the state before the iteration that is currently shown. */
+  virtual void on_actionStepBackward_triggered() = 0;
+
+  /** Show the state after the next iteration. */
+  virtual void on_actionStepForward_triggered() = 0;
+
+  /** Allow the history to be browsed now that nothing is being recorded into it. */
+  virtual void slot_InpaintingComplete() = 0;
+
   /** Update the image that is displayed. */
   virtual void slot_UpdateImage() = 0;
 
@@ -88,6 +101,10 @@ private:
 
   void on_actionQuit_triggered() override;
 
+  void on_actionStepBackward_triggered() override;
+
+  void on_actionStepForward_triggered() override;
+
   void closeEvent(QCloseEvent*);
 
   /** The image that will be displayed, and the from which the patches will
@@ -108,6 +125,9 @@ private:
   /** A wrapper that creates and holds the image, the mapper, and the actor. */
   Layer ImageLayer;
 
+  /** The history of the inpainting, if one is being recorded. */
+  std::shared_ptr<PatchDeltaHistory<TImage> > History;
+
 public:
   // Constructor
 //  BasicViewerWidget(TImage* const image, Mask* const mask);
@@ -115,6 +135,12 @@ public:
 
   void slot_UpdateImage() override;
 
+  void slot_InpaintingComplete() override;
+
+  /** Set the history that the History menu steps through once the inpainting is complete. The history must
+    * be recorded from the same image that this widget displays (see IterationHistoryVisitor). */
+  void SetHistory(std::shared_ptr<PatchDeltaHistory<TImage> > history);
+
   /** Update the source region outline, and display the proposed source patch.
     * We need the target region as well while updating the
     * source region because we may want to mask the source patch with the target patch's mask.
@@ -141,6 +167,13 @@ private:
   /** Setup the QGraphicsScenes. */
   void SetupScenes();
 
+  /** Show 'image' in the main view. */
+  void DisplayImage(const TImage* const image);
+
+  /** Show the replay image of the history, outline the patches of the last iteration that was applied to it,
+    * and enable the steps that are possible from there. */
+  void DisplayHistoryState();
+
   /** The interactor to allow us to zoom and pan the image while still moving images with Pickable=true */
 //  vtkSmartPointer<InteractorStyleImageWithDrag> InteractorStyle;
   vtkSmartPointer<vtkInteractorStyleImage> InteractorStyle;
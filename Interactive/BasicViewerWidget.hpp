@@ -58,6 +58,9 @@
 // Custom
 #include "InteractorStyleImageWithDrag.h"
 
+// STL
+#include <sstream>
+
 template <typename TImage>
 //BasicViewerWidget<TImage>::BasicViewerWidget(TImage* const image, Mask* const mask) :
 BasicViewerWidget<TImage>::BasicViewerWidget(typename TImage::Pointer image, Mask::Pointer mask) :
@@ -128,6 +131,12 @@ void BasicViewerWidget<TImage>::slot_UpdateImage()
 {
 //  std::cout << "BasicViewerWidget::slot_UpdateImage()" << std::endl;
 
+  DisplayImage(this->Image.GetPointer());
+}
+
+template <typename TImage>
+void BasicViewerWidget<TImage>::DisplayImage(const TImage* const image)
+{
   // Show the masked image (should do this if the hole has not been blanked by the user)
 //  typename TImage::Pointer tempImage = TImage::New();
 //  ITKHelpers::DeepCopy(this->Image.GetPointer(), tempImage.GetPointer());
@@ -138,8 +147,7 @@ void BasicViewerWidget<TImage>::slot_UpdateImage()
 //                                                       this->ImageLayer.ImageData);
 
   // Show the image "as-is"
-  ITKVTKHelpers::ITKVectorImageToVTKImageFromDimension(this->Image.GetPointer(),
-                                                       this->ImageLayer.ImageData);
+  ITKVTKHelpers::ITKVectorImageToVTKImageFromDimension(image, this->ImageLayer.ImageData);
 
 //   if(chkScaleImage->isChecked())
 //   {
@@ -162,6 +170,79 @@ void BasicViewerWidget<TImage>::slot_UpdateImage()
   this->qvtkWidget->GetRenderWindow()->Render();
 }
 
+template <typename TImage>
+void BasicViewerWidget<TImage>::SetHistory(std::shared_ptr<PatchDeltaHistory<TImage> > history)
+{
+  this->History = history;
+}
+
+template <typename TImage>
+void BasicViewerWidget<TImage>::slot_InpaintingComplete()
+{
+  if(!this->History)
+  {
+    return;
+  }
+
+  // The history is recorded on the inpainting thread, so it is only safe to step through it from here on.
+  this->History->Seek(this->History->GetNumberOfIterations());
+  DisplayHistoryState();
+}
+
+template <typename TImage>
+void BasicViewerWidget<TImage>::on_actionStepBackward_triggered()
+{
+  if(!this->History || this->History->GetReplayState() == 0)
+  {
+    return;
+  }
+
+  this->History->StepBackward();
+  DisplayHistoryState();
+}
+
+template <typename TImage>
+void BasicViewerWidget<TImage>::on_actionStepForward_triggered()
+{
+  if(!this->History || this->History->GetReplayState() == this->History->GetNumberOfIterations())
+  {
+    return;
+  }
+
+  this->History->StepForward();
+  DisplayHistoryState();
+}
+
+template <typename TImage>
+void BasicViewerWidget<TImage>::DisplayHistoryState()
+{
+  unsigned int state = this->History->GetReplayState();
+  unsigned int numberOfIterations = this->History->GetNumberOfIterations();
+
+  DisplayImage(this->History->GetReplayImage());
+
+  // Outline the patches of the iteration that produced this state.
+  if(state > 0 && this->TargetHighlighter && this->SourceHighlighter)
+  {
+    const typename PatchDeltaHistory<TImage>::Delta& delta = this->History->GetDelta(state - 1);
+
+    // The delta's region is the cropped target region, so the source region is cropped the same way.
+    itk::Offset<2> sourceOffset = delta.SourcePixel - delta.TargetPixel;
+    itk::ImageRegion<2> sourceRegion(delta.Region.GetIndex() + sourceOffset, delta.Region.GetSize());
+
+    this->TargetHighlighter->SetRegion(delta.Region);
+    this->SourceHighlighter->SetRegion(sourceRegion);
+    this->qvtkWidget->GetRenderWindow()->Render();
+  }
+
+  std::stringstream ss;
+  ss << "Iteration " << state << " of " << numberOfIterations;
+  this->statusBar()->showMessage(ss.str().c_str());
+
+  this->actionStepBackward->setEnabled(state > 0);
+  this->actionStepForward->setEnabled(state < numberOfIterations);
+}
+
 template <typename TImage>
 void BasicViewerWidget<TImage>::slot_UpdateSource(const itk::ImageRegion<2>& sourceRegion,
                                                   const itk::ImageRegion<2>& targetRegion)
@@ -232,6 +313,11 @@ void BasicViewerWidget<TImage>::ConnectVisitor(TVisitor* visitor)
                    this, SLOT(slot_UpdateTarget(const itk::ImageRegion<2>&)),
                    Qt::BlockingQueuedConnection);
 
+  // Nothing is waiting on this one, so the visitor does not have to block.
+  QObject::connect(visitor, SIGNAL(signal_InpaintingComplete()),
+                   this, SLOT(slot_InpaintingComplete()),
+                   Qt::QueuedConnection);
+
 }
 
 template <typename TImage>
@@ -26,6 +26,8 @@
 
 // This class allows us to record iterations of the inpainting procedure.
 // It stores the image and mask AFTER the ith iteration is complete.
+// Storing full images at every iteration does not scale to long runs on large images -
+// Utilities/PatchDeltaHistory.h stores only the painted pixels of each iteration instead.
 // For this reason, the PotentialPairSets are the pairs that were considered
 // BEFORE moving to this state.
 class InpaintingIterationRecord
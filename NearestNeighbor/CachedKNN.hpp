@@ -0,0 +1,270 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef CachedKNN_HPP
+#define CachedKNN_HPP
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+  * This class wraps a KNN search (e.g. LinearSearchKNNProperty) with a cache of the neighbors of each target, so it
+  * can be the first step of TwoStepNearestNeighbor or KNNBestWrapper.
+  *
+  * Precompute() searches for the neighbors of all of the targets that are known before the inpainting starts (the
+  * initial boundary, see IndirectPriorityQueue::GetValidNodes()) in parallel, and most of them are not touched for
+  * many iterations. Invalidate() (called by KNNCacheInvalidationVisitor after each patch is filled) removes the
+  * neighbors of every target whose patch, or the patch of any of whose neighbors, overlaps the filled patch, since
+  * their differences may have changed. A search for a target without neighbors in the cache is passed to the
+  * wrapped search.
+  *
+  * The cache does not know about source patches that are created during the inpainting (see
+  * InpaintingVisitor::SetAllowNewPatches()).
+  * \tparam TVertexDescriptor The type of the vertex descriptor.
+  * \tparam TKNNSearch The KNN search to wrap. It must be safe to call from multiple threads after its first search
+  *                    (which builds the index of an indexed search), as LinearSearchKNNProperty is. It should not
+  *                    use an unnamed critical section, which would serialize the threads of Precompute().
+  */
+template <typename TVertexDescriptor, typename TKNNSearch>
+class CachedKNN
+{
+  typedef std::pair<itk::Index<2>::IndexValueType, itk::Index<2>::IndexValueType> PixelPairType;
+  typedef std::vector<TVertexDescriptor> NeighborVectorType;
+
+  std::shared_ptr<TKNNSearch> KNNSearch;
+
+  unsigned int PatchHalfWidth;
+
+  bool InvalidateSourceOverlaps;
+
+  /** The neighbors of each cached target. */
+  std::map<PixelPairType, NeighborVectorType> Neighbors;
+
+  /** The cached targets that each source patch is a neighbor of. The targets are not removed when their neighbors
+    * are invalidated, so some of them may not be cached any more. */
+  std::map<PixelPairType, std::vector<PixelPairType> > Users;
+
+  static PixelPairType GetPixelPair(const TVertexDescriptor& vertex)
+  {
+    itk::Index<2> index = ITKHelpers::CreateIndex(vertex);
+    return PixelPairType(index[0], index[1]);
+  }
+
+public:
+
+  unsigned int NumberOfPrecomputedTargets = 0;
+  unsigned int NumberOfHits = 0;
+  unsigned int NumberOfMisses = 0;
+  unsigned int NumberOfInvalidations = 0;
+
+  /** Source patches never contain hole pixels, so they are not changed when only the hole pixels of a patch are
+    * filled (as PatchInpainter does), and by default only the targets whose own patches overlap a filled patch are
+    * invalidated. 'invalidateSourceOverlaps' also invalidates the targets that have a neighbor that overlaps a
+    * filled patch, for inpainters that change valid pixels too. */
+  CachedKNN(std::shared_ptr<TKNNSearch> knnSearch, const unsigned int patchHalfWidth,
+            const bool invalidateSourceOverlaps = false) :
+    KNNSearch(knnSearch), PatchHalfWidth(patchHalfWidth), InvalidateSourceOverlaps(invalidateSourceOverlaps)
+  {
+  }
+
+  std::shared_ptr<TKNNSearch> GetKNNSearch() const
+  {
+    return this->KNNSearch;
+  }
+
+  /** Set the number of nearest neighbors to return. This clears the cache if it changes. */
+  void SetK(const unsigned int k)
+  {
+    if(k != this->KNNSearch->GetK())
+    {
+      Clear();
+    }
+    this->KNNSearch->SetK(k);
+  }
+
+  /** Get the number of nearest neighbors to return. */
+  unsigned int GetK() const
+  {
+    return this->KNNSearch->GetK();
+  }
+
+  void Clear()
+  {
+    this->Neighbors.clear();
+    this->Users.clear();
+  }
+
+  /** Get the number of targets whose neighbors are cached. */
+  std::size_t GetNumberOfCachedTargets() const
+  {
+    return this->Neighbors.size();
+  }
+
+  /** Get the fraction of the searches that were answered by the cache. */
+  float GetHitRate() const
+  {
+    const unsigned int numberOfSearches = this->NumberOfHits + this->NumberOfMisses;
+    return numberOfSearches > 0 ? static_cast<float>(this->NumberOfHits) / numberOfSearches : 0.0f;
+  }
+
+  void WriteStatistics(std::ostream& stream) const
+  {
+    stream << "CachedKNN: precomputed " << this->NumberOfPrecomputedTargets << " targets, " << this->NumberOfHits
+           << " hits and " << this->NumberOfMisses << " misses (hit rate " << GetHitRate() << "), "
+           << this->NumberOfInvalidations << " invalidated targets" << std::endl;
+  }
+
+  /** Search for the neighbors of each of the targets in [targetsFirst, targetsLast) among [first, last) in
+    * parallel, and cache them. The descriptors of the targets must already be discovered (e.g. by
+    * ImagePatchDescriptorVisitor::DiscoverVertex()), as they are for a search in the inpainting loop. */
+  template <typename TIterator, typename TTargetIterator>
+  void Precompute(TIterator first, TIterator last, TTargetIterator targetsFirst, TTargetIterator targetsLast)
+  {
+    std::vector<TVertexDescriptor> targets(targetsFirst, targetsLast);
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    if(targets.empty() || first == last)
+    {
+      return;
+    }
+
+    const unsigned int k = GetK();
+    std::vector<NeighborVectorType> neighbors(targets.size(), NeighborVectorType(k));
+    std::vector<std::size_t> numberOfNeighbors(targets.size(), 0);
+
+    // The first search builds the index of an indexed search, so it is not done concurrently
+    numberOfNeighbors[0] = (*this->KNNSearch)(first, last, targets[0], neighbors[0].begin()) - neighbors[0].begin();
+
+    // An exception can not leave a parallel region, so the first one is stored and rethrown after it
+    std::string errorMessage;
+    #pragma omp parallel for schedule(dynamic)
+    for(std::size_t targetId = 1; targetId < targets.size(); ++targetId)
+    {
+      try
+      {
+        numberOfNeighbors[targetId] = (*this->KNNSearch)(first, last, targets[targetId],
+                                                         neighbors[targetId].begin()) - neighbors[targetId].begin();
+      }
+      catch(const std::exception& exception)
+      {
+        #pragma omp critical(CachedKNNPrecompute)
+        if(errorMessage.empty())
+        {
+          errorMessage = exception.what();
+        }
+      }
+    }
+
+    if(!errorMessage.empty())
+    {
+      throw std::runtime_error("CachedKNN::Precompute: " + errorMessage);
+    }
+
+    for(std::size_t targetId = 0; targetId < targets.size(); ++targetId)
+    {
+      neighbors[targetId].resize(numberOfNeighbors[targetId]);
+
+      const PixelPairType target = GetPixelPair(targets[targetId]);
+      for(const TVertexDescriptor& neighbor : neighbors[targetId])
+      {
+        this->Users[GetPixelPair(neighbor)].push_back(target);
+      }
+      this->Neighbors[target].swap(neighbors[targetId]);
+    }
+
+    this->NumberOfPrecomputedTargets += static_cast<unsigned int>(targets.size());
+  }
+
+  /** Remove the neighbors of the targets that are affected by changing the pixels of 'region'. */
+  void Invalidate(const itk::ImageRegion<2>& region)
+  {
+    // A patch overlaps 'region' if its center is in 'region' grown by the half width of a patch
+    itk::ImageRegion<2> centerRegion = region;
+    centerRegion.PadByRadius(this->PatchHalfWidth);
+
+    const itk::Index<2> corner = centerRegion.GetIndex();
+    for(itk::Index<2>::IndexValueType y = corner[1]; y < corner[1] + static_cast<itk::Index<2>::IndexValueType>(
+          centerRegion.GetSize()[1]); ++y)
+    {
+      for(itk::Index<2>::IndexValueType x = corner[0]; x < corner[0] + static_cast<itk::Index<2>::IndexValueType>(
+            centerRegion.GetSize()[0]); ++x)
+      {
+        const PixelPairType pixel(x, y);
+        this->NumberOfInvalidations += static_cast<unsigned int>(this->Neighbors.erase(pixel));
+
+        if(!this->InvalidateSourceOverlaps)
+        {
+          continue;
+        }
+
+        typename std::map<PixelPairType, std::vector<PixelPairType> >::iterator users = this->Users.find(pixel);
+        if(users == this->Users.end())
+        {
+          continue;
+        }
+
+        for(const PixelPairType& target : users->second)
+        {
+          this->NumberOfInvalidations += static_cast<unsigned int>(this->Neighbors.erase(target));
+        }
+        this->Users.erase(users);
+      }
+    }
+  }
+
+  /**
+    * \tparam TIterator The forward-iterator type.
+    * \tparam TOutputIterator The iterator type of the output container.
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search (usually container.end() ).
+    * \param queryNode The item to compare the items in the container against.
+    * \param outputFirst An iterator to the beginning of the output container that will store the K nearest neighbors.
+    * \return The iterator one past the last neighbor that was written.
+    */
+  template <typename TIterator, typename TOutputIterator>
+  TOutputIterator operator()(TIterator first,
+                             TIterator last,
+                             typename TIterator::value_type queryNode,
+                             TOutputIterator outputFirst)
+  {
+    typename std::map<PixelPairType, NeighborVectorType>::const_iterator cached =
+        this->Neighbors.find(GetPixelPair(queryNode));
+    if(cached == this->Neighbors.end())
+    {
+      this->NumberOfMisses++;
+      return (*this->KNNSearch)(first, last, queryNode, outputFirst);
+    }
+
+    this->NumberOfHits++;
+    return std::copy(cached->second.begin(), cached->second.end(), outputFirst);
+  }
+
+};
+
+#endif
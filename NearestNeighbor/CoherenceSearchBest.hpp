@@ -0,0 +1,272 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef CoherenceSearchBest_HPP
+#define CoherenceSearchBest_HPP
+
+// Custom
+#include "Utilities/SourcePixelMap.h"
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+#include <Utilities/Debug/Debug.h>
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+/**
+ * This functor has the same signature as other single-best-neighbor search functors. Before searching the range,
+ * it compares the "coherent" candidates: for every already filled pixel of the target patch, the source patch
+ * that would continue the copy that the pixel came from (as recorded in the source pixel map of the
+ * InpaintingVisitor, see InpaintingVisitor::GetSourcePixelMapImage()), and its neighbors within 'jitterRadius'.
+ * If the best coherent candidate differs from the target by at most 'acceptanceThreshold', it is returned
+ * without searching the range. Otherwise the range is searched, with the difference of the best coherent candidate
+ * as the initial early termination bound (so most comparisons stop after a few pixels).
+ * The result is the same as that of LinearSearchBestProperty unless a coherent candidate is accepted.
+ *
+ * PatchDistanceFunctionType must provide operator()(source, target, targetPixels, bound), as
+ * ImagePatchDifference does.
+ */
+template <typename PropertyMapType, typename PatchDistanceFunctionType>
+struct CoherenceSearchBest : public Debug
+{
+  PropertyMapType PropertyMap;
+
+  const SourcePixelMap::ImageType* SourcePixelMapImage;
+
+  unsigned int PatchHalfWidth;
+
+  unsigned int JitterRadius;
+
+  float AcceptanceThreshold;
+
+  PatchDistanceFunctionType PatchDistanceFunction;
+
+  /** The number of searches. */
+  unsigned int NumberOfQueries = 0;
+
+  /** The number of searches for which there was at least one coherent candidate. */
+  unsigned int NumberOfQueriesWithCandidates = 0;
+
+  /** The number of searches in which a coherent candidate was accepted, so the range was not searched. */
+  unsigned int NumberOfAcceptedCandidates = 0;
+
+  /** The number of searches whose result was a coherent candidate (accepted, or not beaten by the range search). */
+  unsigned int NumberOfHits = 0;
+
+  /** 'acceptanceThreshold' is in the units of the patch difference. A negative threshold means that the range
+    * is always searched. */
+  CoherenceSearchBest(PropertyMapType propertyMap, const SourcePixelMap::ImageType* const sourcePixelMapImage,
+                      const unsigned int patchHalfWidth, const float acceptanceThreshold = 0.0f,
+                      const unsigned int jitterRadius = 1,
+                      PatchDistanceFunctionType patchDistanceFunction = PatchDistanceFunctionType()) :
+    PropertyMap(propertyMap), SourcePixelMapImage(sourcePixelMapImage), PatchHalfWidth(patchHalfWidth),
+    JitterRadius(jitterRadius), AcceptanceThreshold(acceptanceThreshold), PatchDistanceFunction(patchDistanceFunction)
+  {
+
+  }
+
+  /** Get the coherent candidates of 'target' (distinct source patches, excluding the target itself). */
+  template <typename TVertexDescriptor>
+  std::vector<TVertexDescriptor> GetCandidates(const TVertexDescriptor& target) const
+  {
+    const itk::ImageRegion<2> fullRegion = this->SourcePixelMapImage->GetLargestPossibleRegion();
+    itk::Index<2> targetIndex = Helpers::ConvertFrom<itk::Index<2>, TVertexDescriptor>(target);
+
+    itk::ImageRegion<2> targetRegion = ITKHelpers::GetRegionInRadiusAroundPixel(targetIndex, this->PatchHalfWidth);
+    targetRegion.Crop(fullRegion);
+
+    const int jitterRadius = static_cast<int>(this->JitterRadius);
+    std::vector<unsigned int> centers;
+    itk::ImageRegionConstIteratorWithIndex<SourcePixelMap::ImageType> sourceIterator(this->SourcePixelMapImage,
+                                                                                     targetRegion);
+    while(!sourceIterator.IsAtEnd())
+    {
+      // Pixels that are still holes, and original pixels (which are their own source), do not say anything
+      if(sourceIterator.Get() != SourcePixelMap::InvalidSourcePixel &&
+         sourceIterator.Get() != this->SourcePixelMapImage->ComputeOffset(sourceIterator.GetIndex()))
+      {
+        itk::Index<2> source = SourcePixelMap::GetIndex(this->SourcePixelMapImage, sourceIterator.Get());
+        for(int yOffset = -jitterRadius; yOffset <= jitterRadius; ++yOffset)
+        {
+          for(int xOffset = -jitterRadius; xOffset <= jitterRadius; ++xOffset)
+          {
+            itk::Index<2> center = {{source[0] - (sourceIterator.GetIndex()[0] - targetIndex[0]) + xOffset,
+                                     source[1] - (sourceIterator.GetIndex()[1] - targetIndex[1]) + yOffset}};
+            if(fullRegion.IsInside(center) && center != targetIndex)
+            {
+              centers.push_back(this->SourcePixelMapImage->ComputeOffset(center));
+            }
+          }
+        }
+      }
+      ++sourceIterator;
+    }
+
+    std::sort(centers.begin(), centers.end());
+    centers.erase(std::unique(centers.begin(), centers.end()), centers.end());
+
+    std::vector<TVertexDescriptor> candidates;
+    for(unsigned int centerId = 0; centerId < centers.size(); ++centerId)
+    {
+      TVertexDescriptor candidate = Helpers::ConvertFrom<TVertexDescriptor, itk::Index<2> >(
+                                      this->SourcePixelMapImage->ComputeIndex(centers[centerId]));
+      if(get(this->PropertyMap, candidate).GetStatus() == PropertyMapType::value_type::SOURCE_NODE)
+      {
+        candidates.push_back(candidate);
+      }
+    }
+
+    return candidates;
+  }
+
+  /**
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search.
+    * \param query The element to compare to.
+    * \return The best element that was found.
+    */
+  template <typename TIterator>
+  typename TIterator::value_type operator()(TIterator first, TIterator last,
+                                            typename TIterator::value_type query)
+  {
+    // If the input element range is empty, there is nothing to do.
+    if(first == last)
+    {
+      return *last;
+    }
+
+    typedef typename TIterator::value_type VertexDescriptorType;
+    typedef typename PropertyMapType::value_type PatchType;
+
+    this->NumberOfQueries++;
+
+    PatchType queryPatch = get(this->PropertyMap, query);
+
+    typedef std::vector<typename PatchType::ImageType::PixelType> PixelVector;
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+    PixelVector targetPixels(validOffsets->size());
+
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + *offsetIterator);
+    }
+
+    // Compare the coherent candidates
+    float d_best = std::numeric_limits<float>::infinity();
+    VertexDescriptorType result = *first; // As in LinearSearchBestProperty, if no element of the range is valid
+
+    std::vector<VertexDescriptorType> candidates = GetCandidates(query);
+    for(typename std::vector<VertexDescriptorType>::const_iterator candidate = candidates.begin();
+        candidate != candidates.end(); ++candidate)
+    {
+      float d = this->PatchDistanceFunction(get(this->PropertyMap, *candidate), queryPatch, targetPixels);
+      if(d < d_best)
+      {
+        d_best = d;
+        result = *candidate;
+      }
+    }
+
+    if(!candidates.empty())
+    {
+      this->NumberOfQueriesWithCandidates++;
+
+      if(d_best <= this->AcceptanceThreshold)
+      {
+        this->NumberOfAcceptedCandidates++;
+        this->NumberOfHits++;
+        return result;
+      }
+    }
+
+    // Search the range, with the best coherent candidate as the bound
+    std::vector<VertexDescriptorType> validSourceNodes;
+    for(TIterator current = first; current != last; ++current)
+    {
+      if(get(this->PropertyMap, *current).GetStatus() == PatchType::SOURCE_NODE)
+      {
+        validSourceNodes.push_back(*current);
+      }
+    }
+
+    const float coherentDistance = d_best;
+
+    #pragma omp parallel
+    {
+      // Each thread tightens its own bound, so the threads do not have to synchronize inside the loop
+      float threadBest = coherentDistance;
+      VertexDescriptorType threadResult = result;
+
+      #pragma omp for
+      for(std::size_t nodeId = 0; nodeId < validSourceNodes.size(); ++nodeId)
+      {
+        float d = this->PatchDistanceFunction(get(this->PropertyMap, validSourceNodes[nodeId]), queryPatch,
+                                              targetPixels, threadBest);
+        if(d < threadBest)
+        {
+          threadBest = d;
+          threadResult = validSourceNodes[nodeId];
+        }
+      }
+
+      #pragma omp critical
+      if(threadBest < d_best)
+      {
+        d_best = threadBest;
+        result = threadResult;
+      }
+    }
+
+    if(!candidates.empty() && !(d_best < coherentDistance))
+    {
+      this->NumberOfHits++;
+    }
+
+    this->DebugIteration++;
+
+    return result;
+  }
+
+  /** The fraction of the searches whose result was a coherent candidate. */
+  float GetHitRate() const
+  {
+    return this->NumberOfQueries > 0 ? static_cast<float>(this->NumberOfHits) / this->NumberOfQueries : 0.0f;
+  }
+
+  void WriteStatistics(std::ostream& stream) const
+  {
+    stream << "CoherenceSearchBest: " << this->NumberOfQueries << " searches, "
+           << this->NumberOfQueriesWithCandidates << " with coherent candidates, "
+           << this->NumberOfAcceptedCandidates << " accepted without a full search, hit rate "
+           << GetHitRate() << std::endl;
+  }
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef DeadlineSearchBest_HPP
+#define DeadlineSearchBest_HPP
+
+// Custom
+#include "NearestNeighbor/TwoStepNearestNeighbor.hpp"
+#include "PixelDescriptors/PixelDescriptor.h"
+#include "Utilities/DeadlineController.h"
+
+// STL
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * This functor has the same signature as other single-best-neighbor search functors. It performs a
+ * TwoStepNearestNeighbor search with the settings that a DeadlineController currently asks for: the K of the
+ * first step, whether only the source patches returned by the search region functor (e.g. NeighborhoodSearch)
+ * for the query are searched rather than the given range, and the stride with which the candidates are
+ * subsampled. The subsampling starts at a different offset for each query, so that every source patch
+ * is still considered for some of the targets.
+ * If the search region is empty, the given range is searched.
+ */
+template <typename TSearchRegion, typename TPropertyMap, typename TKNNSearch, typename TBestSearch>
+struct DeadlineSearchBest
+{
+  const DeadlineController* Controller;
+
+  TSearchRegion SearchRegion;
+
+  TPropertyMap PropertyMap;
+
+  std::shared_ptr<TKNNSearch> KNNSearch;
+
+  std::shared_ptr<TBestSearch> BestSearch;
+
+  TwoStepNearestNeighbor<TKNNSearch, TBestSearch> TwoStepSearch;
+
+  unsigned int NumberOfQueries = 0;
+
+  DeadlineSearchBest(const DeadlineController* const controller, TSearchRegion searchRegion,
+                     TPropertyMap propertyMap, std::shared_ptr<TKNNSearch> knnSearch,
+                     std::shared_ptr<TBestSearch> bestSearch) :
+    Controller(controller), SearchRegion(searchRegion), PropertyMap(propertyMap),
+    KNNSearch(knnSearch), BestSearch(bestSearch), TwoStepSearch(*knnSearch, *bestSearch)
+  {
+
+  }
+
+  template <typename TIterator>
+  typename TIterator::value_type operator()(TIterator first, TIterator last,
+                                            typename TIterator::value_type query)
+  {
+    typedef typename TIterator::value_type VertexDescriptorType;
+    const DeadlineSearchSettings& settings = this->Controller->GetSettings();
+
+    std::vector<VertexDescriptorType> candidates;
+    if(settings.LocalSearch)
+    {
+      candidates = this->SearchRegion(query);
+    }
+
+    if(candidates.empty())
+    {
+      for(TIterator current = first; current != last; ++current)
+      {
+        if(get(this->PropertyMap, *current).GetStatus() == PixelDescriptor::SOURCE_NODE)
+        {
+          candidates.push_back(*current);
+        }
+      }
+    }
+
+    if(candidates.empty())
+    {
+      throw std::runtime_error("DeadlineSearchBest: there are no source patches to search!");
+    }
+
+    // Subsample the candidates (keeping at least one)
+    const unsigned int stride = std::min<std::size_t>(settings.Stride, candidates.size());
+    if(stride > 1)
+    {
+      std::size_t numberOfKeptCandidates = 0;
+      for(std::size_t candidateId = this->NumberOfQueries % stride; candidateId < candidates.size();
+          candidateId += stride)
+      {
+        candidates[numberOfKeptCandidates++] = candidates[candidateId];
+      }
+      candidates.resize(numberOfKeptCandidates);
+    }
+    this->NumberOfQueries++;
+
+    this->KNNSearch->SetK(std::min<std::size_t>(settings.K, candidates.size()));
+
+    return this->TwoStepSearch(candidates.begin(), candidates.end(), query);
+  }
+};
+
+#endif
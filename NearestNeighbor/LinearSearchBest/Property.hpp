@@ -103,7 +103,7 @@ struct LinearSearchBestProperty : public Debug
 
     // Iterate through all of the input elements
 //    std::cout << "Start search..." << std::endl;
-    typename TIterator::value_type result = *last; // initialize to prevent "possibly used uninitialized" warning
+    typename TIterator::value_type result = *first; // initialize to prevent "possibly used uninitialized" warning
 
     #pragma omp parallel for
 //    for(TIterator current = first; current != last; ++current) // OpenMP 3 doesn't allow != in a parallelized loop
@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef LinearSearchBestPropertyPruned_HPP
+#define LinearSearchBestPropertyPruned_HPP
+
+// Custom
+#include "DifferenceFunctions/Patch/MeanDifferenceBound.hpp"
+#include "NearestNeighbor/PrunedSearch.hpp"
+#include "Utilities/SummedAreaTable.h"
+
+// Submodules
+#include <Utilities/Debug/Debug.h>
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+/**
+   * This functor finds exactly the same best patch (up to ties) as LinearSearchBestProperty, but skips most of the
+   * patch comparisons. A lower bound of the difference of every candidate is computed from the means of the
+   * image under the valid pixels of the target (see MeanDifferenceBound), and the candidates are compared in order
+   * of increasing bound until the next bound exceeds the best difference (see PrunedSearch::FindNearest()).
+   *
+   * The bound is only valid for ImagePatchDifference with SumSquaredPixelDifference. The summed area table is
+   * computed when the functor is created, so the source patches must not change afterwards (they do not change
+   * during an inpainting unless new source patches are allowed, see InpaintingVisitor::SetAllowNewPatches()).
+   * \tparam PropertyMapType The type of the property map containing the patches to compare.
+   * \tparam PatchDistanceFunctionType The functor type to compute the distance between two patches.
+   */
+template <typename PropertyMapType, typename PatchDistanceFunctionType>
+struct LinearSearchBestPropertyPruned : public Debug
+{
+  typedef typename PropertyMapType::value_type PatchType;
+  typedef typename PatchType::ImageType ImageType;
+
+  PropertyMapType PropertyMap;
+  PatchDistanceFunctionType PatchDistanceFunction;
+
+  std::shared_ptr<SummedAreaTable<ImageType> > Table;
+
+  /** The number of candidates (valid source patches) that have been searched, and how many of them were compared. */
+  std::size_t NumberOfCandidates = 0;
+  std::size_t NumberOfComparisons = 0;
+
+  LinearSearchBestPropertyPruned(PropertyMapType propertyMap, const ImageType* const image,
+                                 PatchDistanceFunctionType patchDistanceFunction = PatchDistanceFunctionType()) :
+  PropertyMap(propertyMap), PatchDistanceFunction(patchDistanceFunction),
+  Table(new SummedAreaTable<ImageType>(image))
+  {
+
+  }
+
+  /** The fraction of the candidates that did not have to be compared. */
+  float GetPrunedFraction() const
+  {
+    return this->NumberOfCandidates > 0 ?
+          1.0f - static_cast<float>(this->NumberOfComparisons) / this->NumberOfCandidates : 0.0f;
+  }
+
+  /**
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search.
+    * \param query The element to compare to.
+    * \return The best element in the range.
+    */
+  template <typename TIterator>
+  typename TIterator::value_type operator()(TIterator first, TIterator last,
+                                            typename TIterator::value_type query)
+  {
+    typedef typename TIterator::value_type VertexDescriptorType;
+
+    // If the input element range is empty, there is nothing to do.
+    if(first == last)
+    {
+      return *last;
+    }
+
+    PatchType queryPatch = get(this->PropertyMap, query);
+
+    typedef std::vector<typename ImageType::PixelType> PixelVector;
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+    PixelVector targetPixels(validOffsets->size());
+
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + *offsetIterator);
+    }
+
+    MeanDifferenceBound<ImageType> lowerBound(this->Table.get());
+    lowerBound.SetTarget(*validOffsets, targetPixels);
+
+    // Compute the bound of every valid source patch
+    std::vector<VertexDescriptorType> candidates;
+    std::vector<itk::Index<2> > candidateCorners;
+    for(TIterator current = first; current != last; ++current)
+    {
+      const PatchType& currentPatch = get(this->PropertyMap, *current);
+      if(currentPatch.GetStatus() == PatchType::SOURCE_NODE)
+      {
+        candidates.push_back(*current);
+        candidateCorners.push_back(currentPatch.GetCorner());
+      }
+    }
+
+    if(candidates.empty())
+    {
+      return *last;
+    }
+
+    std::vector<float> bounds(candidates.size());
+
+    #pragma omp parallel for
+    for(std::size_t candidateId = 0; candidateId < candidates.size(); ++candidateId)
+    {
+      bounds[candidateId] = lowerBound(candidateCorners[candidateId]);
+    }
+
+    auto difference = [&](const std::size_t candidateId, const float)
+    {
+      return this->PatchDistanceFunction(get(this->PropertyMap, candidates[candidateId]), queryPatch, targetPixels);
+    };
+
+    std::size_t numberOfComparisons = 0;
+    std::vector<PrunedSearch::NeighborType> best = PrunedSearch::FindNearest(bounds, 1, difference,
+                                                                             numberOfComparisons);
+    VertexDescriptorType result = candidates[best[0].second];
+
+    this->NumberOfCandidates += candidates.size();
+    this->NumberOfComparisons += numberOfComparisons;
+
+    this->DebugIteration++;
+
+    return result;
+  }
+};
+
+#endif
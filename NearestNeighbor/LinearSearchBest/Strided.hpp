@@ -0,0 +1,250 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef LinearSearchBestStrided_HPP
+#define LinearSearchBestStrided_HPP
+
+// Custom
+#include "Utilities/PixelBitmap.h"
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <Utilities/Debug/Debug.h>
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+   * This functor finds (approximately) the same source patch as LinearSearchBestProperty with far fewer patch
+   * comparisons, because adjacent source patches are highly correlated. It searches in two levels:
+   * 1) Only the source patches whose pixel lies on a grid with a spacing of 'stride' are compared to the query,
+   *    and the 'numberOfCoarseCandidates' best of them are kept.
+   * 2) Every source patch in the (2*stride+1) x (2*stride+1) neighborhood of each kept patch is compared to the query.
+   * Only the source patches in [first, last) are considered in both levels. With a stride of 1 the first level
+   * is an exhaustive search, so the result is the same as LinearSearchBestProperty. The grid is aligned with
+   * the image (not with the range), so the same patches are skipped for every query.
+   * \tparam PropertyMapType The type of the property map containing the patches to compare.
+   * \tparam PatchDistanceFunctionType The functor type to compute the distance between two patches.
+   */
+template <typename PropertyMapType, typename PatchDistanceFunctionType>
+struct LinearSearchBestStrided : public Debug
+{
+  PropertyMapType PropertyMap;
+  PatchDistanceFunctionType PatchDistanceFunction;
+
+  /** The spacing of the grid of the first level. */
+  unsigned int Stride;
+
+  /** The number of patches of the first level whose neighborhoods are searched in the second level. */
+  unsigned int NumberOfCoarseCandidates;
+
+  LinearSearchBestStrided(PropertyMapType propertyMap, const unsigned int stride = 2,
+                          const unsigned int numberOfCoarseCandidates = 8,
+                          PatchDistanceFunctionType patchDistanceFunction = PatchDistanceFunctionType()) :
+  PropertyMap(propertyMap), PatchDistanceFunction(patchDistanceFunction), Stride(stride),
+  NumberOfCoarseCandidates(numberOfCoarseCandidates)
+  {
+    CheckParameters(stride, numberOfCoarseCandidates);
+  }
+
+  void SetStride(const unsigned int stride)
+  {
+    CheckParameters(stride, this->NumberOfCoarseCandidates);
+    this->Stride = stride;
+  }
+
+  void SetNumberOfCoarseCandidates(const unsigned int numberOfCoarseCandidates)
+  {
+    CheckParameters(this->Stride, numberOfCoarseCandidates);
+    this->NumberOfCoarseCandidates = numberOfCoarseCandidates;
+  }
+
+  /**
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search.
+    * \param query The element to compare to.
+    * \return The best element that was found in the range.
+    */
+  template <typename TIterator>
+  typename TIterator::value_type operator()(TIterator first, TIterator last,
+                                            typename TIterator::value_type query)
+  {
+    typedef typename TIterator::value_type VertexDescriptorType;
+
+    // If the input element range is empty, there is nothing to do.
+    if(first == last)
+    {
+      return *last;
+    }
+
+    typedef typename PropertyMapType::value_type PatchType;
+
+    PatchType queryPatch = get(this->PropertyMap, query);
+
+    typedef std::vector<typename PatchType::ImageType::PixelType> PixelVector;
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+    PixelVector targetPixels(validOffsets->size());
+
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      itk::Offset<2> currentOffset = *offsetIterator;
+
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + currentOffset);
+    }
+
+    // Find the source patches in the range (for the second level), and the ones on the grid (for the first level)
+    std::vector<itk::Index<2> > sourceIndices;
+    std::vector<VertexDescriptorType> coarseVertices;
+    itk::Index<2> minimumCorner = {{std::numeric_limits<itk::IndexValueType>::max(),
+                                    std::numeric_limits<itk::IndexValueType>::max()}};
+    itk::Index<2> maximumCorner = {{std::numeric_limits<itk::IndexValueType>::min(),
+                                    std::numeric_limits<itk::IndexValueType>::min()}};
+    for(TIterator current = first; current != last; ++current)
+    {
+      if(get(this->PropertyMap, *current).GetStatus() != PatchType::SOURCE_NODE)
+      {
+        continue;
+      }
+
+      itk::Index<2> index = Helpers::ConvertFrom<itk::Index<2>, VertexDescriptorType>(*current);
+      sourceIndices.push_back(index);
+      for(unsigned int dimension = 0; dimension < 2; ++dimension)
+      {
+        minimumCorner[dimension] = std::min(minimumCorner[dimension], index[dimension]);
+        maximumCorner[dimension] = std::max(maximumCorner[dimension], index[dimension]);
+      }
+
+      if(index[0] % this->Stride == 0 && index[1] % this->Stride == 0)
+      {
+        coarseVertices.push_back(*current);
+      }
+    }
+
+    if(sourceIndices.empty())
+    {
+      return *last;
+    }
+
+    // A range with no source patches on the grid (e.g. a small local search region) is searched exhaustively
+    if(coarseVertices.empty())
+    {
+      for(const itk::Index<2>& index : sourceIndices)
+      {
+        coarseVertices.push_back(Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(index));
+      }
+    }
+
+    itk::Size<2> sourceSize = {{static_cast<itk::SizeValueType>(maximumCorner[0] - minimumCorner[0] + 1),
+                                static_cast<itk::SizeValueType>(maximumCorner[1] - minimumCorner[1] + 1)}};
+    itk::ImageRegion<2> sourceRegion(minimumCorner, sourceSize);
+
+    PixelBitmap sourceBitmap(sourceRegion);
+    for(const itk::Index<2>& index : sourceIndices)
+    {
+      sourceBitmap.Insert(index);
+    }
+
+    // Level 1: compare the patches on the grid
+    typedef std::pair<float, VertexDescriptorType> ScoredVertexType;
+    std::vector<ScoredVertexType> coarseScores(coarseVertices.size());
+
+    #pragma omp parallel for
+    for(std::size_t coarseId = 0; coarseId < coarseVertices.size(); ++coarseId)
+    {
+      PatchType currentPatch = get(this->PropertyMap, coarseVertices[coarseId]);
+      coarseScores[coarseId] = ScoredVertexType(this->PatchDistanceFunction(currentPatch, queryPatch, targetPixels),
+                                                coarseVertices[coarseId]);
+    }
+
+    auto compareScores = [](const ScoredVertexType& a, const ScoredVertexType& b)
+    {
+      return a.first < b.first;
+    };
+
+    std::size_t numberOfKept = std::min<std::size_t>(this->NumberOfCoarseCandidates, coarseScores.size());
+    std::partial_sort(coarseScores.begin(), coarseScores.begin() + numberOfKept, coarseScores.end(), compareScores);
+
+    // Level 2: compare the patches around the best patches of the first level. The patches that have already
+    // been compared (including the kept ones) are marked, so that overlapping neighborhoods are not compared twice.
+    PixelBitmap comparedBitmap(sourceRegion);
+    for(std::size_t coarseId = 0; coarseId < numberOfKept; ++coarseId)
+    {
+      comparedBitmap.Insert(Helpers::ConvertFrom<itk::Index<2>, VertexDescriptorType>(coarseScores[coarseId].second));
+    }
+
+    std::vector<VertexDescriptorType> fineVertices;
+    const int radius = static_cast<int>(this->Stride);
+    for(std::size_t coarseId = 0; coarseId < numberOfKept; ++coarseId)
+    {
+      itk::Index<2> center = Helpers::ConvertFrom<itk::Index<2>, VertexDescriptorType>(coarseScores[coarseId].second);
+      for(int yOffset = -radius; yOffset <= radius; ++yOffset)
+      {
+        for(int xOffset = -radius; xOffset <= radius; ++xOffset)
+        {
+          itk::Index<2> index = {{center[0] + xOffset, center[1] + yOffset}};
+          if(sourceBitmap.Contains(index) && !comparedBitmap.Contains(index))
+          {
+            comparedBitmap.Insert(index);
+            fineVertices.push_back(Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(index));
+          }
+        }
+      }
+    }
+
+    float d_best = coarseScores[0].first;
+    VertexDescriptorType result = coarseScores[0].second;
+
+    #pragma omp parallel for
+    for(std::size_t fineId = 0; fineId < fineVertices.size(); ++fineId)
+    {
+      PatchType currentPatch = get(this->PropertyMap, fineVertices[fineId]);
+      float d = this->PatchDistanceFunction(currentPatch, queryPatch, targetPixels);
+
+      #pragma omp critical
+      if(d < d_best)
+      {
+        d_best = d;
+        result = fineVertices[fineId];
+      }
+    }
+
+    this->DebugIteration++;
+
+    return result;
+  }
+
+private:
+
+  static void CheckParameters(const unsigned int stride, const unsigned int numberOfCoarseCandidates)
+  {
+    if(stride == 0 || numberOfCoarseCandidates == 0)
+    {
+      throw std::runtime_error("LinearSearchBestStrided: the stride and the number of coarse candidates must be positive!");
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,200 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef LinearSearchBestSuccessiveElimination_HPP
+#define LinearSearchBestSuccessiveElimination_HPP
+
+// Custom
+#include "DifferenceFunctions/Patch/MultilevelMeanDifferenceBound.hpp"
+#include "NearestNeighbor/PrunedSearch.hpp"
+#include "Utilities/SummedAreaTable.h"
+
+// Submodules
+#include <Utilities/Debug/Debug.h>
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/**
+   * This functor finds exactly the same best patch (up to ties) as LinearSearchBestProperty, using the multilevel
+   * successive elimination algorithm. Every candidate must pass the bounds of MultilevelMeanDifferenceBound, from
+   * the coarsest level (the mean of the whole patch) to the finest, before its full difference is computed, and
+   * is rejected at the first level whose bound exceeds the best difference so far. The candidates are visited in
+   * order of increasing coarsest bound until the coarsest bound alone rejects the rest (see
+   * PrunedSearch::FindNearest()).
+   *
+   * As for LinearSearchBestPropertyPruned, the bounds are only valid for ImagePatchDifference with
+   * SumSquaredPixelDifference, and the source patches must not change after the functor is created.
+   * \tparam PropertyMapType The type of the property map containing the patches to compare.
+   * \tparam PatchDistanceFunctionType The functor type to compute the distance between two patches.
+   */
+template <typename PropertyMapType, typename PatchDistanceFunctionType>
+struct LinearSearchBestSuccessiveElimination : public Debug
+{
+  typedef typename PropertyMapType::value_type PatchType;
+  typedef typename PatchType::ImageType ImageType;
+
+  PropertyMapType PropertyMap;
+  PatchDistanceFunctionType PatchDistanceFunction;
+
+  std::shared_ptr<SummedAreaTable<ImageType> > Table;
+
+  unsigned int NumberOfLevels;
+
+  /** The number of candidates (valid source patches) that have been searched, how many of them were rejected by
+    * the bound of each level, and how many were compared. */
+  std::size_t NumberOfCandidates = 0;
+  std::vector<std::size_t> NumberOfRejections;
+  std::size_t NumberOfComparisons = 0;
+
+  LinearSearchBestSuccessiveElimination(PropertyMapType propertyMap, const ImageType* const image,
+                                        const unsigned int numberOfLevels = 3,
+                                        PatchDistanceFunctionType patchDistanceFunction =
+                                            PatchDistanceFunctionType()) :
+  PropertyMap(propertyMap), PatchDistanceFunction(patchDistanceFunction),
+  Table(new SummedAreaTable<ImageType>(image)), NumberOfLevels(std::max(numberOfLevels, 1u)),
+  NumberOfRejections(NumberOfLevels, 0)
+  {
+
+  }
+
+  /** The fraction of the candidates that were rejected by the bound of 'levelId'. */
+  float GetRejectedFraction(const unsigned int levelId) const
+  {
+    return this->NumberOfCandidates > 0 ?
+          static_cast<float>(this->NumberOfRejections[levelId]) / this->NumberOfCandidates : 0.0f;
+  }
+
+  void WriteStatistics(std::ostream& stream) const
+  {
+    stream << "LinearSearchBestSuccessiveElimination: " << this->NumberOfCandidates << " candidates";
+    for(unsigned int levelId = 0; levelId < this->NumberOfLevels; ++levelId)
+    {
+      stream << ", level " << levelId << " rejected " << GetRejectedFraction(levelId);
+    }
+    stream << ", compared " << (this->NumberOfCandidates > 0 ?
+                                static_cast<float>(this->NumberOfComparisons) / this->NumberOfCandidates : 0.0f)
+           << std::endl;
+  }
+
+  /**
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search.
+    * \param query The element to compare to.
+    * \return The best element in the range.
+    */
+  template <typename TIterator>
+  typename TIterator::value_type operator()(TIterator first, TIterator last,
+                                            typename TIterator::value_type query)
+  {
+    typedef typename TIterator::value_type VertexDescriptorType;
+
+    // If the input element range is empty, there is nothing to do.
+    if(first == last)
+    {
+      return *last;
+    }
+
+    PatchType queryPatch = get(this->PropertyMap, query);
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+    std::vector<typename ImageType::PixelType> targetPixels(validOffsets->size());
+
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + *offsetIterator);
+    }
+
+    MultilevelMeanDifferenceBound<ImageType> lowerBound(this->Table.get(), this->NumberOfLevels);
+    lowerBound.SetTarget(*validOffsets, targetPixels);
+
+    std::vector<VertexDescriptorType> candidates;
+    std::vector<itk::Index<2> > candidateCorners;
+    for(TIterator current = first; current != last; ++current)
+    {
+      const PatchType& currentPatch = get(this->PropertyMap, *current);
+      if(currentPatch.GetStatus() == PatchType::SOURCE_NODE)
+      {
+        candidates.push_back(*current);
+        candidateCorners.push_back(currentPatch.GetCorner());
+      }
+    }
+
+    if(candidates.empty())
+    {
+      return *last;
+    }
+
+    // The coarsest bound orders the candidates
+    std::vector<float> coarseBounds(candidates.size());
+
+    #pragma omp parallel for
+    for(std::size_t candidateId = 0; candidateId < candidates.size(); ++candidateId)
+    {
+      coarseBounds[candidateId] = lowerBound(0, candidateCorners[candidateId]);
+    }
+
+    // Level 0 is the coarse bound that orders the candidates, so a compared candidate must still pass the finer
+    // levels before its full difference is computed
+    std::vector<std::size_t> numberOfRejections(this->NumberOfLevels, 0);
+    auto difference = [&](const std::size_t candidateId, const float kthDifference) -> float
+    {
+      for(unsigned int levelId = 1; levelId < this->NumberOfLevels; ++levelId)
+      {
+        if(lowerBound(levelId, candidateCorners[candidateId]) * PrunedSearch::Margin > kthDifference)
+        {
+          #pragma omp atomic
+          numberOfRejections[levelId]++;
+          return std::numeric_limits<float>::infinity();
+        }
+      }
+
+      return this->PatchDistanceFunction(get(this->PropertyMap, candidates[candidateId]), queryPatch, targetPixels);
+    };
+
+    std::size_t numberOfCandidatesPassingCoarseBound = 0;
+    std::vector<PrunedSearch::NeighborType> best = PrunedSearch::FindNearest(coarseBounds, 1, difference,
+                                                                             numberOfCandidatesPassingCoarseBound);
+    VertexDescriptorType result = candidates[best[0].second];
+
+    // The candidates that were never given to 'difference' are rejected by the coarsest bound
+    numberOfRejections[0] = candidates.size() - numberOfCandidatesPassingCoarseBound;
+    std::size_t numberOfComparisons = candidates.size();
+    for(unsigned int levelId = 0; levelId < this->NumberOfLevels; ++levelId)
+    {
+      this->NumberOfRejections[levelId] += numberOfRejections[levelId];
+      numberOfComparisons -= numberOfRejections[levelId];
+    }
+    this->NumberOfCandidates += candidates.size();
+    this->NumberOfComparisons += numberOfComparisons;
+
+    this->DebugIteration++;
+
+    return result;
+  }
+};
+
+#endif
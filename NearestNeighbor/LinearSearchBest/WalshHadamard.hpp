@@ -0,0 +1,251 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef LinearSearchBestWalshHadamard_HPP
+#define LinearSearchBestWalshHadamard_HPP
+
+// Custom
+#include "NearestNeighbor/PrunedSearch.hpp"
+#include "Utilities/WalshHadamardProjections.h"
+
+// Submodules
+#include <Utilities/Debug/Debug.h>
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+/**
+   * This functor finds exactly the same best patch (up to ties) as LinearSearchBestProperty, but rejects most
+   * candidates with a Walsh-Hadamard projection lower bound before their full difference is computed.
+   * The projections of every source position are computed once, when the functor is created (see
+   * WalshHadamardProjections), so it suits drivers whose patch radius is fixed for the whole run.
+   *
+   * A masked target is bounded over the largest power of two square window inside its valid pixels (the SSD over
+   * part of the valid pixels is at most the SSD over all of them). If there is no such window of at least 2x2
+   * pixels, every candidate is compared (the bound-free path).
+   *
+   * As for LinearSearchBestPropertyPruned, the bound is only valid for ImagePatchDifference with
+   * SumSquaredPixelDifference, and the source patches must not change after the functor is created.
+   * \tparam PropertyMapType The type of the property map containing the patches to compare.
+   * \tparam PatchDistanceFunctionType The functor type to compute the distance between two patches.
+   */
+template <typename PropertyMapType, typename PatchDistanceFunctionType>
+struct LinearSearchBestWalshHadamard : public Debug
+{
+  typedef typename PropertyMapType::value_type PatchType;
+  typedef typename PatchType::ImageType ImageType;
+
+  PropertyMapType PropertyMap;
+  PatchDistanceFunctionType PatchDistanceFunction;
+
+  std::shared_ptr<WalshHadamardProjections<ImageType> > Projections;
+
+  unsigned int PatchSideLength;
+
+  /** The number of candidates (valid source patches) that have been searched and how many of them were compared,
+    * and the number of searches that had to take the bound-free path. */
+  std::size_t NumberOfCandidates = 0;
+  std::size_t NumberOfComparisons = 0;
+  std::size_t NumberOfQueries = 0;
+  std::size_t NumberOfBoundFreeQueries = 0;
+
+  LinearSearchBestWalshHadamard(PropertyMapType propertyMap, const ImageType* const image,
+                                const unsigned int patchHalfWidth, const unsigned int maximumNumberOfKernels = 8,
+                                PatchDistanceFunctionType patchDistanceFunction = PatchDistanceFunctionType()) :
+  PropertyMap(propertyMap), PatchDistanceFunction(patchDistanceFunction),
+  Projections(new WalshHadamardProjections<ImageType>(image, 2 * patchHalfWidth + 1, maximumNumberOfKernels)),
+  PatchSideLength(2 * patchHalfWidth + 1)
+  {
+
+  }
+
+  /** The fraction of the candidates that did not have to be compared. */
+  float GetPrunedFraction() const
+  {
+    return this->NumberOfCandidates > 0 ?
+          1.0f - static_cast<float>(this->NumberOfComparisons) / this->NumberOfCandidates : 0.0f;
+  }
+
+  void WriteStatistics(std::ostream& stream) const
+  {
+    stream << "LinearSearchBestWalshHadamard: " << this->NumberOfQueries << " searches ("
+           << this->NumberOfBoundFreeQueries << " without a bound), pruned " << GetPrunedFraction()
+           << " of the candidates" << std::endl;
+  }
+
+  /**
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search.
+    * \param query The element to compare to.
+    * \return The best element in the range.
+    */
+  template <typename TIterator>
+  typename TIterator::value_type operator()(TIterator first, TIterator last,
+                                            typename TIterator::value_type query)
+  {
+    typedef typename TIterator::value_type VertexDescriptorType;
+
+    // If the input element range is empty, there is nothing to do.
+    if(first == last)
+    {
+      return *last;
+    }
+
+    PatchType queryPatch = get(this->PropertyMap, query);
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+    std::vector<typename ImageType::PixelType> targetPixels(validOffsets->size());
+
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + *offsetIterator);
+    }
+
+    std::vector<VertexDescriptorType> candidates;
+    std::vector<itk::Index<2> > candidateCorners;
+    for(TIterator current = first; current != last; ++current)
+    {
+      const PatchType& currentPatch = get(this->PropertyMap, *current);
+      if(currentPatch.GetStatus() == PatchType::SOURCE_NODE)
+      {
+        candidates.push_back(*current);
+        candidateCorners.push_back(currentPatch.GetCorner());
+      }
+    }
+
+    if(candidates.empty())
+    {
+      return *last;
+    }
+
+    this->NumberOfQueries++;
+
+    // Bound every candidate over the largest window that is entirely valid in the target
+    std::vector<float> bounds(candidates.size(), 0.0f);
+    unsigned int sizeId = 0;
+    itk::Offset<2> windowOffset = {{0, 0}};
+    if(FindWindow(*validOffsets, sizeId, windowOffset))
+    {
+      const unsigned int numberOfProjections =
+          this->Projections->GetNumberOfKernels(sizeId) * this->Projections->GetNumberOfComponents();
+      std::vector<float> targetProjections(numberOfProjections);
+      this->Projections->ProjectWindow(sizeId, queryPatch.GetImage(), queryPatch.GetCorner() + windowOffset,
+                                       targetProjections.data());
+
+      // The kernels have a squared norm of size^2, and the difference is averaged over the valid pixels
+      const unsigned int windowSize = this->Projections->GetWindowSize(sizeId);
+      const float normalization = 1.0f / (static_cast<float>(windowSize * windowSize) * validOffsets->size());
+
+      #pragma omp parallel for
+      for(std::size_t candidateId = 0; candidateId < candidates.size(); ++candidateId)
+      {
+        const float* sourceProjections =
+            this->Projections->GetProjections(sizeId, candidateCorners[candidateId] + windowOffset);
+        float bound = 0.0f;
+        for(unsigned int projectionId = 0; projectionId < numberOfProjections; ++projectionId)
+        {
+          const float projectionDifference = sourceProjections[projectionId] - targetProjections[projectionId];
+          bound += projectionDifference * projectionDifference;
+        }
+        bounds[candidateId] = bound * normalization;
+      }
+    }
+    else
+    {
+      // All of the bounds are 0, so every candidate is compared
+      this->NumberOfBoundFreeQueries++;
+    }
+
+    auto difference = [&](const std::size_t candidateId, const float)
+    {
+      return this->PatchDistanceFunction(get(this->PropertyMap, candidates[candidateId]), queryPatch, targetPixels);
+    };
+
+    std::size_t numberOfComparisons = 0;
+    std::vector<PrunedSearch::NeighborType> best = PrunedSearch::FindNearest(bounds, 1, difference,
+                                                                             numberOfComparisons);
+    VertexDescriptorType result = candidates[best[0].second];
+
+    this->NumberOfCandidates += candidates.size();
+    this->NumberOfComparisons += numberOfComparisons;
+
+    this->DebugIteration++;
+
+    return result;
+  }
+
+private:
+
+  /** Find the largest window (and its offset from the patch corner) whose pixels are all valid offsets.
+    * Returns false if there is no such window. */
+  bool FindWindow(const std::vector<itk::Offset<2> >& validOffsets, unsigned int& sizeId,
+                  itk::Offset<2>& windowOffset) const
+  {
+    // The number of valid offsets above and to the left of each offset, to count the valid offsets of a window
+    const unsigned int tableSideLength = this->PatchSideLength + 1;
+    std::vector<unsigned int> validCounts(tableSideLength * tableSideLength, 0);
+    for(const itk::Offset<2>& offset : validOffsets)
+    {
+      validCounts[(offset[1] + 1) * tableSideLength + offset[0] + 1] = 1;
+    }
+
+    for(unsigned int y = 1; y < tableSideLength; ++y)
+    {
+      for(unsigned int x = 1; x < tableSideLength; ++x)
+      {
+        validCounts[y * tableSideLength + x] += validCounts[(y - 1) * tableSideLength + x] +
+                                                validCounts[y * tableSideLength + x - 1] -
+                                                validCounts[(y - 1) * tableSideLength + x - 1];
+      }
+    }
+
+    for(int currentSizeId = static_cast<int>(this->Projections->GetNumberOfWindowSizes()) - 1; currentSizeId >= 0;
+        --currentSizeId)
+    {
+      const unsigned int windowSize = this->Projections->GetWindowSize(currentSizeId);
+      for(unsigned int y = 0; y + windowSize < tableSideLength; ++y)
+      {
+        for(unsigned int x = 0; x + windowSize < tableSideLength; ++x)
+        {
+          const unsigned int x1 = x + windowSize;
+          const unsigned int y1 = y + windowSize;
+          const unsigned int count = validCounts[y1 * tableSideLength + x1] - validCounts[y * tableSideLength + x1] -
+                                     validCounts[y1 * tableSideLength + x] + validCounts[y * tableSideLength + x];
+          if(count == windowSize * windowSize)
+          {
+            sizeId = currentSizeId;
+            windowOffset[0] = x;
+            windowOffset[1] = y;
+            return true;
+          }
+        }
+      }
+    }
+
+    return false;
+  }
+};
+
+#endif
@@ -125,17 +125,22 @@ public:
       targetPixels[offsetIterator - validOffsets->begin()] = queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + currentOffset);
     }
 
-    // The queue stores the items in descending score order.
+    // Each distance is stored at the position of its item, so the threads do not need a critical section (which
+    // would also serialize the threads of an enclosing parallel loop, such as that of CachedKNN::Precompute()).
+    std::vector<DistanceValueType> distances(last - first);
     #pragma omp parallel for
 //    for(ForwardIteratorType current = first; current != last; ++current) // OpenMP 3 doesn't allow != in the loop ending condition
     for(TIterator current = first; current < last; ++current)
     {
       typename PropertyMapType::value_type currentPatch = get(*(this->PropertyMap), *current);
       // Argument order is (source, target) ("query node" is the same as "target node")
-      DistanceValueType d = this->DistanceFunction(currentPatch, queryPatch, targetPixels);
+      distances[current - first] = this->DistanceFunction(currentPatch, queryPatch, targetPixels);
+    }
 
-      #pragma omp critical // There are weird crashes without this guard (concurrent access?)
-      outputQueue.push(PairType(d, current));
+    // The queue stores the items in descending score order.
+    for(TIterator current = first; current < last; ++current)
+    {
+      outputQueue.push(PairType(distances[current - first], current));
     }
 
 //    std::cout << "There are " << outputQueue.size() << " items in the queue." << std::endl;
@@ -22,7 +22,7 @@
 // STL
 #include <algorithm> // for lower_bound()
 #include <limits> // for infinity()
-#include <set>
+#include <vector>
 
 // Boost
 #include <boost/utility.hpp> // for enable_if()
@@ -30,6 +30,7 @@
 
 // Custom
 #include "Utilities/Utilities.hpp"
+#include "Utilities/SourcePixelMap.h"
 
 // Submodules
 #include <Mask/Mask.h>
@@ -60,8 +61,8 @@ class LinearSearchKNNPropertyLimitLocalReuse : public Debug
   /** The function to use to compare patches. */
   TPatchDistanceFunction PatchDistanceFunction;
 
-  /** An image indicating where each pixel came from. */
-  typedef itk::Image<itk::Index<2>, 2> SourcePixelMapImageType;
+  /** An image indicating where each pixel came from (see SourcePixelMap). */
+  typedef SourcePixelMap::ImageType SourcePixelMapImageType;
   SourcePixelMapImageType* SourcePixelMapImage;
 
   /** The current inpainting mask. */
@@ -102,7 +103,8 @@ public:
     return this->K;
   }
 
-  typedef std::set<itk::Index<2>, itk::Index<2>::LexicographicCompare> UsedIndexSetType;
+  /** A sorted list of the (linear) source pixels that have been used in the region around the query. */
+  typedef std::vector<SourcePixelMapImageType::PixelType> UsedIndexSetType;
 
   //   template <typename ForwardIteratorType, typename OutputContainerType>
   //   void operator()(ForwardIteratorType first, ForwardIteratorType last,
@@ -148,7 +150,7 @@ public:
 
     if(this->DebugImages)
     {
-      ITKHelpers::WriteIndexImage(this->SourcePixelMapImage, Helpers::GetSequentialFileName("SourcePixelMap", this->Iteration, "mha", 3));
+      ITKHelpers::WriteImage(this->SourcePixelMapImage, Helpers::GetSequentialFileName("SourcePixelMap", this->Iteration, "mha", 3));
     }
 
     // Use a priority queue to keep the items sorted
@@ -180,13 +182,21 @@ public:
                                                                                   largerTargetRegion);
 
     UsedIndexSetType usedIndices;
+    usedIndices.reserve(largerTargetRegion.GetNumberOfPixels());
     while(!sourcePixelMapIterator.IsAtEnd())
     {
-      usedIndices.insert(sourcePixelMapIterator.Get());
+      // Hole pixels that have not been filled yet do not point to a source pixel
+      if(sourcePixelMapIterator.Get() != SourcePixelMap::InvalidSourcePixel)
+      {
+        usedIndices.push_back(sourcePixelMapIterator.Get());
+      }
 
       ++sourcePixelMapIterator;
     }
 
+    std::sort(usedIndices.begin(), usedIndices.end());
+    usedIndices.erase(std::unique(usedIndices.begin(), usedIndices.end()), usedIndices.end());
+
     unsigned int numberOfHolePixels = this->MaskImage->CountHolePixels(queryRegion);
     unsigned int maxAllowedUsedPixels = this->MaxAllowedUsedPixelsRatio * numberOfHolePixels;
 
@@ -270,7 +280,7 @@ public:
 
   template <typename TPriorityQueue, typename TForwardIterator, typename TDescriptor>
   TPriorityQueue FindUsablePatches(TForwardIterator first, TForwardIterator last,
-                                   UsedIndexSetType usedIndices, unsigned int maxAllowedUsedPixels, TDescriptor& queryDescriptor)
+                                   const UsedIndexSetType& usedIndices, unsigned int maxAllowedUsedPixels, TDescriptor& queryDescriptor)
   {
     TPriorityQueue outputQueue;
 
@@ -313,14 +323,11 @@ public:
 
       while(!sourceRegionIterator.IsAtEnd())
       {
-        UsedIndexSetType::iterator usedIndexSetIterator;
         if(this->MaskImage->IsHole(queryRegionIterator.GetIndex()))
         {
           // We want to use the index value in the SourcePixelMapImage,
           // because the value might not equal the current index in the case where new patches are allowed.
-          usedIndexSetIterator = usedIndices.find(sourceRegionIterator.Get());
-
-          if(usedIndexSetIterator != usedIndices.end()) // found
+          if(std::binary_search(usedIndices.begin(), usedIndices.end(), sourceRegionIterator.Get())) // found
           {
             usedPixelCounter++;
           }
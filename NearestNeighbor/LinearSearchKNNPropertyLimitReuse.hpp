@@ -34,6 +34,9 @@
 // Submodules
 #include <Mask/Mask.h>
 
+// Utilities
+#include "Utilities/PixelBitmap.h"
+
 /**
   * This function template is similar to std::min_element but can be used when the comparison
   * involves computing a derived quantity (a.k.a. distance). This algorithm will search for the
@@ -59,9 +62,8 @@ class LinearSearchKNNPropertyLimitReuse
   /** The function to use to compare patches. */
   PatchDistanceFunctionType PatchDistanceFunction;
 
-  /** An image indicating which pixels have been used as source pixels.*/
-  typedef itk::Image<bool, 2> CopiedPixelsImageType;
-  CopiedPixelsImageType* CopiedPixelsImage;
+  /** The set of pixels that have been used as source pixels (see InpaintingVisitor::GetCopiedPixels()). */
+  const PixelBitmap* CopiedPixels;
 
   /** The current inpainting mask. */
   Mask* MaskImage;
@@ -69,9 +71,9 @@ class LinearSearchKNNPropertyLimitReuse
 public:
   LinearSearchKNNPropertyLimitReuse(PropertyMapType propertyMap, Mask* mask, const unsigned int k = 1000,
                                     PatchDistanceFunctionType patchDistanceFunction = PatchDistanceFunctionType(),
-                                    CopiedPixelsImageType* copiedPixelsImage = nullptr) :
+                                    const PixelBitmap* copiedPixels = nullptr) :
     PropertyMap(propertyMap), K(k), PatchDistanceFunction(patchDistanceFunction),
-    CopiedPixelsImage(copiedPixelsImage), MaskImage(mask)
+    CopiedPixels(copiedPixels), MaskImage(mask)
   {
   }
 
@@ -130,6 +132,10 @@ public:
         ITKHelpers::GetRegionInRadiusAroundPixel(queryIndex,
                                                  get(this->PropertyMap, queryNode).GetRegion().GetSize()[0]/2);
 
+    // This only depends on the query, so compute it once rather than for every candidate
+    unsigned int numberOfHolePixels = this->MaskImage->CountHolePixels(queryRegion);
+    unsigned int maxAllowedUsedPixels = numberOfHolePixels / 2; // Arbitrary - only allow half of the hole pixels to have been used
+
     // The queue stores the items in descending score order.
     #pragma omp parallel for
 //    for(ForwardIteratorType current = first; current != last; ++current) // OpenMP 3 doesn't allow != in the loop ending condition
@@ -142,24 +148,10 @@ public:
       itk::ImageRegion<2> potentialSourceRegion =
           ITKHelpers::GetRegionInRadiusAroundPixel(currentIndex,
                                                    get(this->PropertyMap, currentNode).GetRegion().GetSize()[0]/2);
-      potentialSourceRegion.Crop(this->CopiedPixelsImage->GetLargestPossibleRegion());
-      // Count the number of pixels that were already copied fromt this patch
-      itk::ImageRegionConstIteratorWithIndex<CopiedPixelsImageType> copiedPixelIterator(this->CopiedPixelsImage,
-                                                                                        potentialSourceRegion);
-      unsigned int usedPixelCounter = 0;
-      while(!copiedPixelIterator.IsAtEnd())
-      {
-        if(copiedPixelIterator.Get() == true)
-        {
-          usedPixelCounter++;
-        }
-
-        ++copiedPixelIterator;
-      }
+      // Count the number of pixels that were already copied from this patch
+      unsigned int usedPixelCounter = this->CopiedPixels->CountInRegion(potentialSourceRegion);
 
 //      unsigned int maxUsedPixels = potentialSourceRegion.GetNumberOfPixels() / 4;
-      unsigned int numberOfHolePixels = this->MaskImage->CountHolePixels(queryRegion);
-      unsigned int maxAllowedUsedPixels = numberOfHolePixels / 2; // Arbitrary - only allow half of the hole pixels to have been used
 
       if(usedPixelCounter < maxAllowedUsedPixels)
       {
@@ -30,6 +30,7 @@
 
 // Custom
 #include "Utilities/Utilities.hpp"
+#include "Utilities/PixelBitmap.h"
 
 /**
   * This function template is similar to std::min_element but can be used when the comparison
@@ -57,7 +58,7 @@ class LinearSearchKNNPropertyNoReuse
   PatchDistanceFunctionType PatchDistanceFunction;
 
   /** Store a pointer to the InpaintingVisitor's UsedNodesSet */
-  typedef std::set<itk::Index<2>, itk::Index<2>::LexicographicCompare> UsedNodesSetType;
+  typedef PixelBitmap UsedNodesSetType;
   UsedNodesSetType* UsedNodesSet;
 
 public:
@@ -124,9 +125,8 @@ public:
       NodeType currentNode = *currentIterator;
 
       itk::Index<2> currentIndex = Helpers::ConvertFrom<itk::Index<2>, NodeType>(currentNode);
-      UsedNodesSetType::iterator usedNodesSetIterator = this->UsedNodesSet->find(currentIndex);
 
-      if(usedNodesSetIterator == this->UsedNodesSet->end()) // not already used
+      if(!this->UsedNodesSet->Contains(currentIndex)) // not already used
       {
         DistanceValueType d = this->PatchDistanceFunction(get(this->PropertyMap, currentNode), queryPatch); // (source, target) (the query node is the target node)
 
@@ -0,0 +1,191 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef LinearSearchKNNPropertyPruned_HPP
+#define LinearSearchKNNPropertyPruned_HPP
+
+// Custom
+#include "DifferenceFunctions/Patch/MeanDifferenceBound.hpp"
+#include "NearestNeighbor/PrunedSearch.hpp"
+#include "Utilities/SummedAreaTable.h"
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+  * This class finds the same K nearest neighbors (up to ties) as LinearSearchKNNProperty, but skips the
+  * candidates that can not be among them. A lower bound of the difference of every candidate is computed
+  * (see MeanDifferenceBound), the K candidates with the smallest bounds are compared first, and then only the
+  * candidates whose bound is below the K'th best difference so far are compared, in order of increasing bound
+  * (see PrunedSearch::FindNearest()).
+  * The neighbors are written in order of increasing difference.
+  *
+  * The bound is only valid for ImagePatchDifference with SumSquaredPixelDifference, and the source patches must
+  * not change after the functor is created (see LinearSearchBestPropertyPruned).
+  * \tparam PropertyMapType The type of the property map containing the values to compare.
+  * \tparam DistanceFunctionType The functor type to compute the distance measure between two items in the PropertyMap.
+  */
+template <typename PropertyMapType,
+          typename DistanceFunctionType>
+class LinearSearchKNNPropertyPruned
+{
+  typedef float DistanceValueType;
+
+  typedef typename PropertyMapType::value_type PatchType;
+  typedef typename PatchType::ImageType ImageType;
+
+  std::shared_ptr<PropertyMapType> PropertyMap;
+  unsigned int K;
+  DistanceFunctionType DistanceFunction;
+
+  std::shared_ptr<SummedAreaTable<ImageType> > Table;
+
+  std::size_t NumberOfCandidates = 0;
+  std::size_t NumberOfComparisons = 0;
+
+public:
+  LinearSearchKNNPropertyPruned(std::shared_ptr<PropertyMapType> propertyMap, const ImageType* const image,
+                                const unsigned int k = 1000,
+                                DistanceFunctionType distanceFunction = DistanceFunctionType()) :
+    PropertyMap(propertyMap), K(k), DistanceFunction(distanceFunction), Table(new SummedAreaTable<ImageType>(image))
+  {
+  }
+
+  std::shared_ptr<PropertyMapType> GetPropertyMap() const
+  {
+    return this->PropertyMap;
+  }
+
+  /** Set the number of nearest neighbors to return. */
+  void SetK(const unsigned int k)
+  {
+    this->K = k;
+  }
+
+  /** Get the number of nearest neighbors to return. */
+  unsigned int GetK() const
+  {
+    return this->K;
+  }
+
+  /** The fraction of the candidates that did not have to be compared. */
+  float GetPrunedFraction() const
+  {
+    return this->NumberOfCandidates > 0 ?
+          1.0f - static_cast<float>(this->NumberOfComparisons) / this->NumberOfCandidates : 0.0f;
+  }
+
+  /**
+    * \tparam TIterator The forward-iterator type.
+    * \tparam TOutputIterator The iterator type of the output container.
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search (usually container.end() ).
+    * \param queryNode The item to compare the items in the container against.
+    * \param outputFirst An iterator to the beginning of the output container that will store the K nearest neighbors.
+    * \return The iterator one past the last neighbor that was written.
+    */
+  template <typename TIterator, typename TOutputIterator>
+  TOutputIterator operator()(TIterator first,
+                             TIterator last,
+                             typename TIterator::value_type queryNode,
+                             TOutputIterator outputFirst)
+  {
+    typedef typename TIterator::value_type VertexDescriptorType;
+
+    // Nothing to do if the input range is empty
+    if(first == last)
+    {
+      return outputFirst;
+    }
+
+    PatchType queryPatch = get(*(this->PropertyMap), queryNode);
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+
+    std::vector<typename ImageType::PixelType> targetPixels(validOffsets->size());
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + *offsetIterator);
+    }
+
+    MeanDifferenceBound<ImageType> lowerBound(this->Table.get());
+    lowerBound.SetTarget(*validOffsets, targetPixels);
+
+    // Compute the bound of every valid source patch
+    std::vector<VertexDescriptorType> candidates;
+    std::vector<itk::Index<2> > candidateCorners;
+    for(TIterator current = first; current != last; ++current)
+    {
+      const PatchType& currentPatch = get(*(this->PropertyMap), *current);
+      if(currentPatch.GetStatus() == PatchType::SOURCE_NODE)
+      {
+        candidates.push_back(*current);
+        candidateCorners.push_back(currentPatch.GetCorner());
+      }
+    }
+
+    if(candidates.size() < this->K)
+    {
+      std::stringstream ss;
+      ss << "Requested " << this->K << " items but only found " << candidates.size();
+      throw std::runtime_error(ss.str());
+    }
+
+    std::vector<DistanceValueType> bounds(candidates.size());
+
+    #pragma omp parallel for
+    for(std::size_t candidateId = 0; candidateId < candidates.size(); ++candidateId)
+    {
+      bounds[candidateId] = lowerBound(candidateCorners[candidateId]);
+    }
+
+    auto difference = [&](const std::size_t candidateId, const DistanceValueType)
+    {
+      return this->DistanceFunction(get(*(this->PropertyMap), candidates[candidateId]), queryPatch, targetPixels);
+    };
+
+    std::size_t numberOfComparisons = 0;
+    std::vector<PrunedSearch::NeighborType> neighbors = PrunedSearch::FindNearest(bounds, this->K, difference,
+                                                                                  numberOfComparisons);
+
+    this->NumberOfCandidates += candidates.size();
+    this->NumberOfComparisons += numberOfComparisons;
+
+    // Write the neighbors, best first
+    TOutputIterator currentOutputIterator = outputFirst;
+    for(const PrunedSearch::NeighborType& neighbor : neighbors)
+    {
+      *currentOutputIterator = candidates[neighbor.second];
+      ++currentOutputIterator;
+    }
+
+    return currentOutputIterator;
+  } // end operator()
+
+};
+
+#endif
@@ -0,0 +1,442 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef LocalitySensitiveHashKNN_HPP
+#define LocalitySensitiveHashKNN_HPP
+
+// Custom
+#include "SearchRange.hpp"
+#include "Utilities/LocalitySensitiveHash.h"
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+  * This class finds approximate K nearest neighbors of a query with the same interface as LinearSearchKNNProperty,
+  * so it can be the first step of TwoStepNearestNeighbor. The candidates are the source descriptors that share a
+  * probed bucket of a LocalitySensitiveHash of the feature vectors (e.g. of FeatureVectorPixelDescriptors) with
+  * the query, and they are ranked with the exact DistanceFunction (e.g. FeatureVectorDifference with a EUCLIDEAN
+  * or MANHATTAN hash, or FeatureVectorAngleDifference with a HYPERPLANE hash). If there are fewer than K
+  * candidates, the range is searched linearly instead.
+  *
+  * BuildIndex() hashes every source descriptor in a range. A search that is given a different range than the hash
+  * was built from (e.g. the first search) builds it again. Source descriptors of the range that are created later
+  * (e.g. by InitializeVertex, see IndexUpdateDescriptorVisitor) are added with AddSources(). MeasureRecall()
+  * compares the neighbors to the ones of a linear search. FindWithinDistance() instead finds every candidate within
+  * a distance of the query, like LinearSearchCriteriaProperty (see ThresholdBestWrapper).
+  * \tparam PropertyMapType The type of the property map containing the descriptors to compare.
+  * \tparam DistanceFunctionType The functor type to compute the exact distance between two descriptors.
+  */
+template <typename PropertyMapType,
+          typename DistanceFunctionType>
+class LocalitySensitiveHashKNN
+{
+  typedef float DistanceValueType;
+
+  typedef typename PropertyMapType::value_type DescriptorType;
+  typedef typename PropertyMapType::key_type VertexDescriptorType;
+
+  std::shared_ptr<PropertyMapType> PropertyMap;
+  unsigned int K;
+  DistanceFunctionType DistanceFunction;
+
+  LocalitySensitiveHash Hash;
+
+  /** If true, the query is also hashed with the opposite sign, e.g. for normals that may not be oriented
+    * consistently (see FeatureVectorAngleDifference). */
+  bool Unoriented = false;
+
+  /** The vertex of each hashed descriptor (by its id in the hash), and the set of them. */
+  std::vector<VertexDescriptorType> Sources;
+  std::set<VertexDescriptorType> IndexedSources;
+
+  SearchRange<VertexDescriptorType> IndexedRange;
+
+public:
+
+  /** The number of searches. */
+  unsigned int NumberOfQueries = 0;
+
+  /** The total number of candidates of the searches. */
+  std::size_t NumberOfCandidates = 0;
+
+  /** The number of searches with fewer than K candidates, which searched the range linearly. */
+  unsigned int NumberOfFallbacks = 0;
+
+  LocalitySensitiveHashKNN(std::shared_ptr<PropertyMapType> propertyMap, const unsigned int k = 1000,
+                           const LocalitySensitiveHash& hash = LocalitySensitiveHash(),
+                           DistanceFunctionType distanceFunction = DistanceFunctionType()) :
+    PropertyMap(propertyMap), K(k), DistanceFunction(distanceFunction), Hash(hash)
+  {
+  }
+
+  std::shared_ptr<PropertyMapType> GetPropertyMap() const
+  {
+    return this->PropertyMap;
+  }
+
+  /** Set the number of nearest neighbors to return. */
+  void SetK(const unsigned int k)
+  {
+    this->K = k;
+  }
+
+  /** Get the number of nearest neighbors to return. */
+  unsigned int GetK() const
+  {
+    return this->K;
+  }
+
+  void SetUnoriented(const bool unoriented)
+  {
+    this->Unoriented = unoriented;
+  }
+
+  /** Get the number of hashed source descriptors. */
+  unsigned int GetNumberOfSources() const
+  {
+    return static_cast<unsigned int>(this->Sources.size());
+  }
+
+  float GetAverageNumberOfCandidates() const
+  {
+    return this->NumberOfQueries > 0 ? static_cast<float>(this->NumberOfCandidates) / this->NumberOfQueries : 0.0f;
+  }
+
+  void WriteStatistics(std::ostream& stream) const
+  {
+    stream << "LocalitySensitiveHashKNN: " << this->NumberOfQueries << " searches of " << this->Sources.size()
+           << " sources, " << GetAverageNumberOfCandidates() << " candidates per search, "
+           << this->NumberOfFallbacks << " linear searches" << std::endl;
+  }
+
+  /** Hash the source descriptors in [first, last). A search of a different range does this again. */
+  template <typename TIterator>
+  void BuildIndex(TIterator first, TIterator last)
+  {
+    this->IndexedRange.Clear();
+    this->Sources.clear();
+    this->IndexedSources.clear();
+    for(TIterator current = first; current != last; ++current)
+    {
+      AddSource(*current);
+    }
+
+    this->IndexedRange.Set(first, last);
+  }
+
+  /** Hash the source descriptors in [first, last) that are not hashed yet. Other descriptors, and the ones that are
+    * not in the range the hash was built from, are ignored. */
+  template <typename TIterator>
+  void AddSources(TIterator first, TIterator last)
+  {
+    for(TIterator current = first; current != last; ++current)
+    {
+      if(this->IndexedRange.Contains(*current))
+      {
+        AddSource(*current);
+      }
+    }
+  }
+
+  /** Find the source descriptors that share a probed bucket with the query (not including the query). */
+  void FindCandidates(const VertexDescriptorType& queryNode, std::vector<VertexDescriptorType>& candidates) const
+  {
+    candidates.clear();
+
+    std::vector<float> featureVector = get(*(this->PropertyMap), queryNode).GetFeatureVector();
+    if(this->Sources.empty() || featureVector.size() != this->Hash.GetDimension())
+    {
+      return;
+    }
+
+    std::vector<unsigned int> ids;
+    this->Hash.FindCandidates(featureVector.data(), ids);
+    if(this->Unoriented)
+    {
+      for(std::size_t componentId = 0; componentId < featureVector.size(); ++componentId)
+      {
+        featureVector[componentId] = -featureVector[componentId];
+      }
+
+      std::vector<unsigned int> oppositeIds;
+      this->Hash.FindCandidates(featureVector.data(), oppositeIds);
+
+      std::vector<unsigned int> allIds;
+      std::set_union(ids.begin(), ids.end(), oppositeIds.begin(), oppositeIds.end(), std::back_inserter(allIds));
+      ids.swap(allIds);
+    }
+
+    for(std::size_t idId = 0; idId < ids.size(); ++idId)
+    {
+      if(!(this->Sources[ids[idId]] == queryNode))
+      {
+        candidates.push_back(this->Sources[ids[idId]]);
+      }
+    }
+  }
+
+  /**
+    * \tparam TIterator The forward-iterator type.
+    * \tparam TOutputIterator The iterator type of the output container.
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search (usually container.end() ).
+    * \param queryNode The item to compare the items in the container against.
+    * \param outputFirst An iterator to the beginning of the output container that will store the K nearest neighbors.
+    * \return The iterator one past the last neighbor that was written.
+    */
+  template <typename TIterator, typename TOutputIterator>
+  TOutputIterator operator()(TIterator first,
+                             TIterator last,
+                             typename TIterator::value_type queryNode,
+                             TOutputIterator outputFirst)
+  {
+    // Nothing to do if the input range is empty
+    if(first == last)
+    {
+      return outputFirst;
+    }
+
+    if(!this->IndexedRange.IsEqual(first, last))
+    {
+      BuildIndex(first, last);
+    }
+
+    std::vector<VertexDescriptorType> candidates;
+    FindCandidates(queryNode, candidates);
+
+    this->NumberOfQueries++;
+    this->NumberOfCandidates += candidates.size();
+
+    std::vector<std::pair<DistanceValueType, VertexDescriptorType> > neighbors;
+    RankCandidates(candidates.begin(), candidates.end(), queryNode, neighbors);
+    if(neighbors.size() < this->K)
+    {
+      this->NumberOfFallbacks++;
+      RankCandidates(first, last, queryNode, neighbors);
+    }
+
+    if(neighbors.size() < this->K)
+    {
+      std::stringstream ss;
+      ss << "Requested " << this->K << " items but only found " << neighbors.size();
+      throw std::runtime_error(ss.str());
+    }
+
+    TOutputIterator currentOutputIterator = outputFirst;
+    for(std::size_t neighborId = 0; neighborId < neighbors.size(); ++neighborId)
+    {
+      *currentOutputIterator = neighbors[neighborId].second;
+      ++currentOutputIterator;
+    }
+
+    return currentOutputIterator;
+  }
+
+  /** Find the candidates whose distance to the query is less than 'distanceThreshold' (e.g. a maximum angle with
+    * FeatureVectorAngleDifference), instead of the K nearest ones. A source descriptor within the distance that does
+    * not share a probed bucket with the query is missed. If no candidate is within the distance, the range is
+    * searched linearly, and if nothing in the range is within the distance either, the whole range is returned, as
+    * LinearSearchCriteriaProperty does. */
+  template <typename TIterator>
+  void FindWithinDistance(TIterator first, TIterator last, const VertexDescriptorType& queryNode,
+                          const float distanceThreshold, std::vector<VertexDescriptorType>& output)
+  {
+    output.clear();
+    if(first == last)
+    {
+      return;
+    }
+
+    if(!this->IndexedRange.IsEqual(first, last))
+    {
+      BuildIndex(first, last);
+    }
+
+    std::vector<VertexDescriptorType> candidates;
+    FindCandidates(queryNode, candidates);
+
+    this->NumberOfQueries++;
+    this->NumberOfCandidates += candidates.size();
+
+    SelectWithinDistance(candidates.begin(), candidates.end(), queryNode, distanceThreshold, output);
+    if(output.empty())
+    {
+      this->NumberOfFallbacks++;
+      SelectWithinDistance(first, last, queryNode, distanceThreshold, output);
+    }
+
+    if(output.empty())
+    {
+      output.assign(first, last);
+    }
+  }
+
+  /** Compute the fraction of the K nearest neighbors (from a linear search of the source descriptors in
+    * [first, last)) that the hash finds for the queries in [queryFirst, queryLast), on average. A neighbor as
+    * close as the K-th nearest one also counts, so ties do not matter. Queries without K neighbors are skipped. */
+  template <typename TIterator, typename TQueryIterator>
+  float MeasureRecall(TIterator first, TIterator last, TQueryIterator queryFirst, TQueryIterator queryLast)
+  {
+    if(!this->IndexedRange.IsEqual(first, last))
+    {
+      BuildIndex(first, last);
+    }
+
+    // The hash only contains source descriptors
+    std::vector<VertexDescriptorType> sources;
+    for(TIterator current = first; current != last; ++current)
+    {
+      if(get(*(this->PropertyMap), *current).GetStatus() == DescriptorType::SOURCE_NODE)
+      {
+        sources.push_back(*current);
+      }
+    }
+
+    float totalRecall = 0.0f;
+    unsigned int numberOfQueries = 0;
+    std::vector<VertexDescriptorType> candidates;
+    std::vector<std::pair<DistanceValueType, VertexDescriptorType> > exactNeighbors;
+    std::vector<std::pair<DistanceValueType, VertexDescriptorType> > hashNeighbors;
+    for(TQueryIterator query = queryFirst; query != queryLast; ++query)
+    {
+      RankCandidates(sources.begin(), sources.end(), *query, exactNeighbors);
+      if(this->K == 0 || exactNeighbors.size() < this->K)
+      {
+        continue;
+      }
+
+      FindCandidates(*query, candidates);
+      RankCandidates(candidates.begin(), candidates.end(), *query, hashNeighbors);
+
+      unsigned int numberOfFound = 0;
+      for(std::size_t neighborId = 0; neighborId < hashNeighbors.size(); ++neighborId)
+      {
+        if(hashNeighbors[neighborId].first <= exactNeighbors.back().first)
+        {
+          numberOfFound++;
+        }
+      }
+
+      totalRecall += static_cast<float>(numberOfFound) / this->K;
+      numberOfQueries++;
+    }
+
+    return numberOfQueries > 0 ? totalRecall / numberOfQueries : 0.0f;
+  }
+
+private:
+
+  /** Hash the descriptor of the vertex if it is a source descriptor that is not hashed yet. */
+  void AddSource(const VertexDescriptorType& vertex)
+  {
+    const DescriptorType& descriptor = get(*(this->PropertyMap), vertex);
+    if(descriptor.GetStatus() != DescriptorType::SOURCE_NODE || this->IndexedSources.count(vertex) > 0)
+    {
+      return;
+    }
+
+    const std::vector<float>& featureVector = descriptor.GetFeatureVector();
+    if(this->Sources.empty())
+    {
+      this->Hash.Initialize(static_cast<unsigned int>(featureVector.size()));
+    }
+    else if(featureVector.size() != this->Hash.GetDimension())
+    {
+      throw std::runtime_error("LocalitySensitiveHashKNN: the source descriptors do not all have the same length!");
+    }
+
+    this->Hash.Insert(featureVector.data());
+    this->Sources.push_back(vertex);
+    this->IndexedSources.insert(vertex);
+  }
+
+  /** Compute the distances from the query to the descriptors in [first, last), and keep the finite ones. */
+  template <typename TIterator>
+  void ComputeDistances(TIterator first, TIterator last, const VertexDescriptorType& queryNode,
+                        std::vector<std::pair<DistanceValueType, VertexDescriptorType> >& neighbors) const
+  {
+    const std::vector<VertexDescriptorType> items(first, last);
+    std::vector<DistanceValueType> distances(items.size());
+    const DescriptorType& queryDescriptor = get(*(this->PropertyMap), queryNode);
+
+    #pragma omp parallel for
+    for(int itemId = 0; itemId < static_cast<int>(items.size()); ++itemId)
+    {
+      // Argument order is (source, target) ("query node" is the same as "target node")
+      distances[itemId] = this->DistanceFunction(get(*(this->PropertyMap), items[itemId]), queryDescriptor);
+    }
+
+    neighbors.clear();
+    for(std::size_t itemId = 0; itemId < items.size(); ++itemId)
+    {
+      if(distances[itemId] < std::numeric_limits<DistanceValueType>::infinity())
+      {
+        neighbors.push_back(std::make_pair(distances[itemId], items[itemId]));
+      }
+    }
+  }
+
+  /** Keep the descriptors in [first, last) whose distance to the query is less than 'distanceThreshold'. */
+  template <typename TIterator>
+  void SelectWithinDistance(TIterator first, TIterator last, const VertexDescriptorType& queryNode,
+                            const float distanceThreshold, std::vector<VertexDescriptorType>& output) const
+  {
+    std::vector<std::pair<DistanceValueType, VertexDescriptorType> > neighbors;
+    ComputeDistances(first, last, queryNode, neighbors);
+
+    output.clear();
+    for(std::size_t neighborId = 0; neighborId < neighbors.size(); ++neighborId)
+    {
+      if(neighbors[neighborId].first < distanceThreshold)
+      {
+        output.push_back(neighbors[neighborId].second);
+      }
+    }
+  }
+
+  /** Compute the distances from the query to the descriptors in [first, last), and keep the (at most) K closest
+    * finite ones in order of increasing distance. */
+  template <typename TIterator>
+  void RankCandidates(TIterator first, TIterator last, const VertexDescriptorType& queryNode,
+                      std::vector<std::pair<DistanceValueType, VertexDescriptorType> >& neighbors) const
+  {
+    ComputeDistances(first, last, queryNode, neighbors);
+
+    const std::size_t numberOfNeighbors = std::min<std::size_t>(this->K, neighbors.size());
+    auto closer = [](const std::pair<DistanceValueType, VertexDescriptorType>& a,
+                     const std::pair<DistanceValueType, VertexDescriptorType>& b)
+    {
+      return a.first < b.first;
+    };
+    std::partial_sort(neighbors.begin(), neighbors.begin() + numberOfNeighbors, neighbors.end(), closer);
+    neighbors.resize(numberOfNeighbors);
+  }
+};
+
+#endif
@@ -1,55 +1,118 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
 #ifndef PrecomputedNeighbors_HPP
 #define PrecomputedNeighbors_HPP
 
 // STL
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 // Custom
-#include "Node.h"
-#include "Helpers/Helpers.h"
-
-#include <boost/property_map/property_map.hpp>
+#include "Utilities/FillLog.h"
 
+/**
+  * This "neighbor finder" returns the source that was used for each target in a previous
+  * inpainting. The log can be a binary fill log (which is memory mapped and looked up in its hash table)
+  * or a text log written by LoggerVisitor ("sx sy : tx ty" per line).
+ */
 struct PrecomputedNeighbors
 {
-  typedef std::map<Node, Node> NeighborMapType;
+  typedef std::pair<itk::Index<2>::IndexValueType, itk::Index<2>::IndexValueType> PixelPairType;
+
+  /** Only used for text logs. */
+  typedef std::map<PixelPairType, itk::Index<2> > NeighborMapType;
   NeighborMapType NeighborMap;
-  
-  PrecomputedNeighbors(std::ifstream& inputStream)
+
+  /** Only used for binary logs. */
+  std::shared_ptr<FillLogReader> Reader;
+
+  PrecomputedNeighbors(const std::string& fileName)
   {
-    Node targetNode;
-    Node sourceNode;
-    std::string junk; // TODO: Replace with Helpers::InlineIgnore
+    if(FillLog::IsFillLog(fileName))
+    {
+      this->Reader = std::make_shared<FillLogReader>(fileName);
+      return;
+    }
+
+    std::ifstream inputStream(fileName.c_str());
+    if(!inputStream)
+    {
+      std::stringstream ss;
+      ss << "PrecomputedNeighbors: could not open " << fileName << "!";
+      throw std::runtime_error(ss.str());
+    }
+
     std::string line;
     while(getline(inputStream, line))
-      {
+    {
       std::stringstream ss;
       ss << line;
-      //ss >> targetNode[0] >> targetNode[1] >> Helpers::InlineIgnore >> sourceNode[0] >> sourceNode[1];
-      ss >> targetNode[0] >> targetNode[1] >> junk >> sourceNode[0] >> sourceNode[1];
-      NeighborMap[targetNode] = sourceNode;
-      }
+
+      itk::Index<2> sourcePixel;
+      itk::Index<2> targetPixel;
+      ss >> sourcePixel[0] >> sourcePixel[1];
+      ss.ignore(std::numeric_limits<std::streamsize>::max(), ':'); // Ignore the colon
+      ss >> targetPixel[0] >> targetPixel[1];
+
+      this->NeighborMap[PixelPairType(targetPixel[0], targetPixel[1])] = sourcePixel;
+    }
   }
 
   template <typename TForwardIterator>
   typename TForwardIterator::value_type operator()(TForwardIterator first, TForwardIterator last,
                                                    typename TForwardIterator::value_type query)
   {
-    Node target = Helpers::ConvertFrom<Node, typename TForwardIterator::value_type>(query);
-    NeighborMapType::iterator iter = NeighborMap.find(target);
+    itk::Index<2> target = {{static_cast<itk::Index<2>::IndexValueType>(query[0]),
+                             static_cast<itk::Index<2>::IndexValueType>(query[1])}};
+    itk::Index<2> source;
 
-    if(iter == NeighborMap.end())
+    bool found = false;
+    if(this->Reader)
+    {
+      found = this->Reader->FindSource(target, source);
+    }
+    else
+    {
+      NeighborMapType::const_iterator iter = this->NeighborMap.find(PixelPairType(target[0], target[1]));
+      if(iter != this->NeighborMap.end())
       {
+        source = iter->second;
+        found = true;
+      }
+    }
+
+    if(!found)
+    {
       std::stringstream ss;
       ss << "Target node " << target[0] << " " << target[1] << " was not found in the neighbor map!";
       throw std::runtime_error(ss.str());
-      }
-    else
-      {
-      typename TForwardIterator::value_type source = Helpers::ConvertFrom<typename TForwardIterator::value_type, Node>(iter->second);
-      return source;
-      }
+    }
+
+    typename TForwardIterator::value_type sourceNode = query;
+    sourceNode[0] = source[0];
+    sourceNode[1] = source[1];
+    return sourceNode;
   }
 };
 
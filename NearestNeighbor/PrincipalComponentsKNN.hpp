@@ -0,0 +1,236 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef PrincipalComponentsKNN_HPP
+#define PrincipalComponentsKNN_HPP
+
+// Custom
+#include "SearchRange.hpp"
+#include "Utilities/KDTree.h"
+#include "Utilities/PatchPrincipalComponents.h"
+
+// STL
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+  * This class finds approximate K nearest neighbors of a query with the same interface as LinearSearchKNNProperty,
+  * so it can be the first step of TwoStepNearestNeighbor.
+  *
+  * BuildIndex() learns a PCA basis from a sample of (at most SampleSize) source patches
+  * (see PatchPrincipalComponents), every source patch in the range is projected onto it, and a KDTree of the
+  * projections is built. Each search projects the query by least squares over its valid pixels, takes the
+  * ReRankFactor * K nearest source patches in the projected space from the tree, and re-ranks them with the exact
+  * DistanceFunction (e.g. ImagePatchDifference). The best K are written in order of increasing difference.
+  *
+  * A search that is given a different range than the index was built from (e.g. the first search) builds the
+  * index again. The index is a snapshot of the source patches of the range, which do not change during an
+  * inpainting (unless new source patches are allowed, see InpaintingVisitor::SetAllowNewPatches()).
+  * \tparam PropertyMapType The type of the property map containing the patches to compare.
+  * \tparam DistanceFunctionType The functor type to compute the exact distance between two patches.
+  */
+template <typename PropertyMapType,
+          typename DistanceFunctionType>
+class PrincipalComponentsKNN
+{
+  typedef float DistanceValueType;
+
+  typedef typename PropertyMapType::value_type PatchType;
+  typedef typename PatchType::ImageType ImageType;
+  typedef typename PropertyMapType::key_type VertexDescriptorType;
+
+  std::shared_ptr<PropertyMapType> PropertyMap;
+  const ImageType* Image;
+  unsigned int PatchSideLength;
+  unsigned int K;
+  DistanceFunctionType DistanceFunction;
+
+  unsigned int NumberOfDimensions;
+  unsigned int ReRankFactor;
+  unsigned int SampleSize;
+
+  PatchPrincipalComponents<ImageType> PrincipalComponents;
+  KDTree Tree;
+  std::vector<VertexDescriptorType> Sources;
+  SearchRange<VertexDescriptorType> IndexedRange;
+
+public:
+  PrincipalComponentsKNN(std::shared_ptr<PropertyMapType> propertyMap, const ImageType* const image,
+                         const unsigned int patchHalfWidth, const unsigned int k = 1000,
+                         const unsigned int numberOfDimensions = 24, const unsigned int reRankFactor = 2,
+                         const unsigned int sampleSize = 2000,
+                         DistanceFunctionType distanceFunction = DistanceFunctionType()) :
+    PropertyMap(propertyMap), Image(image), PatchSideLength(2 * patchHalfWidth + 1), K(k),
+    DistanceFunction(distanceFunction), NumberOfDimensions(numberOfDimensions),
+    ReRankFactor(std::max(reRankFactor, 1u)), SampleSize(sampleSize)
+  {
+  }
+
+  std::shared_ptr<PropertyMapType> GetPropertyMap() const
+  {
+    return this->PropertyMap;
+  }
+
+  /** Set the number of nearest neighbors to return. */
+  void SetK(const unsigned int k)
+  {
+    this->K = k;
+  }
+
+  /** Get the number of nearest neighbors to return. */
+  unsigned int GetK() const
+  {
+    return this->K;
+  }
+
+  /** Learn the basis and build the index from the source patches in [first, last). A search of a different
+    * range does this again. */
+  template <typename TIterator>
+  void BuildIndex(TIterator first, TIterator last)
+  {
+    this->IndexedRange.Clear();
+    this->Sources.clear();
+    std::vector<itk::Index<2> > sourceCorners;
+    for(TIterator current = first; current != last; ++current)
+    {
+      const PatchType& currentPatch = get(*(this->PropertyMap), *current);
+      if(currentPatch.GetStatus() == PatchType::SOURCE_NODE)
+      {
+        this->Sources.push_back(*current);
+        sourceCorners.push_back(currentPatch.GetCorner());
+      }
+    }
+
+    if(this->Sources.size() < 2)
+    {
+      throw std::runtime_error("PrincipalComponentsKNN: at least 2 source patches are required!");
+    }
+
+    // Sample evenly spaced source patches, so the sample is the same every time
+    std::vector<itk::Index<2> > sampleCorners;
+    const std::size_t step = std::max<std::size_t>(1, sourceCorners.size() / std::max(this->SampleSize, 2u));
+    for(std::size_t sourceId = 0; sourceId < sourceCorners.size(); sourceId += step)
+    {
+      sampleCorners.push_back(sourceCorners[sourceId]);
+    }
+
+    this->PrincipalComponents.Compute(this->Image, sampleCorners, this->PatchSideLength, this->NumberOfDimensions);
+
+    const unsigned int dimension = this->PrincipalComponents.GetNumberOfDimensions();
+    std::vector<float> projections(sourceCorners.size() * dimension);
+
+    #pragma omp parallel for
+    for(std::size_t sourceId = 0; sourceId < sourceCorners.size(); ++sourceId)
+    {
+      this->PrincipalComponents.Project(this->Image, sourceCorners[sourceId], &projections[sourceId * dimension]);
+    }
+
+    this->Tree.Build(projections, dimension);
+    this->IndexedRange.Set(first, last);
+  }
+
+  /**
+    * \tparam TIterator The forward-iterator type.
+    * \tparam TOutputIterator The iterator type of the output container.
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search (usually container.end() ).
+    * \param queryNode The item to compare the items in the container against.
+    * \param outputFirst An iterator to the beginning of the output container that will store the K nearest neighbors.
+    * \return The iterator one past the last neighbor that was written.
+    */
+  template <typename TIterator, typename TOutputIterator>
+  TOutputIterator operator()(TIterator first,
+                             TIterator last,
+                             typename TIterator::value_type queryNode,
+                             TOutputIterator outputFirst)
+  {
+    // Nothing to do if the input range is empty
+    if(first == last)
+    {
+      return outputFirst;
+    }
+
+    if(!this->IndexedRange.IsEqual(first, last))
+    {
+      BuildIndex(first, last);
+    }
+
+    if(this->Sources.size() < this->K)
+    {
+      std::stringstream ss;
+      ss << "Requested " << this->K << " items but only found " << this->Sources.size();
+      throw std::runtime_error(ss.str());
+    }
+
+    PatchType queryPatch = get(*(this->PropertyMap), queryNode);
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+
+    std::vector<typename ImageType::PixelType> targetPixels(validOffsets->size());
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + *offsetIterator);
+    }
+
+    std::vector<float> queryProjection(this->PrincipalComponents.GetNumberOfDimensions());
+    this->PrincipalComponents.ProjectMasked(queryPatch.GetImage(), queryPatch.GetCorner(), *validOffsets,
+                                            queryProjection.data());
+
+    std::vector<KDTree::NeighborType> indexNeighbors;
+    this->Tree.FindNearest(queryProjection.data(), this->ReRankFactor * this->K, indexNeighbors);
+
+    // Re-rank the candidates with the exact difference
+    typedef std::pair<DistanceValueType, VertexDescriptorType> PairType;
+    std::vector<PairType> neighbors(indexNeighbors.size());
+
+    #pragma omp parallel for
+    for(std::size_t neighborId = 0; neighborId < indexNeighbors.size(); ++neighborId)
+    {
+      const VertexDescriptorType& source = this->Sources[indexNeighbors[neighborId].second];
+      neighbors[neighborId] = PairType(this->DistanceFunction(get(*(this->PropertyMap), source), queryPatch,
+                                                              targetPixels), source);
+    }
+
+    const std::size_t numberOfNeighbors = std::min<std::size_t>(this->K, neighbors.size());
+    std::partial_sort(neighbors.begin(), neighbors.begin() + numberOfNeighbors, neighbors.end(),
+                      [](const PairType& a, const PairType& b)
+    {
+      return a.first < b.first;
+    });
+
+    TOutputIterator currentOutputIterator = outputFirst;
+    for(std::size_t neighborId = 0; neighborId < numberOfNeighbors; ++neighborId)
+    {
+      *currentOutputIterator = neighbors[neighborId].second;
+      ++currentOutputIterator;
+    }
+
+    return currentOutputIterator;
+  } // end operator()
+
+};
+
+#endif
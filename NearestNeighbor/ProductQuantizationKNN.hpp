@@ -0,0 +1,269 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef ProductQuantizationKNN_HPP
+#define ProductQuantizationKNN_HPP
+
+// Custom
+#include "SearchRange.hpp"
+#include "Utilities/PatchProductQuantizer.h"
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+  * This class finds approximate K nearest neighbors of a query with the same interface as LinearSearchKNNProperty,
+  * so it can be the first step of TwoStepNearestNeighbor.
+  *
+  * BuildIndex() trains a PatchProductQuantizer on a sample of (at most SampleSize) source patches, and
+  * every source patch in the range is encoded to a few bytes, so the index is much smaller than the patches (see
+  * WriteStatistics()). Each search computes the table of the differences of the valid pixels of the query to every
+  * centroid, ranks all of the codes with it, and re-ranks the ReRankFactor * K best with the exact DistanceFunction
+  * (e.g. ImagePatchDifference). The best K are written in order of increasing difference.
+  *
+  * A search that is given a different range than the index was built from (e.g. the first search) builds the
+  * index again. The index is a snapshot of the source patches of the range, which do not change during an
+  * inpainting (unless new source patches are allowed, see InpaintingVisitor::SetAllowNewPatches()).
+  * \tparam PropertyMapType The type of the property map containing the patches to compare.
+  * \tparam DistanceFunctionType The functor type to compute the exact distance between two patches.
+  */
+template <typename PropertyMapType,
+          typename DistanceFunctionType>
+class ProductQuantizationKNN
+{
+  typedef float DistanceValueType;
+
+  typedef typename PropertyMapType::value_type PatchType;
+  typedef typename PatchType::ImageType ImageType;
+  typedef typename PropertyMapType::key_type VertexDescriptorType;
+
+  std::shared_ptr<PropertyMapType> PropertyMap;
+  const ImageType* Image;
+  unsigned int PatchSideLength;
+  unsigned int K;
+  DistanceFunctionType DistanceFunction;
+
+  unsigned int RowsPerSubvector;
+  unsigned int ReRankFactor;
+  unsigned int SampleSize;
+
+  PatchProductQuantizer<ImageType> Quantizer;
+
+  /** The code of each source patch, one after another. */
+  std::vector<unsigned char> Codes;
+  std::vector<VertexDescriptorType> Sources;
+  SearchRange<VertexDescriptorType> IndexedRange;
+
+public:
+  ProductQuantizationKNN(std::shared_ptr<PropertyMapType> propertyMap, const ImageType* const image,
+                         const unsigned int patchHalfWidth, const unsigned int k = 1000,
+                         const unsigned int rowsPerSubvector = 1, const unsigned int reRankFactor = 4,
+                         const unsigned int sampleSize = 4000,
+                         DistanceFunctionType distanceFunction = DistanceFunctionType()) :
+    PropertyMap(propertyMap), Image(image), PatchSideLength(2 * patchHalfWidth + 1), K(k),
+    DistanceFunction(distanceFunction), RowsPerSubvector(rowsPerSubvector),
+    ReRankFactor(std::max(reRankFactor, 1u)), SampleSize(sampleSize)
+  {
+  }
+
+  std::shared_ptr<PropertyMapType> GetPropertyMap() const
+  {
+    return this->PropertyMap;
+  }
+
+  /** Set the number of nearest neighbors to return. */
+  void SetK(const unsigned int k)
+  {
+    this->K = k;
+  }
+
+  /** Get the number of nearest neighbors to return. */
+  unsigned int GetK() const
+  {
+    return this->K;
+  }
+
+  /** Get the number of bytes of the index (the codes and the centroids). */
+  std::size_t GetIndexSize() const
+  {
+    return this->Codes.size() + this->Quantizer.GetCodebookSize();
+  }
+
+  /** Get the number of bytes of the source patches if they were stored as floats. */
+  std::size_t GetUncompressedSize() const
+  {
+    return this->Sources.size() * this->Quantizer.GetVectorLength() * sizeof(float);
+  }
+
+  void WriteStatistics(std::ostream& stream) const
+  {
+    stream << "ProductQuantizationKNN: " << this->Sources.size() << " source patches in "
+           << this->Quantizer.GetCodeLength() << " bytes each, index of " << GetIndexSize()
+           << " bytes instead of " << GetUncompressedSize() << " bytes of floats" << std::endl;
+  }
+
+  /** Train the quantizer and encode the source patches in [first, last). A search of a different range does this
+    * again. */
+  template <typename TIterator>
+  void BuildIndex(TIterator first, TIterator last)
+  {
+    this->IndexedRange.Clear();
+    this->Sources.clear();
+    std::vector<itk::Index<2> > sourceCorners;
+    for(TIterator current = first; current != last; ++current)
+    {
+      const PatchType& currentPatch = get(*(this->PropertyMap), *current);
+      if(currentPatch.GetStatus() == PatchType::SOURCE_NODE)
+      {
+        this->Sources.push_back(*current);
+        sourceCorners.push_back(currentPatch.GetCorner());
+      }
+    }
+
+    if(this->Sources.empty())
+    {
+      throw std::runtime_error("ProductQuantizationKNN: there are no source patches to index!");
+    }
+
+    // Sample evenly spaced source patches, so the sample is the same every time
+    std::vector<itk::Index<2> > sampleCorners;
+    const std::size_t step = std::max<std::size_t>(1, sourceCorners.size() / std::max(this->SampleSize, 1u));
+    for(std::size_t sourceId = 0; sourceId < sourceCorners.size(); sourceId += step)
+    {
+      sampleCorners.push_back(sourceCorners[sourceId]);
+    }
+
+    this->Quantizer.Train(this->Image, sampleCorners, this->PatchSideLength, this->RowsPerSubvector);
+
+    const unsigned int codeLength = this->Quantizer.GetCodeLength();
+    this->Codes.resize(sourceCorners.size() * codeLength);
+
+    #pragma omp parallel for
+    for(std::size_t sourceId = 0; sourceId < sourceCorners.size(); ++sourceId)
+    {
+      this->Quantizer.Encode(this->Image, sourceCorners[sourceId], &this->Codes[sourceId * codeLength]);
+    }
+
+    this->IndexedRange.Set(first, last);
+  }
+
+  /**
+    * \tparam TIterator The forward-iterator type.
+    * \tparam TOutputIterator The iterator type of the output container.
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search (usually container.end() ).
+    * \param queryNode The item to compare the items in the container against.
+    * \param outputFirst An iterator to the beginning of the output container that will store the K nearest neighbors.
+    * \return The iterator one past the last neighbor that was written.
+    */
+  template <typename TIterator, typename TOutputIterator>
+  TOutputIterator operator()(TIterator first,
+                             TIterator last,
+                             typename TIterator::value_type queryNode,
+                             TOutputIterator outputFirst)
+  {
+    // Nothing to do if the input range is empty
+    if(first == last)
+    {
+      return outputFirst;
+    }
+
+    if(!this->IndexedRange.IsEqual(first, last))
+    {
+      BuildIndex(first, last);
+    }
+
+    if(this->Sources.size() < this->K)
+    {
+      std::stringstream ss;
+      ss << "Requested " << this->K << " items but only found " << this->Sources.size();
+      throw std::runtime_error(ss.str());
+    }
+
+    PatchType queryPatch = get(*(this->PropertyMap), queryNode);
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = queryPatch.GetValidOffsetsAddress();
+
+    std::vector<typename ImageType::PixelType> targetPixels(validOffsets->size());
+    for(OffsetVectorType::const_iterator offsetIterator = validOffsets->begin();
+        offsetIterator < validOffsets->end(); ++offsetIterator)
+    {
+      targetPixels[offsetIterator - validOffsets->begin()] =
+          queryPatch.GetImage()->GetPixel(queryPatch.GetCorner() + *offsetIterator);
+    }
+
+    // Rank every code by its approximate difference to the valid pixels of the query
+    const unsigned int codeLength = this->Quantizer.GetCodeLength();
+    std::vector<float> table(codeLength * PatchProductQuantizer<ImageType>::NumberOfCentroids);
+    this->Quantizer.ComputeDistanceTable(queryPatch.GetImage(), queryPatch.GetCorner(), *validOffsets,
+                                         table.data());
+
+    typedef std::pair<DistanceValueType, unsigned int> CandidateType;
+    std::vector<CandidateType> candidates(this->Sources.size());
+
+    #pragma omp parallel for
+    for(std::size_t sourceId = 0; sourceId < this->Sources.size(); ++sourceId)
+    {
+      candidates[sourceId] = CandidateType(this->Quantizer.ComputeDistance(table.data(),
+                                                                           &this->Codes[sourceId * codeLength]),
+                                           static_cast<unsigned int>(sourceId));
+    }
+
+    const std::size_t numberOfCandidates = std::min<std::size_t>(this->ReRankFactor * this->K, candidates.size());
+    std::nth_element(candidates.begin(), candidates.begin() + (numberOfCandidates - 1), candidates.end());
+
+    // Re-rank the candidates with the exact difference
+    typedef std::pair<DistanceValueType, VertexDescriptorType> PairType;
+    std::vector<PairType> neighbors(numberOfCandidates);
+
+    #pragma omp parallel for
+    for(std::size_t neighborId = 0; neighborId < numberOfCandidates; ++neighborId)
+    {
+      const VertexDescriptorType& source = this->Sources[candidates[neighborId].second];
+      neighbors[neighborId] = PairType(this->DistanceFunction(get(*(this->PropertyMap), source), queryPatch,
+                                                              targetPixels), source);
+    }
+
+    const std::size_t numberOfNeighbors = std::min<std::size_t>(this->K, neighbors.size());
+    std::partial_sort(neighbors.begin(), neighbors.begin() + numberOfNeighbors, neighbors.end(),
+                      [](const PairType& a, const PairType& b)
+    {
+      return a.first < b.first;
+    });
+
+    TOutputIterator currentOutputIterator = outputFirst;
+    for(std::size_t neighborId = 0; neighborId < numberOfNeighbors; ++neighborId)
+    {
+      *currentOutputIterator = neighbors[neighborId].second;
+      ++currentOutputIterator;
+    }
+
+    return currentOutputIterator;
+  } // end operator()
+
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PrunedSearch_HPP
+#define PrunedSearch_HPP
+
+// STL
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/** The search loop that is shared by the searches that prune with a lower bound of the patch difference
+  * (LinearSearchBestPropertyPruned, LinearSearchBestWalshHadamard, LinearSearchBestSuccessiveElimination and
+  * LinearSearchKNNPropertyPruned). */
+namespace PrunedSearch
+{
+
+/** The differences are accumulated in float, so the bounds are scaled by this margin before they are compared
+  * to a difference. This keeps rounding from pruning a candidate that is better by less than the rounding. */
+const float Margin = 1.0f - 1e-4f;
+
+typedef std::pair<float, std::size_t> NeighborType;
+
+/**
+  * Find the 'k' candidates with the smallest differences, given a lower bound of the difference of every
+  * candidate. The k candidates with the smallest bounds are compared first, then only the candidates whose bound
+  * is below the k'th best difference so far are compared, in order of increasing bound and in blocks (in parallel
+  * within a block), until the next bound exceeds the k'th best difference.
+  *
+  * 'difference(candidateId, kthDifference)' must return the difference of the candidate. It may instead return
+  * any value that is not less than 'kthDifference' if it can tell that the candidate is not better (e.g. from a
+  * tighter bound). It is called from several threads at once, with an infinite 'kthDifference' for the first k
+  * candidates.
+  * \param numberOfComparisons Set to the number of times 'difference' was called.
+  * \return The (difference, candidate id) pairs of the best min(k, bounds.size()) candidates, best first.
+  */
+template <typename TDifference>
+std::vector<NeighborType> FindNearest(const std::vector<float>& bounds, const unsigned int k,
+                                      TDifference difference, std::size_t& numberOfComparisons)
+{
+  std::vector<NeighborType> neighbors;
+  numberOfComparisons = 0;
+
+  const std::size_t numberOfNeighbors = std::min<std::size_t>(k, bounds.size());
+  if(numberOfNeighbors == 0)
+  {
+    return neighbors;
+  }
+
+  auto compareBounds = [&bounds](const std::size_t a, const std::size_t b)
+  {
+    return bounds[a] < bounds[b];
+  };
+
+  std::vector<std::size_t> candidateIds(bounds.size());
+  for(std::size_t candidateId = 0; candidateId < bounds.size(); ++candidateId)
+  {
+    candidateIds[candidateId] = candidateId;
+  }
+
+  // The k candidates with the smallest bounds are compared first
+  if(numberOfNeighbors < candidateIds.size())
+  {
+    std::nth_element(candidateIds.begin(), candidateIds.begin() + numberOfNeighbors, candidateIds.end(),
+                     compareBounds);
+  }
+
+  neighbors.resize(numberOfNeighbors);
+
+  #pragma omp parallel for
+  for(std::size_t neighborId = 0; neighborId < numberOfNeighbors; ++neighborId)
+  {
+    const std::size_t candidateId = candidateIds[neighborId];
+    neighbors[neighborId] = NeighborType(difference(candidateId, std::numeric_limits<float>::infinity()),
+                                         candidateId);
+  }
+  numberOfComparisons = numberOfNeighbors;
+
+  // The largest of the k best differences is at the front
+  std::make_heap(neighbors.begin(), neighbors.end());
+
+  // Only the candidates that could be better than the k'th neighbor are kept, sorted by their bound
+  std::vector<std::size_t> remainingIds;
+  for(std::size_t rankId = numberOfNeighbors; rankId < candidateIds.size(); ++rankId)
+  {
+    if(bounds[candidateIds[rankId]] * Margin <= neighbors.front().first)
+    {
+      remainingIds.push_back(candidateIds[rankId]);
+    }
+  }
+  std::sort(remainingIds.begin(), remainingIds.end(), compareBounds);
+
+  // Compare them in blocks (in parallel within a block), stopping at the first block that can not be better
+  const std::size_t blockSize = 64;
+  std::vector<NeighborType> blockNeighbors;
+  for(std::size_t blockStart = 0; blockStart < remainingIds.size(); blockStart += blockSize)
+  {
+    const float kthDifference = neighbors.front().first;
+    if(bounds[remainingIds[blockStart]] * Margin > kthDifference)
+    {
+      break;
+    }
+
+    const std::size_t blockEnd = std::min(blockStart + blockSize, remainingIds.size());
+    blockNeighbors.assign(blockEnd - blockStart, NeighborType(std::numeric_limits<float>::infinity(), 0));
+
+    std::size_t blockComparisons = 0;
+
+    #pragma omp parallel for reduction(+:blockComparisons)
+    for(std::size_t remainingId = blockStart; remainingId < blockEnd; ++remainingId)
+    {
+      const std::size_t candidateId = remainingIds[remainingId];
+      if(bounds[candidateId] * Margin > kthDifference)
+      {
+        continue;
+      }
+
+      blockNeighbors[remainingId - blockStart] = NeighborType(difference(candidateId, kthDifference), candidateId);
+      blockComparisons++;
+    }
+    numberOfComparisons += blockComparisons;
+
+    for(const NeighborType& neighbor : blockNeighbors)
+    {
+      if(neighbor.first < neighbors.front().first)
+      {
+        std::pop_heap(neighbors.begin(), neighbors.end());
+        neighbors.back() = neighbor;
+        std::push_heap(neighbors.begin(), neighbors.end());
+      }
+    }
+  }
+
+  std::sort_heap(neighbors.begin(), neighbors.end());
+
+  return neighbors;
+}
+
+} // end namespace PrunedSearch
+
+#endif
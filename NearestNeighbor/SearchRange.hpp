@@ -0,0 +1,85 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef SearchRange_HPP
+#define SearchRange_HPP
+
+// STL
+#include <algorithm>
+#include <vector>
+
+/**
+  * The range of items that a search index (e.g. of PrincipalComponentsKNN) was built from. A search is given a
+  * range every time, so the index compares it to this one and is rebuilt if it is not the same range.
+  * \tparam TItem The type of the items (e.g. a vertex descriptor), which must have == and <.
+  */
+template <typename TItem>
+class SearchRange
+{
+  /** The items in the order of the range, and sorted. */
+  std::vector<TItem> Items;
+  std::vector<TItem> SortedItems;
+
+public:
+
+  /** Set the range to [first, last). */
+  template <typename TIterator>
+  void Set(TIterator first, TIterator last)
+  {
+    this->Items.assign(first, last);
+    this->SortedItems = this->Items;
+    std::sort(this->SortedItems.begin(), this->SortedItems.end());
+  }
+
+  /** Forget the range, so no range is equal to it. */
+  void Clear()
+  {
+    this->Items.clear();
+    this->SortedItems.clear();
+  }
+
+  /** Check if [first, last) is the same (non-empty) range, in the same order. This compares every item, which
+    * is much less work than comparing the descriptors of the items. */
+  template <typename TIterator>
+  bool IsEqual(TIterator first, TIterator last) const
+  {
+    if(this->Items.empty())
+    {
+      return false;
+    }
+
+    for(typename std::vector<TItem>::const_iterator item = this->Items.begin(); item != this->Items.end(); ++item)
+    {
+      if(first == last || !(*first == *item))
+      {
+        return false;
+      }
+      ++first;
+    }
+
+    return first == last;
+  }
+
+  /** Check if the item is in the range. */
+  bool Contains(const TItem& item) const
+  {
+    return std::binary_search(this->SortedItems.begin(), this->SortedItems.end(), item);
+  }
+};
+
+#endif
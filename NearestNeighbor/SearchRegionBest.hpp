@@ -0,0 +1,61 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef SearchRegionBest_HPP
+#define SearchRegionBest_HPP
+
+// STL
+#include <memory>
+#include <vector>
+
+/**
+ * This functor has the same signature as other single-best-neighbor search functors, but it ignores
+ * the range it is given and searches only the nodes returned by a search region functor (e.g. NeighborhoodSearch
+ * or OffsetWindowSearch) for the query node. If the search region is empty, the given range is searched.
+ * This lets InpaintingAlgorithm perform the same local search as InpaintingAlgorithmWithLocalSearch.
+ */
+template <typename TSearchRegion, typename TBestSearch>
+struct SearchRegionBest
+{
+  TSearchRegion SearchRegion;
+
+  std::shared_ptr<TBestSearch> BestSearch;
+
+  SearchRegionBest(TSearchRegion searchRegion, std::shared_ptr<TBestSearch> bestSearch) :
+    SearchRegion(searchRegion), BestSearch(bestSearch)
+  {
+
+  }
+
+  template <typename TIterator>
+  typename TIterator::value_type operator()(TIterator first, TIterator last,
+                                            typename TIterator::value_type query)
+  {
+    typedef typename TIterator::value_type VertexDescriptorType;
+    std::vector<VertexDescriptorType> searchRegionNodes = this->SearchRegion(query);
+
+    if(searchRegionNodes.empty())
+    {
+      return (*this->BestSearch)(first, last, query);
+    }
+
+    return (*this->BestSearch)(searchRegionNodes.begin(), searchRegionNodes.end(), query);
+  }
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef BoundaryQueries_HPP
+#define BoundaryQueries_HPP
+
+// Custom
+#include "NearestNeighbor/LinearSearchBest/Property.hpp"
+#include "PixelDescriptors/ImagePatchPixelDescriptor.h"
+#include "Visitors/DescriptorVisitors/ImagePatchDescriptorVisitor.hpp"
+#include "Utilities/IndirectPriorityQueue.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
+
+// ITK
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+// Boost
+#include <boost/graph/grid_graph.hpp>
+#include <boost/property_map/property_map.hpp>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** The setup that the search tests share: an image and its mask, a grid graph of the image, and an
+  * ImagePatchPixelDescriptor for every pixel, created with an ImagePatchDescriptorVisitor (whose DiscoverVertex()
+  * must still be called for each query). */
+template <typename TImage>
+struct ImagePatchDescriptorFixture
+{
+  typedef ImagePatchPixelDescriptor<TImage> ImagePatchPixelDescriptorType;
+
+  typedef boost::grid_graph<2> VertexListGraphType;
+  typedef typename boost::graph_traits<VertexListGraphType>::vertex_descriptor VertexDescriptorType;
+  typedef typename boost::graph_traits<VertexListGraphType>::vertex_iterator VertexIteratorType;
+
+  typedef IndirectPriorityQueue<VertexListGraphType> BoundaryNodeQueueType;
+
+  typedef boost::vector_property_map<ImagePatchPixelDescriptorType,
+      typename BoundaryNodeQueueType::IndexMapType> ImagePatchDescriptorMapType;
+
+  typedef ImagePatchDescriptorVisitor<VertexListGraphType, TImage, ImagePatchDescriptorMapType>
+      ImagePatchDescriptorVisitorType;
+
+  typename TImage::Pointer Image;
+  Mask::Pointer MaskImage;
+
+  VertexListGraphType Graph;
+  BoundaryNodeQueueType BoundaryNodeQueue;
+
+  std::shared_ptr<ImagePatchDescriptorMapType> DescriptorMap;
+  ImagePatchDescriptorVisitorType DescriptorVisitor;
+
+  /** All of the vertices of 'Graph'. */
+  VertexIteratorType VertexBegin;
+  VertexIteratorType VertexEnd;
+
+  /** Read the image and the mask from files. */
+  ImagePatchDescriptorFixture(const std::string& imageFileName, const std::string& maskFileName,
+                              const unsigned int patchHalfWidth) :
+    ImagePatchDescriptorFixture(ReadImage(imageFileName), ReadMask(maskFileName), patchHalfWidth)
+  {
+  }
+
+  ImagePatchDescriptorFixture(typename TImage::Pointer image, Mask::Pointer mask, const unsigned int patchHalfWidth) :
+    Image(image), MaskImage(mask), Graph(GetGraphSideLengths(image.GetPointer())), BoundaryNodeQueue(Graph),
+    DescriptorMap(new ImagePatchDescriptorMapType(num_vertices(Graph), *(BoundaryNodeQueue.GetIndexMap()))),
+    DescriptorVisitor(Image.GetPointer(), MaskImage.GetPointer(), DescriptorMap, patchHalfWidth)
+  {
+    tie(this->VertexBegin, this->VertexEnd) = vertices(this->Graph);
+    for(VertexIteratorType vertexIterator = this->VertexBegin; vertexIterator != this->VertexEnd; ++vertexIterator)
+    {
+      this->DescriptorVisitor.InitializeVertex(*vertexIterator);
+    }
+  }
+
+  ImagePatchDescriptorFixture(const ImagePatchDescriptorFixture&) = delete;
+  ImagePatchDescriptorFixture& operator=(const ImagePatchDescriptorFixture&) = delete;
+
+private:
+
+  static typename TImage::Pointer ReadImage(const std::string& imageFileName)
+  {
+    typedef itk::ImageFileReader<TImage> ImageReaderType;
+    typename ImageReaderType::Pointer imageReader = ImageReaderType::New();
+    imageReader->SetFileName(imageFileName);
+    imageReader->Update();
+
+    typename TImage::Pointer image = TImage::New();
+    ITKHelpers::DeepCopy(imageReader->GetOutput(), image.GetPointer());
+    return image;
+  }
+
+  static Mask::Pointer ReadMask(const std::string& maskFileName)
+  {
+    Mask::Pointer mask = Mask::New();
+    mask->Read(maskFileName);
+    return mask;
+  }
+
+  static boost::array<std::size_t, 2> GetGraphSideLengths(const TImage* const image)
+  {
+    boost::array<std::size_t, 2> graphSideLengths = { { image->GetLargestPossibleRegion().GetSize()[0],
+                                                        image->GetLargestPossibleRegion().GetSize()[1] } };
+    return graphSideLengths;
+  }
+};
+
+/** Find up to 'maximumNumberOfQueries' hole pixels, evenly spread along the boundary of the hole, whose
+  * patches are entirely inside the image. */
+inline std::vector<itk::Index<2> > GetBoundaryQueries(const Mask* const mask, const unsigned int patchHalfWidth,
+                                                      const unsigned int maximumNumberOfQueries)
+{
+  std::vector<itk::Index<2> > boundaryPixels;
+  itk::ImageRegionConstIteratorWithIndex<Mask> maskIterator(mask, mask->GetLargestPossibleRegion());
+  while(!maskIterator.IsAtEnd())
+  {
+    itk::Index<2> index = maskIterator.GetIndex();
+    itk::ImageRegion<2> patchRegion = ITKHelpers::GetRegionInRadiusAroundPixel(index, patchHalfWidth);
+    if(mask->IsHole(index) && mask->GetLargestPossibleRegion().IsInside(patchRegion))
+    {
+      bool boundary = false;
+      for(int dimension = 0; dimension < 2; ++dimension)
+      {
+        for(int step = -1; step <= 1; step += 2)
+        {
+          itk::Index<2> neighbor = index;
+          neighbor[dimension] += step;
+          boundary = boundary || mask->IsValid(neighbor);
+        }
+      }
+
+      if(boundary)
+      {
+        boundaryPixels.push_back(index);
+      }
+    }
+    ++maskIterator;
+  }
+
+  std::vector<itk::Index<2> > queries;
+  const std::size_t step = std::max<std::size_t>(1, boundaryPixels.size() / maximumNumberOfQueries);
+  for(std::size_t pixelId = 0; pixelId < boundaryPixels.size() && queries.size() < maximumNumberOfQueries;
+      pixelId += step)
+  {
+    queries.push_back(boundaryPixels[pixelId]);
+  }
+  return queries;
+}
+
+/** The boundary queries of a fixture (see GetBoundaryQueries()), whose descriptors are discovered, and the
+  * difference of the best patch of each of them that the exhaustive search (LinearSearchBestProperty) finds.
+  * The approximate searches are compared to these. */
+template <typename TFixture, typename TPatchDifference>
+struct ExhaustiveQueries
+{
+  typedef typename TFixture::VertexDescriptorType VertexDescriptorType;
+
+  std::vector<VertexDescriptorType> Vertices;
+  std::vector<float> Distances;
+
+  /** The time of all of the exhaustive searches. */
+  double Seconds;
+
+  ExhaustiveQueries(TFixture& fixture, const unsigned int patchHalfWidth, const unsigned int maximumNumberOfQueries,
+                    TPatchDifference patchDifference = TPatchDifference())
+  {
+    LinearSearchBestProperty<typename TFixture::ImagePatchDescriptorMapType, TPatchDifference>
+        exhaustiveSearch(*fixture.DescriptorMap, patchDifference);
+
+    std::vector<itk::Index<2> > queries = GetBoundaryQueries(fixture.MaskImage, patchHalfWidth,
+                                                             maximumNumberOfQueries);
+    auto start = std::chrono::steady_clock::now();
+    for(const itk::Index<2>& query : queries)
+    {
+      VertexDescriptorType queryVertex = Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(query);
+      fixture.DescriptorVisitor.DiscoverVertex(queryVertex);
+      this->Vertices.push_back(queryVertex);
+
+      VertexDescriptorType best = exhaustiveSearch(fixture.VertexBegin, fixture.VertexEnd, queryVertex);
+      this->Distances.push_back(patchDifference(get(*fixture.DescriptorMap, best),
+                                                get(*fixture.DescriptorMap, queryVertex)));
+    }
+    this->Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+};
+
+/** Count how many of the results of a search are as good as the exhaustive results (the recall@1, where ties
+  * count as hits), and the mean ratio of their differences to the exhaustive ones. */
+class RecallCounter
+{
+  unsigned int NumberOfQueries = 0;
+  unsigned int NumberOfHits = 0;
+  double DistanceRatioSum = 0.0;
+
+public:
+  void Add(const float distance, const float exhaustiveDistance)
+  {
+    this->NumberOfQueries++;
+    if(distance == exhaustiveDistance)
+    {
+      this->NumberOfHits++;
+    }
+    this->DistanceRatioSum += exhaustiveDistance > 0.0f ? distance / exhaustiveDistance : 1.0;
+  }
+
+  float GetRecall() const
+  {
+    return this->NumberOfQueries > 0 ? static_cast<float>(this->NumberOfHits) / this->NumberOfQueries : 0.0f;
+  }
+
+  double GetMeanDistanceRatio() const
+  {
+    return this->NumberOfQueries > 0 ? this->DistanceRatioSum / this->NumberOfQueries : 1.0;
+  }
+};
+
+/** Search the first half of the vertices of a fixture (and the query) with a KNN search (e.g. one whose index was
+  * built from all of the vertices), and return false if it returns a patch that is not in that range. */
+template <typename TFixture, typename TKNNSearch>
+bool CheckSearchOfHalfRange(const TFixture& fixture, TKNNSearch& knnSearch,
+                            const typename TFixture::VertexDescriptorType& query, const std::string& searchName)
+{
+  typedef typename TFixture::VertexDescriptorType VertexDescriptorType;
+
+  const std::vector<VertexDescriptorType> allVertices(fixture.VertexBegin, fixture.VertexEnd);
+  std::vector<VertexDescriptorType> halfVertices(allVertices.begin(), allVertices.begin() + allVertices.size() / 2);
+  halfVertices.push_back(query);
+
+  std::vector<VertexDescriptorType> neighbors(knnSearch.GetK());
+  knnSearch(halfVertices.begin(), halfVertices.end(), query, neighbors.begin());
+  for(const VertexDescriptorType& neighbor : neighbors)
+  {
+    if(std::find(halfVertices.begin(), halfVertices.end(), neighbor) == halfVertices.end())
+    {
+      std::cerr << searchName << " returned a patch outside of the searched range!" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Report an error and return false if the recall of a search is below the minimum that the test requires. */
+inline bool CheckRecall(const std::string& searchName, const float recall, const float minimumRecall)
+{
+  if(recall < minimumRecall)
+  {
+    std::cerr << searchName << " has a recall of " << recall << ", but at least " << minimumRecall
+              << " is required!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/** The main() of the benchmark tests: call 'benchmarkImage(imageFileName, maskFileName)' for each pair of
+  * arguments, and fail if any of the calls returns false.
+  * Run with: Tests/data/LetterA.png Tests/data/LetterA.mask [image.png image.mask ...] */
+template <typename TBenchmark>
+int RunBenchmarks(int argc, char *argv[], TBenchmark benchmarkImage)
+{
+  if(argc < 3 || argc % 2 == 0)
+  {
+    std::cerr << "Required arguments: image.png image.mask [image.png image.mask ...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for(int argumentId = 1; argumentId + 1 < argc; argumentId += 2)
+  {
+    if(!benchmarkImage(argv[argumentId], argv[argumentId + 1]))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+#endif
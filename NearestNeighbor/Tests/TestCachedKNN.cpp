@@ -0,0 +1,139 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "NearestNeighbor/CachedKNN.hpp"
+
+// Boost
+#include <boost/graph/grid_graph.hpp>
+
+// STL
+#include <cstdlib>
+#include <iostream>
+
+typedef boost::grid_graph<2> VertexListGraphType;
+typedef boost::graph_traits<VertexListGraphType>::vertex_descriptor VertexDescriptorType;
+
+/** The neighbors of (x, y) are (x + 20, y), (x + 21, y), ... */
+struct ShiftedKNN
+{
+  unsigned int K = 3;
+
+  unsigned int NumberOfSearches = 0;
+
+  unsigned int GetK() const
+  {
+    return this->K;
+  }
+
+  void SetK(const unsigned int k)
+  {
+    this->K = k;
+  }
+
+  template <typename TIterator, typename TOutputIterator>
+  TOutputIterator operator()(TIterator, TIterator, VertexDescriptorType queryNode, TOutputIterator outputFirst)
+  {
+    #pragma omp atomic
+    this->NumberOfSearches++;
+
+    for(unsigned int neighborId = 0; neighborId < this->K; ++neighborId)
+    {
+      VertexDescriptorType neighbor = {{queryNode[0] + 20 + neighborId, queryNode[1]}};
+      *outputFirst = neighbor;
+      ++outputFirst;
+    }
+    return outputFirst;
+  }
+};
+
+int main(int, char*[])
+{
+  std::vector<VertexDescriptorType> sources(10);
+
+  std::vector<VertexDescriptorType> targets;
+  for(std::size_t x = 0; x < 50; x += 5)
+  {
+    VertexDescriptorType target = {{x, 10}};
+    targets.push_back(target);
+  }
+
+  // A target that is given twice is only searched for once
+  std::vector<VertexDescriptorType> repeatedTargets(targets);
+  repeatedTargets.push_back(targets[2]);
+
+  std::shared_ptr<ShiftedKNN> knnSearch(new ShiftedKNN);
+  CachedKNN<VertexDescriptorType, ShiftedKNN> cachedKNNSearch(knnSearch, 2, true);
+  cachedKNNSearch.Precompute(sources.begin(), sources.end(), repeatedTargets.begin(), repeatedTargets.end());
+  if(knnSearch->NumberOfSearches != targets.size() || cachedKNNSearch.GetNumberOfCachedTargets() != targets.size())
+  {
+    std::cerr << "Precompute() should search for and cache every target once." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A cached target is not searched for again
+  std::vector<VertexDescriptorType> neighbors(3);
+  std::vector<VertexDescriptorType>::iterator neighborsEnd =
+      cachedKNNSearch(sources.begin(), sources.end(), targets[1], neighbors.begin());
+  if(neighborsEnd != neighbors.end() || neighbors[0][0] != 25 || knnSearch->NumberOfSearches != targets.size())
+  {
+    std::cerr << "The neighbors of a cached target were not returned from the cache." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Filling the patch around (0, 10) changes the target (0, 10), but not (5, 10), whose patch is 5 pixels away
+  itk::Index<2> filledPixel = {{0, 10}};
+  cachedKNNSearch.Invalidate(ITKHelpers::GetRegionInRadiusAroundPixel(filledPixel, 2));
+  if(cachedKNNSearch.GetNumberOfCachedTargets() != targets.size() - 1)
+  {
+    std::cerr << "Only the target whose patch overlaps the filled patch should be invalidated." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Filling the patch around (40, 10) changes the target (40, 10), and the neighbors of (15, 10) and (20, 10)
+  filledPixel[0] = 40;
+  cachedKNNSearch.Invalidate(ITKHelpers::GetRegionInRadiusAroundPixel(filledPixel, 2));
+  if(cachedKNNSearch.GetNumberOfCachedTargets() != targets.size() - 4)
+  {
+    std::cerr << "The targets with a neighbor that overlaps the filled patch should be invalidated." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  cachedKNNSearch(sources.begin(), sources.end(), targets[3], neighbors.begin());
+  if(knnSearch->NumberOfSearches != targets.size() + 1 || cachedKNNSearch.NumberOfHits != 1 ||
+     cachedKNNSearch.NumberOfMisses != 1)
+  {
+    std::cerr << "An invalidated target should be searched for again." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  cachedKNNSearch.WriteStatistics(std::cout);
+
+  // By default only the target whose own patch overlaps the filled patch is invalidated
+  CachedKNN<VertexDescriptorType, ShiftedKNN> targetOnlyKNNSearch(knnSearch, 2);
+  targetOnlyKNNSearch.Precompute(sources.begin(), sources.end(), targets.begin(), targets.end());
+  targetOnlyKNNSearch.Invalidate(ITKHelpers::GetRegionInRadiusAroundPixel(filledPixel, 2));
+  if(targetOnlyKNNSearch.GetNumberOfCachedTargets() != targets.size() - 1)
+  {
+    std::cerr << "Without invalidateSourceOverlaps only the overlapping target should be invalidated." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "BoundaryQueries.hpp"
+#include "NearestNeighbor/CoherenceSearchBest.hpp"
+#include "NearestNeighbor/LinearSearchBest/Property.hpp"
+#include "DifferenceFunctions/Patch/ImagePatchDifference.hpp"
+#include "DifferenceFunctions/Pixel/SumSquaredPixelDifference.hpp"
+
+// Submodules
+#include <Mask/Mask.h>
+
+// ITK
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <iostream>
+
+typedef itk::Image<itk::CovariantVector<float, 3>, 2> ImageType;
+
+typedef ImagePatchDescriptorFixture<ImageType> FixtureType;
+typedef FixtureType::ImagePatchPixelDescriptorType ImagePatchPixelDescriptorType;
+typedef FixtureType::VertexDescriptorType VertexDescriptorType;
+typedef FixtureType::ImagePatchDescriptorMapType ImagePatchDescriptorMapType;
+
+typedef ImagePatchDifference<ImagePatchPixelDescriptorType,
+    SumSquaredPixelDifference<ImageType::PixelType> > PatchDifferenceType;
+
+typedef CoherenceSearchBest<ImagePatchDescriptorMapType, PatchDifferenceType> CoherenceSearchType;
+
+const unsigned int PatchHalfWidth = 3;
+
+/** The image repeats every 12 pixels in both directions. */
+static const int Period = 12;
+
+int main(int, char*[])
+{
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{60, 60}};
+  itk::ImageRegion<2> fullRegion(corner, size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(fullRegion);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIterator(image, fullRegion);
+  while(!imageIterator.IsAtEnd())
+  {
+    ImageType::PixelType pixel;
+    pixel[0] = (imageIterator.GetIndex()[0] % Period) * 20;
+    pixel[1] = (imageIterator.GetIndex()[1] % Period) * 7;
+    pixel[2] = ((imageIterator.GetIndex()[0] + imageIterator.GetIndex()[1]) % Period) * 3;
+    imageIterator.Set(pixel);
+    ++imageIterator;
+  }
+
+  // The hole is x in [30, 36), y in [24, 36). The pixels x in [24, 30) of those rows were already filled by
+  // copying from 12 pixels to their left.
+  itk::Index<2> holeCorner = {{30, 24}};
+  itk::Size<2> holeSize = {{6, 12}};
+  itk::ImageRegion<2> holeRegion(holeCorner, holeSize);
+
+  itk::Index<2> filledCorner = {{24, 24}};
+  itk::Size<2> filledSize = {{6, 12}};
+  itk::ImageRegion<2> filledRegion(filledCorner, filledSize);
+
+  Mask::Pointer mask = Mask::New();
+  mask->SetRegions(fullRegion);
+  mask->Allocate();
+
+  SourcePixelMap::ImageType::Pointer sourcePixelMap = SourcePixelMap::ImageType::New();
+  sourcePixelMap->SetRegions(fullRegion);
+  sourcePixelMap->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<Mask> maskIterator(mask, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    itk::Index<2> index = maskIterator.GetIndex();
+    if(holeRegion.IsInside(index))
+    {
+      maskIterator.Set(mask->GetHoleValue());
+      sourcePixelMap->SetPixel(index, SourcePixelMap::InvalidSourcePixel);
+    }
+    else if(filledRegion.IsInside(index))
+    {
+      maskIterator.Set(mask->GetValidValue());
+      itk::Index<2> source = {{index[0] - Period, index[1]}};
+      sourcePixelMap->SetPixel(index, sourcePixelMap->ComputeOffset(source));
+    }
+    else
+    {
+      maskIterator.Set(mask->GetValidValue());
+      sourcePixelMap->SetPixel(index, sourcePixelMap->ComputeOffset(index));
+    }
+    ++maskIterator;
+  }
+
+  // The coherent candidate of the target is 12 pixels to its left. Spoil it slightly, so that it is not
+  // an exact match, but other copies of the pattern are.
+  itk::Index<2> target = {{30, 30}};
+  itk::Index<2> coherentSource = {{target[0] - Period, target[1]}};
+  ImageType::PixelType spoiledPixel = image->GetPixel(coherentSource);
+  spoiledPixel[0] += 10.0f;
+  image->SetPixel(coherentSource, spoiledPixel);
+
+  // Create the descriptors
+  FixtureType fixture(image, mask, PatchHalfWidth);
+
+  VertexDescriptorType targetVertex = Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(target);
+  fixture.DescriptorVisitor.DiscoverVertex(targetVertex);
+  const ImagePatchPixelDescriptorType& targetPatch = get(*fixture.DescriptorMap, targetVertex);
+
+  PatchDifferenceType patchDifference;
+
+  // The bounded difference is exact when the bound is not reached
+  {
+    VertexDescriptorType sourceVertex = Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(coherentSource);
+    const ImagePatchPixelDescriptorType& sourcePatch = get(*fixture.DescriptorMap, sourceVertex);
+
+    std::vector<ImageType::PixelType> targetPixels;
+    for(const itk::Offset<2>& offset : targetPatch.GetValidOffsets())
+    {
+      targetPixels.push_back(image->GetPixel(targetPatch.GetCorner() + offset));
+    }
+
+    float exactDifference = patchDifference(sourcePatch, targetPatch, targetPixels);
+    if(exactDifference <= 0.0f ||
+       patchDifference(sourcePatch, targetPatch, targetPixels, 2.0f * exactDifference) != exactDifference ||
+       !(patchDifference(sourcePatch, targetPatch, targetPixels, 0.0f) > 0.0f))
+    {
+      std::cerr << "The bounded patch difference is wrong." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The exhaustive search finds an exact copy of the pattern
+  typedef LinearSearchBestProperty<ImagePatchDescriptorMapType, PatchDifferenceType> ExhaustiveSearchType;
+  ExhaustiveSearchType exhaustiveSearch(*fixture.DescriptorMap);
+  VertexDescriptorType exhaustiveBest = exhaustiveSearch(fixture.VertexBegin, fixture.VertexEnd, targetVertex);
+  float exhaustiveDistance = patchDifference(get(*fixture.DescriptorMap, exhaustiveBest), targetPatch);
+
+  // The coherent candidates include the source that continues the copy of the filled pixels
+  CoherenceSearchType coherenceSearch(*fixture.DescriptorMap, sourcePixelMap, PatchHalfWidth, 0.0f, 1);
+  std::vector<VertexDescriptorType> candidates = coherenceSearch.GetCandidates(targetVertex);
+  VertexDescriptorType coherentVertex = Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(coherentSource);
+  if(std::find(candidates.begin(), candidates.end(), coherentVertex) == candidates.end())
+  {
+    std::cerr << "The coherent source is not a candidate." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The spoiled coherent candidate is not good enough, so the range is searched (with its difference as the bound)
+  VertexDescriptorType result = coherenceSearch(fixture.VertexBegin, fixture.VertexEnd, targetVertex);
+  if(patchDifference(get(*fixture.DescriptorMap, result), targetPatch) != exhaustiveDistance ||
+     coherenceSearch.NumberOfAcceptedCandidates != 0 || coherenceSearch.NumberOfHits != 0)
+  {
+    std::cerr << "The bounded search should have found a patch as good as the exhaustive search." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // With a loose threshold the coherent candidate is accepted
+  CoherenceSearchType acceptingSearch(*fixture.DescriptorMap, sourcePixelMap, PatchHalfWidth, 1000.0f, 0);
+  result = acceptingSearch(fixture.VertexBegin, fixture.VertexEnd, targetVertex);
+  if(result != coherentVertex || acceptingSearch.NumberOfAcceptedCandidates != 1 || acceptingSearch.GetHitRate() != 1.0f)
+  {
+    std::cerr << "The coherent candidate should have been accepted." << std::endl;
+    return EXIT_FAILURE;
+  }
+  acceptingSearch.WriteStatistics(std::cout);
+
+  // Without any filled pixels there are no candidates, and the result is that of the exhaustive search
+  SourcePixelMap::ImageType::Pointer emptySourcePixelMap = SourcePixelMap::ImageType::New();
+  emptySourcePixelMap->SetRegions(fullRegion);
+  emptySourcePixelMap->Allocate();
+  emptySourcePixelMap->FillBuffer(SourcePixelMap::InvalidSourcePixel);
+
+  CoherenceSearchType emptySearch(*fixture.DescriptorMap, emptySourcePixelMap, PatchHalfWidth, 1000.0f, 1);
+  result = emptySearch(fixture.VertexBegin, fixture.VertexEnd, targetVertex);
+  if(patchDifference(get(*fixture.DescriptorMap, result), targetPatch) != exhaustiveDistance ||
+     emptySearch.NumberOfQueriesWithCandidates != 0)
+  {
+    std::cerr << "Without candidates the result should be that of the exhaustive search." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "BoundaryQueries.hpp"
+#include "NearestNeighbor/LinearSearchBest/Property.hpp"
+#include "NearestNeighbor/LinearSearchBest/Strided.hpp"
+#include "DifferenceFunctions/Patch/ImagePatchDifference.hpp"
+#include "DifferenceFunctions/Pixel/SumSquaredPixelDifference.hpp"
+
+// Submodules
+#include <Mask/Mask.h>
+
+// STL
+#include <chrono>
+#include <iostream>
+
+typedef itk::Image<itk::CovariantVector<int, 3>, 2> ImageType;
+
+/** The recall@1 that the strided search must reach with a stride of 2 and 16 coarse candidates. */
+static const float MinimumRecall = 0.5f;
+
+/** Compare LinearSearchBestStrided to LinearSearchBestProperty on the boundary of the hole of 'imageFileName'.
+  * Returns false if the strided search returns something that the exhaustive search could not have, or if its
+  * recall@1 is below MinimumRecall with a stride of 2 and 16 coarse candidates. */
+static bool BenchmarkImage(const std::string& imageFileName, const std::string& maskFileName)
+{
+  const unsigned int patchHalfWidth = 7;
+
+  typedef ImagePatchDescriptorFixture<ImageType> FixtureType;
+  FixtureType fixture(imageFileName, maskFileName, patchHalfWidth);
+
+  typedef FixtureType::ImagePatchPixelDescriptorType ImagePatchPixelDescriptorType;
+  typedef FixtureType::VertexDescriptorType VertexDescriptorType;
+  typedef FixtureType::ImagePatchDescriptorMapType ImagePatchDescriptorMapType;
+
+  typedef ImagePatchDifference<ImagePatchPixelDescriptorType,
+      SumSquaredPixelDifference<ImageType::PixelType> > PatchDifferenceType;
+  PatchDifferenceType patchDifference;
+
+  typedef LinearSearchBestStrided<ImagePatchDescriptorMapType, PatchDifferenceType> StridedSearchType;
+
+  // Run the exhaustive search once for every query, to compare every setting to
+  ExhaustiveQueries<FixtureType, PatchDifferenceType> queries(fixture, patchHalfWidth, 40);
+
+  std::cout << imageFileName << ": " << queries.Vertices.size() << " queries, exhaustive search "
+            << queries.Seconds << "s" << std::endl;
+  std::cout << "stride\tcandidates\trecall@1\tmeanDistanceRatio\tspeedup" << std::endl;
+
+  const unsigned int numbersOfCoarseCandidates[] = {1, 4, 16};
+  for(unsigned int stride = 1; stride <= 4; ++stride)
+  {
+    for(unsigned int numberOfCoarseCandidates : numbersOfCoarseCandidates)
+    {
+      StridedSearchType stridedSearch(*fixture.DescriptorMap, stride, numberOfCoarseCandidates);
+
+      RecallCounter recall;
+      auto start = std::chrono::steady_clock::now();
+      for(std::size_t queryId = 0; queryId < queries.Vertices.size(); ++queryId)
+      {
+        VertexDescriptorType result = stridedSearch(fixture.VertexBegin, fixture.VertexEnd,
+                                                    queries.Vertices[queryId]);
+        if(get(*fixture.DescriptorMap, result).GetStatus() != ImagePatchPixelDescriptorType::SOURCE_NODE)
+        {
+          std::cerr << "The strided search returned a patch that is not a source patch!" << std::endl;
+          return false;
+        }
+
+        float distance = patchDifference(get(*fixture.DescriptorMap, result),
+                                         get(*fixture.DescriptorMap, queries.Vertices[queryId]));
+        if(distance < queries.Distances[queryId])
+        {
+          std::cerr << "The strided search found a better patch than the exhaustive search!" << std::endl;
+          return false;
+        }
+
+        recall.Add(distance, queries.Distances[queryId]);
+      }
+      double stridedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      std::cout << stride << "\t" << numberOfCoarseCandidates << "\t" << recall.GetRecall() << "\t"
+                << recall.GetMeanDistanceRatio() << "\t" << queries.Seconds / stridedSeconds << std::endl;
+
+      // With a stride of 1 the strided search is exhaustive
+      if(stride == 1 && !CheckRecall("The strided search with a stride of 1", recall.GetRecall(), 1.0f))
+      {
+        return false;
+      }
+
+      if(stride == 2 && numberOfCoarseCandidates == 16 &&
+         !CheckRecall("The strided search with a stride of 2", recall.GetRecall(), MinimumRecall))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  return RunBenchmarks(argc, argv, BenchmarkImage);
+}
@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "BoundaryQueries.hpp"
+#include "NearestNeighbor/LinearSearchBest/PropertyPruned.hpp"
+#include "NearestNeighbor/LinearSearchBest/SuccessiveElimination.hpp"
+#include "NearestNeighbor/LinearSearchBest/WalshHadamard.hpp"
+#include "NearestNeighbor/LinearSearchKNNProperty.hpp"
+#include "NearestNeighbor/LinearSearchKNNPropertyPruned.hpp"
+#include "DifferenceFunctions/Patch/ImagePatchDifference.hpp"
+#include "DifferenceFunctions/Pixel/SumSquaredPixelDifference.hpp"
+
+// Submodules
+#include <Mask/Mask.h>
+
+// STL
+#include <chrono>
+#include <iostream>
+
+typedef itk::Image<itk::CovariantVector<int, 3>, 2> ImageType;
+
+/** Compare LinearSearchBestPropertyPruned, LinearSearchBestSuccessiveElimination, LinearSearchBestWalshHadamard
+  * and LinearSearchKNNPropertyPruned to the exhaustive searches on the boundary of the hole of 'imageFileName',
+  * and report the fraction of the candidates that were pruned.
+  * Returns false if a pruned search does not find neighbors as good as the exhaustive search. */
+static bool BenchmarkImage(const std::string& imageFileName, const std::string& maskFileName)
+{
+  const unsigned int patchHalfWidth = 7;
+  const unsigned int numberOfNeighbors = 10;
+
+  typedef ImagePatchDescriptorFixture<ImageType> FixtureType;
+  FixtureType fixture(imageFileName, maskFileName, patchHalfWidth);
+
+  typedef FixtureType::ImagePatchPixelDescriptorType ImagePatchPixelDescriptorType;
+  typedef FixtureType::VertexDescriptorType VertexDescriptorType;
+  typedef FixtureType::ImagePatchDescriptorMapType ImagePatchDescriptorMapType;
+
+  typedef ImagePatchDifference<ImagePatchPixelDescriptorType,
+      SumSquaredPixelDifference<ImageType::PixelType> > PatchDifferenceType;
+  PatchDifferenceType patchDifference;
+
+  LinearSearchBestPropertyPruned<ImagePatchDescriptorMapType, PatchDifferenceType>
+      prunedBestSearch(*fixture.DescriptorMap, fixture.Image.GetPointer());
+  LinearSearchBestSuccessiveElimination<ImagePatchDescriptorMapType, PatchDifferenceType>
+      successiveEliminationSearch(*fixture.DescriptorMap, fixture.Image.GetPointer());
+  LinearSearchBestWalshHadamard<ImagePatchDescriptorMapType, PatchDifferenceType>
+      walshHadamardSearch(*fixture.DescriptorMap, fixture.Image.GetPointer(), patchHalfWidth);
+
+  LinearSearchKNNProperty<ImagePatchDescriptorMapType, PatchDifferenceType>
+      exhaustiveKNNSearch(fixture.DescriptorMap, numberOfNeighbors);
+  LinearSearchKNNPropertyPruned<ImagePatchDescriptorMapType, PatchDifferenceType>
+      prunedKNNSearch(fixture.DescriptorMap, fixture.Image.GetPointer(), numberOfNeighbors);
+
+  // Patches with the same difference may be returned in any order, so only the differences are compared
+  auto getDistances = [&](const std::vector<VertexDescriptorType>& neighbors, const VertexDescriptorType query)
+  {
+    std::vector<float> distances;
+    for(const VertexDescriptorType& neighbor : neighbors)
+    {
+      distances.push_back(patchDifference(get(*fixture.DescriptorMap, neighbor),
+                                          get(*fixture.DescriptorMap, query)));
+    }
+    return distances;
+  };
+
+  ExhaustiveQueries<FixtureType, PatchDifferenceType> queries(fixture, patchHalfWidth, 40);
+  double prunedBestSeconds = 0.0;
+  double successiveEliminationSeconds = 0.0;
+  double walshHadamardSeconds = 0.0;
+  double exhaustiveKNNSeconds = 0.0;
+  double prunedKNNSeconds = 0.0;
+  for(std::size_t queryId = 0; queryId < queries.Vertices.size(); ++queryId)
+  {
+    const VertexDescriptorType& queryVertex = queries.Vertices[queryId];
+    const itk::Index<2> query = ITKHelpers::CreateIndex(queryVertex);
+    const std::vector<float> exhaustiveBestDistances(1, queries.Distances[queryId]);
+
+    auto start = std::chrono::steady_clock::now();
+    VertexDescriptorType prunedBest = prunedBestSearch(fixture.VertexBegin, fixture.VertexEnd, queryVertex);
+    auto end = std::chrono::steady_clock::now();
+    prunedBestSeconds += std::chrono::duration<double>(end - start).count();
+
+    if(getDistances(std::vector<VertexDescriptorType>(1, prunedBest), queryVertex) != exhaustiveBestDistances)
+    {
+      std::cerr << "The pruned search did not find the best patch for " << query << "!" << std::endl;
+      return false;
+    }
+
+    start = std::chrono::steady_clock::now();
+    VertexDescriptorType successiveEliminationBest =
+        successiveEliminationSearch(fixture.VertexBegin, fixture.VertexEnd, queryVertex);
+    end = std::chrono::steady_clock::now();
+    successiveEliminationSeconds += std::chrono::duration<double>(end - start).count();
+
+    if(getDistances(std::vector<VertexDescriptorType>(1, successiveEliminationBest), queryVertex) !=
+       exhaustiveBestDistances)
+    {
+      std::cerr << "The successive elimination search did not find the best patch for " << query << "!" << std::endl;
+      return false;
+    }
+
+    start = std::chrono::steady_clock::now();
+    VertexDescriptorType walshHadamardBest = walshHadamardSearch(fixture.VertexBegin, fixture.VertexEnd, queryVertex);
+    end = std::chrono::steady_clock::now();
+    walshHadamardSeconds += std::chrono::duration<double>(end - start).count();
+
+    if(getDistances(std::vector<VertexDescriptorType>(1, walshHadamardBest), queryVertex) !=
+       exhaustiveBestDistances)
+    {
+      std::cerr << "The Walsh-Hadamard search did not find the best patch for " << query << "!" << std::endl;
+      return false;
+    }
+
+    std::vector<VertexDescriptorType> exhaustiveNeighbors(numberOfNeighbors);
+    start = std::chrono::steady_clock::now();
+    exhaustiveKNNSearch(fixture.VertexBegin, fixture.VertexEnd, queryVertex, exhaustiveNeighbors.begin());
+    end = std::chrono::steady_clock::now();
+    exhaustiveKNNSeconds += std::chrono::duration<double>(end - start).count();
+
+    std::vector<VertexDescriptorType> prunedNeighbors(numberOfNeighbors);
+    start = std::chrono::steady_clock::now();
+    prunedKNNSearch(fixture.VertexBegin, fixture.VertexEnd, queryVertex, prunedNeighbors.begin());
+    end = std::chrono::steady_clock::now();
+    prunedKNNSeconds += std::chrono::duration<double>(end - start).count();
+
+    if(getDistances(prunedNeighbors, queryVertex) != getDistances(exhaustiveNeighbors, queryVertex))
+    {
+      std::cerr << "The pruned search did not find the " << numberOfNeighbors << " best patches for "
+                << query << "!" << std::endl;
+      return false;
+    }
+  }
+
+  std::cout << imageFileName << ": " << queries.Vertices.size() << " queries" << std::endl;
+  std::cout << "search\tprunedFraction\tspeedup" << std::endl;
+  std::cout << "best\t" << prunedBestSearch.GetPrunedFraction() << "\t"
+            << queries.Seconds / prunedBestSeconds << std::endl;
+  std::cout << "sea\t" << 1.0f - static_cast<float>(successiveEliminationSearch.NumberOfComparisons) /
+                              successiveEliminationSearch.NumberOfCandidates << "\t"
+            << queries.Seconds / successiveEliminationSeconds << std::endl;
+  std::cout << "wh\t" << walshHadamardSearch.GetPrunedFraction() << "\t"
+            << queries.Seconds / walshHadamardSeconds << std::endl;
+  std::cout << "knn(" << numberOfNeighbors << ")\t" << prunedKNNSearch.GetPrunedFraction() << "\t"
+            << exhaustiveKNNSeconds / prunedKNNSeconds << std::endl;
+  successiveEliminationSearch.WriteStatistics(std::cout);
+  walshHadamardSearch.WriteStatistics(std::cout);
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  return RunBenchmarks(argc, argv, BenchmarkImage);
+}
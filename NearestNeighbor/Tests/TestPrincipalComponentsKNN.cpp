@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "BoundaryQueries.hpp"
+#include "NearestNeighbor/LinearSearchBest/Property.hpp"
+#include "NearestNeighbor/PrincipalComponentsKNN.hpp"
+#include "NearestNeighbor/TwoStepNearestNeighbor.hpp"
+#include "DifferenceFunctions/Patch/ImagePatchDifference.hpp"
+#include "DifferenceFunctions/Pixel/SumSquaredPixelDifference.hpp"
+
+// Submodules
+#include <Mask/Mask.h>
+
+// STL
+#include <chrono>
+#include <iostream>
+
+typedef itk::Image<itk::CovariantVector<int, 3>, 2> ImageType;
+
+/** The recall@1 that the two step search must reach with the largest K. */
+static const float MinimumRecall = 0.5f;
+
+/** Use PrincipalComponentsKNN as the first step of TwoStepNearestNeighbor on the boundary of the hole of
+  * 'imageFileName', and report its recall@1 against the exhaustive search for several K.
+  * Returns false if the neighbors are not source patches of the searched range in order of increasing difference,
+  * or if the recall@1 with the largest K is below MinimumRecall. */
+static bool BenchmarkImage(const std::string& imageFileName, const std::string& maskFileName)
+{
+  const unsigned int patchHalfWidth = 7;
+
+  typedef ImagePatchDescriptorFixture<ImageType> FixtureType;
+  FixtureType fixture(imageFileName, maskFileName, patchHalfWidth);
+
+  typedef FixtureType::ImagePatchPixelDescriptorType ImagePatchPixelDescriptorType;
+  typedef FixtureType::VertexDescriptorType VertexDescriptorType;
+  typedef FixtureType::ImagePatchDescriptorMapType ImagePatchDescriptorMapType;
+
+  typedef ImagePatchDifference<ImagePatchPixelDescriptorType,
+      SumSquaredPixelDifference<ImageType::PixelType> > PatchDifferenceType;
+  PatchDifferenceType patchDifference;
+
+  ExhaustiveQueries<FixtureType, PatchDifferenceType> queries(fixture, patchHalfWidth, 40);
+
+  typedef PrincipalComponentsKNN<ImagePatchDescriptorMapType, PatchDifferenceType> KNNSearchType;
+  KNNSearchType knnSearch(fixture.DescriptorMap, fixture.Image.GetPointer(), patchHalfWidth);
+
+  auto start = std::chrono::steady_clock::now();
+  knnSearch.BuildIndex(fixture.VertexBegin, fixture.VertexEnd);
+  double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << imageFileName << ": " << queries.Vertices.size() << " queries, exhaustive search "
+            << queries.Seconds << "s, index built in " << buildSeconds << "s" << std::endl;
+  std::cout << "K\trecall@1\tmeanDistanceRatio\tspeedup" << std::endl;
+
+  typedef LinearSearchBestProperty<ImagePatchDescriptorMapType, PatchDifferenceType> BestSearchType;
+  BestSearchType secondStepSearch(*fixture.DescriptorMap);
+  TwoStepNearestNeighbor<KNNSearchType, BestSearchType> twoStepSearch(knnSearch, secondStepSearch);
+
+  const VertexDescriptorType& firstQuery = queries.Vertices[0];
+
+  const unsigned int numbersOfNeighbors[] = {10, 50, 200};
+  for(unsigned int numberOfNeighbors : numbersOfNeighbors)
+  {
+    knnSearch.SetK(numberOfNeighbors);
+
+    // The neighbors must be source patches in order of increasing difference
+    std::vector<VertexDescriptorType> neighbors(numberOfNeighbors);
+    knnSearch(fixture.VertexBegin, fixture.VertexEnd, firstQuery, neighbors.begin());
+    for(unsigned int neighborId = 0; neighborId < numberOfNeighbors; ++neighborId)
+    {
+      if(get(*fixture.DescriptorMap, neighbors[neighborId]).GetStatus() !=
+         ImagePatchPixelDescriptorType::SOURCE_NODE)
+      {
+        std::cerr << "PrincipalComponentsKNN returned a patch that is not a source patch!" << std::endl;
+        return false;
+      }
+
+      if(neighborId > 0 &&
+         patchDifference(get(*fixture.DescriptorMap, neighbors[neighborId]),
+                         get(*fixture.DescriptorMap, firstQuery)) <
+         patchDifference(get(*fixture.DescriptorMap, neighbors[neighborId - 1]),
+                         get(*fixture.DescriptorMap, firstQuery)))
+      {
+        std::cerr << "PrincipalComponentsKNN did not sort its neighbors by their exact difference!" << std::endl;
+        return false;
+      }
+    }
+
+    RecallCounter recall;
+    start = std::chrono::steady_clock::now();
+    for(std::size_t queryId = 0; queryId < queries.Vertices.size(); ++queryId)
+    {
+      VertexDescriptorType result = twoStepSearch(fixture.VertexBegin, fixture.VertexEnd, queries.Vertices[queryId]);
+      recall.Add(patchDifference(get(*fixture.DescriptorMap, result),
+                                 get(*fixture.DescriptorMap, queries.Vertices[queryId])),
+                 queries.Distances[queryId]);
+    }
+    double twoStepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << numberOfNeighbors << "\t" << recall.GetRecall() << "\t" << recall.GetMeanDistanceRatio() << "\t"
+              << queries.Seconds / twoStepSeconds << std::endl;
+
+    if(numberOfNeighbors == numbersOfNeighbors[2] &&
+       !CheckRecall("PrincipalComponentsKNN", recall.GetRecall(), MinimumRecall))
+    {
+      return false;
+    }
+  }
+
+  // A search of a different range rebuilds the index
+  knnSearch.SetK(10);
+  return CheckSearchOfHalfRange(fixture, knnSearch, firstQuery, "PrincipalComponentsKNN");
+}
+
+int main(int argc, char *argv[])
+{
+  return RunBenchmarks(argc, argv, BenchmarkImage);
+}
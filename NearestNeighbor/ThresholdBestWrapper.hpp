@@ -0,0 +1,72 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef ThresholdBestWrapper_HPP
+#define ThresholdBestWrapper_HPP
+
+// STL
+#include <memory>
+#include <vector>
+
+/**
+  * This class is like KNNBestWrapper, but the first step keeps every candidate within a distance of the query
+  * (e.g. a maximum angle between normals) instead of the K nearest ones, so the number of candidates that the
+  * Best finder compares varies from query to query.
+  * \tparam ThresholdFinderType A search with a FindWithinDistance() function (e.g. LocalitySensitiveHashKNN)
+  * \tparam BestFinderType A Best search
+  */
+template <typename ThresholdFinderType, typename BestFinderType>
+class ThresholdBestWrapper
+{
+private:
+  std::shared_ptr<ThresholdFinderType> ThresholdFinder;
+  float DistanceThreshold;
+  std::shared_ptr<BestFinderType> BestFinder;
+
+public:
+  ThresholdBestWrapper(std::shared_ptr<ThresholdFinderType> thresholdFinder, const float distanceThreshold,
+                       std::shared_ptr<BestFinderType> bestFinder) :
+    ThresholdFinder(thresholdFinder), DistanceThreshold(distanceThreshold), BestFinder(bestFinder)
+  {
+  }
+
+  /**
+    * \tparam TIterator The forward-iterator type.
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search (usually container.end() ).
+    * \param queryNode The item to compare the items in the container against.
+    */
+  template <typename TIterator>
+  inline
+  typename TIterator::value_type operator()(const TIterator first,
+                                            const TIterator last,
+                                            typename TIterator::value_type queryNode)
+  {
+    // Find the candidates within the distance
+    std::vector<typename TIterator::value_type> candidates;
+    this->ThresholdFinder->FindWithinDistance(first, last, queryNode, this->DistanceThreshold, candidates);
+
+    // Perform the best search
+    typename TIterator::value_type bestVertex = (*this->BestFinder)(candidates.begin(), candidates.end(),
+                                                                    queryNode);
+    return bestVertex;
+  }
+
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef TiledWindowSearchBest_HPP
+#define TiledWindowSearchBest_HPP
+
+// Custom
+#include "DifferenceFunctions/Pixel/SumSquaredPixelDifference.hpp"
+#include "Utilities/SummedAreaTable.h"
+#include "Utilities/TiledImage.h"
+#include "Utilities/TiledMask.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * This functor finds the best source patch for a target patch of an image that is not loaded into memory.
+ * The candidates are the patches centered within 'SearchRadius' of the target center (as OffsetWindowSearch) that
+ * are inside the image and have no hole pixels, and they are compared to the valid pixels of the target patch
+ * with TPixelDifference.
+ * The candidates are visited in row-major order, a band of TileSize rows at a time: the tiles that the patches
+ * of a band cover are prefetched (so they are loaded in the order in which the candidates use them), and the band is
+ * then copied out of the tile caches. Besides the tiles, only a (2 * SearchRadius + 1) x TileSize band of centers
+ * (plus the patch border) is in memory.
+ */
+template <typename TImage, typename TPixelDifference = SumSquaredPixelDifference<typename TImage::PixelType> >
+class TiledWindowSearchBest
+{
+public:
+
+  typedef typename TImage::PixelType PixelType;
+
+  TiledWindowSearchBest(TiledImage<TImage>* const image, TiledMask* const mask, const unsigned int patchHalfWidth,
+                        const unsigned int searchRadius) :
+    Image(image), MaskImage(mask), PatchHalfWidth(patchHalfWidth), SearchRadius(searchRadius)
+  {
+    this->BandImage = TImage::New();
+    this->BandMask = TiledMask::ImageType::New();
+    this->BandHoles = TiledMask::ImageType::New();
+  }
+
+  /** Get the center of the best source patch for the patch centered at 'targetCenter'. */
+  itk::Index<2> operator()(const itk::Index<2>& targetCenter)
+  {
+    itk::ImageRegion<2> fullRegion = this->Image->GetLargestPossibleRegion();
+
+    // The target patch is cropped to the image, and only its valid pixels are compared
+    itk::ImageRegion<2> targetRegion = ITKHelpers::GetRegionInRadiusAroundPixel(targetCenter, this->PatchHalfWidth);
+    targetRegion.Crop(fullRegion);
+
+    typename TImage::Pointer targetImage = TImage::New();
+    this->Image->ReadRegion(targetRegion, targetImage.GetPointer());
+    TiledMask::ImageType::Pointer targetMask = TiledMask::ImageType::New();
+    this->MaskImage->ReadRegion(targetRegion, targetMask.GetPointer());
+
+    std::vector<itk::Offset<2> > validOffsets;
+    std::vector<PixelType> validPixels;
+    itk::ImageRegionConstIteratorWithIndex<TImage> targetIterator(targetImage, targetImage->GetLargestPossibleRegion());
+    while(!targetIterator.IsAtEnd())
+    {
+      if(!this->MaskImage->IsHoleValue(targetMask->GetPixel(targetIterator.GetIndex())))
+      {
+        // The target image starts at (0,0)
+        itk::Offset<2> offsetInPatch = {{targetIterator.GetIndex()[0], targetIterator.GetIndex()[1]}};
+        validOffsets.push_back((targetRegion.GetIndex() + offsetInPatch) - targetCenter);
+        validPixels.push_back(targetIterator.Get());
+      }
+      ++targetIterator;
+    }
+
+    if(fullRegion.GetSize()[0] <= 2 * this->PatchHalfWidth || fullRegion.GetSize()[1] <= 2 * this->PatchHalfWidth)
+    {
+      throw std::runtime_error("TiledWindowSearchBest: the image is smaller than a patch!");
+    }
+
+    // The centers of the candidate patches that are entirely inside the image
+    itk::ImageRegion<2> centerRegion = fullRegion;
+    centerRegion.ShrinkByRadius(this->PatchHalfWidth);
+
+    itk::ImageRegion<2> window = ITKHelpers::GetRegionInRadiusAroundPixel(targetCenter, this->SearchRadius);
+    bool windowHasCenters = window.Crop(centerRegion);
+
+    itk::Index<2> bestCenter = {{0, 0}};
+    float bestDifference = std::numeric_limits<float>::infinity();
+
+    TPixelDifference pixelDifference;
+
+    // The window has no centers if none within the search radius is far enough from the image border
+    const unsigned int tileSize = this->Image->GetTileSize();
+    const unsigned int windowHeight = windowHasCenters ? window.GetSize()[1] : 0;
+    bool foundSource = false;
+    for(unsigned int bandStart = 0; bandStart < windowHeight; bandStart += tileSize)
+    {
+      itk::Index<2> bandCorner = {{window.GetIndex()[0], window.GetIndex()[1] + static_cast<itk::IndexValueType>(bandStart)}};
+      itk::Size<2> bandSize = {{window.GetSize()[0], std::min<itk::SizeValueType>(tileSize, window.GetSize()[1] - bandStart)}};
+      itk::ImageRegion<2> bandCenters(bandCorner, bandSize);
+
+      itk::ImageRegion<2> bandRegion = bandCenters;
+      bandRegion.PadByRadius(this->PatchHalfWidth);
+
+      this->Image->Prefetch(bandRegion);
+      this->MaskImage->Prefetch(bandRegion);
+      this->Image->ReadRegion(bandRegion, this->BandImage);
+      this->MaskImage->ReadRegion(bandRegion, this->BandMask);
+
+      // Count the holes of the band, so that a candidate with a hole is rejected from 4 values of the table
+      this->BandHoles->SetRegions(this->BandMask->GetLargestPossibleRegion());
+      this->BandHoles->Allocate();
+      itk::ImageRegionConstIterator<TiledMask::ImageType> bandMaskIterator(this->BandMask, this->BandMask->GetLargestPossibleRegion());
+      itk::ImageRegionIterator<TiledMask::ImageType> bandHolesIterator(this->BandHoles, this->BandHoles->GetLargestPossibleRegion());
+      while(!bandMaskIterator.IsAtEnd())
+      {
+        bandHolesIterator.Set(this->MaskImage->IsHoleValue(bandMaskIterator.Get()) ? 1 : 0);
+        ++bandMaskIterator;
+        ++bandHolesIterator;
+      }
+      SummedAreaTable<TiledMask::ImageType> bandHoleCounts(this->BandHoles);
+
+      for(unsigned int y = 0; y < bandCenters.GetSize()[1]; ++y)
+      {
+        for(unsigned int x = 0; x < bandCenters.GetSize()[0]; ++x)
+        {
+          // The position of the candidate center in the band images
+          itk::Index<2> bandCenter = {{static_cast<itk::IndexValueType>(x + this->PatchHalfWidth),
+                                       static_cast<itk::IndexValueType>(y + this->PatchHalfWidth)}};
+
+          double numberOfHoles = 0.0;
+          bandHoleCounts.AddSum(ITKHelpers::GetRegionInRadiusAroundPixel(bandCenter, this->PatchHalfWidth),
+                                &numberOfHoles);
+          if(numberOfHoles > 0.0)
+          {
+            continue;
+          }
+
+          // Stop comparing as soon as the candidate can not be better
+          float difference = 0.0f;
+          for(std::size_t pixelId = 0; pixelId < validOffsets.size() && difference < bestDifference; ++pixelId)
+          {
+            difference += pixelDifference(validPixels[pixelId],
+                                          this->BandImage->GetPixel(bandCenter + validOffsets[pixelId]));
+          }
+
+          if(difference < bestDifference)
+          {
+            bestDifference = difference;
+            bestCenter[0] = bandCenters.GetIndex()[0] + static_cast<itk::IndexValueType>(x);
+            bestCenter[1] = bandCenters.GetIndex()[1] + static_cast<itk::IndexValueType>(y);
+            foundSource = true;
+          }
+        }
+      }
+    }
+
+    if(!foundSource)
+    {
+      std::stringstream ss;
+      ss << "TiledWindowSearchBest: there is no source patch without holes within the search radius of "
+         << targetCenter << "!";
+      throw std::runtime_error(ss.str());
+    }
+
+    return bestCenter;
+  }
+
+private:
+
+  /** The tiled image and mask are not owned. */
+  TiledImage<TImage>* Image;
+
+  TiledMask* MaskImage;
+
+  unsigned int PatchHalfWidth;
+
+  unsigned int SearchRadius;
+
+  /** The band of candidates that is being compared (reused across bands and targets). */
+  typename TImage::Pointer BandImage;
+
+  TiledMask::ImageType::Pointer BandMask;
+
+  /** 1 at the hole pixels of BandMask and 0 elsewhere. */
+  TiledMask::ImageType::Pointer BandHoles;
+};
+
+#endif
@@ -0,0 +1,337 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef VantagePointTreeKNN_HPP
+#define VantagePointTreeKNN_HPP
+
+// Custom
+#include "SearchRange.hpp"
+#include "Utilities/VantagePointTree.h"
+#include "PixelDescriptors/FeatureVectorPixelDescriptor.h"
+
+// Submodules
+#include <ITKHelpers/ITKContainerInterface.h>
+
+// STL
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/** Get the values of a FeatureVectorPixelDescriptor to index, which are all valid. */
+struct FeatureVectorDescriptorValues
+{
+  void operator()(const FeatureVectorPixelDescriptor& descriptor, std::vector<float>& values,
+                  std::vector<unsigned int>& validComponents) const
+  {
+    values = descriptor.GetFeatureVector();
+    validComponents.clear();
+  }
+};
+
+/** Get the pixel components of an ImagePatchVectorized to index, in raster scan order. Only the components of
+  * the valid pixels of a target patch are valid. */
+struct VectorizedPatchValues
+{
+  template <typename TPatch>
+  void operator()(const TPatch& patch, std::vector<float>& values, std::vector<unsigned int>& validComponents) const
+  {
+    const std::vector<typename TPatch::PixelType>& pixels = patch.GetPixelVector();
+    const unsigned int numberOfComponents = pixels.empty() ? 0 : Helpers::length(pixels[0]);
+
+    values.resize(pixels.size() * numberOfComponents);
+    for(std::size_t pixelId = 0; pixelId < pixels.size(); ++pixelId)
+    {
+      for(unsigned int component = 0; component < numberOfComponents; ++component)
+      {
+        values[pixelId * numberOfComponents + component] = Helpers::index(pixels[pixelId], component);
+      }
+    }
+
+    validComponents.clear();
+    if(patch.GetStatus() == PixelDescriptor::TARGET_NODE)
+    {
+      const std::vector<unsigned int>* validOffsets = patch.GetValidOffsetsAddress();
+      for(std::size_t offsetId = 0; offsetId < validOffsets->size(); ++offsetId)
+      {
+        for(unsigned int component = 0; component < numberOfComponents; ++component)
+        {
+          validComponents.push_back((*validOffsets)[offsetId] * numberOfComponents + component);
+        }
+      }
+    }
+  }
+};
+
+/**
+  * This class finds the exact K nearest neighbors of a query with the same interface as LinearSearchKNNProperty,
+  * so it can be the first step of TwoStepNearestNeighbor, using a VantagePointTree of the values of the source
+  * descriptors (e.g. FeatureVectorDescriptorValues or VectorizedPatchValues).
+  *
+  * BuildIndex() builds the tree (in parallel) from every source descriptor in a range. A search that is given a
+  * different range than the tree was built from (e.g. the first search) builds it again. Source descriptors of
+  * the range that become valid later (see InpaintingVisitor::SetAllowNewPatches()) are added with AddSources().
+  * The distance is the Manhattan distance (which is FeatureVectorDifference) or the Euclidean distance (which orders
+  * the neighbors in the same way as the sum of squared differences) of the values, over only the valid components
+  * of the query. The neighbors are written in order of increasing distance, without the query itself.
+  * \tparam PropertyMapType The type of the property map containing the descriptors to compare.
+  * \tparam TValuesFunctor The functor type to get the values of a descriptor to index.
+  */
+template <typename PropertyMapType,
+          typename TValuesFunctor>
+class VantagePointTreeKNN
+{
+  typedef typename PropertyMapType::value_type DescriptorType;
+  typedef typename PropertyMapType::key_type VertexDescriptorType;
+
+  std::shared_ptr<PropertyMapType> PropertyMap;
+  unsigned int K;
+  TValuesFunctor ValuesFunctor;
+
+  VantagePointTree Tree;
+
+  /** The vertex of each point in the tree, and the set of them. */
+  std::vector<VertexDescriptorType> Sources;
+  std::set<VertexDescriptorType> IndexedSources;
+
+  SearchRange<VertexDescriptorType> IndexedRange;
+
+public:
+  VantagePointTreeKNN(std::shared_ptr<PropertyMapType> propertyMap, const unsigned int k = 1000,
+                      const VantagePointTree::MetricEnum metric = VantagePointTree::EUCLIDEAN,
+                      TValuesFunctor valuesFunctor = TValuesFunctor()) :
+    PropertyMap(propertyMap), K(k), ValuesFunctor(valuesFunctor), Tree(metric)
+  {
+  }
+
+  std::shared_ptr<PropertyMapType> GetPropertyMap() const
+  {
+    return this->PropertyMap;
+  }
+
+  /** Set the number of nearest neighbors to return. */
+  void SetK(const unsigned int k)
+  {
+    this->K = k;
+  }
+
+  /** Get the number of nearest neighbors to return. */
+  unsigned int GetK() const
+  {
+    return this->K;
+  }
+
+  /** Get the number of source descriptors in the index. */
+  unsigned int GetNumberOfSources() const
+  {
+    return static_cast<unsigned int>(this->Sources.size());
+  }
+
+  /** Build the index from the source descriptors in [first, last). A search of a different range does this
+    * again. */
+  template <typename TIterator>
+  void BuildIndex(TIterator first, TIterator last)
+  {
+    this->IndexedRange.Clear();
+    this->Sources.clear();
+    this->IndexedSources.clear();
+    for(TIterator current = first; current != last; ++current)
+    {
+      if(get(*(this->PropertyMap), *current).GetStatus() == DescriptorType::SOURCE_NODE &&
+         this->IndexedSources.insert(*current).second)
+      {
+        this->Sources.push_back(*current);
+      }
+    }
+
+    if(this->Sources.empty())
+    {
+      throw std::runtime_error("VantagePointTreeKNN: there are no source descriptors to index!");
+    }
+
+    std::vector<float> values;
+    std::vector<unsigned int> validComponents;
+    this->ValuesFunctor(get(*(this->PropertyMap), this->Sources[0]), values, validComponents);
+    const unsigned int dimension = static_cast<unsigned int>(values.size());
+
+    std::vector<float> points(this->Sources.size() * dimension);
+    bool sameDimension = true;
+
+    #pragma omp parallel for firstprivate(values, validComponents)
+    for(int sourceId = 0; sourceId < static_cast<int>(this->Sources.size()); ++sourceId)
+    {
+      this->ValuesFunctor(get(*(this->PropertyMap), this->Sources[sourceId]), values, validComponents);
+      if(values.size() != dimension)
+      {
+        #pragma omp critical
+        sameDimension = false;
+        continue;
+      }
+
+      std::copy(values.begin(), values.end(), points.begin() + sourceId * dimension);
+    }
+
+    if(!sameDimension)
+    {
+      throw std::runtime_error("VantagePointTreeKNN: the source descriptors do not all have the same length!");
+    }
+
+    this->Tree.Build(points, dimension);
+    this->IndexedRange.Set(first, last);
+  }
+
+  /** Add the source descriptors in [first, last) that are not in the index yet (e.g. the vertices of a region
+    * that was just filled, see IndexUpdateDescriptorVisitor). Other descriptors, and the ones that are not in the
+    * range the index was built from, are ignored. */
+  template <typename TIterator>
+  void AddSources(TIterator first, TIterator last)
+  {
+    // Before the index is built, the first search builds it from all of the source descriptors of its range
+    if(this->Sources.empty())
+    {
+      return;
+    }
+
+    std::vector<float> values;
+    std::vector<unsigned int> validComponents;
+    for(TIterator current = first; current != last; ++current)
+    {
+      const DescriptorType& descriptor = get(*(this->PropertyMap), *current);
+      if(descriptor.GetStatus() != DescriptorType::SOURCE_NODE || this->IndexedSources.count(*current) > 0 ||
+         !this->IndexedRange.Contains(*current))
+      {
+        continue;
+      }
+
+      this->ValuesFunctor(descriptor, values, validComponents);
+      if(values.size() != this->Tree.GetDimension())
+      {
+        throw std::runtime_error("VantagePointTreeKNN::AddSources: the descriptor has a different length!");
+      }
+
+      this->Tree.Insert(values.data());
+      this->Sources.push_back(*current);
+      this->IndexedSources.insert(*current);
+    }
+  }
+
+  /**
+    * \tparam TIterator The forward-iterator type.
+    * \tparam TOutputIterator The iterator type of the output container.
+    * \param first Start of the range in which to search.
+    * \param last One element past the last element in the range in which to search (usually container.end() ).
+    * \param queryNode The item to compare the items in the container against.
+    * \param outputFirst An iterator to the beginning of the output container that will store the K nearest neighbors.
+    * \return The iterator one past the last neighbor that was written.
+    */
+  template <typename TIterator, typename TOutputIterator>
+  TOutputIterator operator()(TIterator first,
+                             TIterator last,
+                             typename TIterator::value_type queryNode,
+                             TOutputIterator outputFirst)
+  {
+    // Nothing to do if the input range is empty
+    if(first == last)
+    {
+      return outputFirst;
+    }
+
+    if(!this->IndexedRange.IsEqual(first, last))
+    {
+      BuildIndex(first, last);
+    }
+
+    std::vector<VertexDescriptorType> neighbors;
+    if(!FindNeighbors(queryNode, neighbors))
+    {
+      throw std::runtime_error("VantagePointTreeKNN: the query descriptor has a different length!");
+    }
+
+    if(neighbors.size() < this->K)
+    {
+      std::stringstream ss;
+      ss << "Requested " << this->K << " items but only found " << neighbors.size();
+      throw std::runtime_error(ss.str());
+    }
+
+    return std::copy(neighbors.begin(), neighbors.end(), outputFirst);
+  }
+
+  /** Find the K nearest neighbors of each of the queries in [queryFirst, queryLast) (e.g. every boundary vertex),
+    * in parallel. BuildIndex() must have been called. */
+  template <typename TIterator>
+  void FindNeighbors(TIterator queryFirst, TIterator queryLast,
+                     std::vector<std::vector<VertexDescriptorType> >& neighbors) const
+  {
+    const std::vector<VertexDescriptorType> queries(queryFirst, queryLast);
+    neighbors.resize(queries.size());
+    bool sameDimension = true;
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for(int queryId = 0; queryId < static_cast<int>(queries.size()); ++queryId)
+    {
+      if(!FindNeighbors(queries[queryId], neighbors[queryId]))
+      {
+        #pragma omp critical
+        sameDimension = false;
+      }
+    }
+
+    if(!sameDimension)
+    {
+      throw std::runtime_error("VantagePointTreeKNN: a query descriptor has a different length!");
+    }
+  }
+
+private:
+
+  /** Find (at most) K nearest neighbors of the query, in order of increasing distance. Return false (and find
+    * none) if the query does not have as many values as the source descriptors. */
+  bool FindNeighbors(const VertexDescriptorType& queryNode, std::vector<VertexDescriptorType>& neighbors) const
+  {
+    neighbors.clear();
+
+    std::vector<float> queryValues;
+    std::vector<unsigned int> validComponents;
+    this->ValuesFunctor(get(*(this->PropertyMap), queryNode), queryValues, validComponents);
+    if(queryValues.size() != this->Tree.GetDimension())
+    {
+      return false;
+    }
+
+    // The query may be in the index itself, so find one more neighbor in case it has to be skipped
+    std::vector<VantagePointTree::NeighborType> indexNeighbors;
+    this->Tree.FindNearest(queryValues.data(), this->K + 1, indexNeighbors,
+                           validComponents.empty() ? nullptr : &validComponents);
+
+    for(std::size_t neighborId = 0; neighborId < indexNeighbors.size() && neighbors.size() < this->K; ++neighborId)
+    {
+      const VertexDescriptorType& source = this->Sources[indexNeighbors[neighborId].second];
+      if(!(source == queryNode))
+      {
+        neighbors.push_back(source);
+      }
+    }
+
+    return true;
+  }
+};
+
+#endif
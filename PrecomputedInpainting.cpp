@@ -33,6 +33,10 @@
 
 // Inpainting
 #include "Algorithms/InpaintingPrecomputedAlgorithm.hpp"
+#include "Algorithms/FillLogReplayer.h"
+
+// Utilities
+#include "Utilities/FillLog.h"
 
 // ITK
 #include "itkImageFileReader.h"
@@ -48,13 +52,17 @@
 #include <boost/graph/detail/d_ary_heap.hpp>
 
 // Run with: Data/trashcan.mha Data/trashcan_mask.mha 15 precomputed.txt filled.mha
+// The precomputed file can be a text log or a binary fill log (see Utilities/FillLog.h).
+// A binary fill log is applied directly with FillLogReplayer. It can be applied to an image that is an integer
+// multiple of the size it was computed at, and to additional channels (e.g. depth.mha depthFilled.mha labels.mha labelsFilled.mha).
 int main(int argc, char *argv[])
 {
   // Verify arguments
-  if(argc != 6)
+  if(argc < 6 || (argc - 6) % 2 != 0)
     {
     std::stringstream ss;
-    ss << "Required arguments: image.mha imageMask.mha patch_half_width precomputed.txt output.mha" << std::endl;
+    ss << "Required arguments: image.mha imageMask.mha patch_half_width precomputed.txt output.mha"
+       << " [channel.mha channelOutput.mha ...]" << std::endl;
     ss << "Input arguments: ";
     for(int i = 1; i < argc; ++i)
       {
@@ -97,6 +105,60 @@ int main(int argc, char *argv[])
   Mask::Pointer mask = Mask::New();
   mask->Read(maskFilename);
 
+  if(FillLog::IsFillLog(precomputedFilename))
+    {
+    FillLogReader fillLogReader(precomputedFilename);
+
+    if(fillLogReader.GetPatchRadius() != patchHalfWidth)
+      {
+      std::stringstream ss;
+      ss << "The fill log was written with patch half width " << fillLogReader.GetPatchRadius()
+         << " but " << patchHalfWidth << " was requested!";
+      throw std::runtime_error(ss.str());
+      }
+
+    if(fillLogReader.GetImageSize() == image->GetLargestPossibleRegion().GetSize() &&
+       fillLogReader.GetInputChecksum() != FillLog::ComputeInputChecksum(image.GetPointer(), mask.GetPointer()))
+      {
+      std::cerr << "Warning: the image and mask are not the ones the fill log was written for!" << std::endl;
+      }
+
+    // The replayer changes the mask as it goes, so the channels must all be added before replaying.
+    FillLogReplayer replayer(mask);
+    replayer.AddChannel(image.GetPointer());
+
+    std::vector<ImageType::Pointer> channels;
+    for(int i = 6; i < argc; i += 2)
+      {
+      std::cout << "Reading channel: " << argv[i] << std::endl;
+      ImageReaderType::Pointer channelReader = ImageReaderType::New();
+      channelReader->SetFileName(argv[i]);
+      channelReader->Update();
+
+      ImageType::Pointer channel = ImageType::New();
+      ITKHelpers::DeepCopy(channelReader->GetOutput(), channel.GetPointer());
+      replayer.AddChannel(channel.GetPointer());
+      channels.push_back(channel);
+      }
+
+    replayer.Replay(fillLogReader);
+    std::cout << "Replayed " << replayer.GetNumberOfPatches() << " patches in "
+              << replayer.GetNumberOfRuns() << " runs." << std::endl;
+
+    OutputHelpers::WriteImage(image.GetPointer(), outputFilename);
+    for(unsigned int i = 0; i < channels.size(); ++i)
+      {
+      OutputHelpers::WriteImage(channels[i].GetPointer(), argv[7 + 2 * i]);
+      }
+
+    return EXIT_SUCCESS;
+    }
+
+  if(argc > 6)
+    {
+    throw std::runtime_error("Additional channels can only be filled from a binary fill log!");
+    }
+
   typedef std::pair<itk::Index<2>, itk::Index<2> > NodePairType;
   typedef std::queue<NodePairType> NodePairQueueType;
   NodePairQueueType nodePairQueue;
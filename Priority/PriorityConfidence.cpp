@@ -18,6 +18,9 @@
 
 #include "PriorityConfidence.h"
 
+// Custom
+#include "Utilities/Checkpoint.h"
+
 PriorityConfidence::PriorityConfidence(const Mask* const maskImage, const unsigned int patchRadius) :
 MaskImage(maskImage), PatchRadius(patchRadius)
 {
@@ -50,3 +53,13 @@ void PriorityConfidence::InitializeConfidenceMap()
 //   ITKHelpers::WriteImage(ConfidenceMapImage.GetPointer(), "ConfidenceMapInitial.mha");
 //   ITKHelpers::WriteScaledScalarImage(ConfidenceMapImage.GetPointer(), "ConfidenceMapInitial.png");
 }
+
+void PriorityConfidence::SaveState(Checkpoint& checkpoint) const
+{
+  checkpoint.AddImage("PriorityConfidence.ConfidenceMap", this->ConfidenceMapImage.GetPointer());
+}
+
+void PriorityConfidence::LoadState(const Checkpoint& checkpoint)
+{
+  checkpoint.GetImage("PriorityConfidence.ConfidenceMap", this->ConfidenceMapImage.GetPointer());
+}
@@ -25,6 +25,8 @@
 #include <Mask/Mask.h>
 #include <Utilities/Debug/Debug.h>
 
+class Checkpoint;
+
 /**
 \class PriorityConfidence
 \brief This class ranks the priority of a patch based on confidence values
@@ -49,6 +51,12 @@ public:
   void Update(const TNode& sourceNode, const TNode& targetNode,
               const unsigned int patchNumber = 0);
 
+  /** Add the confidence map to 'checkpoint'. */
+  void SaveState(Checkpoint& checkpoint) const;
+
+  /** Restore the confidence map from 'checkpoint'. */
+  void LoadState(const Checkpoint& checkpoint);
+
 protected:
 
   typedef itk::Image<float, 2> ConfidenceImageType;
@@ -18,6 +18,9 @@
 
 #include "PriorityConfidence.h" // Appease syntax parser
 
+// Custom
+#include "Utilities/AsyncImageWriter.h"
+
 // Submodules
 #include <Helpers/Helpers.h>
 #include <ITKHelpers/ITKHelpers.h>
@@ -31,7 +34,8 @@ void PriorityConfidence::Update(const TNode& sourceNode, const TNode& targetNode
 
   if(this->IsDebugOn())
   {
-    ITKHelpers::WriteSequentialImage(this->ConfidenceMapImage.GetPointer(), "ConfidenceMap", patchNumber, 3, "mha");
+    AsyncImageWriter::GetInstance().WriteSequentialImage(this->ConfidenceMapImage.GetPointer(), "ConfidenceMap",
+                                                         patchNumber, 3, "mha");
   }
 }
 
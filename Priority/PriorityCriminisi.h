@@ -55,6 +55,12 @@ public:
 
   using PriorityConfidence::ComputeConfidenceTerm;
 
+  /** Add the confidence map, isophotes and boundary normals to 'checkpoint'. */
+  void SaveState(Checkpoint& checkpoint) const;
+
+  /** Restore the state saved by SaveState(). */
+  void LoadState(const Checkpoint& checkpoint);
+
 protected:
 
   typedef PriorityConfidence Superclass;
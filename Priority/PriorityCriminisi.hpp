@@ -24,6 +24,8 @@
 // Custom
 #include "ImageProcessing/BoundaryNormals.h"
 #include "ImageProcessing/Isophotes.h"
+#include "Utilities/AsyncImageWriter.h"
+#include "Utilities/Checkpoint.h"
 
 // Submodules
 #include <Helpers/Helpers.h>
@@ -92,10 +94,10 @@ void PriorityCriminisi<TImage>::Update(const TNode& sourceNode, const TNode& tar
 
   if(this->GetDebugImages())
   {
-    ITKHelpers::WriteSequentialImage(this->BoundaryNormalsImage.GetPointer(), "BoundaryNormals",
-                                     patchNumber, 3, "mha");
-    ITKHelpers::WriteSequentialImage(this->IsophoteImage.GetPointer(), "IsophoteImage",
-                                     patchNumber, 3, "mha");
+    AsyncImageWriter::GetInstance().WriteSequentialImage(this->BoundaryNormalsImage.GetPointer(), "BoundaryNormals",
+                                                         patchNumber, 3, "mha");
+    AsyncImageWriter::GetInstance().WriteSequentialImage(this->IsophoteImage.GetPointer(), "IsophoteImage",
+                                                         patchNumber, 3, "mha");
 
     WriteDataImage(patchNumber);
     WriteBoundaryImage(patchNumber);
@@ -103,6 +105,22 @@ void PriorityCriminisi<TImage>::Update(const TNode& sourceNode, const TNode& tar
   }
 }
 
+template <typename TImage>
+void PriorityCriminisi<TImage>::SaveState(Checkpoint& checkpoint) const
+{
+  Superclass::SaveState(checkpoint);
+  checkpoint.AddImage("PriorityCriminisi.Isophotes", this->IsophoteImage.GetPointer());
+  checkpoint.AddImage("PriorityCriminisi.BoundaryNormals", this->BoundaryNormalsImage.GetPointer());
+}
+
+template <typename TImage>
+void PriorityCriminisi<TImage>::LoadState(const Checkpoint& checkpoint)
+{
+  Superclass::LoadState(checkpoint);
+  checkpoint.GetImage("PriorityCriminisi.Isophotes", this->IsophoteImage.GetPointer());
+  checkpoint.GetImage("PriorityCriminisi.BoundaryNormals", this->BoundaryNormalsImage.GetPointer());
+}
+
 template <typename TImage>
 template <typename TNode>
 float PriorityCriminisi<TImage>::ComputePriority(const TNode& queryPixel) const
@@ -147,8 +165,7 @@ void PriorityCriminisi<TImage>::WriteBoundaryImage(const unsigned int patchNumbe
 
   this->MaskImage->CreateBoundaryImage(boundaryImage, Mask::VALID, 255);
 
-  ITKHelpers::WriteImage(boundaryImage.GetPointer(),
-                         Helpers::GetSequentialFileName("BoundaryImage", patchNumber, "mha", 3));
+  AsyncImageWriter::GetInstance().WriteSequentialImage(boundaryImage.GetPointer(), "BoundaryImage", patchNumber, 3, "mha");
 }
 
 template <typename TImage>
@@ -174,8 +191,7 @@ void PriorityCriminisi<TImage>::WriteDataImage(const unsigned int patchNumber)
     dataImage->SetPixel(*iter, ComputeDataTerm(*iter));
   }
 
-  ITKHelpers::WriteImage(dataImage.GetPointer(),
-                         Helpers::GetSequentialFileName("DataImage", patchNumber, "mha", 3));
+  AsyncImageWriter::GetInstance().WriteSequentialImage(dataImage.GetPointer(), "DataImage", patchNumber, 3, "mha");
 }
 
 template <typename TImage>
@@ -201,8 +217,7 @@ void PriorityCriminisi<TImage>::WritePriorityImage(const unsigned int patchNumbe
     priorityImage->SetPixel(*iter, ComputePriority(*iter));
   }
 
-  ITKHelpers::WriteImage(priorityImage.GetPointer(),
-                         Helpers::GetSequentialFileName("PriorityImage", patchNumber, "mha", 3));
+  AsyncImageWriter::GetInstance().WriteSequentialImage(priorityImage.GetPointer(), "PriorityImage", patchNumber, 3, "mha");
 }
 
 #endif
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# End to end test of InpaintingServer and InpaintingClient, run by ctest (see the root CMakeLists.txt):
+# start a server, inpaint Data/trashcan with both drivers (the second job reuses the cached image),
+# check the progress events, the outputs and the server status, and shut the server down.
+
+if [ $# -ne 3 ]; then
+  echo "Usage: TestInpaintingServer.bash InpaintingServer InpaintingClient DataDirectory"
+  exit 1
+fi
+
+SERVER=$1
+CLIENT=$2
+DATA=$3
+
+WORKDIR=$(mktemp -d)
+SOCKET=$WORKDIR/inpainting.sock
+
+"$SERVER" "$SOCKET" 2 2 &
+SERVER_PID=$!
+trap 'kill $SERVER_PID 2> /dev/null; rm -rf "$WORKDIR"' EXIT
+
+for i in $(seq 1 50); do
+  [ -S "$SOCKET" ] && break
+  sleep 0.1
+done
+
+fail()
+{
+  echo "FAILED: $1"
+  exit 1
+}
+
+# The second job is only submitted after the first one is finished, so that it is sure to find the image in the
+# cache (two jobs running at the same time on the 2 workers could both miss it).
+"$CLIENT" "$SOCKET" INPAINT image="$DATA/trashcan.png" mask="$DATA/trashcan.mask" radius=7 \
+  workingSetSearchRadius=20 output="$WORKDIR/classical.png" > "$WORKDIR/classical.txt" ||
+  fail "the classical job: $(cat "$WORKDIR/classical.txt")"
+
+"$CLIENT" "$SOCKET" INPAINT image="$DATA/trashcan.png" mask="$DATA/trashcan.mask" radius=7 driver=pyramid \
+  levels=2 output="$WORKDIR/pyramid.png" priority=1 > "$WORKDIR/pyramid.txt" ||
+  fail "the pyramid job: $(cat "$WORKDIR/pyramid.txt")"
+
+for job in classical pyramid; do
+  for event in QUEUED STARTED PROGRESS DONE; do
+    grep -q "^$event " "$WORKDIR/$job.txt" || fail "no $event event for the $job job"
+  done
+  grep -q "remainingHolePixels=0" "$WORKDIR/$job.txt" || fail "the $job job did not report an empty hole"
+  [ -s "$WORKDIR/$job.png" ] || fail "the $job job did not write its output"
+done
+
+# An invalid request is answered with an error, and the client fails
+"$CLIENT" "$SOCKET" INPAINT image="$DATA/trashcan.png" > "$WORKDIR/invalid.txt" && fail "an invalid request succeeded"
+grep -q "^ERROR " "$WORKDIR/invalid.txt" || fail "no ERROR event for an invalid request"
+
+"$CLIENT" "$SOCKET" STATUS > "$WORKDIR/status.txt" || fail "STATUS"
+grep -q "finished=2" "$WORKDIR/status.txt" || fail "the status is $(cat "$WORKDIR/status.txt")"
+grep -q "cacheHits=1" "$WORKDIR/status.txt" || fail "the image was not cached: $(cat "$WORKDIR/status.txt")"
+
+"$CLIENT" "$SOCKET" SHUTDOWN > /dev/null || fail "SHUTDOWN"
+wait $SERVER_PID || fail "the server exited with an error"
+[ -e "$SOCKET" ] && fail "the server did not remove its socket"
+
+echo "PASSED"
+exit 0
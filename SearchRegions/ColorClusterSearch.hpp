@@ -0,0 +1,289 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef ColorClusterSearch_HPP
+#define ColorClusterSearch_HPP
+
+// Custom
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+#include <ITKHelpers/ITKContainerInterface.h>
+#include "PixelDescriptors/PixelDescriptor.h"
+#include "Utilities/ColorClusterIndex.h"
+
+// ITK
+#include "itkImageRegionConstIterator.h"
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+  * This class returns the K source patches with the smallest difference to a target patch, found by visiting only
+  * the clusters of a ColorClusterIndex of the mean colors of all source patches that can contain them. It is
+  * intended for use with InpaintingAlgorithmWithLocalSearch (or SearchRegionBest), which then picks the best of
+  * the K.
+  *
+  * The clusters are visited in order of a lower bound of their difference to the valid pixels of the target patch,
+  * and the search stops as soon as the bound of the next cluster is not smaller than the difference of the K-th
+  * best patch found so far:
+  * - EXACT uses the bound of the range of the pixel values of each cluster, so the result is the same as a full
+  *   search.
+  * - APPROXIMATE uses the bound of the distance of the mean of the valid target pixels to the mean colors of each
+  *   cluster. It visits fewer clusters, but it can miss a patch whose mean over the valid target pixels differs
+  *   from its mean over the whole patch.
+  * Inside a visited cluster, a patch is only compared if the range of its own pixel values does not rule it out.
+  *
+  * The bounds are of the average squared pixel difference, so 'TDistanceFunction' must compute it, e.g.
+  * ImagePatchDifference with SumSquaredPixelDifference (its operator() with a bound is used).
+  *
+  * The index is built from the source patches of the first query, which do not change during an inpainting
+  * (unless new source patches are allowed, see InpaintingVisitor::SetAllowNewPatches()).
+  */
+template <typename TVertexDescriptorType, typename TImagePatchDescriptorMap, typename TDistanceFunction>
+struct ColorClusterSearch
+{
+  typedef std::vector<TVertexDescriptorType> VectorType;
+
+  typedef typename TImagePatchDescriptorMap::value_type PatchType;
+  typedef typename PatchType::ImageType ImageType;
+
+  enum StoppingRuleEnum {EXACT, APPROXIMATE};
+
+  itk::ImageRegion<2> FullRegion;
+
+  TImagePatchDescriptorMap ImagePatchDescriptorMap;
+
+  StoppingRuleEnum StoppingRule;
+
+  unsigned int K;
+
+  TDistanceFunction DistanceFunction;
+
+  ColorClusterIndex Index;
+
+  /** The source patches in the order of the points of the index, and the range of the values of each of their
+    * components (GetDimension() values each). */
+  VectorType Sources;
+  std::vector<float> SourceMinimums;
+  std::vector<float> SourceMaximums;
+
+  unsigned int NumberOfQueries = 0;
+  unsigned long long NumberOfVisitedClusters = 0;
+  unsigned long long NumberOfComparisons = 0;
+
+  /**
+    * 'fullRegion' is the region of the image that is being inpainted.
+    */
+  ColorClusterSearch(const itk::ImageRegion<2>& fullRegion, TImagePatchDescriptorMap imagePatchDescriptorMap,
+                     const unsigned int numberOfClusters = 32, const StoppingRuleEnum stoppingRule = EXACT,
+                     const unsigned int k = 1, TDistanceFunction distanceFunction = TDistanceFunction()) :
+    FullRegion(fullRegion), ImagePatchDescriptorMap(imagePatchDescriptorMap), StoppingRule(stoppingRule),
+    K(std::max(k, 1u)), DistanceFunction(distanceFunction), Index(numberOfClusters)
+  {
+
+  }
+
+  /** Compute the mean and the range of the colors of every source patch, and cluster them. This is done by the
+    * first query if it has not been called. */
+  void BuildIndex()
+  {
+    this->Sources.clear();
+    std::vector<itk::Index<2> > indices = ITKHelpers::GetIndicesInRegion(this->FullRegion);
+    for(unsigned int indexId = 0; indexId < indices.size(); ++indexId)
+    {
+      TVertexDescriptorType vert = Helpers::ConvertFrom<TVertexDescriptorType, itk::Index<2> >(indices[indexId]);
+
+      if(get(this->ImagePatchDescriptorMap, vert).GetStatus() == PixelDescriptor::SOURCE_NODE)
+      {
+        this->Sources.push_back(vert);
+      }
+    }
+
+    if(this->Sources.empty())
+    {
+      return;
+    }
+
+    const unsigned int dimension = get(this->ImagePatchDescriptorMap, this->Sources[0]).GetImage()->
+                                   GetNumberOfComponentsPerPixel();
+    std::vector<float> means(this->Sources.size() * dimension);
+    this->SourceMinimums.resize(means.size());
+    this->SourceMaximums.resize(means.size());
+
+    #pragma omp parallel for
+    for(std::size_t sourceId = 0; sourceId < this->Sources.size(); ++sourceId)
+    {
+      const PatchType& sourcePatch = get(this->ImagePatchDescriptorMap, this->Sources[sourceId]);
+      float* mean = &means[sourceId * dimension];
+      float* minimum = &this->SourceMinimums[sourceId * dimension];
+      float* maximum = &this->SourceMaximums[sourceId * dimension];
+      std::fill(minimum, minimum + dimension, std::numeric_limits<float>::max());
+      std::fill(maximum, maximum + dimension, std::numeric_limits<float>::lowest());
+
+      itk::ImageRegionConstIterator<ImageType> imageIterator(sourcePatch.GetImage(), sourcePatch.GetRegion());
+      while(!imageIterator.IsAtEnd())
+      {
+        typename ImageType::PixelType pixel = imageIterator.Get();
+        for(unsigned int component = 0; component < dimension; ++component)
+        {
+          const float value = Helpers::index(pixel, component);
+          mean[component] += value;
+          minimum[component] = std::min(minimum[component], value);
+          maximum[component] = std::max(maximum[component], value);
+        }
+        ++imageIterator;
+      }
+
+      for(unsigned int component = 0; component < dimension; ++component)
+      {
+        mean[component] /= sourcePatch.GetRegion().GetNumberOfPixels();
+      }
+    }
+
+    this->Index.Build(means, this->SourceMinimums, this->SourceMaximums, dimension);
+  }
+
+  VectorType operator()(const TVertexDescriptorType& target)
+  {
+    if(this->Sources.empty())
+    {
+      BuildIndex();
+    }
+
+    // Nothing to search (SearchRegionBest then searches everything)
+    if(this->Sources.empty())
+    {
+      return VectorType();
+    }
+
+    this->NumberOfQueries++;
+
+    const PatchType& targetPatch = get(this->ImagePatchDescriptorMap, target);
+
+    typedef std::vector<itk::Offset<2> > OffsetVectorType;
+    const OffsetVectorType* validOffsets = targetPatch.GetValidOffsetsAddress();
+
+    const unsigned int dimension = this->Index.GetDimension();
+    std::vector<typename ImageType::PixelType> targetPixels(validOffsets->size());
+    std::vector<float> targetValues(validOffsets->size() * dimension);
+    std::vector<float> targetMean(dimension, 0.0f);
+    for(unsigned int offsetId = 0; offsetId < validOffsets->size(); ++offsetId)
+    {
+      targetPixels[offsetId] = targetPatch.GetImage()->GetPixel(targetPatch.GetCorner() + (*validOffsets)[offsetId]);
+      for(unsigned int component = 0; component < dimension; ++component)
+      {
+        targetValues[offsetId * dimension + component] = Helpers::index(targetPixels[offsetId], component);
+        targetMean[component] += targetValues[offsetId * dimension + component] / validOffsets->size();
+      }
+    }
+
+    const unsigned int numberOfPixels = static_cast<unsigned int>(validOffsets->size());
+    std::vector<ColorClusterIndex::ClusterDistanceType> clusters =
+        this->StoppingRule == EXACT ? this->Index.GetClustersByBox(targetValues.data(), numberOfPixels) :
+                                      this->Index.GetClustersByMean(targetMean.data());
+
+    // The K best patches so far, with the worst of them at the front
+    typedef std::pair<float, unsigned int> NeighborType;
+    std::vector<NeighborType> neighbors;
+    std::vector<float> differences;
+    // The bounds and the differences are accumulated in float in different orders, so a small margin keeps
+    // rounding from pruning a patch that is as good as the K'th neighbor.
+    const float margin = 1.0f - 1e-4f;
+    for(const ColorClusterIndex::ClusterDistanceType& cluster : clusters)
+    {
+      float worstDifference = neighbors.size() < this->K ? std::numeric_limits<float>::max() :
+                                                           neighbors.front().first;
+      if(cluster.first * margin >= worstDifference)
+      {
+        break;
+      }
+
+      this->NumberOfVisitedClusters++;
+
+      const std::vector<unsigned int>& members = this->Index.GetMembers(cluster.second);
+      differences.resize(members.size());
+
+      unsigned long long numberOfComparisons = 0;
+      #pragma omp parallel for reduction(+:numberOfComparisons)
+      for(std::size_t memberId = 0; memberId < members.size(); ++memberId)
+      {
+        const unsigned int sourceId = members[memberId];
+        if(this->Index.ComputeBoxLowerBound(&this->SourceMinimums[sourceId * dimension],
+                                            &this->SourceMaximums[sourceId * dimension],
+                                            targetValues.data(), numberOfPixels) * margin >= worstDifference)
+        {
+          differences[memberId] = std::numeric_limits<float>::max();
+          continue;
+        }
+
+        differences[memberId] = this->DistanceFunction(get(this->ImagePatchDescriptorMap, this->Sources[sourceId]),
+                                                       targetPatch, targetPixels, worstDifference);
+        numberOfComparisons++;
+      }
+      this->NumberOfComparisons += numberOfComparisons;
+
+      for(std::size_t memberId = 0; memberId < members.size(); ++memberId)
+      {
+        if(differences[memberId] >= worstDifference)
+        {
+          continue;
+        }
+
+        neighbors.push_back(NeighborType(differences[memberId], members[memberId]));
+        std::push_heap(neighbors.begin(), neighbors.end());
+        if(neighbors.size() > this->K)
+        {
+          std::pop_heap(neighbors.begin(), neighbors.end());
+          neighbors.pop_back();
+        }
+
+        if(neighbors.size() == this->K)
+        {
+          worstDifference = neighbors.front().first;
+        }
+      }
+    }
+
+    std::sort_heap(neighbors.begin(), neighbors.end());
+
+    VectorType vertices(neighbors.size());
+    for(unsigned int neighborId = 0; neighborId < neighbors.size(); ++neighborId)
+    {
+      vertices[neighborId] = this->Sources[neighbors[neighborId].second];
+    }
+    return vertices;
+  }
+
+  void WriteStatistics(std::ostream& stream) const
+  {
+    stream << "ColorClusterSearch: " << this->NumberOfQueries << " queries of " << this->Sources.size()
+           << " source patches in " << this->Index.GetNumberOfClusters() << " clusters, visited "
+           << static_cast<float>(this->NumberOfVisitedClusters) / std::max(this->NumberOfQueries, 1u)
+           << " clusters and compared "
+           << static_cast<float>(this->NumberOfComparisons) / std::max(this->NumberOfQueries, 1u)
+           << " patches per query" << std::endl;
+  }
+
+};
+
+#endif
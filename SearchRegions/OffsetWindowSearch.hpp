@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef OffsetWindowSearch_HPP
+#define OffsetWindowSearch_HPP
+
+// Custom
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+#include "Utilities/SourcePixelMap.h"
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+// STL
+#include <algorithm>
+#include <vector>
+
+/**
+  * This class returns the source patches in small windows around guessed source patch positions, rather
+  * than around the target patch (as NeighborhoodSearch does). The guess is a SourcePixelMap image that holds,
+  * for each hole pixel, the pixel it is expected to be copied from (e.g. the nearest neighbor field of a coarser
+  * level, see PyramidHelpers::UpsampleSourcePixelMap()). Each hole pixel of the target patch with a guess votes
+  * for the source patch center (its guess minus its offset from the target center), and the windows of radius
+  * 'radius' around the distinct centers are searched.
+  *
+  * If no pixel of the target patch has a guess, an empty list is returned (SearchRegionBest then searches everything).
+  */
+template <typename TVertexDescriptorType, typename TImagePatchDescriptorMap>
+struct OffsetWindowSearch
+{
+  typedef std::vector<TVertexDescriptorType> VectorType;
+
+  const SourcePixelMap::ImageType* SourcePixelGuess;
+
+  itk::ImageRegion<2> FullRegion;
+
+  unsigned int PatchHalfWidth;
+
+  unsigned int Radius;
+
+  TImagePatchDescriptorMap ImagePatchDescriptorMap;
+
+  OffsetWindowSearch(const SourcePixelMap::ImageType* const sourcePixelGuess, const unsigned int patchHalfWidth,
+                     const unsigned int radius, TImagePatchDescriptorMap imagePatchDescriptorMap) :
+    SourcePixelGuess(sourcePixelGuess), FullRegion(sourcePixelGuess->GetLargestPossibleRegion()),
+    PatchHalfWidth(patchHalfWidth), Radius(radius), ImagePatchDescriptorMap(imagePatchDescriptorMap)
+  {
+
+  }
+
+  VectorType operator()(const TVertexDescriptorType& target)
+  {
+    itk::Index<2> targetIndex = Helpers::ConvertFrom<itk::Index<2>, TVertexDescriptorType>(target);
+
+    itk::ImageRegion<2> targetRegion = ITKHelpers::GetRegionInRadiusAroundPixel(targetIndex, this->PatchHalfWidth);
+    targetRegion.Crop(this->FullRegion);
+
+    // Collect the distinct source patch centers that the pixels of the target patch vote for
+    std::vector<unsigned int> centers;
+    itk::ImageRegionConstIteratorWithIndex<SourcePixelMap::ImageType> guessIterator(this->SourcePixelGuess,
+                                                                                    targetRegion);
+    while(!guessIterator.IsAtEnd())
+    {
+      if(guessIterator.Get() != SourcePixelMap::InvalidSourcePixel)
+      {
+        itk::Index<2> guess = SourcePixelMap::GetIndex(this->SourcePixelGuess, guessIterator.Get());
+        itk::Index<2> center = {{guess[0] - (guessIterator.GetIndex()[0] - targetIndex[0]),
+                                 guess[1] - (guessIterator.GetIndex()[1] - targetIndex[1])}};
+        if(this->FullRegion.IsInside(center))
+        {
+          centers.push_back(this->SourcePixelGuess->ComputeOffset(center));
+        }
+      }
+      ++guessIterator;
+    }
+
+    std::sort(centers.begin(), centers.end());
+    centers.erase(std::unique(centers.begin(), centers.end()), centers.end());
+
+    // The windows around nearby centers overlap, so collect linear indices first and remove the duplicates
+    std::vector<unsigned int> candidates;
+    for(unsigned int centerId = 0; centerId < centers.size(); ++centerId)
+    {
+      itk::Index<2> center = this->SourcePixelGuess->ComputeIndex(centers[centerId]);
+      itk::ImageRegion<2> window = ITKHelpers::GetRegionInRadiusAroundPixel(center, this->Radius);
+      window.Crop(this->FullRegion);
+
+      itk::ImageRegionConstIteratorWithIndex<SourcePixelMap::ImageType> windowIterator(this->SourcePixelGuess, window);
+      while(!windowIterator.IsAtEnd())
+      {
+        candidates.push_back(this->SourcePixelGuess->ComputeOffset(windowIterator.GetIndex()));
+        ++windowIterator;
+      }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    VectorType vertices;
+    for(unsigned int candidateId = 0; candidateId < candidates.size(); ++candidateId)
+    {
+      TVertexDescriptorType vert = Helpers::ConvertFrom<TVertexDescriptorType, itk::Index<2> >(
+                                     this->SourcePixelGuess->ComputeIndex(candidates[candidateId]));
+
+      if(get(this->ImagePatchDescriptorMap, vert).GetStatus() == PixelDescriptor::SOURCE_NODE)
+      {
+        vertices.push_back(vert);
+      }
+    }
+    return vertices;
+  }
+
+};
+
+#endif
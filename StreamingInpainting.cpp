@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Submodules
+#include <Helpers/Helpers.h>
+
+// Utilities
+#include "Utilities/TiledImage.h"
+#include "Utilities/TiledMask.h"
+
+// Drivers
+#include "Drivers/WorkingSetInpainting.hpp"
+
+// ITK
+#include "itkCovariantVector.h"
+#include "itkImage.h"
+
+// STL
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Inpaint an image that is too large to be loaded into memory. The input is copied to the output file and the mask
+// image is copied to a working MetaImage next to it, and both are then read and filled through tile caches, so only
+// the tiles around the current target patch (within the search radius) are loaded.
+// The image must be in a format that ITK can stream read and write (e.g. uncompressed .mha).
+// The tile memory budget is split between the image and the mask in proportion to their pixel sizes.
+// Run with: Data/trashcan.mha Data/trashcan.mask 15 filled.mha 100
+// or, to use at most 64 MB of tiles of 512x512 pixels: Data/trashcan.mha Data/trashcan.mask 15 filled.mha 100 64 512
+int main(int argc, char *argv[])
+{
+  // Verify arguments
+  if(argc < 6 || argc > 8)
+  {
+    std::cerr << "Required arguments: image.mha imageMask.mask patchHalfWidth output.mha searchRadius"
+              << " [tileMemoryBudgetMB] [tileSize]" << std::endl;
+    std::cerr << "Input arguments: ";
+    for(int i = 1; i < argc; ++i)
+    {
+      std::cerr << argv[i] << " ";
+    }
+    return EXIT_FAILURE;
+  }
+
+  // Parse arguments
+  std::string imageFilename = argv[1];
+  std::string maskFilename = argv[2];
+
+  std::stringstream ssPatchHalfWidth;
+  ssPatchHalfWidth << argv[3];
+  unsigned int patchHalfWidth = 0;
+  ssPatchHalfWidth >> patchHalfWidth;
+
+  std::string outputFileName = argv[4];
+
+  std::stringstream ssSearchRadius;
+  ssSearchRadius << argv[5];
+  unsigned int searchRadius = 0;
+  ssSearchRadius >> searchRadius;
+
+  unsigned int tileMemoryBudget = 256;
+  if(argc > 6)
+  {
+    std::stringstream ssTileMemoryBudget;
+    ssTileMemoryBudget << argv[6];
+    ssTileMemoryBudget >> tileMemoryBudget;
+  }
+
+  unsigned int tileSize = 256;
+  if(argc > 7)
+  {
+    std::stringstream ssTileSize;
+    ssTileSize << argv[7];
+    ssTileSize >> tileSize;
+  }
+
+  if(Helpers::GetFileExtension(imageFilename) != Helpers::GetFileExtension(outputFileName))
+  {
+    std::cerr << "The output must be in the same format as the input, as the input file is copied "
+              << "and then modified in place." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Copy the input without decoding it, so the image is never loaded as a whole
+  {
+  std::ifstream input(imageFilename.c_str(), std::ios::binary);
+  std::ofstream output(outputFileName.c_str(), std::ios::binary);
+  output << input.rdbuf();
+  if(!input || !output)
+  {
+    std::cerr << "Could not copy " << imageFilename << " to " << outputFileName << std::endl;
+    return EXIT_FAILURE;
+  }
+  }
+
+  typedef itk::Image<itk::CovariantVector<int, 3>, 2> OriginalImageType;
+
+  // The filled mask is written to a working file, so that its tiles can be written back like the tiles of the image
+  std::string workingMaskFileName = outputFileName.substr(0, outputFileName.find_last_of('.')) + "_mask.mha";
+
+  unsigned char holeValue = 0;
+  unsigned char validValue = 0;
+  std::string maskImageFileName;
+  TiledMask::ReadMaskFile(maskFilename, holeValue, validValue, maskImageFileName);
+  TiledMask::CopyMaskImage(maskImageFileName, workingMaskFileName, tileSize);
+
+  const std::size_t budget = static_cast<std::size_t>(tileMemoryBudget) * 1024 * 1024;
+  const std::size_t pixelSize = sizeof(OriginalImageType::PixelType);
+  const std::size_t maskPixelSize = sizeof(TiledMask::ImageType::PixelType);
+
+  {
+  TiledImage<OriginalImageType> tiledImage(outputFileName, tileSize, budget / (pixelSize + maskPixelSize) * pixelSize);
+  TiledMask tiledMask(workingMaskFileName, holeValue, validValue, tileSize,
+                      budget / (pixelSize + maskPixelSize) * maskPixelSize);
+
+  WorkingSetInpainting(tiledImage, tiledMask, patchHalfWidth, searchRadius);
+
+  tiledImage.Flush();
+
+  std::cout << "Read " << tiledImage.GetNumberOfTileReads() << " image tiles and " << tiledMask.GetNumberOfTileReads()
+            << " mask tiles, and wrote " << tiledImage.GetNumberOfTileWrites() << " image tiles." << std::endl;
+  }
+
+  // The mask is completely valid after the inpainting
+  std::remove(workingMaskFileName.c_str());
+
+  return EXIT_SUCCESS;
+}
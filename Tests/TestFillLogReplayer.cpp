@@ -0,0 +1,229 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "Algorithms/FillLogReplayer.h"
+
+// STL
+#include <cstdio>
+#include <iostream>
+
+typedef itk::Image<float, 2> FloatImageType;
+typedef itk::Image<unsigned short, 2> LabelImageType;
+
+/** Apply one patch a pixel at a time, as ImageAndMaskPatchInpainter does. */
+template <typename TImage>
+static void ApplyPatchReference(TImage* const image, Mask* const mask, const itk::Index<2>& target,
+                                const itk::Index<2>& source, const unsigned int patchHalfWidth)
+{
+  const int radius = patchHalfWidth;
+  for(int j = -radius; j <= radius; ++j)
+  {
+    for(int i = -radius; i <= radius; ++i)
+    {
+      itk::Index<2> targetPixel = {{target[0] + i, target[1] + j}};
+      itk::Index<2> sourcePixel = {{source[0] + i, source[1] + j}};
+      if(mask->GetLargestPossibleRegion().IsInside(targetPixel) && mask->IsHole(targetPixel))
+      {
+        image->SetPixel(targetPixel, image->GetPixel(sourcePixel));
+      }
+    }
+  }
+}
+
+static void ApplyMaskReference(Mask* const mask, const itk::Index<2>& target,
+                               const itk::Index<2>& source, const unsigned int patchHalfWidth)
+{
+  const int radius = patchHalfWidth;
+  for(int j = -radius; j <= radius; ++j)
+  {
+    for(int i = -radius; i <= radius; ++i)
+    {
+      itk::Index<2> targetPixel = {{target[0] + i, target[1] + j}};
+      itk::Index<2> sourcePixel = {{source[0] + i, source[1] + j}};
+      if(mask->GetLargestPossibleRegion().IsInside(targetPixel) && mask->IsHole(targetPixel))
+      {
+        mask->SetPixel(targetPixel, mask->GetPixel(sourcePixel));
+      }
+    }
+  }
+}
+
+template <typename TImage>
+static typename TImage::Pointer CreateImage(const itk::ImageRegion<2>& region)
+{
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  for(unsigned int y = 0; y < region.GetSize()[1]; ++y)
+  {
+    for(unsigned int x = 0; x < region.GetSize()[0]; ++x)
+    {
+      itk::Index<2> pixel = {{static_cast<itk::Index<2>::IndexValueType>(x),
+                              static_cast<itk::Index<2>::IndexValueType>(y)}};
+      image->SetPixel(pixel, static_cast<typename TImage::PixelType>(x * 7 + y * 13));
+    }
+  }
+  return image;
+}
+
+static Mask::Pointer CreateMask(const itk::ImageRegion<2>& region, const itk::ImageRegion<2>& hole)
+{
+  Mask::Pointer mask = Mask::New();
+  mask->SetRegions(region);
+  mask->Allocate();
+  for(unsigned int y = 0; y < region.GetSize()[1]; ++y)
+  {
+    for(unsigned int x = 0; x < region.GetSize()[0]; ++x)
+    {
+      itk::Index<2> pixel = {{static_cast<itk::Index<2>::IndexValueType>(x),
+                              static_cast<itk::Index<2>::IndexValueType>(y)}};
+      mask->SetPixel(pixel, hole.IsInside(pixel) ? mask->GetHoleValue() : mask->GetValidValue());
+    }
+  }
+  return mask;
+}
+
+template <typename TImage>
+static bool ImagesEqual(const TImage* const image1, const TImage* const image2)
+{
+  const itk::ImageRegion<2>& region = image1->GetLargestPossibleRegion();
+  for(unsigned int y = 0; y < region.GetSize()[1]; ++y)
+  {
+    for(unsigned int x = 0; x < region.GetSize()[0]; ++x)
+    {
+      itk::Index<2> pixel = {{static_cast<itk::Index<2>::IndexValueType>(x),
+                              static_cast<itk::Index<2>::IndexValueType>(y)}};
+      if(image1->GetPixel(pixel) != image2->GetPixel(pixel))
+      {
+        std::cerr << "Images differ at " << pixel << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int, char*[])
+{
+  const unsigned int patchHalfWidth = 2;
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{60, 40}};
+  itk::ImageRegion<2> region(corner, size);
+
+  itk::Index<2> holeCorner = {{20, 10}};
+  itk::Size<2> holeSize = {{20, 20}};
+  itk::ImageRegion<2> hole(holeCorner, holeSize);
+
+  // Targets that overlap their predecessors (so some runs must be split) and some that are
+  // independent, with sources from the valid region on both sides of the hole.
+  std::vector<FillLogReplayer::TargetSourcePairType> pairs;
+  for(unsigned int i = 0; i < 80; ++i)
+  {
+    itk::Index<2> target = {{20 + static_cast<int>((i * 7) % 20), 10 + static_cast<int>((i * 3) % 20)}};
+    itk::Index<2> source = {{(i % 2 == 0) ? 5 + static_cast<int>(i % 10) : 45 + static_cast<int>(i % 10),
+                             5 + static_cast<int>(i % 30)}};
+    pairs.push_back(FillLogReplayer::TargetSourcePairType(target, source));
+  }
+
+  // Reference: apply the patches sequentially
+  FloatImageType::Pointer referenceImage = CreateImage<FloatImageType>(region);
+  LabelImageType::Pointer referenceLabels = CreateImage<LabelImageType>(region);
+  Mask::Pointer referenceMask = CreateMask(region, hole);
+  for(unsigned int i = 0; i < pairs.size(); ++i)
+  {
+    ApplyPatchReference(referenceImage.GetPointer(), referenceMask.GetPointer(), pairs[i].first, pairs[i].second,
+                        patchHalfWidth);
+    ApplyPatchReference(referenceLabels.GetPointer(), referenceMask.GetPointer(), pairs[i].first, pairs[i].second,
+                        patchHalfWidth);
+    ApplyMaskReference(referenceMask.GetPointer(), pairs[i].first, pairs[i].second, patchHalfWidth);
+  }
+
+  // The replayer applies the same fill to both channels
+  FloatImageType::Pointer image = CreateImage<FloatImageType>(region);
+  LabelImageType::Pointer labels = CreateImage<LabelImageType>(region);
+  Mask::Pointer mask = CreateMask(region, hole);
+
+  FillLogReplayer replayer(mask.GetPointer());
+  replayer.AddChannel(image.GetPointer());
+  replayer.AddChannel(labels.GetPointer());
+  replayer.Replay(pairs, patchHalfWidth);
+
+  std::cout << "Replayed " << replayer.GetNumberOfPatches() << " patches in "
+            << replayer.GetNumberOfRuns() << " runs." << std::endl;
+
+  if(replayer.GetNumberOfRuns() <= 1 || replayer.GetNumberOfRuns() >= pairs.size())
+  {
+    std::cerr << "The patches should be split into some (but not all single patch) runs." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(!ImagesEqual(image.GetPointer(), referenceImage.GetPointer()) ||
+     !ImagesEqual(labels.GetPointer(), referenceLabels.GetPointer()) ||
+     !ImagesEqual(static_cast<Mask*>(mask.GetPointer()), static_cast<Mask*>(referenceMask.GetPointer())))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A fill log written at half resolution must fill the full resolution image
+  {
+    itk::Size<2> halfSize = {{size[0] / 2, size[1] / 2}};
+    {
+      FillLogWriter writer("TestFillLogReplayer.fill", itk::ImageRegion<2>(corner, halfSize), 1, 0);
+      itk::Index<2> target = {{15, 10}};
+      itk::Index<2> source = {{5, 10}};
+      writer.Write(target, source);
+    }
+
+    FloatImageType::Pointer fullImage = CreateImage<FloatImageType>(region);
+    itk::Index<2> scaledHoleCorner = {{28, 18}};
+    itk::Size<2> scaledHoleSize = {{6, 6}};
+    Mask::Pointer fullMask = CreateMask(region, itk::ImageRegion<2>(scaledHoleCorner, scaledHoleSize));
+
+    FillLogReplayer scaledReplayer(fullMask.GetPointer());
+    scaledReplayer.AddChannel(fullImage.GetPointer());
+    FillLogReader reader("TestFillLogReplayer.fill");
+    scaledReplayer.Replay(reader);
+    std::remove("TestFillLogReplayer.fill");
+
+    // Target (15,10) with radius 1 covers [28,34) x [18,24) at scale 2, source (5,10) covers [8,14) x [18,24).
+    FloatImageType::Pointer expectedImage = CreateImage<FloatImageType>(region);
+    for(int y = 18; y < 24; ++y)
+    {
+      for(int x = 28; x < 34; ++x)
+      {
+        itk::Index<2> targetPixel = {{x, y}};
+        itk::Index<2> sourcePixel = {{x - 20, y}};
+        expectedImage->SetPixel(targetPixel, expectedImage->GetPixel(sourcePixel));
+        if(fullMask->IsHole(targetPixel))
+        {
+          std::cerr << "The scaled replay did not fill " << targetPixel << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    if(!ImagesEqual(fullImage.GetPointer(), expectedImage.GetPointer()))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
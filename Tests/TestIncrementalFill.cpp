@@ -0,0 +1,163 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "Algorithms/IncrementalFill.h"
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+// STL
+#include <cstdio>
+#include <iostream>
+
+static Mask::Pointer CreateMask(const itk::ImageRegion<2>& fullRegion, const itk::ImageRegion<2>& holeRegion)
+{
+  Mask::Pointer mask = Mask::New();
+  mask->SetRegions(fullRegion);
+  mask->Allocate();
+
+  itk::ImageRegionConstIteratorWithIndex<Mask> maskIterator(mask, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    mask->SetPixel(maskIterator.GetIndex(),
+                   holeRegion.IsInside(maskIterator.GetIndex()) ? mask->GetHoleValue() : mask->GetValidValue());
+    ++maskIterator;
+  }
+  return mask;
+}
+
+static unsigned int CountHoles(const Mask* const mask)
+{
+  unsigned int numberOfHoles = 0;
+  itk::ImageRegionConstIteratorWithIndex<Mask> maskIterator(mask, mask->GetLargestPossibleRegion());
+  while(!maskIterator.IsAtEnd())
+  {
+    if(mask->IsHole(maskIterator.GetIndex()))
+    {
+      numberOfHoles++;
+    }
+    ++maskIterator;
+  }
+  return numberOfHoles;
+}
+
+/** Every hole pixel of 'refillMask' must be a hole of 'newMask'. */
+static bool IsInsideHole(const Mask* const refillMask, const Mask* const newMask)
+{
+  itk::ImageRegionConstIteratorWithIndex<Mask> maskIterator(refillMask, refillMask->GetLargestPossibleRegion());
+  while(!maskIterator.IsAtEnd())
+  {
+    if(refillMask->IsHole(maskIterator.GetIndex()) && !newMask->IsHole(maskIterator.GetIndex()))
+    {
+      return false;
+    }
+    ++maskIterator;
+  }
+  return true;
+}
+
+int main(int, char*[])
+{
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{20, 20}};
+  itk::ImageRegion<2> fullRegion(corner, size);
+
+  // A 4x4 hole from (8,8) to (11,11), filled row by row with 3x3 patches copied from around (3,3)
+  itk::Index<2> holeCorner = {{8, 8}};
+  itk::Size<2> holeSize = {{4, 4}};
+  itk::ImageRegion<2> holeRegion(holeCorner, holeSize);
+  Mask::Pointer oldMask = CreateMask(fullRegion, holeRegion);
+
+  const std::string fillLogFileName = "TestIncrementalFill.fill";
+  {
+    FillLogWriter writer(fillLogFileName, fullRegion, 1, 0);
+    for(int y = 8; y < 12; ++y)
+    {
+      for(int x = 8; x < 12; ++x)
+      {
+        itk::Index<2> target = {{x, y}};
+        itk::Index<2> source = {{x - 5, y - 5}};
+        writer.Write(target, source);
+      }
+    }
+    writer.Close();
+  }
+  FillLogReader fillLog(fillLogFileName);
+  std::remove(fillLogFileName.c_str());
+
+  Mask::Pointer refillMask = Mask::New();
+  std::vector<bool> keptRecords;
+
+  // An unchanged mask keeps everything
+  std::size_t numberOfKeptRecords = IncrementalFill::FindRefillRegion(fillLog, oldMask, oldMask, refillMask,
+                                                                      keptRecords);
+  if(numberOfKeptRecords != 16 || CountHoles(refillMask) != 0)
+  {
+    std::cerr << "With the same mask, " << numberOfKeptRecords << " of 16 patches were kept and "
+              << CountHoles(refillMask) << " pixels must be refilled." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Shrinking the hole keeps everything
+  itk::Index<2> shrunkHoleCorner = {{9, 8}};
+  itk::Size<2> shrunkHoleSize = {{3, 4}};
+  Mask::Pointer shrunkMask = CreateMask(fullRegion, itk::ImageRegion<2>(shrunkHoleCorner, shrunkHoleSize));
+  numberOfKeptRecords = IncrementalFill::FindRefillRegion(fillLog, oldMask, shrunkMask, refillMask, keptRecords);
+  if(numberOfKeptRecords != 16 || CountHoles(refillMask) != 0)
+  {
+    std::cerr << "With a smaller hole, " << numberOfKeptRecords << " of 16 patches were kept and "
+              << CountHoles(refillMask) << " pixels must be refilled." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Growing the hole to the right redoes the patches whose target touches the new column, and those that depend on
+  // them, but the first patch (which only touches the top left of the hole) is kept
+  itk::Size<2> grownHoleSize = {{5, 4}};
+  Mask::Pointer grownMask = CreateMask(fullRegion, itk::ImageRegion<2>(holeCorner, grownHoleSize));
+  numberOfKeptRecords = IncrementalFill::FindRefillRegion(fillLog, oldMask, grownMask, refillMask, keptRecords);
+  itk::Index<2> newColumnPixel = {{12, 9}};
+  if(numberOfKeptRecords == 0 || numberOfKeptRecords == 16 || !keptRecords[0] || keptRecords[3] ||
+     !refillMask->IsHole(newColumnPixel) || !IsInsideHole(refillMask, grownMask))
+  {
+    std::cerr << "With a larger hole, " << numberOfKeptRecords << " of 16 patches were kept." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Covering a pixel that the first patch was copied from redoes the first patch
+  itk::Index<2> sourcePixelHoleCorner = {{2, 2}};
+  itk::Size<2> onePixel = {{1, 1}};
+  Mask::Pointer sourceHoleMask = CreateMask(fullRegion, itk::ImageRegion<2>(sourcePixelHoleCorner, onePixel));
+  itk::ImageRegionConstIteratorWithIndex<Mask> holeIterator(oldMask, holeRegion);
+  while(!holeIterator.IsAtEnd())
+  {
+    sourceHoleMask->SetPixel(holeIterator.GetIndex(), sourceHoleMask->GetHoleValue());
+    ++holeIterator;
+  }
+
+  numberOfKeptRecords = IncrementalFill::FindRefillRegion(fillLog, oldMask, sourceHoleMask, refillMask, keptRecords);
+  itk::Index<2> firstFilledPixel = {{8, 8}};
+  if(keptRecords[0] || !refillMask->IsHole(sourcePixelHoleCorner) || !refillMask->IsHole(firstFilledPixel) ||
+     !IsInsideHole(refillMask, sourceHoleMask))
+  {
+    std::cerr << "A patch whose source was covered was kept." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "AsyncImageWriter.h"
+
+// STL
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+AsyncImageWriter& AsyncImageWriter::GetInstance()
+{
+  static AsyncImageWriter instance;
+  return instance;
+}
+
+AsyncImageWriter::AsyncImageWriter(const unsigned int maxQueueSize) : MaxQueueSize(std::max(maxQueueSize, 1u))
+{
+
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->Stop = true;
+  }
+  this->JobAvailable.notify_all();
+
+  // The writer thread finishes the jobs that are still queued before it exits.
+  if(this->WriterThread.joinable())
+  {
+    this->WriterThread.join();
+  }
+
+  if(this->NumberOfDroppedImages > 0 || this->NumberOfFailedImages > 0)
+  {
+    std::cout << "AsyncImageWriter: wrote " << this->NumberOfWrittenImages << " images, dropped "
+              << this->NumberOfDroppedImages << " and failed to write " << this->NumberOfFailedImages << "."
+              << std::endl;
+  }
+}
+
+void AsyncImageWriter::SetMaxQueueSize(const unsigned int maxQueueSize)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->MaxQueueSize = std::max(maxQueueSize, 1u);
+}
+
+void AsyncImageWriter::SetBackPressurePolicy(const BackPressurePolicyEnum policy)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->BackPressurePolicy = policy;
+}
+
+void AsyncImageWriter::SetSampleInterval(const unsigned int sampleInterval)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->SampleInterval = std::max(sampleInterval, 1u);
+}
+
+void AsyncImageWriter::SetCompressionLevel(const int compressionLevel)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->CompressionLevel = compressionLevel;
+}
+
+int AsyncImageWriter::GetCompressionLevel() const
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  return this->CompressionLevel;
+}
+
+void AsyncImageWriter::SetAsynchronous(const bool asynchronous)
+{
+  Flush();
+
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->Asynchronous = asynchronous;
+}
+
+void AsyncImageWriter::Flush()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->JobFinished.wait(lock, [this]{return this->Jobs.empty() && this->NumberOfActiveJobs == 0;});
+}
+
+unsigned int AsyncImageWriter::GetNumberOfWrittenImages() const
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  return this->NumberOfWrittenImages;
+}
+
+unsigned int AsyncImageWriter::GetNumberOfDroppedImages() const
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  return this->NumberOfDroppedImages;
+}
+
+unsigned int AsyncImageWriter::GetNumberOfFailedImages() const
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  return this->NumberOfFailedImages;
+}
+
+bool AsyncImageWriter::AcceptRequest(const unsigned int iteration)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+
+  if(!this->Asynchronous)
+  {
+    return true;
+  }
+
+  if(this->BackPressurePolicy == SAMPLE && iteration % this->SampleInterval != 0)
+  {
+    this->NumberOfDroppedImages++;
+    return false;
+  }
+
+  if(this->Jobs.size() >= this->MaxQueueSize)
+  {
+    if(this->BackPressurePolicy == DROP)
+    {
+      this->NumberOfDroppedImages++;
+      return false;
+    }
+
+    // BLOCK and SAMPLE wait for room
+    this->JobFinished.wait(lock, [this]{return this->Jobs.size() < this->MaxQueueSize;});
+  }
+
+  return true;
+}
+
+void AsyncImageWriter::Enqueue(const std::function<void()>& job)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+
+  if(!this->Asynchronous)
+  {
+    lock.unlock();
+    bool written = RunJob(job);
+    lock.lock();
+    CountJob(written);
+    return;
+  }
+
+  if(!this->WriterThread.joinable())
+  {
+    this->WriterThread = std::thread(&AsyncImageWriter::Run, this);
+  }
+
+  this->Jobs.push_back(job);
+  lock.unlock();
+
+  this->JobAvailable.notify_one();
+}
+
+void AsyncImageWriter::Run()
+{
+  while(true)
+  {
+    std::function<void()> job;
+
+    {
+      std::unique_lock<std::mutex> lock(this->Mutex);
+      this->JobAvailable.wait(lock, [this]{return this->Stop || !this->Jobs.empty();});
+
+      if(this->Jobs.empty()) // Only true if we are stopping
+      {
+        return;
+      }
+
+      job = this->Jobs.front();
+      this->Jobs.pop_front();
+      this->NumberOfActiveJobs++;
+    }
+
+    // There is now room in the queue
+    this->JobFinished.notify_all();
+
+    bool written = RunJob(job);
+
+    {
+      std::unique_lock<std::mutex> lock(this->Mutex);
+      this->NumberOfActiveJobs--;
+      CountJob(written);
+    }
+
+    this->JobFinished.notify_all();
+  }
+}
+
+bool AsyncImageWriter::RunJob(const std::function<void()>& job)
+{
+  // An exception cannot be passed back to the thread that made the request, so just report it.
+  try
+  {
+    job();
+    return true;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "AsyncImageWriter: failed to write an image: " << e.what() << std::endl;
+  }
+  catch (...)
+  {
+    std::cerr << "AsyncImageWriter: failed to write an image." << std::endl;
+  }
+
+  return false;
+}
+
+void AsyncImageWriter::CountJob(const bool written)
+{
+  if(written)
+  {
+    this->NumberOfWrittenImages++;
+  }
+  else
+  {
+    this->NumberOfFailedImages++;
+  }
+}
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef AsyncImageWriter_H
+#define AsyncImageWriter_H
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+\class AsyncImageWriter
+\brief This class writes debug/iteration images on a background thread so that
+       the inpainting loop does not wait on the disk or the png encoder.
+
+       Each request takes a snapshot of the image (or of only the requested region)
+       on the calling thread, so the caller is free to keep modifying the image
+       immediately. The snapshots wait in a bounded queue. When the queue is full,
+       the BackPressurePolicy decides what happens to new requests:
+       - BLOCK: wait for the writer thread to make room (nothing is lost).
+       - DROP: discard the request (the snapshot is never made).
+       - SAMPLE: only accept requests whose iteration is a multiple of SampleInterval,
+                 and block if the queue is still full. Images from the same iteration are
+                 kept or discarded together.
+
+       Use GetInstance() to share one writer between all of the classes that write debug images.
+*/
+class AsyncImageWriter
+{
+public:
+
+  enum BackPressurePolicyEnum {BLOCK, DROP, SAMPLE};
+
+  /** Get the writer that is shared by the whole program. */
+  static AsyncImageWriter& GetInstance();
+
+  /** A maxQueueSize of 0 is treated as 1. */
+  AsyncImageWriter(const unsigned int maxQueueSize = 16);
+
+  /** Write everything that is still queued and stop the writer thread. */
+  ~AsyncImageWriter();
+
+  /** Set the maximum number of snapshots that can be waiting to be written (at least 1). */
+  void SetMaxQueueSize(const unsigned int maxQueueSize);
+
+  void SetBackPressurePolicy(const BackPressurePolicyEnum policy);
+
+  /** Set N for the SAMPLE policy (only every Nth iteration is written). */
+  void SetSampleInterval(const unsigned int sampleInterval);
+
+  /** Set the compression level (0-9) used by the writer. 0 disables compression and a negative value uses the
+    * file format's default. ITK < 5 can only turn compression on or off. This only applies to images that can be
+    * written directly (not to the RGB conversion fallback). */
+  void SetCompressionLevel(const int compressionLevel);
+
+  int GetCompressionLevel() const;
+
+  /** If this is false, images are written immediately on the calling thread (the old behavior). */
+  void SetAsynchronous(const bool asynchronous);
+
+  /** Block until all of the queued images have been written. */
+  void Flush();
+
+  /** Get the number of images that have been written successfully. */
+  unsigned int GetNumberOfWrittenImages() const;
+
+  /** Get the number of images whose write threw an exception. */
+  unsigned int GetNumberOfFailedImages() const;
+
+  /** Get the number of requests that were discarded because of the BackPressurePolicy. */
+  unsigned int GetNumberOfDroppedImages() const;
+
+  /** Write 'image' to prefix_iteration.extension. If the image cannot be written directly in this format
+    * (e.g. a float image as png), it is converted to RGB. */
+  template <typename TImage>
+  void WriteSequentialImage(const TImage* const image, const std::string& prefix, const unsigned int iteration,
+                            const unsigned int iterationLength, const std::string& extension);
+
+  /** Write 'image' to prefix_iteration.extension as an RGB image. */
+  template <typename TImage>
+  void WriteSequentialRGBImage(const TImage* const image, const std::string& prefix, const unsigned int iteration,
+                               const unsigned int iterationLength, const std::string& extension);
+
+  /** Write 'region' of 'image' to prefix_iteration.extension. Only the region is copied into the snapshot. */
+  template <typename TImage>
+  void WriteSequentialRegion(const TImage* const image, const itk::ImageRegion<2>& region,
+                             const std::string& prefix, const unsigned int iteration,
+                             const unsigned int iterationLength, const std::string& extension);
+
+private:
+
+  /** Copy 'region' of 'image' into a new image. */
+  template <typename TImage>
+  static typename TImage::Pointer CreateSnapshot(const TImage* const image, const itk::ImageRegion<2>& region);
+
+  /** Write 'image' with 'compressionLevel'. If 'rgb' is true, or if the image cannot be written directly,
+    * it is converted to RGB. This is called on the writer thread. */
+  template <typename TImage>
+  static void WriteSnapshot(const TImage* const image, const std::string& fileName,
+                            const int compressionLevel, const bool rgb);
+
+  /** Decide if a request for 'iteration' should be written at all, waiting for room in the queue if
+    * the policy requires it. */
+  bool AcceptRequest(const unsigned int iteration);
+
+  /** Add a job to the queue, or run it immediately if the writer is not asynchronous. */
+  void Enqueue(const std::function<void()>& job);
+
+  /** The loop that the writer thread runs. */
+  void Run();
+
+  /** Run 'job', reporting any exception it throws. Returns true if the image was written. */
+  static bool RunJob(const std::function<void()>& job);
+
+  /** Add a finished job to the written or the failed count. The mutex must be held. */
+  void CountJob(const bool written);
+
+  std::deque<std::function<void()> > Jobs;
+
+  /** The number of jobs that have been removed from the queue but are still being written. */
+  unsigned int NumberOfActiveJobs = 0;
+
+  unsigned int MaxQueueSize;
+
+  BackPressurePolicyEnum BackPressurePolicy = BLOCK;
+
+  unsigned int SampleInterval = 1;
+
+  int CompressionLevel = -1;
+
+  bool Asynchronous = true;
+
+  unsigned int NumberOfWrittenImages = 0;
+
+  unsigned int NumberOfDroppedImages = 0;
+
+  unsigned int NumberOfFailedImages = 0;
+
+  bool Stop = false;
+
+  mutable std::mutex Mutex;
+
+  /** Signaled when a job is added (or the writer is stopping). */
+  std::condition_variable JobAvailable;
+
+  /** Signaled when a job is removed from the queue and when it is finished. */
+  std::condition_variable JobFinished;
+
+  /** The writer thread is only started when the first job arrives. */
+  std::thread WriterThread;
+};
+
+#include "AsyncImageWriter.hpp"
+
+#endif
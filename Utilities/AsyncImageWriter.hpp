@@ -0,0 +1,142 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef AsyncImageWriter_HPP
+#define AsyncImageWriter_HPP
+
+#include "AsyncImageWriter.h"
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKHelpers.h>
+
+// ITK
+#include "itkImageAlgorithm.h"
+#include "itkImageFileWriter.h"
+#include "itkVersion.h"
+
+template <typename TImage>
+void AsyncImageWriter::WriteSequentialImage(const TImage* const image, const std::string& prefix,
+                                            const unsigned int iteration, const unsigned int iterationLength,
+                                            const std::string& extension)
+{
+  if(!AcceptRequest(iteration))
+  {
+    return;
+  }
+
+  typename TImage::Pointer snapshot = CreateSnapshot(image, image->GetLargestPossibleRegion());
+  std::string fileName = Helpers::GetSequentialFileName(prefix, iteration, extension, iterationLength);
+  int compressionLevel = GetCompressionLevel();
+
+  Enqueue([snapshot, fileName, compressionLevel]()
+          {
+            WriteSnapshot(snapshot.GetPointer(), fileName, compressionLevel, false);
+          });
+}
+
+template <typename TImage>
+void AsyncImageWriter::WriteSequentialRGBImage(const TImage* const image, const std::string& prefix,
+                                               const unsigned int iteration, const unsigned int iterationLength,
+                                               const std::string& extension)
+{
+  if(!AcceptRequest(iteration))
+  {
+    return;
+  }
+
+  typename TImage::Pointer snapshot = CreateSnapshot(image, image->GetLargestPossibleRegion());
+  std::string fileName = Helpers::GetSequentialFileName(prefix, iteration, extension, iterationLength);
+  int compressionLevel = GetCompressionLevel();
+
+  Enqueue([snapshot, fileName, compressionLevel]()
+          {
+            WriteSnapshot(snapshot.GetPointer(), fileName, compressionLevel, true);
+          });
+}
+
+template <typename TImage>
+void AsyncImageWriter::WriteSequentialRegion(const TImage* const image, const itk::ImageRegion<2>& region,
+                                             const std::string& prefix, const unsigned int iteration,
+                                             const unsigned int iterationLength, const std::string& extension)
+{
+  if(!AcceptRequest(iteration))
+  {
+    return;
+  }
+
+  itk::ImageRegion<2> croppedRegion = region;
+  croppedRegion.Crop(image->GetLargestPossibleRegion());
+
+  // The snapshot only contains the region, so writing the whole snapshot writes the region.
+  typename TImage::Pointer snapshot = CreateSnapshot(image, croppedRegion);
+  std::string fileName = Helpers::GetSequentialFileName(prefix, iteration, extension, iterationLength);
+  int compressionLevel = GetCompressionLevel();
+
+  Enqueue([snapshot, fileName, compressionLevel]()
+          {
+            WriteSnapshot(snapshot.GetPointer(), fileName, compressionLevel, false);
+          });
+}
+
+template <typename TImage>
+typename TImage::Pointer AsyncImageWriter::CreateSnapshot(const TImage* const image,
+                                                          const itk::ImageRegion<2>& region)
+{
+  typename TImage::Pointer snapshot = TImage::New();
+  snapshot->CopyInformation(image); // Spacing, origin, and the number of components (for VectorImage)
+  snapshot->SetRegions(region);
+  snapshot->Allocate();
+
+  itk::ImageAlgorithm::Copy(image, snapshot.GetPointer(), region, region);
+
+  return snapshot;
+}
+
+template <typename TImage>
+void AsyncImageWriter::WriteSnapshot(const TImage* const image, const std::string& fileName,
+                                     const int compressionLevel, const bool rgb)
+{
+  if(!rgb)
+  {
+    try
+    {
+      typedef itk::ImageFileWriter<TImage> WriterType;
+      typename WriterType::Pointer writer = WriterType::New();
+      writer->SetFileName(fileName);
+      writer->SetInput(image);
+      writer->SetUseCompression(compressionLevel != 0);
+#if ITK_VERSION_MAJOR >= 5
+      if(compressionLevel > 0)
+      {
+        writer->SetCompressionLevel(compressionLevel);
+      }
+#endif
+      writer->Update();
+      return;
+    }
+    catch (...)
+    {
+      // The pixel type is not supported by this file format, so fall back to an RGB conversion.
+    }
+  }
+
+  ITKHelpers::WriteRGBImage(image, fileName);
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "BatchManifest.h"
+
+// Boost
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+// STL
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace BatchManifest
+{
+
+namespace
+{
+
+std::string Trim(const std::string& s)
+{
+  const std::string whitespace = " \t\r\n";
+  std::size_t first = s.find_first_not_of(whitespace);
+  if(first == std::string::npos)
+  {
+    return "";
+  }
+  std::size_t last = s.find_last_not_of(whitespace);
+  return s.substr(first, last - first + 1);
+}
+
+std::vector<std::string> SplitCSVLine(const std::string& line)
+{
+  std::vector<std::string> fields;
+  std::stringstream ss(line);
+  std::string field;
+  while(std::getline(ss, field, ','))
+  {
+    fields.push_back(Trim(field));
+  }
+
+  // getline() does not produce the empty field after a trailing comma
+  if(!line.empty() && line[line.size() - 1] == ',')
+  {
+    fields.push_back("");
+  }
+  return fields;
+}
+
+unsigned int ParseUnsigned(const std::map<std::string, std::string>& values, const std::string& key,
+                           const unsigned int defaultValue, const std::string& description)
+{
+  std::map<std::string, std::string>::const_iterator iterator = values.find(key);
+  if(iterator == values.end() || iterator->second.empty())
+  {
+    return defaultValue;
+  }
+
+  std::stringstream ss(iterator->second);
+  unsigned int value = 0;
+  std::string rest;
+  if(iterator->second[0] == '-' || !(ss >> value) || (ss >> rest))
+  {
+    throw std::runtime_error(description + ": '" + key + "' must be a non-negative integer, but it is '" +
+                             iterator->second + "'");
+  }
+  return value;
+}
+
+std::string GetRequired(const std::map<std::string, std::string>& values, const std::string& key,
+                        const std::string& description)
+{
+  std::map<std::string, std::string>::const_iterator iterator = values.find(key);
+  if(iterator == values.end() || iterator->second.empty())
+  {
+    throw std::runtime_error(description + ": '" + key + "' is required");
+  }
+  return iterator->second;
+}
+
+} // end anonymous namespace
+
+std::vector<BatchJob> Read(const std::string& fileName)
+{
+  std::ifstream stream(fileName.c_str());
+  if(!stream)
+  {
+    throw std::runtime_error("BatchManifest::Read: cannot open " + fileName);
+  }
+
+  const std::string jsonExtension = ".json";
+  if(fileName.size() >= jsonExtension.size() &&
+     fileName.compare(fileName.size() - jsonExtension.size(), jsonExtension.size(), jsonExtension) == 0)
+  {
+    return ReadJSON(stream);
+  }
+
+  return ReadCSV(stream);
+}
+
+std::vector<BatchJob> ReadCSV(std::istream& stream)
+{
+  std::vector<BatchJob> jobs;
+  std::vector<std::string> columns;
+
+  std::string line;
+  unsigned int lineNumber = 0;
+  while(std::getline(stream, line))
+  {
+    lineNumber++;
+    line = Trim(line);
+    if(line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+
+    std::vector<std::string> fields = SplitCSVLine(line);
+
+    if(columns.empty())
+    {
+      columns = fields;
+      continue;
+    }
+
+    std::stringstream description;
+    description << "manifest line " << lineNumber;
+
+    if(fields.size() != columns.size())
+    {
+      std::stringstream error;
+      error << description.str() << ": expected " << columns.size() << " fields, but there are " << fields.size();
+      throw std::runtime_error(error.str());
+    }
+
+    std::map<std::string, std::string> values;
+    for(std::size_t i = 0; i < columns.size(); ++i)
+    {
+      values[columns[i]] = fields[i];
+    }
+
+    jobs.push_back(CreateJob(values, description.str()));
+  }
+
+  return jobs;
+}
+
+std::vector<BatchJob> ReadJSON(std::istream& stream)
+{
+  boost::property_tree::ptree tree;
+  try
+  {
+    boost::property_tree::read_json(stream, tree);
+  }
+  catch(const boost::property_tree::json_parser_error& error)
+  {
+    throw std::runtime_error(std::string("manifest: ") + error.what());
+  }
+
+  std::vector<BatchJob> jobs;
+  for(boost::property_tree::ptree::const_iterator jobIterator = tree.begin(); jobIterator != tree.end(); ++jobIterator)
+  {
+    std::stringstream description;
+    description << "manifest job " << jobs.size();
+
+    std::map<std::string, std::string> values;
+    for(boost::property_tree::ptree::const_iterator valueIterator = jobIterator->second.begin();
+        valueIterator != jobIterator->second.end(); ++valueIterator)
+    {
+      values[valueIterator->first] = valueIterator->second.data();
+    }
+
+    jobs.push_back(CreateJob(values, description.str()));
+  }
+
+  return jobs;
+}
+
+BatchJob CreateJob(const std::map<std::string, std::string>& values, const std::string& description)
+{
+  BatchJob job;
+  job.ImageFileName = GetRequired(values, "image", description);
+  job.MaskFileName = GetRequired(values, "mask", description);
+  job.OutputFileName = GetRequired(values, "output", description);
+
+  job.PatchHalfWidth = ParseUnsigned(values, "radius", 0, description);
+  if(job.PatchHalfWidth == 0)
+  {
+    throw std::runtime_error(description + ": 'radius' (the patch half width) is required and must be positive");
+  }
+
+  std::map<std::string, std::string>::const_iterator driverIterator = values.find("driver");
+  if(driverIterator != values.end() && !driverIterator->second.empty())
+  {
+    job.Driver = driverIterator->second;
+  }
+
+  if(job.Driver != "classical" && job.Driver != "pyramid")
+  {
+    throw std::runtime_error(description + ": unknown driver '" + job.Driver +
+                             "' (expected 'classical' or 'pyramid')");
+  }
+
+  job.NumberOfPyramidLevels = ParseUnsigned(values, "levels", job.NumberOfPyramidLevels, description);
+  job.PyramidSearchRadius = ParseUnsigned(values, "pyramidSearchRadius", job.PyramidSearchRadius, description);
+  job.WorkingSetSearchRadius = ParseUnsigned(values, "workingSetSearchRadius", job.WorkingSetSearchRadius,
+                                             description);
+
+  return job;
+}
+
+void DivideThreads(const unsigned int numberOfThreads, const unsigned int numberOfJobs,
+                   unsigned int& numberOfWorkers, unsigned int& threadsPerJob)
+{
+  const unsigned int threadBudget = std::max(numberOfThreads, 1u);
+
+  numberOfWorkers = std::min(numberOfWorkers, std::min(numberOfJobs, threadBudget));
+  numberOfWorkers = std::max(numberOfWorkers, 1u);
+
+  threadsPerJob = std::max(threadBudget / numberOfWorkers, 1u);
+}
+
+} // end namespace
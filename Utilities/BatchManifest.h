@@ -0,0 +1,84 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef BatchManifest_H
+#define BatchManifest_H
+
+// STL
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+/** One image/mask pair to inpaint in a batch (see BatchInpainting.cpp). */
+struct BatchJob
+{
+  std::string ImageFileName;
+  std::string MaskFileName;
+  unsigned int PatchHalfWidth = 0;
+
+  /** "classical" (ClassicalImageInpainting) or "pyramid" (PyramidInpainting). */
+  std::string Driver = "classical";
+
+  std::string OutputFileName;
+
+  /** Only used by the "pyramid" driver. */
+  unsigned int NumberOfPyramidLevels = 3;
+  unsigned int PyramidSearchRadius = 4;
+
+  /** 0 means the whole image is inpainted, otherwise see WorkingSet::GetWorkingRegion(). */
+  unsigned int WorkingSetSearchRadius = 0;
+};
+
+/** Functions to read the list of jobs of a batch. A manifest is either a CSV file, whose first line names the
+  * columns, e.g.
+  *
+  *   image,mask,radius,driver,output
+  *   Data/trashcan.png,Data/trashcan.mask,15,classical,trashcan_filled.png
+  *
+  * or a JSON file (".json") holding an array of objects with the same keys, e.g.
+  *
+  *   [ { "image": "Data/trashcan.png", "mask": "Data/trashcan.mask", "radius": 15,
+  *       "driver": "pyramid", "levels": 3, "output": "trashcan_filled.png" } ]
+  *
+  * The keys "image", "mask", "radius" (the patch half width) and "output" are required. "driver" (default "classical"),
+  * "levels", "pyramidSearchRadius" and "workingSetSearchRadius" are optional. Blank CSV lines and lines starting
+  * with '#' are skipped. Errors are reported by throwing std::runtime_error.
+  */
+namespace BatchManifest
+{
+
+/** Read a manifest file, as JSON if its extension is ".json" and as CSV otherwise. */
+std::vector<BatchJob> Read(const std::string& fileName);
+
+std::vector<BatchJob> ReadCSV(std::istream& stream);
+
+std::vector<BatchJob> ReadJSON(std::istream& stream);
+
+/** Create a job from its key/value pairs. 'description' is used in error messages. */
+BatchJob CreateJob(const std::map<std::string, std::string>& values, const std::string& description);
+
+/** Split a budget of 'numberOfThreads' threads between at most 'numberOfWorkers' concurrent jobs. The number of
+  * workers is clamped to [1, min(numberOfJobs, numberOfThreads)] and every worker gets the same number
+  * of threads (at least 1) to use inside its job. */
+void DivideThreads(const unsigned int numberOfThreads, const unsigned int numberOfJobs,
+                   unsigned int& numberOfWorkers, unsigned int& threadsPerJob);
+
+} // end namespace
+
+#endif
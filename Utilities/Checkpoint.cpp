@@ -0,0 +1,307 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "Checkpoint.h"
+
+// STL
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+  const char Magic[8] = {'P', 'B', 'I', 'C', 'K', 'P', 'T', '\0'};
+  const std::uint32_t Version = 1;
+
+  /** The layout of a stored region. */
+  struct StoredRegion
+  {
+    std::int64_t Index[2];
+    std::uint64_t Size[2];
+  };
+}
+
+void Checkpoint::AddData(const std::string& name, const void* const data, const std::size_t numberOfBytes)
+{
+  const char* bytes = static_cast<const char*>(data);
+  this->Sections[name].assign(bytes, bytes + numberOfBytes);
+}
+
+bool Checkpoint::HasData(const std::string& name) const
+{
+  return this->Sections.find(name) != this->Sections.end();
+}
+
+const std::vector<char>& Checkpoint::GetData(const std::string& name) const
+{
+  std::map<std::string, std::vector<char> >::const_iterator iterator = this->Sections.find(name);
+  if(iterator == this->Sections.end())
+  {
+    throw std::runtime_error("Checkpoint::GetData: there is no section " + name + "!");
+  }
+  return iterator->second;
+}
+
+void Checkpoint::AddPixelBitmap(const std::string& name, const PixelBitmap& pixelBitmap)
+{
+  AddRegion(name + ".Region", pixelBitmap.GetRegion());
+  AddVector(name, pixelBitmap.GetWords());
+}
+
+void Checkpoint::GetPixelBitmap(const std::string& name, PixelBitmap& pixelBitmap) const
+{
+  CheckRegion(name + ".Region", pixelBitmap.GetRegion());
+  pixelBitmap.SetWords(GetVector<PixelBitmap::WordType>(name));
+}
+
+std::size_t Checkpoint::GetNumberOfBytes() const
+{
+  std::size_t numberOfBytes = 0;
+  for(std::map<std::string, std::vector<char> >::const_iterator iterator = this->Sections.begin();
+      iterator != this->Sections.end(); ++iterator)
+  {
+    numberOfBytes += iterator->second.size();
+  }
+  return numberOfBytes;
+}
+
+void Checkpoint::Write(const std::string& fileName) const
+{
+  std::string temporaryFileName = fileName + ".tmp";
+
+  {
+  std::ofstream file(temporaryFileName.c_str(), std::ios::binary | std::ios::trunc);
+  if(!file)
+  {
+    throw std::runtime_error("Checkpoint::Write: could not open " + temporaryFileName + "!");
+  }
+
+  std::uint32_t numberOfSections = static_cast<std::uint32_t>(this->Sections.size());
+  file.write(Magic, sizeof(Magic));
+  file.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+  file.write(reinterpret_cast<const char*>(&numberOfSections), sizeof(numberOfSections));
+
+  for(std::map<std::string, std::vector<char> >::const_iterator iterator = this->Sections.begin();
+      iterator != this->Sections.end(); ++iterator)
+  {
+    std::uint32_t nameLength = static_cast<std::uint32_t>(iterator->first.size());
+    std::uint64_t dataLength = iterator->second.size();
+    file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+    file.write(iterator->first.data(), nameLength);
+    file.write(reinterpret_cast<const char*>(&dataLength), sizeof(dataLength));
+    file.write(iterator->second.data(), static_cast<std::streamsize>(dataLength));
+  }
+
+  file.flush();
+  if(!file)
+  {
+    throw std::runtime_error("Checkpoint::Write: could not write " + temporaryFileName + "!");
+  }
+  }
+
+  if(std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+  {
+    throw std::runtime_error("Checkpoint::Write: could not replace " + fileName + "!");
+  }
+}
+
+void Checkpoint::Read(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  if(!file)
+  {
+    throw std::runtime_error("Checkpoint::Read: could not open " + fileName + "!");
+  }
+
+  char magic[sizeof(Magic)];
+  std::uint32_t version = 0;
+  std::uint32_t numberOfSections = 0;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char*>(&version), sizeof(version));
+  file.read(reinterpret_cast<char*>(&numberOfSections), sizeof(numberOfSections));
+  if(!file || std::memcmp(magic, Magic, sizeof(Magic)) != 0)
+  {
+    throw std::runtime_error("Checkpoint::Read: " + fileName + " is not a checkpoint!");
+  }
+
+  if(version != Version)
+  {
+    std::stringstream ss;
+    ss << "Checkpoint::Read: " << fileName << " has version " << version << " but version " << Version
+       << " is required!";
+    throw std::runtime_error(ss.str());
+  }
+
+  // The lengths are checked against the rest of the file before allocating, so a corrupt length can not make us
+  // allocate gigabytes.
+  const std::streamoff headerEnd = file.tellg();
+  file.seekg(0, std::ios::end);
+  const std::streamoff fileSize = file.tellg();
+  file.seekg(headerEnd);
+  if(!file)
+  {
+    throw std::runtime_error("Checkpoint::Read: could not determine the size of " + fileName + "!");
+  }
+
+  this->Sections.clear();
+  for(std::uint32_t sectionId = 0; sectionId < numberOfSections; ++sectionId)
+  {
+    std::uint32_t nameLength = 0;
+    file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+    if(!file || nameLength > static_cast<std::uint64_t>(fileSize - file.tellg()))
+    {
+      throw std::runtime_error("Checkpoint::Read: " + fileName + " is truncated!");
+    }
+
+    std::string name(nameLength, '\0');
+    file.read(&name[0], nameLength);
+    if(!file)
+    {
+      throw std::runtime_error("Checkpoint::Read: " + fileName + " is truncated!");
+    }
+
+    std::uint64_t dataLength = 0;
+    file.read(reinterpret_cast<char*>(&dataLength), sizeof(dataLength));
+    if(!file || dataLength > static_cast<std::uint64_t>(fileSize - file.tellg()))
+    {
+      throw std::runtime_error("Checkpoint::Read: " + fileName + " is truncated!");
+    }
+
+    std::vector<char>& data = this->Sections[name];
+    data.resize(dataLength);
+    file.read(data.data(), static_cast<std::streamsize>(dataLength));
+    if(!file)
+    {
+      throw std::runtime_error("Checkpoint::Read: " + fileName + " is truncated!");
+    }
+  }
+}
+
+bool Checkpoint::IsCheckpoint(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  char magic[sizeof(Magic)];
+  file.read(magic, sizeof(magic));
+  return file && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+void Checkpoint::AddRegion(const std::string& name, const itk::ImageRegion<2>& region)
+{
+  StoredRegion storedRegion;
+  for(unsigned int dimension = 0; dimension < 2; ++dimension)
+  {
+    storedRegion.Index[dimension] = region.GetIndex()[dimension];
+    storedRegion.Size[dimension] = region.GetSize()[dimension];
+  }
+  AddValue(name, storedRegion);
+}
+
+void Checkpoint::CheckRegion(const std::string& name, const itk::ImageRegion<2>& region) const
+{
+  StoredRegion storedRegion = GetValue<StoredRegion>(name);
+  for(unsigned int dimension = 0; dimension < 2; ++dimension)
+  {
+    if(storedRegion.Index[dimension] != region.GetIndex()[dimension] ||
+       storedRegion.Size[dimension] != region.GetSize()[dimension])
+    {
+      std::stringstream ss;
+      ss << "Checkpoint: " << name << " is (" << storedRegion.Index[0] << ", " << storedRegion.Index[1] << ") "
+         << storedRegion.Size[0] << "x" << storedRegion.Size[1] << " but the region to load into is ("
+         << region.GetIndex()[0] << ", " << region.GetIndex()[1] << ") " << region.GetSize()[0] << "x"
+         << region.GetSize()[1] << "!";
+      throw std::runtime_error(ss.str());
+    }
+  }
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& fileName) : FileName(fileName)
+{
+  this->Thread = std::thread(&CheckpointWriter::Run, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+  {
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->Stop = true;
+  }
+  this->Condition.notify_all();
+  this->Thread.join();
+}
+
+void CheckpointWriter::Submit(std::unique_ptr<Checkpoint> checkpoint)
+{
+  {
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->Waiting = std::move(checkpoint);
+  }
+  this->Condition.notify_all();
+}
+
+void CheckpointWriter::Flush()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->Condition.wait(lock, [this]{ return !this->Waiting && !this->Writing; });
+}
+
+const std::string& CheckpointWriter::GetFileName() const
+{
+  return this->FileName;
+}
+
+unsigned int CheckpointWriter::GetNumberOfCheckpointsWritten() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->NumberOfCheckpointsWritten;
+}
+
+void CheckpointWriter::Run()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  while(true)
+  {
+    this->Condition.wait(lock, [this]{ return this->Waiting || this->Stop; });
+    if(!this->Waiting)
+    {
+      return; // Stopped, and everything has been written
+    }
+
+    std::unique_ptr<Checkpoint> checkpoint = std::move(this->Waiting);
+    this->Writing = true;
+    lock.unlock();
+
+    bool written = false;
+    try
+    {
+      checkpoint->Write(this->FileName);
+      written = true;
+    }
+    catch(const std::exception& e)
+    {
+      std::cerr << "CheckpointWriter: " << e.what() << std::endl;
+    }
+
+    lock.lock();
+    this->Writing = false;
+    if(written)
+    {
+      this->NumberOfCheckpointsWritten++;
+    }
+    this->Condition.notify_all();
+  }
+}
@@ -0,0 +1,179 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef Checkpoint_H
+#define Checkpoint_H
+
+// Custom
+#include "PixelBitmap.h"
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+\class Checkpoint
+\brief This class holds a snapshot of the state of an inpainting run as a set of named binary sections,
+       so that the run can be resumed later (see CheckpointVisitor).
+
+       Each stateful part of the algorithm adds its own sections (e.g. PriorityConfidence::SaveState(),
+       IndirectPriorityQueue::SaveState(), InpaintingVisitor::SaveState()) and reads them back in LoadState().
+       Images are stored as their raw pixel buffers, so a section can only be loaded into an image of
+       the same region and pixel type.
+
+       File layout (native byte order): the 8 byte magic "PBICKPT", a uint32 version and a uint32 number of
+       sections, then for each section a uint32 name length, the name, a uint64 data length and the data.
+*/
+class Checkpoint
+{
+public:
+
+  /** Add (or replace) the section 'name'. */
+  void AddData(const std::string& name, const void* const data, const std::size_t numberOfBytes);
+
+  bool HasData(const std::string& name) const;
+
+  /** Get the section 'name'. An exception is thrown if there is no such section. */
+  const std::vector<char>& GetData(const std::string& name) const;
+
+  /** Add a value of a trivially copyable type. */
+  template <typename T>
+  void AddValue(const std::string& name, const T& value);
+
+  template <typename T>
+  T GetValue(const std::string& name) const;
+
+  template <typename T>
+  void AddVector(const std::string& name, const std::vector<T>& values);
+
+  template <typename T>
+  std::vector<T> GetVector(const std::string& name) const;
+
+  /** Add the region and pixel buffer of 'image'. */
+  template <typename TImage>
+  void AddImage(const std::string& name, const TImage* const image);
+
+  /** Copy the pixel buffer that was stored as 'name' into 'image', which must already be allocated with the
+    * region that was stored. */
+  template <typename TImage>
+  void GetImage(const std::string& name, TImage* const image) const;
+
+  void AddPixelBitmap(const std::string& name, const PixelBitmap& pixelBitmap);
+
+  /** Load the bits that were stored as 'name' into 'pixelBitmap', which must cover the region that was stored. */
+  void GetPixelBitmap(const std::string& name, PixelBitmap& pixelBitmap) const;
+
+  /** Get the total size of the data of all sections. */
+  std::size_t GetNumberOfBytes() const;
+
+  /** Write the checkpoint to 'fileName'. The file is written to a temporary file which then replaces 'fileName',
+    * so 'fileName' always holds a complete checkpoint, even if the program dies while writing. */
+  void Write(const std::string& fileName) const;
+
+  /** Replace the contents of this checkpoint with the contents of 'fileName'. */
+  void Read(const std::string& fileName);
+
+  /** Determine if 'fileName' exists and is a checkpoint. */
+  static bool IsCheckpoint(const std::string& fileName);
+
+private:
+
+  void AddRegion(const std::string& name, const itk::ImageRegion<2>& region);
+
+  /** Throw an exception if the region stored as 'name' is not 'region'. */
+  void CheckRegion(const std::string& name, const itk::ImageRegion<2>& region) const;
+
+  std::map<std::string, std::vector<char> > Sections;
+};
+
+/** How a driver should checkpoint a run (see CheckpointVisitor). Checkpointing is off if FileName is empty. */
+struct CheckpointSettings
+{
+  std::string FileName;
+
+  /** Save a checkpoint every IterationInterval iterations (0 to disable). */
+  unsigned int IterationInterval = 0;
+
+  /** Save a checkpoint every SecondsInterval seconds (0 to disable). */
+  double SecondsInterval = 0;
+
+  /** If this is true and FileName is a checkpoint of the same inputs, the run is resumed from it. */
+  bool Resume = true;
+};
+
+/**
+\class CheckpointWriter
+\brief This class writes checkpoints to a file on a background thread, so that the inpainting loop only pays
+       for taking the snapshot. Only the most recent checkpoint matters, so a checkpoint that is still waiting
+       when a newer one is submitted is discarded.
+*/
+class CheckpointWriter
+{
+public:
+
+  CheckpointWriter(const std::string& fileName);
+
+  /** Write the waiting checkpoint (if any) and stop the writer thread. */
+  ~CheckpointWriter();
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  void Submit(std::unique_ptr<Checkpoint> checkpoint);
+
+  /** Wait until every submitted checkpoint has been written (or discarded). */
+  void Flush();
+
+  const std::string& GetFileName() const;
+
+  unsigned int GetNumberOfCheckpointsWritten() const;
+
+private:
+
+  void Run();
+
+  std::string FileName;
+
+  std::unique_ptr<Checkpoint> Waiting;
+
+  /** True while the writer thread is writing a checkpoint. */
+  bool Writing = false;
+
+  bool Stop = false;
+
+  unsigned int NumberOfCheckpointsWritten = 0;
+
+  mutable std::mutex Mutex;
+
+  std::condition_variable Condition;
+
+  std::thread Thread;
+};
+
+#include "Checkpoint.hpp"
+
+#endif
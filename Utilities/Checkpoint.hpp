@@ -0,0 +1,109 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef Checkpoint_HPP
+#define Checkpoint_HPP
+
+#include "Checkpoint.h" // Make syntax parser happy
+
+// STL
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+template <typename T>
+void Checkpoint::AddValue(const std::string& name, const T& value)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable.");
+  AddData(name, &value, sizeof(T));
+}
+
+template <typename T>
+T Checkpoint::GetValue(const std::string& name) const
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable.");
+  const std::vector<char>& data = GetData(name);
+  if(data.size() != sizeof(T))
+  {
+    std::stringstream ss;
+    ss << "Checkpoint::GetValue: section " << name << " has " << data.size() << " bytes but "
+       << sizeof(T) << " were expected!";
+    throw std::runtime_error(ss.str());
+  }
+
+  T value;
+  std::memcpy(&value, data.data(), sizeof(T));
+  return value;
+}
+
+template <typename T>
+void Checkpoint::AddVector(const std::string& name, const std::vector<T>& values)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable.");
+  AddData(name, values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+std::vector<T> Checkpoint::GetVector(const std::string& name) const
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Checkpoint values must be trivially copyable.");
+  const std::vector<char>& data = GetData(name);
+  if(data.size() % sizeof(T) != 0)
+  {
+    std::stringstream ss;
+    ss << "Checkpoint::GetVector: section " << name << " has " << data.size()
+       << " bytes, which is not a multiple of " << sizeof(T) << "!";
+    throw std::runtime_error(ss.str());
+  }
+
+  std::vector<T> values(data.size() / sizeof(T));
+  if(!values.empty())
+  {
+    std::memcpy(values.data(), data.data(), data.size());
+  }
+  return values;
+}
+
+template <typename TImage>
+void Checkpoint::AddImage(const std::string& name, const TImage* const image)
+{
+  AddRegion(name + ".Region", image->GetLargestPossibleRegion());
+  AddData(name, image->GetBufferPointer(),
+          image->GetPixelContainer()->Size() * sizeof(typename TImage::InternalPixelType));
+}
+
+template <typename TImage>
+void Checkpoint::GetImage(const std::string& name, TImage* const image) const
+{
+  CheckRegion(name + ".Region", image->GetLargestPossibleRegion());
+
+  const std::vector<char>& data = GetData(name);
+  std::size_t numberOfBytes = image->GetPixelContainer()->Size() * sizeof(typename TImage::InternalPixelType);
+  if(data.size() != numberOfBytes)
+  {
+    std::stringstream ss;
+    ss << "Checkpoint::GetImage: section " << name << " has " << data.size() << " bytes but the image has "
+       << numberOfBytes << " bytes!";
+    throw std::runtime_error(ss.str());
+  }
+
+  std::memcpy(image->GetBufferPointer(), data.data(), numberOfBytes);
+}
+
+#endif
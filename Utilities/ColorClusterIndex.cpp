@@ -0,0 +1,273 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "ColorClusterIndex.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+ColorClusterIndex::ColorClusterIndex(const unsigned int numberOfClusters, const unsigned int numberOfIterations) :
+  NumberOfClusters(numberOfClusters), NumberOfIterations(numberOfIterations)
+{
+  if(numberOfClusters == 0)
+  {
+    throw std::runtime_error("ColorClusterIndex: at least 1 cluster is required!");
+  }
+}
+
+void ColorClusterIndex::Build(const std::vector<float>& means, const std::vector<float>& minimums,
+                              const std::vector<float>& maximums, const unsigned int dimension)
+{
+  if(dimension == 0 || means.size() % dimension != 0 || minimums.size() != means.size() ||
+     maximums.size() != means.size())
+  {
+    throw std::runtime_error("ColorClusterIndex::Build: the means, minimums and maximums must all have "
+                             "'dimension' values per point!");
+  }
+
+  this->Dimension = dimension;
+  const std::size_t numberOfPoints = means.size() / dimension;
+  const unsigned int numberOfClusters =
+      static_cast<unsigned int>(std::min<std::size_t>(this->NumberOfClusters, numberOfPoints));
+
+  // Start from evenly spaced points
+  this->Centroids.resize(static_cast<std::size_t>(numberOfClusters) * dimension);
+  for(unsigned int clusterId = 0; clusterId < numberOfClusters; ++clusterId)
+  {
+    const std::size_t pointId = clusterId * numberOfPoints / numberOfClusters;
+    std::copy(&means[pointId * dimension], &means[pointId * dimension] + dimension,
+              &this->Centroids[clusterId * dimension]);
+  }
+
+  this->Assignments.assign(numberOfPoints, 0);
+  std::vector<double> sums(this->Centroids.size());
+  std::vector<unsigned int> counts(numberOfClusters);
+  for(unsigned int iteration = 0; iteration <= this->NumberOfIterations; ++iteration)
+  {
+    #pragma omp parallel for
+    for(std::size_t pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      float bestDistance = std::numeric_limits<float>::max();
+      for(unsigned int clusterId = 0; clusterId < numberOfClusters; ++clusterId)
+      {
+        const float distance = ComputeSquaredDistance(&means[pointId * dimension],
+                                                      &this->Centroids[clusterId * dimension]);
+        if(distance < bestDistance)
+        {
+          bestDistance = distance;
+          this->Assignments[pointId] = clusterId;
+        }
+      }
+    }
+
+    // The last pass only assigns the points to the final centroids
+    if(iteration == this->NumberOfIterations)
+    {
+      break;
+    }
+
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(counts.begin(), counts.end(), 0);
+    for(std::size_t pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      const unsigned int clusterId = this->Assignments[pointId];
+      for(unsigned int component = 0; component < dimension; ++component)
+      {
+        sums[clusterId * dimension + component] += means[pointId * dimension + component];
+      }
+      counts[clusterId]++;
+    }
+
+    // A cluster without points keeps its centroid
+    for(unsigned int clusterId = 0; clusterId < numberOfClusters; ++clusterId)
+    {
+      if(counts[clusterId] == 0)
+      {
+        continue;
+      }
+
+      for(unsigned int component = 0; component < dimension; ++component)
+      {
+        this->Centroids[clusterId * dimension + component] =
+            static_cast<float>(sums[clusterId * dimension + component] / counts[clusterId]);
+      }
+    }
+  }
+
+  // Fill the inverted lists and summarize each cluster
+  this->Members.assign(numberOfClusters, std::vector<unsigned int>());
+  this->Radii.assign(numberOfClusters, 0.0f);
+  this->Minimums.assign(this->Centroids.size(), std::numeric_limits<float>::max());
+  this->Maximums.assign(this->Centroids.size(), std::numeric_limits<float>::lowest());
+  for(std::size_t pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    const unsigned int clusterId = this->Assignments[pointId];
+    this->Members[clusterId].push_back(static_cast<unsigned int>(pointId));
+
+    this->Radii[clusterId] = std::max(this->Radii[clusterId],
+                                      std::sqrt(ComputeSquaredDistance(&means[pointId * dimension],
+                                                                       &this->Centroids[clusterId * dimension])));
+    for(unsigned int component = 0; component < dimension; ++component)
+    {
+      float& minimum = this->Minimums[clusterId * dimension + component];
+      float& maximum = this->Maximums[clusterId * dimension + component];
+      minimum = std::min(minimum, minimums[pointId * dimension + component]);
+      maximum = std::max(maximum, maximums[pointId * dimension + component]);
+    }
+  }
+}
+
+unsigned int ColorClusterIndex::GetNumberOfClusters() const
+{
+  return static_cast<unsigned int>(this->Members.size());
+}
+
+unsigned int ColorClusterIndex::GetNumberOfPoints() const
+{
+  return static_cast<unsigned int>(this->Assignments.size());
+}
+
+unsigned int ColorClusterIndex::GetDimension() const
+{
+  return this->Dimension;
+}
+
+const std::vector<unsigned int>& ColorClusterIndex::GetMembers(const unsigned int clusterId) const
+{
+  return this->Members[clusterId];
+}
+
+const float* ColorClusterIndex::GetCentroid(const unsigned int clusterId) const
+{
+  return &this->Centroids[clusterId * this->Dimension];
+}
+
+unsigned int ColorClusterIndex::GetCluster(const unsigned int pointId) const
+{
+  return this->Assignments[pointId];
+}
+
+float ColorClusterIndex::ComputeMeanLowerBound(const unsigned int clusterId, const float* const mean) const
+{
+  // By the triangle inequality, no member mean is closer than the distance to the centroid minus the radius.
+  // The radius is rounded up a little so that rounding errors do not make the bound too large.
+  const float distance = std::sqrt(ComputeSquaredDistance(mean, GetCentroid(clusterId))) -
+                         this->Radii[clusterId] * (1.0f + 1e-5f) - 1e-5f;
+  return distance > 0.0f ? distance * distance : 0.0f;
+}
+
+float ColorClusterIndex::ComputeBoxLowerBound(const unsigned int clusterId, const float* const pixels,
+                                              const unsigned int numberOfPixels) const
+{
+  return ComputeBoxLowerBound(&this->Minimums[clusterId * this->Dimension],
+                              &this->Maximums[clusterId * this->Dimension], pixels, numberOfPixels);
+}
+
+float ColorClusterIndex::ComputeBoxLowerBound(const float* const minimum, const float* const maximum,
+                                              const float* const pixels, const unsigned int numberOfPixels) const
+{
+  if(numberOfPixels == 0)
+  {
+    return 0.0f;
+  }
+
+  float sum = 0.0f;
+  for(unsigned int pixelId = 0; pixelId < numberOfPixels; ++pixelId)
+  {
+    const float* pixel = pixels + pixelId * this->Dimension;
+    for(unsigned int component = 0; component < this->Dimension; ++component)
+    {
+      // The distance of the component to the interval [minimum, maximum]
+      float difference = 0.0f;
+      if(pixel[component] < minimum[component])
+      {
+        difference = minimum[component] - pixel[component];
+      }
+      else if(pixel[component] > maximum[component])
+      {
+        difference = pixel[component] - maximum[component];
+      }
+      sum += difference * difference;
+    }
+  }
+
+  // Round down a little so that a different order of summation in the exact difference can not make it smaller
+  return sum / numberOfPixels * (1.0f - 1e-5f);
+}
+
+std::vector<ColorClusterIndex::ClusterDistanceType> ColorClusterIndex::GetClustersByMean(const float* const mean) const
+{
+  std::vector<std::tuple<float, float, unsigned int> > order(GetNumberOfClusters());
+  for(unsigned int clusterId = 0; clusterId < order.size(); ++clusterId)
+  {
+    order[clusterId] = std::make_tuple(ComputeMeanLowerBound(clusterId, mean),
+                                       ComputeSquaredDistance(mean, GetCentroid(clusterId)), clusterId);
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<ClusterDistanceType> clusters(order.size());
+  for(unsigned int position = 0; position < order.size(); ++position)
+  {
+    clusters[position] = ClusterDistanceType(std::get<0>(order[position]), std::get<2>(order[position]));
+  }
+  return clusters;
+}
+
+std::vector<ColorClusterIndex::ClusterDistanceType>
+ColorClusterIndex::GetClustersByBox(const float* const pixels, const unsigned int numberOfPixels) const
+{
+  std::vector<float> mean(this->Dimension, 0.0f);
+  for(unsigned int pixelId = 0; pixelId < numberOfPixels; ++pixelId)
+  {
+    for(unsigned int component = 0; component < this->Dimension; ++component)
+    {
+      mean[component] += pixels[pixelId * this->Dimension + component] / numberOfPixels;
+    }
+  }
+
+  std::vector<std::tuple<float, float, unsigned int> > order(GetNumberOfClusters());
+  for(unsigned int clusterId = 0; clusterId < order.size(); ++clusterId)
+  {
+    order[clusterId] = std::make_tuple(ComputeBoxLowerBound(clusterId, pixels, numberOfPixels),
+                                       ComputeSquaredDistance(mean.data(), GetCentroid(clusterId)), clusterId);
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<ClusterDistanceType> clusters(order.size());
+  for(unsigned int position = 0; position < order.size(); ++position)
+  {
+    clusters[position] = ClusterDistanceType(std::get<0>(order[position]), std::get<2>(order[position]));
+  }
+  return clusters;
+}
+
+float ColorClusterIndex::ComputeSquaredDistance(const float* const a, const float* const b) const
+{
+  float distance = 0.0f;
+  for(unsigned int component = 0; component < this->Dimension; ++component)
+  {
+    const float difference = a[component] - b[component];
+    distance += difference * difference;
+  }
+  return distance;
+}
@@ -0,0 +1,118 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef ColorClusterIndex_H
+#define ColorClusterIndex_H
+
+// STL
+#include <utility>
+#include <vector>
+
+/**
+\class ColorClusterIndex
+\brief This class is an inverted index of patches by color: the mean colors of the patches are clustered by k-means,
+       and each cluster lists the patches (by their position in the points given to Build()) whose mean is closest
+       to its centroid.
+
+       Each cluster also stores two summaries of its patches, from which lower bounds of the average squared
+       difference of a query patch to any of its patches are computed without visiting them:
+       - the largest distance of a member mean to the centroid (its radius), which bounds the squared difference of
+         the query mean to any member mean (ComputeMeanLowerBound()). By Jensen's inequality, this is a lower bound
+         of the average squared pixel difference if the means are taken over the same pixels, which is only
+         approximately true for a query with invalid pixels.
+       - the per-component range of every pixel of every member (its box), which bounds the squared difference of
+         each query pixel to any member pixel, so it is an exact lower bound for any set of valid pixels
+         (ComputeBoxLowerBound()).
+
+       The index is not modified by queries, so they are safe to perform from multiple threads.
+*/
+class ColorClusterIndex
+{
+public:
+
+  /** A cluster to visit: a lower bound of the difference of the query to its members, and its id. */
+  typedef std::pair<float, unsigned int> ClusterDistanceType;
+
+  ColorClusterIndex(const unsigned int numberOfClusters = 32, const unsigned int numberOfIterations = 10);
+
+  /** Cluster the points (e.g. patches) whose means, and the minimum and maximum of each component of their
+    * pixels, are stored one after another (with 'dimension' values each) in 'means', 'minimums' and 'maximums'. */
+  void Build(const std::vector<float>& means, const std::vector<float>& minimums,
+             const std::vector<float>& maximums, const unsigned int dimension);
+
+  /** Get the number of clusters, which is at most the number of points. */
+  unsigned int GetNumberOfClusters() const;
+
+  unsigned int GetNumberOfPoints() const;
+
+  unsigned int GetDimension() const;
+
+  /** Get the ids of the points of a cluster. */
+  const std::vector<unsigned int>& GetMembers(const unsigned int clusterId) const;
+
+  /** Get the (GetDimension() values of the) centroid of a cluster. */
+  const float* GetCentroid(const unsigned int clusterId) const;
+
+  /** Get the cluster of a point. */
+  unsigned int GetCluster(const unsigned int pointId) const;
+
+  /** A lower bound of the squared distance of 'mean' to the mean of any point of the cluster. */
+  float ComputeMeanLowerBound(const unsigned int clusterId, const float* const mean) const;
+
+  /** A lower bound of the average (over the 'numberOfPixels' pixels of GetDimension() values each, stored one after
+    * another in 'pixels') squared distance of the pixels to any pixels of the points of the cluster. */
+  float ComputeBoxLowerBound(const unsigned int clusterId, const float* const pixels,
+                             const unsigned int numberOfPixels) const;
+
+  /** A lower bound of the average squared distance of 'pixels' to the pixels of a point whose pixels are in the
+    * box 'minimum' to 'maximum' (GetDimension() values each). */
+  float ComputeBoxLowerBound(const float* const minimum, const float* const maximum, const float* const pixels,
+                             const unsigned int numberOfPixels) const;
+
+  /** Get the clusters in order of increasing ComputeMeanLowerBound() of 'mean' (ties are broken by the distance to
+    * the centroid). */
+  std::vector<ClusterDistanceType> GetClustersByMean(const float* const mean) const;
+
+  /** Get the clusters in order of increasing ComputeBoxLowerBound() of 'pixels' (ties are broken by the distance of
+    * their mean to the centroid). */
+  std::vector<ClusterDistanceType> GetClustersByBox(const float* const pixels,
+                                                    const unsigned int numberOfPixels) const;
+
+private:
+
+  float ComputeSquaredDistance(const float* const a, const float* const b) const;
+
+  unsigned int NumberOfClusters;
+
+  unsigned int NumberOfIterations;
+
+  unsigned int Dimension = 0;
+
+  /** The centroids, the radius (not squared) and the box of each cluster. */
+  std::vector<float> Centroids;
+  std::vector<float> Radii;
+  std::vector<float> Minimums;
+  std::vector<float> Maximums;
+
+  /** The points of each cluster, and the cluster of each point. */
+  std::vector<std::vector<unsigned int> > Members;
+  std::vector<unsigned int> Assignments;
+};
+
+#endif
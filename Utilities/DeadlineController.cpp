@@ -0,0 +1,189 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "DeadlineController.h"
+
+// STL
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+DeadlineController::DeadlineController(const double budgetSeconds, const unsigned int k,
+                                       const unsigned int localSearchRadius, const unsigned int maximumStride) :
+  Budget(budgetSeconds), LocalSearchRadius(localSearchRadius), MaximumStride(std::max(maximumStride, 1u))
+{
+  if(!(budgetSeconds > 0.0))
+  {
+    throw std::runtime_error("DeadlineController: the budget must be positive!");
+  }
+
+  this->Settings.K = std::max(k, 1u);
+}
+
+void DeadlineController::Start(const unsigned int numberOfHolePixels)
+{
+  this->StartTime = std::chrono::steady_clock::now();
+
+  this->ChangeIteration = 0;
+  this->ChangeNumberOfHolePixels = numberOfHolePixels;
+  this->ChangeSeconds = 0.0;
+
+  this->LastIteration = 0;
+  this->LastNumberOfHolePixels = numberOfHolePixels;
+  this->LastSeconds = 0.0;
+}
+
+bool DeadlineController::Update(const unsigned int iteration, const unsigned int numberOfHolePixels)
+{
+  return Update(iteration, numberOfHolePixels, GetElapsedSeconds());
+}
+
+bool DeadlineController::Update(const unsigned int iteration, const unsigned int numberOfHolePixels,
+                                const double elapsedSeconds)
+{
+  this->LastIteration = iteration;
+  this->LastNumberOfHolePixels = numberOfHolePixels;
+  this->LastSeconds = elapsedSeconds;
+
+  if(numberOfHolePixels == 0 || IsFullyDegraded() ||
+     iteration < this->ChangeIteration + this->MinimumIterations)
+  {
+    return false;
+  }
+
+  const double plannedSeconds = this->SafetyFactor * this->Budget;
+
+  // Project the finish time from the rate at which the current settings have been filling the hole
+  const unsigned int filledPixels = this->ChangeNumberOfHolePixels - std::min(numberOfHolePixels,
+                                                                              this->ChangeNumberOfHolePixels);
+  const double seconds = elapsedSeconds - this->ChangeSeconds;
+  if(filledPixels > 0 && seconds > 0.0)
+  {
+    const double projectedSeconds = elapsedSeconds + numberOfHolePixels * seconds / filledPixels;
+    if(projectedSeconds <= plannedSeconds)
+    {
+      return false;
+    }
+  }
+  else if(elapsedSeconds <= plannedSeconds)
+  {
+    // Nothing has been filled (or no time has passed), so there is no rate to project with yet
+    return false;
+  }
+
+  std::string description;
+  Degrade(description);
+
+  Degradation degradation;
+  degradation.Iteration = iteration;
+  degradation.Seconds = elapsedSeconds;
+  degradation.NumberOfHolePixels = numberOfHolePixels;
+  degradation.Description = description;
+  this->Degradations.push_back(degradation);
+
+  this->ChangeIteration = iteration;
+  this->ChangeNumberOfHolePixels = numberOfHolePixels;
+  this->ChangeSeconds = elapsedSeconds;
+
+  return true;
+}
+
+bool DeadlineController::Degrade(std::string& description)
+{
+  std::stringstream ss;
+  if(this->Settings.K > 1)
+  {
+    this->Settings.K /= 2;
+    ss << "K reduced to " << this->Settings.K;
+  }
+  else if(!this->Settings.LocalSearch && this->LocalSearchRadius > 0)
+  {
+    this->Settings.LocalSearch = true;
+    ss << "search restricted to a radius of " << this->LocalSearchRadius;
+  }
+  else if(this->Settings.Stride < this->MaximumStride)
+  {
+    this->Settings.Stride = std::min(2 * this->Settings.Stride, this->MaximumStride);
+    ss << "candidate stride raised to " << this->Settings.Stride;
+  }
+  else
+  {
+    return false;
+  }
+
+  description = ss.str();
+  return true;
+}
+
+const DeadlineSearchSettings& DeadlineController::GetSettings() const
+{
+  return this->Settings;
+}
+
+unsigned int DeadlineController::GetLocalSearchRadius() const
+{
+  return this->LocalSearchRadius;
+}
+
+bool DeadlineController::IsFullyDegraded() const
+{
+  return this->Settings.K == 1 && (this->Settings.LocalSearch || this->LocalSearchRadius == 0) &&
+         this->Settings.Stride == this->MaximumStride;
+}
+
+double DeadlineController::GetBudget() const
+{
+  return this->Budget;
+}
+
+double DeadlineController::GetElapsedSeconds() const
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->StartTime).count();
+}
+
+const std::vector<DeadlineController::Degradation>& DeadlineController::GetDegradations() const
+{
+  return this->Degradations;
+}
+
+void DeadlineController::WriteReport(std::ostream& stream) const
+{
+  stream << "Budget: " << this->Budget << "s" << std::endl;
+  stream << "Elapsed: " << this->LastSeconds << "s after " << this->LastIteration << " iterations ("
+         << (this->LastSeconds <= this->Budget ? "within" : "over") << " budget)" << std::endl;
+  stream << "Remaining hole pixels: " << this->LastNumberOfHolePixels << std::endl;
+  stream << "Final settings: K = " << this->Settings.K << ", "
+         << (this->Settings.LocalSearch ? "local" : "global") << " search, stride " << this->Settings.Stride
+         << std::endl;
+  stream << "Degradations: " << this->Degradations.size() << std::endl;
+  for(const Degradation& degradation : this->Degradations)
+  {
+    stream << "  iteration " << degradation.Iteration << " (" << degradation.Seconds << "s, "
+           << degradation.NumberOfHolePixels << " hole pixels left): " << degradation.Description << std::endl;
+  }
+}
+
+void DeadlineController::SetSafetyFactor(const double safetyFactor)
+{
+  this->SafetyFactor = safetyFactor;
+}
+
+void DeadlineController::SetMinimumIterations(const unsigned int minimumIterations)
+{
+  this->MinimumIterations = minimumIterations;
+}
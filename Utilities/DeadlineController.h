@@ -0,0 +1,139 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef DeadlineController_H
+#define DeadlineController_H
+
+// STL
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** The search settings that DeadlineSearchBest uses for the current iteration. */
+struct DeadlineSearchSettings
+{
+  /** The number of nearest neighbors (by SSD) that are passed on to the second step of the search. */
+  unsigned int K = 1;
+
+  /** If true, only the source patches within the local search radius of the target are searched
+    * (see NeighborhoodSearch), otherwise the whole image is searched. */
+  bool LocalSearch = false;
+
+  /** Only every Stride'th candidate source patch is compared to the target. */
+  unsigned int Stride = 1;
+};
+
+/**
+\class DeadlineController
+\brief This class makes an inpainting run finish within a time budget by degrading the search as the run goes.
+
+       After every iteration it is told how many hole pixels remain (see ProgressVisitor). It measures how fast
+       the hole is being filled with the current settings, and if the projected finish time is later than
+       SafetyFactor * budget, it applies the next degradation, in this order:
+       - halve K, down to 1
+       - restrict the search to the source patches within the local search radius of the target
+       - double the candidate stride, up to the maximum stride
+       The fill rate is measured again (for at least MinimumIterations iterations) after each degradation
+       before another one is applied, so a single slow iteration does not throw away all of the quality.
+       The settings are never upgraded again. Every degradation is recorded so that it can be reported.
+*/
+class DeadlineController
+{
+public:
+
+  /** A degradation that was applied, and when. */
+  struct Degradation
+  {
+    unsigned int Iteration;
+    double Seconds;
+    unsigned int NumberOfHolePixels;
+    std::string Description;
+  };
+
+  /** 'k' is the initial K of the search. A 'localSearchRadius' of 0 disables the local search degradation,
+    * and a 'maximumStride' of 1 disables the stride degradation. */
+  DeadlineController(const double budgetSeconds, const unsigned int k, const unsigned int localSearchRadius,
+                     const unsigned int maximumStride);
+
+  /** Start the clock. 'numberOfHolePixels' is the number of hole pixels when the run starts. */
+  void Start(const unsigned int numberOfHolePixels);
+
+  /** Call after every iteration. Returns true if a degradation was applied. */
+  bool Update(const unsigned int iteration, const unsigned int numberOfHolePixels);
+
+  /** The same as Update(iteration, numberOfHolePixels) but with the time given rather than measured. */
+  bool Update(const unsigned int iteration, const unsigned int numberOfHolePixels, const double elapsedSeconds);
+
+  const DeadlineSearchSettings& GetSettings() const;
+
+  unsigned int GetLocalSearchRadius() const;
+
+  /** Determine if all of the degradations have been applied. */
+  bool IsFullyDegraded() const;
+
+  double GetBudget() const;
+
+  /** Get the number of seconds since Start(). */
+  double GetElapsedSeconds() const;
+
+  const std::vector<Degradation>& GetDegradations() const;
+
+  /** Write the budget, the time that was used and the degradations that were applied. */
+  void WriteReport(std::ostream& stream) const;
+
+  /** The fraction of the budget that the run is planned to take (default 0.9), leaving a margin for
+    * the rate to drop (the last iterations are often slower, as the remaining patches have more hole pixels). */
+  void SetSafetyFactor(const double safetyFactor);
+
+  /** The number of iterations to measure the fill rate over before another degradation is applied (default 10). */
+  void SetMinimumIterations(const unsigned int minimumIterations);
+
+private:
+
+  /** Apply the next degradation. Returns false if all of them have already been applied. */
+  bool Degrade(std::string& description);
+
+  double Budget;
+
+  unsigned int LocalSearchRadius;
+
+  unsigned int MaximumStride;
+
+  double SafetyFactor = 0.9;
+
+  unsigned int MinimumIterations = 10;
+
+  DeadlineSearchSettings Settings;
+
+  std::chrono::steady_clock::time_point StartTime;
+
+  /** The state when the current settings were applied, to measure the fill rate of the current settings. */
+  unsigned int ChangeIteration = 0;
+  unsigned int ChangeNumberOfHolePixels = 0;
+  double ChangeSeconds = 0.0;
+
+  /** The state at the last Update(), for the report. */
+  unsigned int LastIteration = 0;
+  unsigned int LastNumberOfHolePixels = 0;
+  double LastSeconds = 0.0;
+
+  std::vector<Degradation> Degradations;
+};
+
+#endif
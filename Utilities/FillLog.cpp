@@ -0,0 +1,420 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "FillLog.h"
+
+// STL
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  /** Get the slot at which to start looking for 'linearIndex' in a table of 'tableSize' (a power of two) slots. */
+  std::size_t GetHashSlot(const std::uint32_t linearIndex, const std::size_t tableSize)
+  {
+    // Fibonacci hashing spreads the (mostly consecutive) pixel indices over the table.
+    return static_cast<std::size_t>((static_cast<std::uint64_t>(linearIndex) * 11400714819323198485ull) >> 32) &
+           (tableSize - 1);
+  }
+
+  /** Get a power of two table size that keeps the load factor at or below 1/2. */
+  std::size_t GetHashTableSize(const std::size_t numberOfRecords)
+  {
+    std::size_t tableSize = 2;
+    while(tableSize < 2 * numberOfRecords)
+    {
+      tableSize *= 2;
+    }
+    return tableSize;
+  }
+
+  /** Insert (recordId + 1) into 'table' for 'linearIndex'. A later record of the same target replaces the earlier one. */
+  void InsertIntoHashTable(std::vector<std::uint32_t>& table, const std::uint32_t linearIndex,
+                           const std::uint32_t recordId, const std::vector<std::uint32_t>& targetIndices)
+  {
+    std::size_t slot = GetHashSlot(linearIndex, table.size());
+    while(table[slot] != 0 && targetIndices[table[slot] - 1] != linearIndex)
+    {
+      slot = (slot + 1) & (table.size() - 1);
+    }
+    table[slot] = recordId + 1;
+  }
+}
+
+namespace FillLog
+{
+
+std::uint64_t ComputeChecksum(const void* const data, const std::size_t numberOfBytes, const std::uint64_t seed)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t hash = seed;
+  for(std::size_t i = 0; i < numberOfBytes; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+bool IsFillLog(const std::string& fileName)
+{
+  std::ifstream inputStream(fileName.c_str(), std::ios::binary);
+  char magic[sizeof(Magic)];
+  if(!inputStream.read(magic, sizeof(magic)))
+  {
+    return false;
+  }
+  return std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+} // end namespace FillLog
+
+FillLogWriter::FillLogWriter(const std::string& fileName, const itk::ImageRegion<2>& fullRegion,
+                             const unsigned int patchRadius, const std::uint64_t inputChecksum)
+{
+  if(fullRegion.GetIndex()[0] != 0 || fullRegion.GetIndex()[1] != 0)
+  {
+    throw std::runtime_error("FillLogWriter: the image region must start at (0,0)!");
+  }
+
+  this->OutputStream.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  if(!this->OutputStream)
+  {
+    std::stringstream ss;
+    ss << "FillLogWriter: could not open " << fileName << " for writing!";
+    throw std::runtime_error(ss.str());
+  }
+
+  std::memset(&this->FileHeader, 0, sizeof(this->FileHeader));
+  std::memcpy(this->FileHeader.Magic, FillLog::Magic, sizeof(FillLog::Magic));
+  this->FileHeader.Version = FillLog::Version;
+  this->FileHeader.Width = fullRegion.GetSize()[0];
+  this->FileHeader.Height = fullRegion.GetSize()[1];
+  this->FileHeader.PatchRadius = patchRadius;
+  this->FileHeader.InputChecksum = inputChecksum;
+
+  // The record count and hash table are filled in by Close(). Until then, a reader recovers the records from the file size.
+  this->OutputStream.write(reinterpret_cast<const char*>(&this->FileHeader), sizeof(this->FileHeader));
+}
+
+FillLogWriter::~FillLogWriter()
+{
+  // Destructors must not throw, and a log that could not be finished can still be recovered by the reader.
+  try
+  {
+    Close();
+  }
+  catch (...)
+  {
+  }
+}
+
+void FillLogWriter::Write(const itk::Index<2>& target, const itk::Index<2>& source)
+{
+  if(this->Closed)
+  {
+    throw std::runtime_error("FillLogWriter::Write: the log has already been closed!");
+  }
+
+  if(target[0] < 0 || target[1] < 0 ||
+     target[0] >= static_cast<itk::Index<2>::IndexValueType>(this->FileHeader.Width) ||
+     target[1] >= static_cast<itk::Index<2>::IndexValueType>(this->FileHeader.Height))
+  {
+    std::stringstream ss;
+    ss << "FillLogWriter::Write: target " << target << " is outside of the image!";
+    throw std::runtime_error(ss.str());
+  }
+
+  FillLog::Record record;
+  record.TargetX = static_cast<std::int32_t>(target[0]);
+  record.TargetY = static_cast<std::int32_t>(target[1]);
+  record.SourceX = static_cast<std::int32_t>(source[0]);
+  record.SourceY = static_cast<std::int32_t>(source[1]);
+
+  this->OutputStream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+  this->TargetIndices.push_back(static_cast<std::uint32_t>(target[1]) * this->FileHeader.Width +
+                                static_cast<std::uint32_t>(target[0]));
+}
+
+void FillLogWriter::Close()
+{
+  if(this->Closed)
+  {
+    return;
+  }
+  this->Closed = true;
+
+  std::vector<std::uint32_t> hashTable(GetHashTableSize(this->TargetIndices.size()), 0);
+  for(std::size_t i = 0; i < this->TargetIndices.size(); ++i)
+  {
+    InsertIntoHashTable(hashTable, this->TargetIndices[i], static_cast<std::uint32_t>(i), this->TargetIndices);
+  }
+
+  this->FileHeader.NumberOfRecords = this->TargetIndices.size();
+  this->FileHeader.HashTableOffset = sizeof(FillLog::Header) + this->TargetIndices.size() * sizeof(FillLog::Record);
+  this->FileHeader.HashTableSize = hashTable.size();
+
+  this->OutputStream.write(reinterpret_cast<const char*>(hashTable.data()), hashTable.size() * sizeof(std::uint32_t));
+
+  this->OutputStream.seekp(0);
+  this->OutputStream.write(reinterpret_cast<const char*>(&this->FileHeader), sizeof(this->FileHeader));
+  this->OutputStream.close();
+
+  if(this->OutputStream.fail())
+  {
+    throw std::runtime_error("FillLogWriter::Close: could not write the log!");
+  }
+}
+
+FillLogReader::FillLogReader(const std::string& fileName)
+{
+  this->FileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if(this->FileDescriptor < 0)
+  {
+    std::stringstream ss;
+    ss << "FillLogReader: could not open " << fileName << "!";
+    throw std::runtime_error(ss.str());
+  }
+
+  struct stat fileStatus;
+  if(fstat(this->FileDescriptor, &fileStatus) != 0 ||
+     static_cast<std::size_t>(fileStatus.st_size) < sizeof(FillLog::Header))
+  {
+    close(this->FileDescriptor);
+    std::stringstream ss;
+    ss << "FillLogReader: " << fileName << " is too small to be a fill log!";
+    throw std::runtime_error(ss.str());
+  }
+
+  this->MappedSize = fileStatus.st_size;
+  this->MappedData = mmap(nullptr, this->MappedSize, PROT_READ, MAP_PRIVATE, this->FileDescriptor, 0);
+  if(this->MappedData == MAP_FAILED)
+  {
+    close(this->FileDescriptor);
+    std::stringstream ss;
+    ss << "FillLogReader: could not map " << fileName << "!";
+    throw std::runtime_error(ss.str());
+  }
+
+  const char* data = static_cast<const char*>(this->MappedData);
+  this->FileHeader = reinterpret_cast<const FillLog::Header*>(data);
+
+  std::stringstream error;
+  if(std::memcmp(this->FileHeader->Magic, FillLog::Magic, sizeof(FillLog::Magic)) != 0)
+  {
+    error << "FillLogReader: " << fileName << " is not a fill log!";
+  }
+  else if(this->FileHeader->Version != FillLog::Version)
+  {
+    error << "FillLogReader: " << fileName << " has version " << this->FileHeader->Version
+          << " but only version " << FillLog::Version << " is supported!";
+  }
+  else if(this->FileHeader->HashTableOffset != 0)
+  {
+    // The records must fit between the header and the hash table, which must fit in the file. The table must be
+    // a power of two (the probing masks with HashTableSize - 1) with at least one empty slot (so probing ends).
+    const std::uint64_t hashTableOffset = this->FileHeader->HashTableOffset;
+    const std::uint64_t hashTableSize = this->FileHeader->HashTableSize;
+    const std::uint64_t numberOfRecords = this->FileHeader->NumberOfRecords;
+    if(hashTableOffset < sizeof(FillLog::Header) || hashTableOffset > this->MappedSize ||
+       hashTableSize > (this->MappedSize - hashTableOffset) / sizeof(std::uint32_t) ||
+       numberOfRecords > (hashTableOffset - sizeof(FillLog::Header)) / sizeof(FillLog::Record))
+    {
+      error << "FillLogReader: " << fileName << " is truncated!";
+    }
+    else if(hashTableOffset % sizeof(std::uint32_t) != 0)
+    {
+      error << "FillLogReader: " << fileName << " is corrupt (its hash table offset " << hashTableOffset
+            << " is not aligned)!";
+    }
+    else if(hashTableSize == 0 || (hashTableSize & (hashTableSize - 1)) != 0 || hashTableSize <= numberOfRecords)
+    {
+      error << "FillLogReader: " << fileName << " is corrupt (its hash table size is " << hashTableSize
+            << " for " << numberOfRecords << " records)!";
+    }
+    else
+    {
+      // Every slot must refer to an existing record, and there must be an empty slot so that probing ends.
+      const std::uint32_t* hashTable = reinterpret_cast<const std::uint32_t*>(data + hashTableOffset);
+      std::uint64_t numberOfUsedSlots = 0;
+      for(std::uint64_t slot = 0; slot < hashTableSize; ++slot)
+      {
+        if(hashTable[slot] > numberOfRecords)
+        {
+          error << "FillLogReader: " << fileName << " is corrupt (hash table slot " << slot << " refers to record "
+                << hashTable[slot] << " of " << numberOfRecords << ")!";
+          break;
+        }
+        numberOfUsedSlots += (hashTable[slot] != 0);
+      }
+
+      if(error.str().empty() && numberOfUsedSlots > numberOfRecords)
+      {
+        error << "FillLogReader: " << fileName << " is corrupt (its hash table has " << numberOfUsedSlots
+              << " entries for " << numberOfRecords << " records)!";
+      }
+    }
+  }
+
+  if(!error.str().empty())
+  {
+    munmap(this->MappedData, this->MappedSize);
+    close(this->FileDescriptor);
+    throw std::runtime_error(error.str());
+  }
+
+  this->Records = reinterpret_cast<const FillLog::Record*>(data + sizeof(FillLog::Header));
+
+  if(this->FileHeader->HashTableOffset != 0)
+  {
+    this->NumberOfRecords = this->FileHeader->NumberOfRecords;
+    this->HashTable = reinterpret_cast<const std::uint32_t*>(data + this->FileHeader->HashTableOffset);
+    this->HashTableSize = this->FileHeader->HashTableSize;
+    return;
+  }
+
+  // The writer was not closed, so use all of the complete records and build the hash table here.
+  this->NumberOfRecords = (this->MappedSize - sizeof(FillLog::Header)) / sizeof(FillLog::Record);
+
+  std::vector<std::uint32_t> targetIndices(this->NumberOfRecords);
+  for(std::size_t i = 0; i < this->NumberOfRecords; ++i)
+  {
+    targetIndices[i] = static_cast<std::uint32_t>(this->Records[i].TargetY) * this->FileHeader->Width +
+                       static_cast<std::uint32_t>(this->Records[i].TargetX);
+  }
+
+  this->RebuiltHashTable.assign(GetHashTableSize(this->NumberOfRecords), 0);
+  for(std::size_t i = 0; i < this->NumberOfRecords; ++i)
+  {
+    InsertIntoHashTable(this->RebuiltHashTable, targetIndices[i], static_cast<std::uint32_t>(i), targetIndices);
+  }
+
+  this->HashTable = this->RebuiltHashTable.data();
+  this->HashTableSize = this->RebuiltHashTable.size();
+}
+
+FillLogReader::~FillLogReader()
+{
+  munmap(this->MappedData, this->MappedSize);
+  close(this->FileDescriptor);
+}
+
+const FillLog::Header& FillLogReader::GetHeader() const
+{
+  return *this->FileHeader;
+}
+
+itk::Size<2> FillLogReader::GetImageSize() const
+{
+  itk::Size<2> size = {{this->FileHeader->Width, this->FileHeader->Height}};
+  return size;
+}
+
+unsigned int FillLogReader::GetPatchRadius() const
+{
+  return this->FileHeader->PatchRadius;
+}
+
+std::uint64_t FillLogReader::GetInputChecksum() const
+{
+  return this->FileHeader->InputChecksum;
+}
+
+std::size_t FillLogReader::GetNumberOfRecords() const
+{
+  return this->NumberOfRecords;
+}
+
+const FillLog::Record& FillLogReader::GetRecord(const std::size_t i) const
+{
+  if(i >= this->NumberOfRecords)
+  {
+    std::stringstream ss;
+    ss << "FillLogReader::GetRecord: record " << i << " does not exist (there are "
+       << this->NumberOfRecords << " records).";
+    throw std::runtime_error(ss.str());
+  }
+
+  return this->Records[i];
+}
+
+bool FillLogReader::FindSource(const itk::Index<2>& target, itk::Index<2>& source) const
+{
+  if(target[0] < 0 || target[1] < 0 ||
+     target[0] >= static_cast<itk::Index<2>::IndexValueType>(this->FileHeader->Width) ||
+     target[1] >= static_cast<itk::Index<2>::IndexValueType>(this->FileHeader->Height))
+  {
+    return false;
+  }
+
+  std::uint32_t linearIndex = static_cast<std::uint32_t>(target[1]) * this->FileHeader->Width +
+                              static_cast<std::uint32_t>(target[0]);
+  std::uint32_t slot = FindSlot(linearIndex);
+  if(slot == 0)
+  {
+    return false;
+  }
+
+  const FillLog::Record& record = this->Records[slot - 1];
+  source[0] = record.SourceX;
+  source[1] = record.SourceY;
+  return true;
+}
+
+void FillLogReader::ExportText(const std::string& fileName) const
+{
+  std::ofstream outputStream(fileName.c_str());
+  if(!outputStream)
+  {
+    std::stringstream ss;
+    ss << "FillLogReader::ExportText: could not open " << fileName << " for writing!";
+    throw std::runtime_error(ss.str());
+  }
+
+  for(std::size_t i = 0; i < this->NumberOfRecords; ++i)
+  {
+    const FillLog::Record& record = this->Records[i];
+    outputStream << record.SourceX << " " << record.SourceY << " : "
+                 << record.TargetX << " " << record.TargetY << std::endl;
+  }
+}
+
+std::uint32_t FillLogReader::FindSlot(const std::uint32_t linearIndex) const
+{
+  std::size_t slot = GetHashSlot(linearIndex, this->HashTableSize);
+  while(this->HashTable[slot] != 0)
+  {
+    const FillLog::Record& record = this->Records[this->HashTable[slot] - 1];
+    if(static_cast<std::uint32_t>(record.TargetY) * this->FileHeader->Width +
+       static_cast<std::uint32_t>(record.TargetX) == linearIndex)
+    {
+      return this->HashTable[slot];
+    }
+    slot = (slot + 1) & (this->HashTableSize - 1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,189 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef FillLog_H
+#define FillLog_H
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/** The binary fill log records which source patch was used to fill each target patch, in fill order.
+  *
+  * File layout (native byte order):
+  * - Header (64 bytes)
+  * - NumberOfRecords Records (16 bytes each), in the order they were filled
+  * - HashTableSize uint32 slots, an open-addressed (linear probing) table keyed by the linear index
+  *   (y * width + x) of the target pixel. A slot stores (record id + 1), or 0 if it is empty.
+  *
+  * If the writer did not finish (e.g. the program crashed), HashTableOffset is 0 and the number of records
+  * is determined from the file size. The reader then builds the hash table itself.
+  */
+namespace FillLog
+{
+  const char Magic[8] = {'P', 'B', 'I', 'F', 'L', 'O', 'G', '\0'};
+  const std::uint32_t Version = 1;
+
+  struct Header
+  {
+    char Magic[8];
+    std::uint32_t Version;
+    std::uint32_t Width;
+    std::uint32_t Height;
+    std::uint32_t PatchRadius;
+    std::uint64_t InputChecksum;
+    std::uint64_t NumberOfRecords;
+    std::uint64_t HashTableOffset;
+    std::uint64_t HashTableSize;
+    std::uint64_t Reserved;
+  };
+
+  struct Record
+  {
+    std::int32_t TargetX;
+    std::int32_t TargetY;
+    std::int32_t SourceX;
+    std::int32_t SourceY;
+  };
+
+  static_assert(sizeof(Header) == 64, "FillLog::Header must be 64 bytes.");
+  static_assert(sizeof(Record) == 16, "FillLog::Record must be 16 bytes.");
+
+  /** Compute a 64-bit FNV-1a checksum of 'numberOfBytes' bytes. Passing the checksum of other data as 'seed'
+    * computes the checksum of the concatenation of the data. */
+  std::uint64_t ComputeChecksum(const void* const data, const std::size_t numberOfBytes,
+                                const std::uint64_t seed = 14695981039346656037ull);
+
+  /** Compute the checksum of the pixel buffer of 'image'. */
+  template <typename TImage>
+  std::uint64_t ComputeImageChecksum(const TImage* const image,
+                                     const std::uint64_t seed = 14695981039346656037ull)
+  {
+    return ComputeChecksum(image->GetBufferPointer(),
+                           image->GetPixelContainer()->Size() * sizeof(typename TImage::InternalPixelType), seed);
+  }
+
+  /** Compute the checksum of the input of an inpainting (the image and the mask before anything is filled).
+    * A log should only be replayed on an input with the same checksum. */
+  template <typename TImage, typename TMask>
+  std::uint64_t ComputeInputChecksum(const TImage* const image, const TMask* const mask)
+  {
+    return ComputeImageChecksum(mask, ComputeImageChecksum(image));
+  }
+
+  /** Determine if 'fileName' is a binary fill log (as opposed to a text log). */
+  bool IsFillLog(const std::string& fileName);
+}
+
+/**
+\class FillLogWriter
+\brief Write a binary fill log as the inpainting runs. Records are streamed to disk
+       as they are added; the hash table is written by Close().
+*/
+class FillLogWriter
+{
+public:
+  FillLogWriter(const std::string& fileName, const itk::ImageRegion<2>& fullRegion,
+                const unsigned int patchRadius, const std::uint64_t inputChecksum);
+
+  /** Close() the log if it has not been closed already. */
+  ~FillLogWriter();
+
+  /** Add a record that 'target' was filled from 'source'. */
+  void Write(const itk::Index<2>& target, const itk::Index<2>& source);
+
+  /** Write the hash table and the final header. No records can be written after this. */
+  void Close();
+
+private:
+  std::ofstream OutputStream;
+
+  FillLog::Header FileHeader;
+
+  /** The linear target index of each record (to build the hash table in Close()). */
+  std::vector<std::uint32_t> TargetIndices;
+
+  bool Closed = false;
+};
+
+/**
+\class FillLogReader
+\brief Read a binary fill log by memory mapping it. Opening the file only validates the header
+       and the hash table (the records are not parsed), so even very large logs are ready to use
+       almost immediately. A log that fails the validation is rejected with an exception.
+*/
+class FillLogReader
+{
+public:
+  explicit FillLogReader(const std::string& fileName);
+
+  ~FillLogReader();
+
+  /** The reader owns the mapping, so it cannot be copied. */
+  FillLogReader(const FillLogReader&) = delete;
+  FillLogReader& operator=(const FillLogReader&) = delete;
+
+  const FillLog::Header& GetHeader() const;
+
+  itk::Size<2> GetImageSize() const;
+
+  unsigned int GetPatchRadius() const;
+
+  std::uint64_t GetInputChecksum() const;
+
+  std::size_t GetNumberOfRecords() const;
+
+  /** Get the ith record (in fill order). */
+  const FillLog::Record& GetRecord(const std::size_t i) const;
+
+  /** Find the source that was used to fill 'target'. Returns false if 'target' was never filled. */
+  bool FindSource(const itk::Index<2>& target, itk::Index<2>& source) const;
+
+  /** Write the log in the text format of LoggerVisitor ("sx sy : tx ty" per line). */
+  void ExportText(const std::string& fileName) const;
+
+private:
+  /** Find the slot of 'linearIndex' in the hash table (the slot is 0 if it is not in the table). */
+  std::uint32_t FindSlot(const std::uint32_t linearIndex) const;
+
+  int FileDescriptor = -1;
+
+  void* MappedData = nullptr;
+
+  std::size_t MappedSize = 0;
+
+  const FillLog::Header* FileHeader = nullptr;
+
+  const FillLog::Record* Records = nullptr;
+
+  std::size_t NumberOfRecords = 0;
+
+  const std::uint32_t* HashTable = nullptr;
+
+  std::size_t HashTableSize = 0;
+
+  /** Used instead of the table in the file if the writer was not closed. */
+  std::vector<std::uint32_t> RebuiltHashTable;
+};
+
+#endif
@@ -19,12 +19,18 @@
 #ifndef IndirectPriorityQueue_H
 #define IndirectPriorityQueue_H
 
+// Custom
+#include "Utilities/Checkpoint.h"
+
 // STL
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 // Boost
 #include <boost/heap/binomial_heap.hpp>
-#include <boost/pending/indirect_cmp.hpp>
 #include <boost/graph/grid_graph.hpp>
 #include <boost/property_map/property_map.hpp>
 
@@ -39,7 +45,30 @@ struct IndirectPriorityQueue
 
   typedef std::less<float> PriorityCompareType;
   typedef boost::vector_property_map<float, IndexMapType> PriorityMapType;
-  typedef boost::indirect_cmp<PriorityMapType, PriorityCompareType> IndirectComparisonType;
+
+  /** Order nodes by priority, and nodes with equal priorities by their index (lower indices are popped first).
+    * The order in which nodes are popped then only depends on what is in the queue, and not on the order in
+    * which the nodes were pushed, so a queue that is restored from a checkpoint behaves exactly like the original. */
+  struct IndirectComparisonType
+  {
+    PriorityMapType PriorityMap;
+    IndexMapType IndexMap;
+    PriorityCompareType PriorityCompare;
+
+    IndirectComparisonType(const PriorityMapType& priorityMap, const IndexMapType& indexMap) :
+      PriorityMap(priorityMap), IndexMap(indexMap) {}
+
+    bool operator()(const VertexDescriptorType& a, const VertexDescriptorType& b) const
+    {
+      float priorityA = get(this->PriorityMap, a);
+      float priorityB = get(this->PriorityMap, b);
+      if(priorityA != priorityB)
+      {
+        return this->PriorityCompare(priorityA, priorityB);
+      }
+      return get(this->IndexMap, a) > get(this->IndexMap, b);
+    }
+  };
 
   typedef boost::heap::binomial_heap<VertexDescriptorType,
       boost::heap::compare<IndirectComparisonType> >
@@ -75,7 +104,7 @@ struct IndirectPriorityQueue
     IndexMap(get(boost::vertex_index, Graph)),
     PriorityMap(num_vertices(Graph), IndexMap),
     HandleMap(IndexMap),
-    IndirectComparison(PriorityMap),
+    IndirectComparison(PriorityMap, IndexMap),
     Queue(IndirectComparison),
     BoundaryStatusMap(num_vertices(Graph), IndexMap)
   {
@@ -116,6 +145,26 @@ struct IndirectPriorityQueue
     return numberOfValidNodes;
   }
 
+  /** Get the nodes that are on the current boundary, each once and in no particular order (e.g. to prepare their
+    * searches before the inpainting starts, see CachedKNN). A node can be in the queue more than once if it was
+    * pushed with push() rather than push_or_update(). */
+  std::vector<ValueType> GetValidNodes() const
+  {
+    std::vector<bool> added(num_vertices(this->Graph), false);
+    std::vector<ValueType> validNodes;
+    for (typename QueueType::const_iterator it = this->Queue.begin();
+         it != this->Queue.end(); ++it)
+    {
+      if(get(this->BoundaryStatusMap, *it) && !added[get(this->IndexMap, *it)])
+      {
+        added[get(this->IndexMap, *it)] = true;
+        validNodes.push_back(*it);
+      }
+    }
+
+    return validNodes;
+  }
+
   HandleType push(ValueType v)
   {
     return this->Queue.push(v);
@@ -205,6 +254,61 @@ struct IndirectPriorityQueue
     this->Queue.update(get(this->HandleMap, value), value);
   }
 
+  /** The state of one node in the queue, as stored in a checkpoint. */
+  struct StoredNode
+  {
+    std::uint64_t Index;
+    float Priority;
+    std::uint32_t Valid;
+  };
+
+  /** Add the nodes in the queue (with their priorities and boundary status) to 'checkpoint'. */
+  void SaveState(Checkpoint& checkpoint) const
+  {
+    std::vector<StoredNode> storedNodes;
+    storedNodes.reserve(this->Queue.size());
+    for (typename QueueType::const_iterator it = this->Queue.begin();
+         it != this->Queue.end(); ++it)
+    {
+      StoredNode storedNode;
+      storedNode.Index = get(this->IndexMap, *it);
+      storedNode.Priority = get(this->PriorityMap, *it);
+      storedNode.Valid = get(this->BoundaryStatusMap, *it);
+      storedNodes.push_back(storedNode);
+    }
+    checkpoint.AddVector("IndirectPriorityQueue.Nodes", storedNodes);
+  }
+
+  /** Replace the contents of the queue with the nodes saved by SaveState(). */
+  void LoadState(const Checkpoint& checkpoint)
+  {
+    std::vector<StoredNode> storedNodes = checkpoint.GetVector<StoredNode>("IndirectPriorityQueue.Nodes");
+
+    this->Queue.clear();
+
+    HandleType invalidHandle(0);
+    VertexIteratorType vertexIterator, vertexIteratorEnd;
+    for( tie(vertexIterator, vertexIteratorEnd) = vertices(this->Graph);
+         vertexIterator != vertexIteratorEnd; ++vertexIterator)
+    {
+      put(this->HandleMap, *vertexIterator, invalidHandle);
+      put(this->BoundaryStatusMap, *vertexIterator, false);
+    }
+
+    for(typename std::vector<StoredNode>::const_iterator it = storedNodes.begin(); it != storedNodes.end(); ++it)
+    {
+      if(it->Index >= num_vertices(this->Graph))
+      {
+        throw std::runtime_error("IndirectPriorityQueue::LoadState: the checkpoint does not match the graph!");
+      }
+
+      VertexDescriptorType v = vertex(it->Index, this->Graph);
+      put(this->PriorityMap, v, it->Priority);
+      put(this->BoundaryStatusMap, v, it->Valid != 0);
+      put(this->HandleMap, v, push(v));
+    }
+  }
+
   void mark_as_invalid(ValueType v)
   {
     // This makes a patch ignored if it is still in the boundaryNodeQueue.
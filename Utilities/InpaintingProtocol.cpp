@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "InpaintingProtocol.h"
+
+// Custom
+#include "UnixSocket.h"
+
+// STL
+#include <stdexcept>
+
+namespace InpaintingProtocol
+{
+
+std::string Message::GetValue(const std::string& key, const std::string& defaultValue) const
+{
+  std::map<std::string, std::string>::const_iterator iterator = this->Values.find(key);
+  if(iterator == this->Values.end())
+  {
+    return defaultValue;
+  }
+  return iterator->second;
+}
+
+std::vector<std::string> FormatMessage(const Message& message)
+{
+  if(message.Command.empty() || message.Command.find('\n') != std::string::npos)
+  {
+    throw std::runtime_error("InpaintingProtocol: invalid command '" + message.Command + "'");
+  }
+
+  std::vector<std::string> lines(1, message.Command);
+  for(std::map<std::string, std::string>::const_iterator iterator = message.Values.begin();
+      iterator != message.Values.end(); ++iterator)
+  {
+    if(iterator->first.empty() || iterator->first.find_first_of("=\n") != std::string::npos ||
+       iterator->second.find('\n') != std::string::npos)
+    {
+      throw std::runtime_error("InpaintingProtocol: invalid value '" + iterator->first + "'");
+    }
+    lines.push_back(iterator->first + "=" + iterator->second);
+  }
+  lines.push_back("");
+
+  return lines;
+}
+
+Message ParseMessage(const std::vector<std::string>& lines)
+{
+  if(lines.empty() || lines[0].empty())
+  {
+    throw std::runtime_error("InpaintingProtocol: a message must start with a command");
+  }
+
+  Message message;
+  message.Command = lines[0];
+  for(std::size_t i = 1; i < lines.size(); ++i)
+  {
+    if(lines[i].empty() && i == lines.size() - 1)
+    {
+      break;
+    }
+
+    std::size_t separator = lines[i].find('=');
+    if(separator == std::string::npos || separator == 0)
+    {
+      throw std::runtime_error("InpaintingProtocol: '" + lines[i] + "' is not a key=value line");
+    }
+    message.Values[lines[i].substr(0, separator)] = lines[i].substr(separator + 1);
+  }
+
+  return message;
+}
+
+std::string ToString(const Message& message)
+{
+  std::string text = message.Command;
+  for(std::map<std::string, std::string>::const_iterator iterator = message.Values.begin();
+      iterator != message.Values.end(); ++iterator)
+  {
+    text += " " + iterator->first + "=" + iterator->second;
+  }
+  return text;
+}
+
+void WriteMessage(UnixSocket& socket, const Message& message)
+{
+  std::vector<std::string> lines = FormatMessage(message);
+
+  // Send the message in one piece, so that messages written by different threads are not interleaved
+  std::string text;
+  for(std::size_t i = 0; i < lines.size() - 1; ++i)
+  {
+    text += lines[i] + "\n";
+  }
+  socket.WriteLine(text);
+}
+
+bool ReadMessage(UnixSocket& socket, Message& message)
+{
+  std::vector<std::string> lines;
+  std::string line;
+  while(socket.ReadLine(line))
+  {
+    if(line.empty())
+    {
+      if(lines.empty())
+      {
+        continue; // Tolerate extra empty lines between messages
+      }
+      message = ParseMessage(lines);
+      return true;
+    }
+    lines.push_back(line);
+  }
+
+  return false;
+}
+
+} // end namespace
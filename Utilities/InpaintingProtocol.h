@@ -0,0 +1,72 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef InpaintingProtocol_H
+#define InpaintingProtocol_H
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+
+class UnixSocket;
+
+/** The messages that InpaintingClient and InpaintingServer exchange. A message is a command line followed by one
+  * "key=value" line per value and an empty line, e.g.
+  *
+  *   INPAINT
+  *   image=/data/trashcan.png
+  *   mask=/data/trashcan.mask
+  *   radius=15
+  *   output=/data/filled.png
+  *   priority=2
+  *
+  * Requests: INPAINT (with the keys of a BatchManifest job plus "priority", higher first), STATUS and SHUTDOWN.
+  * The server answers an INPAINT with QUEUED, STARTED, any number of PROGRESS messages and then DONE or FAILED
+  * (ERROR if the request itself is invalid), and closes the connection after the last message.
+  */
+namespace InpaintingProtocol
+{
+
+struct Message
+{
+  std::string Command;
+  std::map<std::string, std::string> Values;
+
+  /** Get the value of 'key', or 'defaultValue' if there is no such key. */
+  std::string GetValue(const std::string& key, const std::string& defaultValue = "") const;
+};
+
+/** Get the lines of 'message' (including the empty line that ends it). An exception is thrown if the command,
+  * a key or a value contains a line break, or a key is empty or contains '='. */
+std::vector<std::string> FormatMessage(const Message& message);
+
+/** Parse the lines of one message. The empty line that ends it may be left out. */
+Message ParseMessage(const std::vector<std::string>& lines);
+
+/** Format a message on one line, for display. */
+std::string ToString(const Message& message);
+
+void WriteMessage(UnixSocket& socket, const Message& message);
+
+/** Read the next message. False is returned if the stream ended before a complete message was received. */
+bool ReadMessage(UnixSocket& socket, Message& message);
+
+} // end namespace
+
+#endif
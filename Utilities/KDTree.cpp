@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "KDTree.h"
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+KDTree::KDTree()
+{
+
+}
+
+void KDTree::Build(const std::vector<float>& points, const unsigned int dimension)
+{
+  this->Dimension = dimension;
+  this->Nodes.clear();
+  this->Ids.resize(dimension > 0 ? points.size() / dimension : 0);
+  std::iota(this->Ids.begin(), this->Ids.end(), 0);
+
+  if(this->Ids.empty())
+  {
+    this->Points.clear();
+    return;
+  }
+
+  std::vector<float> workingPoints = points;
+  BuildNode(0, static_cast<unsigned int>(this->Ids.size()), workingPoints);
+
+  // Store the points in tree order, so a leaf reads one contiguous block
+  this->Points.resize(this->Ids.size() * dimension);
+  for(std::size_t position = 0; position < this->Ids.size(); ++position)
+  {
+    std::copy(&points[this->Ids[position] * dimension], &points[this->Ids[position] * dimension] + dimension,
+              &this->Points[position * dimension]);
+  }
+}
+
+unsigned int KDTree::BuildNode(const unsigned int begin, const unsigned int end, std::vector<float>& points)
+{
+  const unsigned int nodeId = static_cast<unsigned int>(this->Nodes.size());
+  Node node = {begin, end, 0, 0.0f, 0, 0};
+  this->Nodes.push_back(node);
+
+  if(end - begin <= LeafSize)
+  {
+    return nodeId;
+  }
+
+  // Split on the dimension with the largest spread
+  unsigned int splitDimension = 0;
+  float largestSpread = -1.0f;
+  for(unsigned int dimension = 0; dimension < this->Dimension; ++dimension)
+  {
+    float minimum = std::numeric_limits<float>::max();
+    float maximum = std::numeric_limits<float>::lowest();
+    for(unsigned int position = begin; position < end; ++position)
+    {
+      const float value = points[this->Ids[position] * this->Dimension + dimension];
+      minimum = std::min(minimum, value);
+      maximum = std::max(maximum, value);
+    }
+
+    if(maximum - minimum > largestSpread)
+    {
+      largestSpread = maximum - minimum;
+      splitDimension = dimension;
+    }
+  }
+
+  const unsigned int middle = begin + (end - begin) / 2;
+  std::nth_element(this->Ids.begin() + begin, this->Ids.begin() + middle, this->Ids.begin() + end,
+                   [&points, splitDimension, this](const unsigned int a, const unsigned int b)
+  {
+    return points[a * this->Dimension + splitDimension] < points[b * this->Dimension + splitDimension];
+  });
+
+  const float splitValue = points[this->Ids[middle] * this->Dimension + splitDimension];
+  const unsigned int left = BuildNode(begin, middle, points);
+  const unsigned int right = BuildNode(middle, end, points);
+
+  this->Nodes[nodeId].SplitDimension = splitDimension;
+  this->Nodes[nodeId].SplitValue = splitValue;
+  this->Nodes[nodeId].Left = left;
+  this->Nodes[nodeId].Right = right;
+  return nodeId;
+}
+
+unsigned int KDTree::GetNumberOfPoints() const
+{
+  return static_cast<unsigned int>(this->Ids.size());
+}
+
+unsigned int KDTree::GetDimension() const
+{
+  return this->Dimension;
+}
+
+void KDTree::FindNearest(const float* const query, const unsigned int k, std::vector<NeighborType>& neighbors) const
+{
+  neighbors.clear();
+  if(this->Nodes.empty() || k == 0)
+  {
+    return;
+  }
+
+  // 'neighbors' is a max-heap of the best neighbors so far while searching
+  SearchNode(0, query, k, neighbors);
+  std::sort_heap(neighbors.begin(), neighbors.end());
+}
+
+void KDTree::SearchNode(const unsigned int nodeId, const float* const query, const unsigned int k,
+                        std::vector<NeighborType>& heap) const
+{
+  const Node& node = this->Nodes[nodeId];
+  if(node.Left == 0)
+  {
+    for(unsigned int position = node.Begin; position < node.End; ++position)
+    {
+      const float* point = &this->Points[position * this->Dimension];
+      float distance = 0.0f;
+      for(unsigned int dimension = 0; dimension < this->Dimension; ++dimension)
+      {
+        const float difference = point[dimension] - query[dimension];
+        distance += difference * difference;
+      }
+
+      if(heap.size() < k)
+      {
+        heap.push_back(NeighborType(distance, this->Ids[position]));
+        std::push_heap(heap.begin(), heap.end());
+      }
+      else if(distance < heap.front().first)
+      {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = NeighborType(distance, this->Ids[position]);
+        std::push_heap(heap.begin(), heap.end());
+      }
+    }
+    return;
+  }
+
+  // Search the side of the split that contains the query first, then the other side if it could be closer
+  const float splitDistance = query[node.SplitDimension] - node.SplitValue;
+  const unsigned int nearChild = splitDistance < 0.0f ? node.Left : node.Right;
+  const unsigned int farChild = splitDistance < 0.0f ? node.Right : node.Left;
+
+  SearchNode(nearChild, query, k, heap);
+  if(heap.size() < k || splitDistance * splitDistance < heap.front().first)
+  {
+    SearchNode(farChild, query, k, heap);
+  }
+}
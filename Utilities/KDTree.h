@@ -0,0 +1,88 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef KDTree_H
+#define KDTree_H
+
+// STL
+#include <utility>
+#include <vector>
+
+/**
+\class KDTree
+\brief This class finds the K nearest neighbors (by Euclidean distance) of a query among a static set of points
+       of any dimension, e.g. low dimensional projections of patches (see PatchPrincipalComponents).
+
+       The tree is built once by median splits on the dimension with the largest spread, and is stored in flat
+       arrays: the points are reordered so that every node covers a contiguous range of them. Queries do not
+       modify the tree, so they are safe to perform from multiple threads.
+*/
+class KDTree
+{
+public:
+
+  /** A neighbor: its squared distance to the query and its id (its position in the points given to Build()). */
+  typedef std::pair<float, unsigned int> NeighborType;
+
+  KDTree();
+
+  /** Build the tree of 'numberOfPoints' points of 'dimension' values each, stored one after another in 'points'. */
+  void Build(const std::vector<float>& points, const unsigned int dimension);
+
+  unsigned int GetNumberOfPoints() const;
+
+  unsigned int GetDimension() const;
+
+  /** Find the (at most) 'k' nearest points to 'query' (which has GetDimension() values), in order of increasing
+    * distance. */
+  void FindNearest(const float* const query, const unsigned int k, std::vector<NeighborType>& neighbors) const;
+
+private:
+
+  struct Node
+  {
+    /** The range of Ids (and Points) that the node covers. */
+    unsigned int Begin;
+    unsigned int End;
+
+    /** The split dimension and value, and the children, of an internal node (Left is 0 for a leaf). */
+    unsigned int SplitDimension;
+    float SplitValue;
+    unsigned int Left;
+    unsigned int Right;
+  };
+
+  unsigned int BuildNode(const unsigned int begin, const unsigned int end, std::vector<float>& points);
+
+  void SearchNode(const unsigned int nodeId, const float* const query, const unsigned int k,
+                  std::vector<NeighborType>& heap) const;
+
+  /** Nodes with at most this many points are not split. */
+  static const unsigned int LeafSize = 16;
+
+  unsigned int Dimension = 0;
+
+  /** The points in tree order, and the original id of each of them. */
+  std::vector<float> Points;
+  std::vector<unsigned int> Ids;
+
+  std::vector<Node> Nodes;
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef LRUCache_H
+#define LRUCache_H
+
+// STL
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+
+/**
+\class LRUCache
+\brief A thread safe map that holds at most 'capacity' values, discarding the least recently used value
+       when a new one is inserted into a full cache. TValue should be cheap to copy (e.g. a smart pointer).
+*/
+template <typename TKey, typename TValue>
+class LRUCache
+{
+public:
+
+  LRUCache(const std::size_t capacity);
+
+  /** If 'key' is cached, copy its value to 'value', mark it as the most recently used and return true. */
+  bool Get(const TKey& key, TValue& value);
+
+  /** Add (or replace) the value of 'key'. */
+  void Insert(const TKey& key, const TValue& value);
+
+  void Clear();
+
+  std::size_t GetSize() const;
+
+  std::size_t GetCapacity() const;
+
+  std::size_t GetNumberOfHits() const;
+
+  std::size_t GetNumberOfMisses() const;
+
+private:
+
+  typedef std::list<std::pair<TKey, TValue> > EntryListType;
+
+  /** The most recently used entry is at the front. */
+  EntryListType Entries;
+
+  std::map<TKey, typename EntryListType::iterator> EntryMap;
+
+  std::size_t Capacity;
+
+  std::size_t NumberOfHits = 0;
+
+  std::size_t NumberOfMisses = 0;
+
+  mutable std::mutex Mutex;
+};
+
+#include "LRUCache.hpp"
+
+#endif
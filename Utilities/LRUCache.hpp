@@ -0,0 +1,111 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef LRUCache_HPP
+#define LRUCache_HPP
+
+#include "LRUCache.h" // Make syntax parser happy
+
+template <typename TKey, typename TValue>
+LRUCache<TKey, TValue>::LRUCache(const std::size_t capacity) : Capacity(capacity)
+{
+
+}
+
+template <typename TKey, typename TValue>
+bool LRUCache<TKey, TValue>::Get(const TKey& key, TValue& value)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+
+  typename std::map<TKey, typename EntryListType::iterator>::iterator iterator = this->EntryMap.find(key);
+  if(iterator == this->EntryMap.end())
+  {
+    this->NumberOfMisses++;
+    return false;
+  }
+
+  this->Entries.splice(this->Entries.begin(), this->Entries, iterator->second);
+  value = iterator->second->second;
+  this->NumberOfHits++;
+  return true;
+}
+
+template <typename TKey, typename TValue>
+void LRUCache<TKey, TValue>::Insert(const TKey& key, const TValue& value)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+
+  typename std::map<TKey, typename EntryListType::iterator>::iterator iterator = this->EntryMap.find(key);
+  if(iterator != this->EntryMap.end())
+  {
+    iterator->second->second = value;
+    this->Entries.splice(this->Entries.begin(), this->Entries, iterator->second);
+    return;
+  }
+
+  if(this->Capacity == 0)
+  {
+    return;
+  }
+
+  if(this->Entries.size() >= this->Capacity)
+  {
+    this->EntryMap.erase(this->Entries.back().first);
+    this->Entries.pop_back();
+  }
+
+  this->Entries.push_front(std::make_pair(key, value));
+  this->EntryMap[key] = this->Entries.begin();
+}
+
+template <typename TKey, typename TValue>
+void LRUCache<TKey, TValue>::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->Entries.clear();
+  this->EntryMap.clear();
+}
+
+template <typename TKey, typename TValue>
+std::size_t LRUCache<TKey, TValue>::GetSize() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->Entries.size();
+}
+
+template <typename TKey, typename TValue>
+std::size_t LRUCache<TKey, TValue>::GetCapacity() const
+{
+  return this->Capacity;
+}
+
+template <typename TKey, typename TValue>
+std::size_t LRUCache<TKey, TValue>::GetNumberOfHits() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->NumberOfHits;
+}
+
+template <typename TKey, typename TValue>
+std::size_t LRUCache<TKey, TValue>::GetNumberOfMisses() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->NumberOfMisses;
+}
+
+#endif
@@ -0,0 +1,268 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "LocalitySensitiveHash.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+LocalitySensitiveHash::LocalitySensitiveHash(const FamilyEnum family, const unsigned int numberOfTables,
+                                             const unsigned int numberOfHashFunctions,
+                                             const unsigned int numberOfProbes, const float bucketWidth,
+                                             const unsigned int seed) :
+  Family(family), NumberOfTables(std::max(numberOfTables, 1u)),
+  NumberOfHashFunctions(std::max(numberOfHashFunctions, 1u)), NumberOfProbes(std::max(numberOfProbes, 1u)),
+  BucketWidth(bucketWidth), Seed(seed)
+{
+
+}
+
+void LocalitySensitiveHash::Initialize(const unsigned int dimension)
+{
+  this->Dimension = dimension;
+  this->NumberOfPoints = 0;
+
+  const unsigned int numberOfFunctions = this->NumberOfTables * this->NumberOfHashFunctions;
+  this->Directions.resize(static_cast<std::size_t>(numberOfFunctions) * dimension);
+  this->Offsets.resize(numberOfFunctions);
+
+  // Cauchy projections are 1-stable (their differences are distributed like the L1 distance), and Gaussian
+  // projections are 2-stable (like the L2 distance)
+  std::mt19937 generator(this->Seed);
+  std::normal_distribution<float> normalDistribution(0.0f, 1.0f);
+  std::cauchy_distribution<float> cauchyDistribution(0.0f, 1.0f);
+  std::uniform_real_distribution<float> offsetDistribution(0.0f, this->BucketWidth);
+  for(std::size_t valueId = 0; valueId < this->Directions.size(); ++valueId)
+  {
+    this->Directions[valueId] = this->Family == MANHATTAN ? cauchyDistribution(generator) :
+                                                            normalDistribution(generator);
+  }
+
+  for(unsigned int functionId = 0; functionId < numberOfFunctions; ++functionId)
+  {
+    this->Offsets[functionId] = this->Family == HYPERPLANE ? 0.0f : offsetDistribution(generator);
+  }
+
+  this->Tables.assign(this->NumberOfTables, TableType());
+}
+
+unsigned int LocalitySensitiveHash::Insert(const float* const point)
+{
+  if(this->Tables.empty())
+  {
+    throw std::runtime_error("LocalitySensitiveHash::Insert: Initialize() must be called first!");
+  }
+
+  std::vector<int> values;
+  for(unsigned int tableId = 0; tableId < this->NumberOfTables; ++tableId)
+  {
+    ComputeHash(tableId, point, values, nullptr);
+    this->Tables[tableId][ComputeKey(values)].push_back(this->NumberOfPoints);
+  }
+
+  return this->NumberOfPoints++;
+}
+
+void LocalitySensitiveHash::FindCandidates(const float* const query, std::vector<unsigned int>& candidates) const
+{
+  candidates.clear();
+  if(this->Tables.empty())
+  {
+    return;
+  }
+
+  std::vector<int> values;
+  std::vector<int> probeValues;
+  std::vector<Perturbation> perturbations;
+  std::vector<std::vector<unsigned int> > probes;
+  for(unsigned int tableId = 0; tableId < this->NumberOfTables; ++tableId)
+  {
+    ComputeHash(tableId, query, values, &perturbations);
+    ComputeProbes(perturbations, probes);
+
+    // The query's own bucket is probed first, with no perturbations
+    for(std::size_t probeId = 0; probeId <= probes.size(); ++probeId)
+    {
+      probeValues = values;
+      if(probeId > 0)
+      {
+        for(std::size_t perturbationId = 0; perturbationId < probes[probeId - 1].size(); ++perturbationId)
+        {
+          const Perturbation& perturbation = perturbations[probes[probeId - 1][perturbationId]];
+          probeValues[perturbation.FunctionId] += perturbation.Delta;
+        }
+      }
+
+      TableType::const_iterator bucket = this->Tables[tableId].find(ComputeKey(probeValues));
+      if(bucket != this->Tables[tableId].end())
+      {
+        candidates.insert(candidates.end(), bucket->second.begin(), bucket->second.end());
+      }
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+void LocalitySensitiveHash::ComputeHash(const unsigned int tableId, const float* const point,
+                                        std::vector<int>& values,
+                                        std::vector<Perturbation>* const perturbations) const
+{
+  values.resize(this->NumberOfHashFunctions);
+  if(perturbations)
+  {
+    perturbations->clear();
+  }
+
+  for(unsigned int hashFunctionId = 0; hashFunctionId < this->NumberOfHashFunctions; ++hashFunctionId)
+  {
+    const unsigned int functionId = tableId * this->NumberOfHashFunctions + hashFunctionId;
+    const float* direction = &this->Directions[static_cast<std::size_t>(functionId) * this->Dimension];
+    float projection = 0.0f;
+    for(unsigned int componentId = 0; componentId < this->Dimension; ++componentId)
+    {
+      projection += direction[componentId] * point[componentId];
+    }
+
+    if(this->Family == HYPERPLANE)
+    {
+      values[hashFunctionId] = projection >= 0.0f ? 1 : 0;
+      if(perturbations)
+      {
+        Perturbation flip = {projection * projection, hashFunctionId, values[hashFunctionId] == 1 ? -1 : 1};
+        perturbations->push_back(flip);
+      }
+    }
+    else
+    {
+      const float bucket = (projection + this->Offsets[functionId]) / this->BucketWidth;
+      values[hashFunctionId] = static_cast<int>(std::floor(bucket));
+      if(perturbations)
+      {
+        const float position = bucket - std::floor(bucket);
+        Perturbation lower = {position * position, hashFunctionId, -1};
+        Perturbation upper = {(1.0f - position) * (1.0f - position), hashFunctionId, 1};
+        perturbations->push_back(lower);
+        perturbations->push_back(upper);
+      }
+    }
+  }
+
+  if(perturbations)
+  {
+    std::sort(perturbations->begin(), perturbations->end());
+  }
+}
+
+void LocalitySensitiveHash::ComputeProbes(const std::vector<Perturbation>& perturbations,
+                                          std::vector<std::vector<unsigned int> >& probes) const
+{
+  probes.clear();
+  if(perturbations.empty() || this->NumberOfProbes < 2)
+  {
+    return;
+  }
+
+  // Enumerate the sets in order of increasing score: the successors of a set are the sets with its last
+  // perturbation replaced by the next one (shift), and with the next one added (expand) (Lv et al., 2007)
+  typedef std::pair<float, std::vector<unsigned int> > ProbeType;
+  std::priority_queue<ProbeType, std::vector<ProbeType>, std::greater<ProbeType> > queue;
+  queue.push(ProbeType(perturbations[0].Score, std::vector<unsigned int>(1, 0)));
+
+  // Sets that change a hash function twice are skipped, so allow for some more of them than probes
+  unsigned int remainingSets = 4 * this->NumberOfProbes + static_cast<unsigned int>(perturbations.size());
+  while(!queue.empty() && probes.size() + 1 < this->NumberOfProbes && remainingSets-- > 0)
+  {
+    const ProbeType probe = queue.top();
+    queue.pop();
+
+    const unsigned int last = probe.second.back();
+    if(last + 1 < perturbations.size())
+    {
+      ProbeType shifted = probe;
+      shifted.first += perturbations[last + 1].Score - perturbations[last].Score;
+      shifted.second.back() = last + 1;
+      queue.push(shifted);
+
+      ProbeType expanded = probe;
+      expanded.first += perturbations[last + 1].Score;
+      expanded.second.push_back(last + 1);
+      queue.push(expanded);
+    }
+
+    bool valid = true;
+    for(std::size_t i = 0; i < probe.second.size() && valid; ++i)
+    {
+      for(std::size_t j = i + 1; j < probe.second.size() && valid; ++j)
+      {
+        valid = perturbations[probe.second[i]].FunctionId != perturbations[probe.second[j]].FunctionId;
+      }
+    }
+
+    if(valid)
+    {
+      probes.push_back(probe.second);
+    }
+  }
+}
+
+std::uint64_t LocalitySensitiveHash::ComputeKey(const std::vector<int>& values)
+{
+  // FNV-1a of the values. Different values that collide only add candidates.
+  std::uint64_t key = 14695981039346656037ull;
+  for(std::size_t valueId = 0; valueId < values.size(); ++valueId)
+  {
+    key ^= static_cast<std::uint32_t>(values[valueId]);
+    key *= 1099511628211ull;
+  }
+
+  return key;
+}
+
+unsigned int LocalitySensitiveHash::GetNumberOfPoints() const
+{
+  return this->NumberOfPoints;
+}
+
+unsigned int LocalitySensitiveHash::GetDimension() const
+{
+  return this->Dimension;
+}
+
+LocalitySensitiveHash::FamilyEnum LocalitySensitiveHash::GetFamily() const
+{
+  return this->Family;
+}
+
+void LocalitySensitiveHash::SetNumberOfProbes(const unsigned int numberOfProbes)
+{
+  this->NumberOfProbes = std::max(numberOfProbes, 1u);
+}
+
+unsigned int LocalitySensitiveHash::GetNumberOfProbes() const
+{
+  return this->NumberOfProbes;
+}
@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef LocalitySensitiveHash_H
+#define LocalitySensitiveHash_H
+
+// STL
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+\class LocalitySensitiveHash
+\brief This class finds candidate near neighbors of a query among a set of high dimensional points (e.g. FPFH
+       descriptors or normals) by hashing them into several tables, so that close points are likely to share a
+       bucket in at least one table.
+
+       Each table hashes a point with several functions. HYPERPLANE hashes the side of a random hyperplane
+       through the origin (for the angle between points), and EUCLIDEAN and MANHATTAN hash the bucket of a
+       projection onto a random Gaussian or Cauchy (2-stable or 1-stable) direction, of width BucketWidth.
+       A query also probes the buckets that it is closest to falling into (multi-probe LSH), so fewer tables
+       give the same recall. The recall is traded for speed by NumberOfTables, NumberOfHashFunctions (per table),
+       NumberOfProbes (per table) and BucketWidth.
+
+       The points are not stored, only their ids, so the candidates must be ranked by the caller. Points can be
+       inserted at any time. Queries do not modify the tables, so they are safe to perform from multiple threads
+       (but not during Insert()).
+*/
+class LocalitySensitiveHash
+{
+public:
+
+  /** The hash function family, which determines the distance that the hash is sensitive to. */
+  enum FamilyEnum {HYPERPLANE, EUCLIDEAN, MANHATTAN};
+
+  /** 'bucketWidth' is in the units of the distance, and should be a few times the distance from a point to its
+    * nearest neighbors. It is not used by HYPERPLANE. */
+  LocalitySensitiveHash(const FamilyEnum family = EUCLIDEAN, const unsigned int numberOfTables = 8,
+                        const unsigned int numberOfHashFunctions = 12, const unsigned int numberOfProbes = 16,
+                        const float bucketWidth = 4.0f, const unsigned int seed = 0);
+
+  /** Draw the hash functions for points of 'dimension' values, and remove all of the points. This must be called
+    * before the points are inserted. */
+  void Initialize(const unsigned int dimension);
+
+  /** Add a point (which has GetDimension() values) and return its id, which counts up from 0. */
+  unsigned int Insert(const float* const point);
+
+  /** Find the ids of the points that share a probed bucket with 'query' in any table, in increasing order. */
+  void FindCandidates(const float* const query, std::vector<unsigned int>& candidates) const;
+
+  unsigned int GetNumberOfPoints() const;
+
+  unsigned int GetDimension() const;
+
+  FamilyEnum GetFamily() const;
+
+  /** Set the number of buckets that a query probes in each table (at least 1, the query's own bucket). */
+  void SetNumberOfProbes(const unsigned int numberOfProbes);
+
+  unsigned int GetNumberOfProbes() const;
+
+private:
+
+  /** A change of the value of one hash function of the query, and how unlikely it is to find near points
+    * (the squared distance of the query to the bucket boundary that it crosses). */
+  struct Perturbation
+  {
+    float Score;
+    unsigned int FunctionId;
+    int Delta;
+
+    bool operator<(const Perturbation& other) const
+    {
+      return this->Score < other.Score;
+    }
+  };
+
+  /** Compute the hash values of 'point' in a table, and (if 'perturbations' is given) the ways to change them,
+    * sorted from the most to the least promising. */
+  void ComputeHash(const unsigned int tableId, const float* const point, std::vector<int>& values,
+                   std::vector<Perturbation>* const perturbations) const;
+
+  /** Compute the sets of perturbations (as sorted indices into 'perturbations') with the smallest total scores
+    * that do not change any hash function twice, from the smallest total. */
+  void ComputeProbes(const std::vector<Perturbation>& perturbations,
+                     std::vector<std::vector<unsigned int> >& probes) const;
+
+  static std::uint64_t ComputeKey(const std::vector<int>& values);
+
+  FamilyEnum Family;
+  unsigned int NumberOfTables;
+  unsigned int NumberOfHashFunctions;
+  unsigned int NumberOfProbes;
+  float BucketWidth;
+  unsigned int Seed;
+
+  unsigned int Dimension = 0;
+  unsigned int NumberOfPoints = 0;
+
+  /** The direction and offset of each hash function of each table, one after another. */
+  std::vector<float> Directions;
+  std::vector<float> Offsets;
+
+  /** The ids of the points in each bucket of each table. */
+  typedef std::unordered_map<std::uint64_t, std::vector<unsigned int> > TableType;
+  std::vector<TableType> Tables;
+};
+
+#endif
@@ -0,0 +1,146 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "NewSourcePatches.h"
+
+// Custom
+#include "SummedAreaTable.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <algorithm>
+
+namespace NewSourcePatches
+{
+
+std::vector<itk::Index<2> > GetNewlyValidPatchCenters(const Mask* const mask,
+                                                      const std::vector<itk::Index<2> >& newlyFilledPixels,
+                                                      const unsigned int patchHalfWidth)
+{
+  std::vector<itk::Index<2> > newlyValidCenters;
+
+  const itk::ImageRegion<2>& fullRegion = mask->GetLargestPossibleRegion();
+  const itk::SizeValueType patchSideLength = 2 * patchHalfWidth + 1;
+  if(newlyFilledPixels.empty() ||
+     fullRegion.GetSize()[0] < patchSideLength || fullRegion.GetSize()[1] < patchSideLength)
+  {
+    return newlyValidCenters;
+  }
+
+  // The centers of the patches that are entirely inside the image
+  itk::Index<2> insideCenterCorner = {{fullRegion.GetIndex()[0] + patchHalfWidth,
+                                       fullRegion.GetIndex()[1] + patchHalfWidth}};
+  itk::Size<2> insideCenterSize = {{fullRegion.GetSize()[0] - 2 * patchHalfWidth,
+                                    fullRegion.GetSize()[1] - 2 * patchHalfWidth}};
+  itk::ImageRegion<2> insideCenterRegion(insideCenterCorner, insideCenterSize);
+
+  // The centers of the patches that can contain a newly filled pixel
+  itk::Index<2> minCorner = newlyFilledPixels[0];
+  itk::Index<2> maxCorner = newlyFilledPixels[0];
+  for(std::size_t pixelId = 1; pixelId < newlyFilledPixels.size(); ++pixelId)
+  {
+    for(unsigned int dimension = 0; dimension < 2; ++dimension)
+    {
+      minCorner[dimension] = std::min(minCorner[dimension], newlyFilledPixels[pixelId][dimension]);
+      maxCorner[dimension] = std::max(maxCorner[dimension], newlyFilledPixels[pixelId][dimension]);
+    }
+  }
+
+  itk::Size<2> filledSize = {{static_cast<itk::SizeValueType>(maxCorner[0] - minCorner[0] + 1),
+                              static_cast<itk::SizeValueType>(maxCorner[1] - minCorner[1] + 1)}};
+  itk::ImageRegion<2> centerRegion(minCorner, filledSize);
+  centerRegion.PadByRadius(patchHalfWidth);
+  if(!centerRegion.Crop(insideCenterRegion))
+  {
+    return newlyValidCenters;
+  }
+
+  // Every patch centered in 'centerRegion' is inside 'tableRegion', which is inside the image
+  itk::ImageRegion<2> tableRegion = centerRegion;
+  tableRegion.PadByRadius(patchHalfWidth);
+
+  typedef itk::Image<unsigned char, 2> IndicatorImageType;
+
+  IndicatorImageType::Pointer invalidPixelsImage = IndicatorImageType::New();
+  invalidPixelsImage->SetRegions(tableRegion);
+  invalidPixelsImage->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<IndicatorImageType> invalidPixelsIterator(invalidPixelsImage, tableRegion);
+  while(!invalidPixelsIterator.IsAtEnd())
+  {
+    invalidPixelsIterator.Set(mask->IsValid(invalidPixelsIterator.GetIndex()) ? 0 : 1);
+    ++invalidPixelsIterator;
+  }
+
+  IndicatorImageType::Pointer filledPixelsImage = IndicatorImageType::New();
+  filledPixelsImage->SetRegions(tableRegion);
+  filledPixelsImage->Allocate();
+  filledPixelsImage->FillBuffer(0);
+
+  for(std::size_t pixelId = 0; pixelId < newlyFilledPixels.size(); ++pixelId)
+  {
+    filledPixelsImage->SetPixel(newlyFilledPixels[pixelId], 1);
+  }
+
+  SummedAreaTable<IndicatorImageType> invalidPixelsTable(invalidPixelsImage.GetPointer());
+  SummedAreaTable<IndicatorImageType> filledPixelsTable(filledPixelsImage.GetPointer());
+
+  // Test the rows in parallel, and then concatenate them so that the centers are in raster order
+  const int numberOfRows = static_cast<int>(centerRegion.GetSize()[1]);
+  std::vector<std::vector<itk::Index<2> > > rowCenters(numberOfRows);
+
+  #pragma omp parallel for
+  for(int row = 0; row < numberOfRows; ++row)
+  {
+    itk::Index<2> center = {{centerRegion.GetIndex()[0], centerRegion.GetIndex()[1] + row}};
+    for(itk::SizeValueType column = 0; column < centerRegion.GetSize()[0]; ++column, ++center[0])
+    {
+      itk::ImageRegion<2> patchRegion = ITKHelpers::GetRegionInRadiusAroundPixel(center, patchHalfWidth);
+
+      double numberOfInvalidPixels = 0.0;
+      invalidPixelsTable.AddSum(patchRegion, &numberOfInvalidPixels);
+      if(numberOfInvalidPixels > 0.0)
+      {
+        continue;
+      }
+
+      double numberOfFilledPixels = 0.0;
+      filledPixelsTable.AddSum(patchRegion, &numberOfFilledPixels);
+      if(numberOfFilledPixels > 0.0)
+      {
+        rowCenters[row].push_back(center);
+      }
+    }
+  }
+
+  for(int row = 0; row < numberOfRows; ++row)
+  {
+    newlyValidCenters.insert(newlyValidCenters.end(), rowCenters[row].begin(), rowCenters[row].end());
+  }
+
+  return newlyValidCenters;
+}
+
+} // end namespace
@@ -0,0 +1,49 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef NewSourcePatches_H
+#define NewSourcePatches_H
+
+// Submodules
+#include <Mask/Mask.h>
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <vector>
+
+/** Functions to find the patches that become source patches when hole pixels are filled (see
+  * InpaintingVisitor::SetAllowNewPatches()). Only a patch that contains a newly filled pixel can change from
+  * invalid to valid, so only the centers within the patch radius of the newly filled pixels are tested, each in
+  * constant time with summed area tables of the hole pixels and of the newly filled pixels around them.
+  */
+namespace NewSourcePatches
+{
+
+/** Get the centers (in raster order) of the patches of half width 'patchHalfWidth' that are entirely inside
+  * 'mask', have no hole pixels in 'mask', and contain at least one of 'newlyFilledPixels' (which were hole pixels
+  * before they were filled, and so were not part of any valid patch). 'mask' must already be filled. */
+std::vector<itk::Index<2> > GetNewlyValidPatchCenters(const Mask* const mask,
+                                                      const std::vector<itk::Index<2> >& newlyFilledPixels,
+                                                      const unsigned int patchHalfWidth);
+
+} // end namespace
+
+#endif
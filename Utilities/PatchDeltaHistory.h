@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PatchDeltaHistory_H
+#define PatchDeltaHistory_H
+
+// Submodules
+#include <Mask/Mask.h>
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegion.h"
+
+// STL
+#include <map>
+#include <vector>
+
+/**
+\class PatchDeltaHistory
+\brief This class records the history of an inpainting as a list of patch deltas so that
+       the state after any iteration can be reconstructed.
+
+       Each iteration only stores the pixels of the target region that were holes when the
+       iteration started (their values before and after the iteration), the source/target pair,
+       and the candidate source patches that were considered. The memory used is therefore
+       proportional to the total painted area rather than to (iterations x image size).
+       A full copy of the image and mask (a keyframe) is also stored every KeyframeInterval
+       iterations so that seeking to a far away iteration does not have to replay every delta.
+
+       Iteration i is recorded between BeginIteration() and the next BeginIteration() (or
+       EndIteration()), so it does not matter in which order the other visitors modify the image
+       and the mask during the iteration.
+
+       State s is the state after s iterations (state 0 is the image and mask before inpainting).
+*/
+template <typename TImage>
+class PatchDeltaHistory
+{
+public:
+
+  typedef typename TImage::PixelType PixelType;
+
+  /** The change to the image and mask made by one iteration. */
+  struct Delta
+  {
+    itk::Index<2> TargetPixel;
+    itk::Index<2> SourcePixel;
+
+    /** The target region (cropped to the image). */
+    itk::ImageRegion<2> Region;
+
+    /** The offsets (in row-major order from the corner of Region) of the pixels that may have changed. */
+    std::vector<unsigned int> Offsets;
+
+    std::vector<PixelType> Before;
+    std::vector<PixelType> After;
+
+    std::vector<Mask::PixelType> MaskBefore;
+    std::vector<Mask::PixelType> MaskAfter;
+
+    /** The source patches that were considered for this target patch. */
+    std::vector<itk::Index<2> > Candidates;
+  };
+
+  /** 'image' and 'mask' are the images that are being inpainted. Their current values are recorded as state 0.
+    * If 'keyframeInterval' is 0, only state 0 is stored as a keyframe. */
+  PatchDeltaHistory(const TImage* const image, const Mask* const mask, const unsigned int keyframeInterval = 500);
+
+  /** Set the candidates that were considered for the next iteration. This is typically called
+    * from a nearest neighbors visitor, before the iteration is started. */
+  template <typename TIterator>
+  void SetCandidates(TIterator first, TIterator last);
+
+  /** Start recording an iteration. This must be called before the target patch is painted. */
+  void BeginIteration(const itk::Index<2>& targetPixel, const itk::Index<2>& sourcePixel,
+                      const unsigned int patchRadius);
+
+  /** Change the source of the iteration that is being recorded. This is needed when the source that was
+    * given to BeginIteration() is replaced before it is painted (e.g. by a manual selection). */
+  void SetSourcePixel(const itk::Index<2>& sourcePixel);
+
+  /** Finish recording the current iteration (if there is one). This must be called after all of the
+    * changes from the iteration have been made. BeginIteration() calls this automatically. */
+  void EndIteration();
+
+  /** Get the number of completely recorded iterations. */
+  unsigned int GetNumberOfIterations() const;
+
+  const Delta& GetDelta(const unsigned int iteration) const;
+
+  /** Reconstruct state 'state' in the replay image and mask. This starts from the current replay state
+    * or from the nearest keyframe, whichever is closer, and applies the deltas forward or backward. */
+  void Seek(const unsigned int state);
+
+  /** Move the replay image and mask one iteration forward. */
+  void StepForward();
+
+  /** Move the replay image and mask one iteration backward. */
+  void StepBackward();
+
+  /** Get the state that is currently in the replay image and mask. */
+  unsigned int GetReplayState() const;
+
+  const TImage* GetReplayImage() const;
+
+  const Mask* GetReplayMask() const;
+
+  /** Get the approximate number of bytes used by the deltas and keyframes. */
+  std::size_t GetMemoryUsage() const;
+
+private:
+
+  /** A full copy of the state after an iteration. */
+  struct Keyframe
+  {
+    typename TImage::Pointer Image;
+    Mask::Pointer MaskImage;
+  };
+
+  /** Get the pixel at 'offset' (in row-major order) from the corner of 'region'. */
+  static itk::Index<2> GetPixelFromOffset(const itk::ImageRegion<2>& region, const unsigned int offset);
+
+  void AddKeyframe(const unsigned int state);
+
+  void LoadKeyframe(const unsigned int state);
+
+  /** Write the 'After' (forward) or 'Before' (backward) values of 'delta' into the replay image and mask. */
+  void ApplyDelta(const Delta& delta, const bool forward);
+
+  const TImage* Image;
+
+  const Mask* MaskImage;
+
+  unsigned int KeyframeInterval;
+
+  /** The number of bytes in one pixel of the image (for GetMemoryUsage()). */
+  std::size_t BytesPerPixel;
+
+  std::vector<Delta> Deltas;
+
+  /** Keyframes by the state they store. */
+  std::map<unsigned int, Keyframe> Keyframes;
+
+  /** True between BeginIteration() and EndIteration(). */
+  bool Recording = false;
+
+  std::vector<itk::Index<2> > PendingCandidates;
+
+  typename TImage::Pointer ReplayImage;
+
+  Mask::Pointer ReplayMask;
+
+  unsigned int ReplayState = 0;
+};
+
+#include "PatchDeltaHistory.hpp"
+
+#endif
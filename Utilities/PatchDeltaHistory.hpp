@@ -0,0 +1,309 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PatchDeltaHistory_HPP
+#define PatchDeltaHistory_HPP
+
+#include "PatchDeltaHistory.h" // Make syntax parser happy
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+
+// STL
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+template <typename TImage>
+PatchDeltaHistory<TImage>::PatchDeltaHistory(const TImage* const image, const Mask* const mask,
+                                             const unsigned int keyframeInterval) :
+  Image(image), MaskImage(mask), KeyframeInterval(keyframeInterval)
+{
+  PixelType corner = image->GetPixel(image->GetLargestPossibleRegion().GetIndex());
+  this->BytesPerPixel = itk::NumericTraits<PixelType>::GetLength(corner) *
+                        sizeof(typename itk::NumericTraits<PixelType>::ValueType);
+
+  AddKeyframe(0);
+
+  this->ReplayImage = TImage::New();
+  ITKHelpers::DeepCopy(image, this->ReplayImage.GetPointer());
+
+  this->ReplayMask = Mask::New();
+  this->ReplayMask->DeepCopyFrom(mask);
+}
+
+template <typename TImage>
+template <typename TIterator>
+void PatchDeltaHistory<TImage>::SetCandidates(TIterator first, TIterator last)
+{
+  this->PendingCandidates.clear();
+  for(TIterator iterator = first; iterator != last; ++iterator)
+  {
+    this->PendingCandidates.push_back(ITKHelpers::CreateIndex(*iterator));
+  }
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::BeginIteration(const itk::Index<2>& targetPixel, const itk::Index<2>& sourcePixel,
+                                               const unsigned int patchRadius)
+{
+  EndIteration();
+
+  Delta delta;
+  delta.TargetPixel = targetPixel;
+  delta.SourcePixel = sourcePixel;
+  delta.Region = ITKHelpers::GetRegionInRadiusAroundPixel(targetPixel, patchRadius);
+  delta.Region.Crop(this->Image->GetLargestPossibleRegion());
+  delta.Candidates.swap(this->PendingCandidates);
+
+  // Only the hole pixels of the target region can be changed by this iteration.
+  itk::ImageRegionConstIteratorWithIndex<Mask> maskIterator(this->MaskImage, delta.Region);
+  unsigned int offset = 0;
+  while(!maskIterator.IsAtEnd())
+  {
+    if(this->MaskImage->IsHole(maskIterator.GetIndex()))
+    {
+      delta.Offsets.push_back(offset);
+      delta.Before.push_back(this->Image->GetPixel(maskIterator.GetIndex()));
+      delta.MaskBefore.push_back(maskIterator.Get());
+    }
+
+    ++offset;
+    ++maskIterator;
+  }
+
+  this->Deltas.push_back(delta);
+  this->Recording = true;
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::SetSourcePixel(const itk::Index<2>& sourcePixel)
+{
+  if(!this->Recording)
+  {
+    throw std::runtime_error("PatchDeltaHistory::SetSourcePixel: no iteration is being recorded!");
+  }
+
+  this->Deltas.back().SourcePixel = sourcePixel;
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::EndIteration()
+{
+  if(!this->Recording)
+  {
+    return;
+  }
+
+  Delta& delta = this->Deltas.back();
+  delta.After.reserve(delta.Offsets.size());
+  delta.MaskAfter.reserve(delta.Offsets.size());
+
+  for(unsigned int i = 0; i < delta.Offsets.size(); ++i)
+  {
+    itk::Index<2> pixel = GetPixelFromOffset(delta.Region, delta.Offsets[i]);
+    delta.After.push_back(this->Image->GetPixel(pixel));
+    delta.MaskAfter.push_back(this->MaskImage->GetPixel(pixel));
+  }
+
+  this->Recording = false;
+
+  unsigned int state = this->Deltas.size();
+  if(this->KeyframeInterval > 0 && state % this->KeyframeInterval == 0)
+  {
+    AddKeyframe(state);
+  }
+}
+
+template <typename TImage>
+unsigned int PatchDeltaHistory<TImage>::GetNumberOfIterations() const
+{
+  // The last delta is not usable until it has been ended.
+  return this->Recording ? this->Deltas.size() - 1 : this->Deltas.size();
+}
+
+template <typename TImage>
+const typename PatchDeltaHistory<TImage>::Delta& PatchDeltaHistory<TImage>::GetDelta(const unsigned int iteration) const
+{
+  if(iteration >= GetNumberOfIterations())
+  {
+    std::stringstream ss;
+    ss << "PatchDeltaHistory::GetDelta: iteration " << iteration << " has not been recorded ("
+       << GetNumberOfIterations() << " iterations are available).";
+    throw std::runtime_error(ss.str());
+  }
+
+  return this->Deltas[iteration];
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::Seek(const unsigned int state)
+{
+  if(state > GetNumberOfIterations())
+  {
+    std::stringstream ss;
+    ss << "PatchDeltaHistory::Seek: state " << state << " has not been recorded ("
+       << GetNumberOfIterations() << " iterations are available).";
+    throw std::runtime_error(ss.str());
+  }
+
+  // Find the keyframe that is the fewest deltas away from the requested state
+  unsigned int closestKeyframe = 0;
+  unsigned int closestKeyframeDistance = std::numeric_limits<unsigned int>::max();
+  for(typename std::map<unsigned int, Keyframe>::const_iterator iterator = this->Keyframes.begin();
+      iterator != this->Keyframes.end(); ++iterator)
+  {
+    unsigned int distance = (iterator->first > state) ? iterator->first - state : state - iterator->first;
+    if(distance < closestKeyframeDistance)
+    {
+      closestKeyframe = iterator->first;
+      closestKeyframeDistance = distance;
+    }
+  }
+
+  unsigned int replayDistance = (this->ReplayState > state) ? this->ReplayState - state : state - this->ReplayState;
+  if(closestKeyframeDistance < replayDistance)
+  {
+    LoadKeyframe(closestKeyframe);
+  }
+
+  while(this->ReplayState < state)
+  {
+    StepForward();
+  }
+
+  while(this->ReplayState > state)
+  {
+    StepBackward();
+  }
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::StepForward()
+{
+  if(this->ReplayState >= GetNumberOfIterations())
+  {
+    throw std::runtime_error("PatchDeltaHistory::StepForward: already at the last recorded state!");
+  }
+
+  ApplyDelta(this->Deltas[this->ReplayState], true);
+  this->ReplayState++;
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::StepBackward()
+{
+  if(this->ReplayState == 0)
+  {
+    throw std::runtime_error("PatchDeltaHistory::StepBackward: already at the first state!");
+  }
+
+  this->ReplayState--;
+  ApplyDelta(this->Deltas[this->ReplayState], false);
+}
+
+template <typename TImage>
+unsigned int PatchDeltaHistory<TImage>::GetReplayState() const
+{
+  return this->ReplayState;
+}
+
+template <typename TImage>
+const TImage* PatchDeltaHistory<TImage>::GetReplayImage() const
+{
+  return this->ReplayImage;
+}
+
+template <typename TImage>
+const Mask* PatchDeltaHistory<TImage>::GetReplayMask() const
+{
+  return this->ReplayMask;
+}
+
+template <typename TImage>
+std::size_t PatchDeltaHistory<TImage>::GetMemoryUsage() const
+{
+  std::size_t bytes = 0;
+
+  for(unsigned int i = 0; i < this->Deltas.size(); ++i)
+  {
+    const Delta& delta = this->Deltas[i];
+    bytes += sizeof(Delta);
+    bytes += delta.Offsets.size() * (sizeof(unsigned int) + 2 * this->BytesPerPixel + 2 * sizeof(Mask::PixelType));
+    bytes += delta.Candidates.size() * sizeof(itk::Index<2>);
+  }
+
+  std::size_t pixelsPerKeyframe = this->Image->GetLargestPossibleRegion().GetNumberOfPixels();
+  bytes += this->Keyframes.size() * pixelsPerKeyframe * (this->BytesPerPixel + sizeof(Mask::PixelType));
+
+  return bytes;
+}
+
+template <typename TImage>
+itk::Index<2> PatchDeltaHistory<TImage>::GetPixelFromOffset(const itk::ImageRegion<2>& region, const unsigned int offset)
+{
+  const unsigned int width = region.GetSize()[0];
+  itk::Index<2> pixel = {{region.GetIndex()[0] + static_cast<itk::Index<2>::IndexValueType>(offset % width),
+                          region.GetIndex()[1] + static_cast<itk::Index<2>::IndexValueType>(offset / width)}};
+  return pixel;
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::AddKeyframe(const unsigned int state)
+{
+  Keyframe keyframe;
+
+  keyframe.Image = TImage::New();
+  ITKHelpers::DeepCopy(this->Image, keyframe.Image.GetPointer());
+
+  keyframe.MaskImage = Mask::New();
+  keyframe.MaskImage->DeepCopyFrom(this->MaskImage);
+
+  this->Keyframes[state] = keyframe;
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::LoadKeyframe(const unsigned int state)
+{
+  const Keyframe& keyframe = this->Keyframes.at(state);
+
+  ITKHelpers::DeepCopy(keyframe.Image.GetPointer(), this->ReplayImage.GetPointer());
+  this->ReplayMask->DeepCopyFrom(keyframe.MaskImage);
+
+  this->ReplayState = state;
+}
+
+template <typename TImage>
+void PatchDeltaHistory<TImage>::ApplyDelta(const Delta& delta, const bool forward)
+{
+  const std::vector<PixelType>& values = forward ? delta.After : delta.Before;
+  const std::vector<Mask::PixelType>& maskValues = forward ? delta.MaskAfter : delta.MaskBefore;
+
+  for(unsigned int i = 0; i < delta.Offsets.size(); ++i)
+  {
+    itk::Index<2> pixel = GetPixelFromOffset(delta.Region, delta.Offsets[i]);
+    this->ReplayImage->SetPixel(pixel, values[i]);
+    this->ReplayMask->SetPixel(pixel, maskValues[i]);
+  }
+}
+
+#endif
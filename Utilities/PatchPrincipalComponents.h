@@ -0,0 +1,80 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef PatchPrincipalComponents_H
+#define PatchPrincipalComponents_H
+
+// ITK
+#include "itkImageRegion.h"
+#include "itkOffset.h"
+
+// STL
+#include <vector>
+
+/**
+\class PatchPrincipalComponents
+\brief This class learns a low dimensional PCA basis of the (vectorized, as in ImagePatchVectorized) patches of an
+       image from a sample of fully valid patches, and projects patches onto it.
+
+       A patch with invalid pixels (a target) is projected by least squares over its valid pixels only, so the
+       projection of a target is comparable to the projections of the fully valid source patches.
+*/
+template <typename TImage>
+class PatchPrincipalComponents
+{
+public:
+
+  PatchPrincipalComponents();
+
+  /** Learn a basis of (at most) 'numberOfDimensions' dimensions from the patches of 'image' with side length
+    * 'patchSideLength' whose corners are 'sampleCorners' (they must all be fully valid). */
+  void Compute(const TImage* const image, const std::vector<itk::Index<2> >& sampleCorners,
+               const unsigned int patchSideLength, const unsigned int numberOfDimensions);
+
+  unsigned int GetNumberOfDimensions() const;
+
+  /** Project the fully valid patch with corner 'corner' into 'coefficients' (GetNumberOfDimensions() values). */
+  void Project(const TImage* const image, const itk::Index<2>& corner, float* const coefficients) const;
+
+  /** Project the patch with corner 'corner' using only its 'validOffsets' (relative to the corner). */
+  void ProjectMasked(const TImage* const image, const itk::Index<2>& corner,
+                     const std::vector<itk::Offset<2> >& validOffsets, float* const coefficients) const;
+
+private:
+
+  /** The position of the first channel of 'offset' in a vectorized patch. */
+  std::size_t GetVectorPosition(const itk::Offset<2>& offset) const
+  {
+    return (static_cast<std::size_t>(offset[1]) * this->PatchSideLength + offset[0]) * this->NumberOfComponents;
+  }
+
+  unsigned int PatchSideLength = 0;
+
+  unsigned int NumberOfComponents = 0;
+
+  /** The mean patch, and the basis vectors (one after another). */
+  std::vector<float> Mean;
+  std::vector<float> Basis;
+
+  unsigned int NumberOfDimensions = 0;
+};
+
+#include "PatchPrincipalComponents.hpp"
+
+#endif
@@ -0,0 +1,231 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef PatchPrincipalComponents_HPP
+#define PatchPrincipalComponents_HPP
+
+#include "PatchPrincipalComponents.h" // Make syntax parser happy
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKContainerInterface.h>
+
+// ITK
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/algo/vnl_svd.h>
+#include <vnl/algo/vnl_symmetric_eigensystem.h>
+
+// STL
+#include <algorithm>
+#include <stdexcept>
+
+template <typename TImage>
+PatchPrincipalComponents<TImage>::PatchPrincipalComponents()
+{
+
+}
+
+template <typename TImage>
+void PatchPrincipalComponents<TImage>::Compute(const TImage* const image,
+                                               const std::vector<itk::Index<2> >& sampleCorners,
+                                               const unsigned int patchSideLength,
+                                               const unsigned int numberOfDimensions)
+{
+  if(sampleCorners.size() < 2)
+  {
+    throw std::runtime_error("PatchPrincipalComponents: at least 2 sample patches are required!");
+  }
+
+  this->PatchSideLength = patchSideLength;
+  this->NumberOfComponents = image->GetNumberOfComponentsPerPixel();
+  const std::size_t vectorLength = patchSideLength * patchSideLength * this->NumberOfComponents;
+  const std::size_t numberOfSamples = sampleCorners.size();
+
+  // Store the samples one row per vector position, so that the covariance is a product of contiguous rows
+  std::vector<double> samples(vectorLength * numberOfSamples);
+
+  #pragma omp parallel for
+  for(std::size_t sampleId = 0; sampleId < numberOfSamples; ++sampleId)
+  {
+    for(unsigned int y = 0; y < patchSideLength; ++y)
+    {
+      for(unsigned int x = 0; x < patchSideLength; ++x)
+      {
+        itk::Offset<2> offset = {{static_cast<itk::OffsetValueType>(x), static_cast<itk::OffsetValueType>(y)}};
+        typename TImage::PixelType pixel = image->GetPixel(sampleCorners[sampleId] + offset);
+        for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+        {
+          samples[(GetVectorPosition(offset) + component) * numberOfSamples + sampleId] =
+              Helpers::index(pixel, component);
+        }
+      }
+    }
+  }
+
+  this->Mean.assign(vectorLength, 0.0f);
+  for(std::size_t position = 0; position < vectorLength; ++position)
+  {
+    double* row = &samples[position * numberOfSamples];
+    double mean = 0.0;
+    for(std::size_t sampleId = 0; sampleId < numberOfSamples; ++sampleId)
+    {
+      mean += row[sampleId];
+    }
+    mean /= numberOfSamples;
+
+    for(std::size_t sampleId = 0; sampleId < numberOfSamples; ++sampleId)
+    {
+      row[sampleId] -= mean;
+    }
+    this->Mean[position] = static_cast<float>(mean);
+  }
+
+  vnl_matrix<double> covariance(vectorLength, vectorLength, 0.0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::size_t i = 0; i < vectorLength; ++i)
+  {
+    const double* rowI = &samples[i * numberOfSamples];
+    for(std::size_t j = i; j < vectorLength; ++j)
+    {
+      const double* rowJ = &samples[j * numberOfSamples];
+      double sum = 0.0;
+      for(std::size_t sampleId = 0; sampleId < numberOfSamples; ++sampleId)
+      {
+        sum += rowI[sampleId] * rowJ[sampleId];
+      }
+      covariance(i, j) = sum / (numberOfSamples - 1);
+      covariance(j, i) = covariance(i, j);
+    }
+  }
+
+  // The eigenvalues are in increasing order, so the principal components are the last eigenvectors
+  vnl_symmetric_eigensystem<double> eigensystem(covariance);
+  this->NumberOfDimensions = static_cast<unsigned int>(std::min<std::size_t>(numberOfDimensions, vectorLength));
+  this->Basis.resize(this->NumberOfDimensions * vectorLength);
+  for(unsigned int dimension = 0; dimension < this->NumberOfDimensions; ++dimension)
+  {
+    vnl_vector<double> eigenvector = eigensystem.get_eigenvector(vectorLength - 1 - dimension);
+    for(std::size_t position = 0; position < vectorLength; ++position)
+    {
+      this->Basis[dimension * vectorLength + position] = static_cast<float>(eigenvector[position]);
+    }
+  }
+}
+
+template <typename TImage>
+unsigned int PatchPrincipalComponents<TImage>::GetNumberOfDimensions() const
+{
+  return this->NumberOfDimensions;
+}
+
+template <typename TImage>
+void PatchPrincipalComponents<TImage>::Project(const TImage* const image, const itk::Index<2>& corner,
+                                               float* const coefficients) const
+{
+  const std::size_t vectorLength = this->Mean.size();
+  std::vector<float> centered(vectorLength);
+  for(unsigned int y = 0; y < this->PatchSideLength; ++y)
+  {
+    for(unsigned int x = 0; x < this->PatchSideLength; ++x)
+    {
+      itk::Offset<2> offset = {{static_cast<itk::OffsetValueType>(x), static_cast<itk::OffsetValueType>(y)}};
+      typename TImage::PixelType pixel = image->GetPixel(corner + offset);
+      for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+      {
+        const std::size_t position = GetVectorPosition(offset) + component;
+        centered[position] = Helpers::index(pixel, component) - this->Mean[position];
+      }
+    }
+  }
+
+  for(unsigned int dimension = 0; dimension < this->NumberOfDimensions; ++dimension)
+  {
+    const float* basisVector = &this->Basis[dimension * vectorLength];
+    float coefficient = 0.0f;
+    for(std::size_t position = 0; position < vectorLength; ++position)
+    {
+      coefficient += basisVector[position] * centered[position];
+    }
+    coefficients[dimension] = coefficient;
+  }
+}
+
+template <typename TImage>
+void PatchPrincipalComponents<TImage>::ProjectMasked(const TImage* const image, const itk::Index<2>& corner,
+                                                     const std::vector<itk::Offset<2> >& validOffsets,
+                                                     float* const coefficients) const
+{
+  if(validOffsets.size() == this->PatchSideLength * this->PatchSideLength)
+  {
+    Project(image, corner, coefficients);
+    return;
+  }
+
+  std::fill(coefficients, coefficients + this->NumberOfDimensions, 0.0f);
+  if(validOffsets.empty())
+  {
+    return;
+  }
+
+  // Solve (B_v^T B_v + r I) c = B_v^T (x_v - mean_v), where B_v are the rows of the basis at the valid pixels.
+  // The basis is orthonormal over the whole patch, so B_v^T B_v has eigenvalues in [0, 1]. The small ridge r pulls
+  // the components that the valid pixels barely determine towards the mean patch rather than letting them grow.
+  const double ridge = 1e-2;
+  const std::size_t vectorLength = this->Mean.size();
+  vnl_matrix<double> normalMatrix(this->NumberOfDimensions, this->NumberOfDimensions, 0.0);
+  vnl_vector<double> rightHandSide(this->NumberOfDimensions, 0.0);
+  for(const itk::Offset<2>& offset : validOffsets)
+  {
+    typename TImage::PixelType pixel = image->GetPixel(corner + offset);
+    for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+    {
+      const std::size_t position = GetVectorPosition(offset) + component;
+      const double centered = Helpers::index(pixel, component) - this->Mean[position];
+      for(unsigned int i = 0; i < this->NumberOfDimensions; ++i)
+      {
+        const double basisI = this->Basis[i * vectorLength + position];
+        rightHandSide[i] += basisI * centered;
+        for(unsigned int j = i; j < this->NumberOfDimensions; ++j)
+        {
+          normalMatrix(i, j) += basisI * this->Basis[j * vectorLength + position];
+        }
+      }
+    }
+  }
+
+  for(unsigned int i = 0; i < this->NumberOfDimensions; ++i)
+  {
+    normalMatrix(i, i) += ridge;
+    for(unsigned int j = i + 1; j < this->NumberOfDimensions; ++j)
+    {
+      normalMatrix(j, i) = normalMatrix(i, j);
+    }
+  }
+
+  vnl_svd<double> svd(normalMatrix);
+  vnl_vector<double> solution = svd.solve(rightHandSide);
+  for(unsigned int dimension = 0; dimension < this->NumberOfDimensions; ++dimension)
+  {
+    coefficients[dimension] = static_cast<float>(solution[dimension]);
+  }
+}
+
+#endif
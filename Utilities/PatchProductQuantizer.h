@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef PatchProductQuantizer_H
+#define PatchProductQuantizer_H
+
+// ITK
+#include "itkImageRegion.h"
+#include "itkOffset.h"
+
+// STL
+#include <algorithm>
+#include <vector>
+
+/**
+\class PatchProductQuantizer
+\brief This class compresses the (vectorized, as in ImagePatchVectorized) patches of an image to a few bytes each by
+       product quantization: the patch is split into sub-vectors of RowsPerSubvector rows each, and each sub-vector
+       is replaced by the id of the closest of NumberOfCentroids centroids, which are learned by k-means from a
+       sample of fully valid patches.
+
+       The squared difference of a query patch (e.g. a target, using only its valid pixels) to every code is
+       approximated by asymmetric distance computation: the query is not quantized, so the difference is a sum of one
+       look up per sub-vector in a table of the differences of the query to every centroid.
+*/
+template <typename TImage>
+class PatchProductQuantizer
+{
+public:
+
+  /** The number of centroids of each sub-vector, so that a centroid id is one byte. */
+  static const unsigned int NumberOfCentroids = 256;
+
+  PatchProductQuantizer();
+
+  /** Learn the centroids of the sub-vectors of 'rowsPerSubvector' rows of the patches of 'image' with side length
+    * 'patchSideLength' whose corners are 'sampleCorners' (they must all be fully valid), with
+    * 'numberOfIterations' iterations of k-means. */
+  void Train(const TImage* const image, const std::vector<itk::Index<2> >& sampleCorners,
+             const unsigned int patchSideLength, const unsigned int rowsPerSubvector,
+             const unsigned int numberOfIterations = 10);
+
+  /** Get the number of sub-vectors, which is the number of bytes of a code. */
+  unsigned int GetCodeLength() const;
+
+  /** Get the number of values of a (vectorized) patch. */
+  unsigned int GetVectorLength() const;
+
+  /** Get the number of bytes of the centroids. */
+  std::size_t GetCodebookSize() const;
+
+  /** Encode the fully valid patch with corner 'corner' into 'code' (GetCodeLength() bytes). */
+  void Encode(const TImage* const image, const itk::Index<2>& corner, unsigned char* const code) const;
+
+  /** Compute the table (GetCodeLength() * NumberOfCentroids values) of the sum of squared differences of the
+    * 'validOffsets' (relative to the corner) of the patch with corner 'corner' to every centroid. */
+  void ComputeDistanceTable(const TImage* const image, const itk::Index<2>& corner,
+                            const std::vector<itk::Offset<2> >& validOffsets, float* const table) const;
+
+  /** Approximate the sum of squared differences of the query of 'table' to the patch of 'code'. */
+  float ComputeDistance(const float* const table, const unsigned char* const code) const
+  {
+    float distance = 0.0f;
+    for(unsigned int subvectorId = 0; subvectorId < this->NumberOfSubvectors; ++subvectorId)
+    {
+      distance += table[subvectorId * NumberOfCentroids + code[subvectorId]];
+    }
+    return distance;
+  }
+
+private:
+
+  /** Get the values of the patch with corner 'corner' in raster order. */
+  void GetPatchVector(const TImage* const image, const itk::Index<2>& corner, float* const values) const;
+
+  /** The first position of a sub-vector in a vectorized patch, and its length. */
+  unsigned int GetSubvectorBegin(const unsigned int subvectorId) const
+  {
+    return subvectorId * this->RowsPerSubvector * this->PatchSideLength * this->NumberOfComponents;
+  }
+
+  unsigned int GetSubvectorLength(const unsigned int subvectorId) const
+  {
+    return std::min(this->RowsPerSubvector, this->PatchSideLength - subvectorId * this->RowsPerSubvector) *
+           this->PatchSideLength * this->NumberOfComponents;
+  }
+
+  unsigned int PatchSideLength = 0;
+
+  unsigned int NumberOfComponents = 0;
+
+  unsigned int RowsPerSubvector = 0;
+
+  unsigned int NumberOfSubvectors = 0;
+
+  /** The centroids of each sub-vector, one after another: the centroids of a sub-vector start at
+    * NumberOfCentroids * GetSubvectorBegin(subvectorId). */
+  std::vector<float> Centroids;
+};
+
+#include "PatchProductQuantizer.hpp"
+
+#endif
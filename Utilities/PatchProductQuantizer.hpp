@@ -0,0 +1,244 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef PatchProductQuantizer_HPP
+#define PatchProductQuantizer_HPP
+
+#include "PatchProductQuantizer.h" // Make syntax parser happy
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKContainerInterface.h>
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+template <typename TImage>
+PatchProductQuantizer<TImage>::PatchProductQuantizer()
+{
+
+}
+
+template <typename TImage>
+void PatchProductQuantizer<TImage>::Train(const TImage* const image,
+                                          const std::vector<itk::Index<2> >& sampleCorners,
+                                          const unsigned int patchSideLength,
+                                          const unsigned int rowsPerSubvector,
+                                          const unsigned int numberOfIterations)
+{
+  if(sampleCorners.empty())
+  {
+    throw std::runtime_error("PatchProductQuantizer: at least 1 sample patch is required!");
+  }
+
+  this->PatchSideLength = patchSideLength;
+  this->NumberOfComponents = image->GetNumberOfComponentsPerPixel();
+  this->RowsPerSubvector = std::max(1u, std::min(rowsPerSubvector, patchSideLength));
+  this->NumberOfSubvectors = (patchSideLength + this->RowsPerSubvector - 1) / this->RowsPerSubvector;
+
+  const std::size_t vectorLength = GetVectorLength();
+  const std::size_t numberOfSamples = sampleCorners.size();
+  std::vector<float> samples(vectorLength * numberOfSamples);
+
+  #pragma omp parallel for
+  for(std::size_t sampleId = 0; sampleId < numberOfSamples; ++sampleId)
+  {
+    GetPatchVector(image, sampleCorners[sampleId], &samples[sampleId * vectorLength]);
+  }
+
+  this->Centroids.resize(NumberOfCentroids * vectorLength);
+
+  // The sub-vectors are quantized independently
+  #pragma omp parallel for schedule(dynamic)
+  for(int subvectorId = 0; subvectorId < static_cast<int>(this->NumberOfSubvectors); ++subvectorId)
+  {
+    const unsigned int begin = GetSubvectorBegin(subvectorId);
+    const unsigned int length = GetSubvectorLength(subvectorId);
+    float* centroids = &this->Centroids[NumberOfCentroids * begin];
+
+    // Start from evenly spaced samples (repeated if there are fewer samples than centroids)
+    for(unsigned int centroidId = 0; centroidId < NumberOfCentroids; ++centroidId)
+    {
+      const std::size_t sampleId = (centroidId * numberOfSamples / NumberOfCentroids) % numberOfSamples;
+      std::copy(&samples[sampleId * vectorLength + begin], &samples[sampleId * vectorLength + begin] + length,
+                centroids + centroidId * length);
+    }
+
+    std::vector<unsigned int> assignments(numberOfSamples);
+    std::vector<double> sums(NumberOfCentroids * length);
+    std::vector<unsigned int> counts(NumberOfCentroids);
+    for(unsigned int iteration = 0; iteration < numberOfIterations; ++iteration)
+    {
+      for(std::size_t sampleId = 0; sampleId < numberOfSamples; ++sampleId)
+      {
+        const float* sample = &samples[sampleId * vectorLength + begin];
+        float bestDistance = std::numeric_limits<float>::max();
+        for(unsigned int centroidId = 0; centroidId < NumberOfCentroids; ++centroidId)
+        {
+          const float* centroid = centroids + centroidId * length;
+          float distance = 0.0f;
+          for(unsigned int position = 0; position < length && distance < bestDistance; ++position)
+          {
+            const float difference = sample[position] - centroid[position];
+            distance += difference * difference;
+          }
+
+          if(distance < bestDistance)
+          {
+            bestDistance = distance;
+            assignments[sampleId] = centroidId;
+          }
+        }
+      }
+
+      std::fill(sums.begin(), sums.end(), 0.0);
+      std::fill(counts.begin(), counts.end(), 0);
+      for(std::size_t sampleId = 0; sampleId < numberOfSamples; ++sampleId)
+      {
+        const float* sample = &samples[sampleId * vectorLength + begin];
+        double* sum = &sums[assignments[sampleId] * length];
+        for(unsigned int position = 0; position < length; ++position)
+        {
+          sum[position] += sample[position];
+        }
+        counts[assignments[sampleId]]++;
+      }
+
+      // A centroid without samples keeps its position
+      for(unsigned int centroidId = 0; centroidId < NumberOfCentroids; ++centroidId)
+      {
+        if(counts[centroidId] == 0)
+        {
+          continue;
+        }
+
+        for(unsigned int position = 0; position < length; ++position)
+        {
+          centroids[centroidId * length + position] =
+              static_cast<float>(sums[centroidId * length + position] / counts[centroidId]);
+        }
+      }
+    }
+  }
+}
+
+template <typename TImage>
+unsigned int PatchProductQuantizer<TImage>::GetCodeLength() const
+{
+  return this->NumberOfSubvectors;
+}
+
+template <typename TImage>
+unsigned int PatchProductQuantizer<TImage>::GetVectorLength() const
+{
+  return this->PatchSideLength * this->PatchSideLength * this->NumberOfComponents;
+}
+
+template <typename TImage>
+std::size_t PatchProductQuantizer<TImage>::GetCodebookSize() const
+{
+  return this->Centroids.size() * sizeof(float);
+}
+
+template <typename TImage>
+void PatchProductQuantizer<TImage>::Encode(const TImage* const image, const itk::Index<2>& corner,
+                                           unsigned char* const code) const
+{
+  std::vector<float> values(GetVectorLength());
+  GetPatchVector(image, corner, values.data());
+
+  for(unsigned int subvectorId = 0; subvectorId < this->NumberOfSubvectors; ++subvectorId)
+  {
+    const unsigned int begin = GetSubvectorBegin(subvectorId);
+    const unsigned int length = GetSubvectorLength(subvectorId);
+    const float* centroids = &this->Centroids[NumberOfCentroids * begin];
+
+    float bestDistance = std::numeric_limits<float>::max();
+    for(unsigned int centroidId = 0; centroidId < NumberOfCentroids; ++centroidId)
+    {
+      const float* centroid = centroids + centroidId * length;
+      float distance = 0.0f;
+      for(unsigned int position = 0; position < length && distance < bestDistance; ++position)
+      {
+        const float difference = values[begin + position] - centroid[position];
+        distance += difference * difference;
+      }
+
+      if(distance < bestDistance)
+      {
+        bestDistance = distance;
+        code[subvectorId] = static_cast<unsigned char>(centroidId);
+      }
+    }
+  }
+}
+
+template <typename TImage>
+void PatchProductQuantizer<TImage>::ComputeDistanceTable(const TImage* const image, const itk::Index<2>& corner,
+                                                         const std::vector<itk::Offset<2> >& validOffsets,
+                                                         float* const table) const
+{
+  std::fill(table, table + this->NumberOfSubvectors * NumberOfCentroids, 0.0f);
+
+  // Only the valid pixels of the query contribute, so a sub-vector without valid pixels adds nothing
+  for(const itk::Offset<2>& offset : validOffsets)
+  {
+    const unsigned int subvectorId = offset[1] / this->RowsPerSubvector;
+    const unsigned int length = GetSubvectorLength(subvectorId);
+    const unsigned int positionInSubvector =
+        ((offset[1] - subvectorId * this->RowsPerSubvector) * this->PatchSideLength + offset[0]) *
+        this->NumberOfComponents;
+    const float* centroids = &this->Centroids[NumberOfCentroids * GetSubvectorBegin(subvectorId)];
+    float* subvectorTable = table + subvectorId * NumberOfCentroids;
+
+    typename TImage::PixelType pixel = image->GetPixel(corner + offset);
+    for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+    {
+      const float value = Helpers::index(pixel, component);
+      for(unsigned int centroidId = 0; centroidId < NumberOfCentroids; ++centroidId)
+      {
+        const float difference = value - centroids[centroidId * length + positionInSubvector + component];
+        subvectorTable[centroidId] += difference * difference;
+      }
+    }
+  }
+}
+
+template <typename TImage>
+void PatchProductQuantizer<TImage>::GetPatchVector(const TImage* const image, const itk::Index<2>& corner,
+                                                   float* const values) const
+{
+  for(unsigned int y = 0; y < this->PatchSideLength; ++y)
+  {
+    for(unsigned int x = 0; x < this->PatchSideLength; ++x)
+    {
+      itk::Offset<2> offset = {{static_cast<itk::OffsetValueType>(x), static_cast<itk::OffsetValueType>(y)}};
+      typename TImage::PixelType pixel = image->GetPixel(corner + offset);
+      for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+      {
+        values[(y * this->PatchSideLength + x) * this->NumberOfComponents + component] =
+            Helpers::index(pixel, component);
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,200 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "PixelBitmap.h"
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+  /** Count the set bits in a word. */
+  inline unsigned int PopCount(const PixelBitmap::WordType word)
+  {
+    return static_cast<unsigned int>(__builtin_popcountll(word));
+  }
+}
+
+PixelBitmap::PixelBitmap()
+{
+
+}
+
+PixelBitmap::PixelBitmap(const itk::ImageRegion<2>& region)
+{
+  SetRegion(region);
+}
+
+void PixelBitmap::SetRegion(const itk::ImageRegion<2>& region)
+{
+  this->Region = region;
+  this->Words.assign((region.GetNumberOfPixels() + 63) / 64, 0);
+  this->NumberOfSetBits = 0;
+}
+
+const itk::ImageRegion<2>& PixelBitmap::GetRegion() const
+{
+  return this->Region;
+}
+
+void PixelBitmap::Clear()
+{
+  std::fill(this->Words.begin(), this->Words.end(), 0);
+  this->NumberOfSetBits = 0;
+}
+
+bool PixelBitmap::Insert(const itk::Index<2>& index)
+{
+  assert(this->Region.IsInside(index));
+
+  std::size_t linearIndex = GetLinearIndex(index);
+  WordType bit = WordType(1) << (linearIndex & 63);
+  WordType& word = this->Words[linearIndex >> 6];
+
+  if(word & bit)
+  {
+    return false;
+  }
+
+  word |= bit;
+  this->NumberOfSetBits++;
+  return true;
+}
+
+void PixelBitmap::Erase(const itk::Index<2>& index)
+{
+  assert(this->Region.IsInside(index));
+
+  std::size_t linearIndex = GetLinearIndex(index);
+  WordType bit = WordType(1) << (linearIndex & 63);
+  WordType& word = this->Words[linearIndex >> 6];
+
+  if(word & bit)
+  {
+    word &= ~bit;
+    this->NumberOfSetBits--;
+  }
+}
+
+bool PixelBitmap::Contains(const itk::Index<2>& index) const
+{
+  if(!this->Region.IsInside(index))
+  {
+    return false;
+  }
+
+  return Contains(GetLinearIndex(index));
+}
+
+std::size_t PixelBitmap::CountBits(const std::size_t begin, const std::size_t end) const
+{
+  if(begin >= end)
+  {
+    return 0;
+  }
+
+  std::size_t firstWord = begin >> 6;
+  std::size_t lastWord = (end - 1) >> 6;
+
+  // Mask off the bits before 'begin' in the first word and the bits at or after 'end' in the last word.
+  WordType firstMask = ~WordType(0) << (begin & 63);
+  WordType lastMask = ~WordType(0) >> (63 - ((end - 1) & 63));
+
+  if(firstWord == lastWord)
+  {
+    return PopCount(this->Words[firstWord] & firstMask & lastMask);
+  }
+
+  std::size_t count = PopCount(this->Words[firstWord] & firstMask);
+  for(std::size_t wordId = firstWord + 1; wordId < lastWord; ++wordId)
+  {
+    count += PopCount(this->Words[wordId]);
+  }
+  count += PopCount(this->Words[lastWord] & lastMask);
+
+  return count;
+}
+
+unsigned int PixelBitmap::CountInRegion(const itk::ImageRegion<2>& region) const
+{
+  itk::ImageRegion<2> croppedRegion = region;
+  if(!croppedRegion.Crop(this->Region))
+  {
+    return 0;
+  }
+
+  std::size_t count = 0;
+  for(itk::Index<2>::IndexValueType row = croppedRegion.GetIndex()[1];
+      row < croppedRegion.GetIndex()[1] + static_cast<itk::Index<2>::IndexValueType>(croppedRegion.GetSize()[1]); ++row)
+  {
+    itk::Index<2> rowStart = {{croppedRegion.GetIndex()[0], row}};
+    std::size_t begin = GetLinearIndex(rowStart);
+    count += CountBits(begin, begin + croppedRegion.GetSize()[0]);
+  }
+
+  return static_cast<unsigned int>(count);
+}
+
+std::size_t PixelBitmap::Count() const
+{
+  return this->NumberOfSetBits;
+}
+
+itk::Index<2> PixelBitmap::GetIndex(const std::size_t linearIndex) const
+{
+  itk::Index<2> index = this->Region.GetIndex();
+  index[0] += static_cast<itk::Index<2>::IndexValueType>(linearIndex % this->Region.GetSize()[0]);
+  index[1] += static_cast<itk::Index<2>::IndexValueType>(linearIndex / this->Region.GetSize()[0]);
+  return index;
+}
+
+const std::vector<PixelBitmap::WordType>& PixelBitmap::GetWords() const
+{
+  return this->Words;
+}
+
+void PixelBitmap::SetWords(const std::vector<WordType>& words)
+{
+  if(words.size() != this->Words.size())
+  {
+    throw std::runtime_error("PixelBitmap::SetWords: the number of words does not match the region!");
+  }
+
+  this->Words = words;
+  this->NumberOfSetBits = CountBits(0, this->Region.GetNumberOfPixels());
+}
+
+void PixelBitmap::CreateImage(itk::Image<unsigned char, 2>* const image) const
+{
+  typedef itk::Image<unsigned char, 2> ImageType;
+  image->SetRegions(this->Region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIterator(image, this->Region);
+  while(!imageIterator.IsAtEnd())
+  {
+    imageIterator.Set(Contains(imageIterator.GetIndex()) ? 255 : 0);
+    ++imageIterator;
+  }
+}
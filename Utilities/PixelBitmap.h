@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PixelBitmap_H
+#define PixelBitmap_H
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegion.h"
+
+// STL
+#include <cstdint>
+#include <vector>
+
+/**
+\class PixelBitmap
+\brief This class stores one bit per pixel of an image region. It is used to
+       track sets of pixels (e.g. which nodes have been used as sources, or which
+       pixels have been copied) with O(1) insertion and membership queries, in
+       1/8 of the memory of an itk::Image<bool, 2> and far less than a std::set<itk::Index<2> >.
+
+       Reads are safe to perform from multiple threads as long as no thread is writing.
+*/
+class PixelBitmap
+{
+public:
+
+  typedef std::uint64_t WordType;
+
+  /** Default constructor to allow PixelBitmap objects to be stored as members. Call SetRegion() before use. */
+  PixelBitmap();
+
+  /** Construct an empty bitmap covering 'region'. */
+  explicit PixelBitmap(const itk::ImageRegion<2>& region);
+
+  /** Set the region that the bitmap covers. This clears all of the bits. */
+  void SetRegion(const itk::ImageRegion<2>& region);
+
+  /** Get the region that the bitmap covers. */
+  const itk::ImageRegion<2>& GetRegion() const;
+
+  /** Unset all of the bits. */
+  void Clear();
+
+  /** Set the bit of 'index'. Returns true if the bit was not already set.
+    * 'index' must be inside the region. */
+  bool Insert(const itk::Index<2>& index);
+
+  /** Unset the bit of 'index'. 'index' must be inside the region. */
+  void Erase(const itk::Index<2>& index);
+
+  /** Determine if the bit of 'index' is set. Pixels outside of the region are never set. */
+  bool Contains(const itk::Index<2>& index) const;
+
+  /** Determine if the bit at 'linearIndex' (see GetLinearIndex()) is set. */
+  bool Contains(const std::size_t linearIndex) const
+  {
+    return (this->Words[linearIndex >> 6] >> (linearIndex & 63)) & 1;
+  }
+
+  /** Count the set bits in 'region'. Each row is counted a word at a time, so this is
+    * much faster than querying each pixel. The part of 'region' outside of the bitmap region is ignored. */
+  unsigned int CountInRegion(const itk::ImageRegion<2>& region) const;
+
+  /** Get the total number of set bits. */
+  std::size_t Count() const;
+
+  /** Get the offset of 'index' from the corner of the region in row-major order. */
+  std::size_t GetLinearIndex(const itk::Index<2>& index) const
+  {
+    return static_cast<std::size_t>(index[1] - this->Region.GetIndex()[1]) * this->Region.GetSize()[0] +
+           static_cast<std::size_t>(index[0] - this->Region.GetIndex()[0]);
+  }
+
+  /** Get the pixel at 'linearIndex' (the inverse of GetLinearIndex()). */
+  itk::Index<2> GetIndex(const std::size_t linearIndex) const;
+
+  /** Get the bits, in row-major order starting at the corner of the region (e.g. to save them). */
+  const std::vector<WordType>& GetWords() const;
+
+  /** Replace the bits with 'words' (as returned by GetWords() for the same region). */
+  void SetWords(const std::vector<WordType>& words);
+
+  /** Create an image of the bitmap (set = 255, unset = 0). This is only intended for debugging. */
+  void CreateImage(itk::Image<unsigned char, 2>* const image) const;
+
+private:
+
+  /** Count the set bits in the linear range [begin, end). */
+  std::size_t CountBits(const std::size_t begin, const std::size_t end) const;
+
+  /** The region that the bitmap covers. */
+  itk::ImageRegion<2> Region;
+
+  /** The bits, in row-major order starting at the corner of Region. */
+  std::vector<WordType> Words;
+
+  /** Keep track of the number of set bits so that Count() is O(1). */
+  std::size_t NumberOfSetBits = 0;
+};
+
+#endif
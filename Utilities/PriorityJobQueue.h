@@ -0,0 +1,86 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PriorityJobQueue_H
+#define PriorityJobQueue_H
+
+// STL
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+/**
+\class PriorityJobQueue
+\brief A thread safe queue of jobs that are handed out by priority (highest first), and in the order they were pushed
+       among jobs of the same priority. Workers block in Pop() until there is a job or the queue is closed, so
+       the number of jobs that run at once is the number of workers that pop from the queue.
+*/
+template <typename TJob>
+class PriorityJobQueue
+{
+public:
+
+  /** Add a job. The return value is the number of jobs that will be handed out before it. */
+  std::size_t Push(const TJob& job, const int priority = 0);
+
+  /** Wait for a job and remove it from the queue. False is returned (and 'job' is not changed) if the queue
+    * was closed and has no jobs left. */
+  bool Pop(TJob& job);
+
+  /** Wake all waiting workers. Jobs that are already queued are still handed out, but no more can be pushed. */
+  void Close();
+
+  bool IsClosed() const;
+
+  std::size_t GetNumberOfQueuedJobs() const;
+
+private:
+
+  struct QueuedJob
+  {
+    TJob Job;
+    int Priority;
+    std::uint64_t SequenceNumber;
+
+    /** std::priority_queue pops its largest element, so "less" means "handed out later". */
+    bool operator<(const QueuedJob& other) const
+    {
+      if(this->Priority != other.Priority)
+      {
+        return this->Priority < other.Priority;
+      }
+      return this->SequenceNumber > other.SequenceNumber;
+    }
+  };
+
+  std::priority_queue<QueuedJob> Jobs;
+
+  std::uint64_t NextSequenceNumber = 0;
+
+  bool Closed = false;
+
+  mutable std::mutex Mutex;
+
+  std::condition_variable JobAvailable;
+};
+
+#include "PriorityJobQueue.hpp"
+
+#endif
@@ -0,0 +1,98 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PriorityJobQueue_HPP
+#define PriorityJobQueue_HPP
+
+#include "PriorityJobQueue.h" // Make syntax parser happy
+
+// STL
+#include <stdexcept>
+
+template <typename TJob>
+std::size_t PriorityJobQueue<TJob>::Push(const TJob& job, const int priority)
+{
+  std::size_t position = 0;
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if(this->Closed)
+    {
+      throw std::runtime_error("PriorityJobQueue::Push: the queue is closed!");
+    }
+
+    QueuedJob queuedJob;
+    queuedJob.Job = job;
+    queuedJob.Priority = priority;
+    queuedJob.SequenceNumber = this->NextSequenceNumber++;
+
+    // The queue is not iterable, so count the jobs that the new one does not go before
+    std::priority_queue<QueuedJob> jobs = this->Jobs;
+    while(!jobs.empty() && queuedJob < jobs.top())
+    {
+      position++;
+      jobs.pop();
+    }
+
+    this->Jobs.push(queuedJob);
+  }
+
+  this->JobAvailable.notify_one();
+  return position;
+}
+
+template <typename TJob>
+bool PriorityJobQueue<TJob>::Pop(TJob& job)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->JobAvailable.wait(lock, [this]{ return !this->Jobs.empty() || this->Closed; });
+
+  if(this->Jobs.empty())
+  {
+    return false;
+  }
+
+  job = this->Jobs.top().Job;
+  this->Jobs.pop();
+  return true;
+}
+
+template <typename TJob>
+void PriorityJobQueue<TJob>::Close()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Closed = true;
+  }
+  this->JobAvailable.notify_all();
+}
+
+template <typename TJob>
+bool PriorityJobQueue<TJob>::IsClosed() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->Closed;
+}
+
+template <typename TJob>
+std::size_t PriorityJobQueue<TJob>::GetNumberOfQueuedJobs() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->Jobs.size();
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "PyramidHelpers.h"
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <stdexcept>
+
+namespace PyramidHelpers
+{
+
+itk::ImageRegion<2> GetCoarseRegion(const itk::ImageRegion<2>& fineRegion)
+{
+  if(fineRegion.GetIndex()[0] != 0 || fineRegion.GetIndex()[1] != 0)
+  {
+    throw std::runtime_error("PyramidHelpers::GetCoarseRegion: the region must start at (0,0)!");
+  }
+
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> coarseSize = {{(fineRegion.GetSize()[0] + 1) / 2, (fineRegion.GetSize()[1] + 1) / 2}};
+  return itk::ImageRegion<2>(corner, coarseSize);
+}
+
+void DownsampleMask(const Mask* const fineMask, Mask* const coarseMask)
+{
+  const itk::ImageRegion<2>& fineRegion = fineMask->GetLargestPossibleRegion();
+  itk::ImageRegion<2> coarseRegion = GetCoarseRegion(fineRegion);
+
+  coarseMask->SetRegions(coarseRegion);
+  coarseMask->Allocate();
+  coarseMask->SetHoleValue(fineMask->GetHoleValue());
+  coarseMask->SetValidValue(fineMask->GetValidValue());
+
+  itk::ImageRegionIteratorWithIndex<Mask> coarseIterator(coarseMask, coarseRegion);
+  while(!coarseIterator.IsAtEnd())
+  {
+    itk::Index<2> blockCorner = {{2 * coarseIterator.GetIndex()[0], 2 * coarseIterator.GetIndex()[1]}};
+    itk::Size<2> blockSize = {{2, 2}};
+    itk::ImageRegion<2> block(blockCorner, blockSize);
+    block.Crop(fineRegion);
+
+    bool hole = false;
+    itk::ImageRegionConstIteratorWithIndex<Mask> fineIterator(fineMask, block);
+    while(!fineIterator.IsAtEnd())
+    {
+      if(fineMask->IsHole(fineIterator.GetIndex()))
+      {
+        hole = true;
+        break;
+      }
+      ++fineIterator;
+    }
+
+    coarseIterator.Set(hole ? fineMask->GetHoleValue() : fineMask->GetValidValue());
+    ++coarseIterator;
+  }
+}
+
+void UpsampleSourcePixelMap(const SourcePixelMap::ImageType* const coarseSourcePixelMap, const Mask* const fineMask,
+                            SourcePixelMap::ImageType* const fineSourcePixelGuess)
+{
+  const itk::ImageRegion<2>& fineRegion = fineMask->GetLargestPossibleRegion();
+  if(GetCoarseRegion(fineRegion) != coarseSourcePixelMap->GetLargestPossibleRegion())
+  {
+    throw std::runtime_error("PyramidHelpers::UpsampleSourcePixelMap: the source pixel map is not the next coarser level of the mask!");
+  }
+
+  fineSourcePixelGuess->SetRegions(fineRegion);
+  fineSourcePixelGuess->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<SourcePixelMap::ImageType> fineIterator(fineSourcePixelGuess, fineRegion);
+  while(!fineIterator.IsAtEnd())
+  {
+    const itk::Index<2>& finePixel = fineIterator.GetIndex();
+    fineIterator.Set(SourcePixelMap::InvalidSourcePixel);
+
+    if(fineMask->IsHole(finePixel))
+    {
+      itk::Index<2> coarsePixel = {{finePixel[0] / 2, finePixel[1] / 2}};
+      itk::Index<2> coarseSource = SourcePixelMap::GetIndex(coarseSourcePixelMap,
+                                                            coarseSourcePixelMap->GetPixel(coarsePixel));
+      if(coarseSource[0] >= 0)
+      {
+        itk::Index<2> fineSource = {{2 * coarseSource[0] + finePixel[0] - 2 * coarsePixel[0],
+                                     2 * coarseSource[1] + finePixel[1] - 2 * coarsePixel[1]}};
+        if(fineRegion.IsInside(fineSource))
+        {
+          fineIterator.Set(fineSourcePixelGuess->ComputeOffset(fineSource));
+        }
+      }
+    }
+
+    ++fineIterator;
+  }
+}
+
+} // end namespace
@@ -0,0 +1,66 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PyramidHelpers_H
+#define PyramidHelpers_H
+
+// Submodules
+#include <Mask/Mask.h>
+
+// Custom
+#include "Utilities/SourcePixelMap.h"
+
+// ITK
+#include "itkImageRegion.h"
+
+/** Functions to build the image/mask pyramid used by coarse-to-fine inpainting. Each level is half the
+  * size (rounded up) of the level below it, and coarse pixel c corresponds to the 2x2 block of fine pixels
+  * starting at 2c. All regions must start at (0,0).
+  */
+namespace PyramidHelpers
+{
+
+////////////// Functions //////////////
+
+/** Get the region of the next coarser level. */
+itk::ImageRegion<2> GetCoarseRegion(const itk::ImageRegion<2>& fineRegion);
+
+/** Create the mask of the next coarser level. A coarse pixel is a hole if any of its fine pixels is a hole,
+  * so that the coarse hole covers the fine hole. */
+void DownsampleMask(const Mask* const fineMask, Mask* const coarseMask);
+
+/** Convert the source pixel map of an inpainted coarse level (see InpaintingVisitor::GetSourcePixelMapImage())
+  * to a guess for each hole pixel of the next finer level: fine pixel p = 2c + d is guessed to come from
+  * 2*source(c) + d. Pixels that are not holes in 'fineMask', or whose guess is outside of the image, are set to
+  * SourcePixelMap::InvalidSourcePixel. */
+void UpsampleSourcePixelMap(const SourcePixelMap::ImageType* const coarseSourcePixelMap, const Mask* const fineMask,
+                            SourcePixelMap::ImageType* const fineSourcePixelGuess);
+
+////////////// Function templates //////////////
+
+/** Create the image of the next coarser level by averaging each 2x2 block. The pixel values of coarse holes
+  * do not matter (they are inpainted), and a coarse pixel is only valid if its whole block is valid, so no hole
+  * values leak into the coarse level. */
+template <typename TImage>
+void DownsampleImage(const TImage* const fineImage, TImage* const coarseImage);
+
+}
+
+#include "PyramidHelpers.hpp"
+
+#endif
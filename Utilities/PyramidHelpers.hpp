@@ -0,0 +1,90 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef PyramidHelpers_HPP
+#define PyramidHelpers_HPP
+
+#include "PyramidHelpers.h" // Make syntax parser happy
+
+// ITK
+#include "itkDefaultConvertPixelTraits.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <algorithm>
+#include <vector>
+
+namespace PyramidHelpers
+{
+
+template <typename TImage>
+void DownsampleImage(const TImage* const fineImage, TImage* const coarseImage)
+{
+  typedef typename TImage::PixelType PixelType;
+  typedef itk::DefaultConvertPixelTraits<PixelType> PixelTraitsType;
+  typedef typename PixelTraitsType::ComponentType ComponentType;
+
+  itk::ImageRegion<2> fineRegion = fineImage->GetLargestPossibleRegion();
+  itk::ImageRegion<2> coarseRegion = GetCoarseRegion(fineRegion);
+
+  coarseImage->SetRegions(coarseRegion);
+  coarseImage->SetNumberOfComponentsPerPixel(fineImage->GetNumberOfComponentsPerPixel()); // For VectorImage
+  coarseImage->Allocate();
+
+  const unsigned int numberOfComponents = fineImage->GetNumberOfComponentsPerPixel();
+  std::vector<double> sums(numberOfComponents);
+
+  itk::ImageRegionIteratorWithIndex<TImage> coarseIterator(coarseImage, coarseRegion);
+  while(!coarseIterator.IsAtEnd())
+  {
+    // Average the block (which is smaller at the far edges of an odd sized image) so that the coarse level does
+    // not alias.
+    itk::Index<2> blockCorner = {{2 * coarseIterator.GetIndex()[0], 2 * coarseIterator.GetIndex()[1]}};
+    itk::Size<2> blockSize = {{2, 2}};
+    itk::ImageRegion<2> block(blockCorner, blockSize);
+    block.Crop(fineRegion);
+
+    std::fill(sums.begin(), sums.end(), 0.0);
+    itk::ImageRegionConstIterator<TImage> fineIterator(fineImage, block);
+    while(!fineIterator.IsAtEnd())
+    {
+      PixelType finePixel = fineIterator.Get();
+      for(unsigned int component = 0; component < numberOfComponents; ++component)
+      {
+        sums[component] += PixelTraitsType::GetNthComponent(component, finePixel);
+      }
+      ++fineIterator;
+    }
+
+    // Copy a fine pixel to get a pixel with the right number of components (for VectorImage)
+    PixelType coarsePixel = fineImage->GetPixel(blockCorner);
+    for(unsigned int component = 0; component < numberOfComponents; ++component)
+    {
+      PixelTraitsType::SetNthComponent(component, coarsePixel,
+                                       static_cast<ComponentType>(sums[component] / block.GetNumberOfPixels()));
+    }
+    coarseIterator.Set(coarsePixel);
+
+    ++coarseIterator;
+  }
+}
+
+} // end namespace
+
+#endif
@@ -0,0 +1,52 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef SourcePixelMap_H
+#define SourcePixelMap_H
+
+// ITK
+#include "itkImage.h"
+
+// STL
+#include <limits>
+
+/** The source pixel map records, for every pixel, which pixel its value was originally copied from.
+  * Rather than storing an itk::Index<2> (16 bytes) per pixel, it stores the 32-bit linear index of the
+  * source pixel (the offset into the image buffer, as computed by itk::Image::ComputeOffset()).
+  */
+namespace SourcePixelMap
+{
+  typedef itk::Image<unsigned int, 2> ImageType;
+
+  /** The value of hole pixels that have not been filled yet. */
+  const unsigned int InvalidSourcePixel = std::numeric_limits<unsigned int>::max();
+
+  /** Get the pixel that 'linearIndex' refers to. */
+  inline itk::Index<2> GetIndex(const ImageType* const sourcePixelMap, const unsigned int linearIndex)
+  {
+    if(linearIndex == InvalidSourcePixel)
+    {
+      itk::Index<2> invalidIndex = {{-1, -1}};
+      return invalidIndex;
+    }
+
+    return sourcePixelMap->ComputeIndex(linearIndex);
+  }
+}
+
+#endif
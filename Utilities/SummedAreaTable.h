@@ -0,0 +1,76 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef SummedAreaTable_H
+#define SummedAreaTable_H
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <vector>
+
+/**
+\class SummedAreaTable
+\brief This class holds, for each channel of an image, the sum of all pixels above and to the left of each pixel,
+       so that the sum of any rectangle of the image can be computed from 4 values, regardless of its size.
+
+       The table is a snapshot of the image when Compute() was called. The sum of a rectangle whose pixels have
+       not changed since then is still exact, even if other pixels have changed (e.g. the source patches of an
+       inpainting, which are never modified).
+*/
+template <typename TImage>
+class SummedAreaTable
+{
+public:
+
+  SummedAreaTable();
+
+  explicit SummedAreaTable(const TImage* const image);
+
+  /** (Re)compute the table of the largest possible region of 'image'. */
+  void Compute(const TImage* const image);
+
+  /** Add the sum of each channel of 'region' to 'sums' (which must have GetNumberOfComponents() elements).
+    * 'region' must be inside the image. */
+  void AddSum(const itk::ImageRegion<2>& region, double* const sums) const;
+
+  unsigned int GetNumberOfComponents() const;
+
+  const itk::ImageRegion<2>& GetRegion() const;
+
+private:
+
+  /** Get the position in Sums of the first channel of corner (x, y) of the table, which is one larger than the
+    * image in each dimension (the first row and column are 0). */
+  std::size_t GetTableOffset(const itk::IndexValueType x, const itk::IndexValueType y) const
+  {
+    return (static_cast<std::size_t>(y - this->Region.GetIndex()[1]) * (this->Region.GetSize()[0] + 1) +
+            static_cast<std::size_t>(x - this->Region.GetIndex()[0])) * this->NumberOfComponents;
+  }
+
+  itk::ImageRegion<2> Region;
+
+  unsigned int NumberOfComponents = 0;
+
+  std::vector<double> Sums;
+};
+
+#include "SummedAreaTable.hpp"
+
+#endif
@@ -0,0 +1,109 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef SummedAreaTable_HPP
+#define SummedAreaTable_HPP
+
+#include "SummedAreaTable.h" // Make syntax parser happy
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKContainerInterface.h>
+
+// ITK
+#include "itkImageRegionConstIterator.h"
+
+// STL
+#include <algorithm>
+
+template <typename TImage>
+SummedAreaTable<TImage>::SummedAreaTable()
+{
+
+}
+
+template <typename TImage>
+SummedAreaTable<TImage>::SummedAreaTable(const TImage* const image)
+{
+  Compute(image);
+}
+
+template <typename TImage>
+void SummedAreaTable<TImage>::Compute(const TImage* const image)
+{
+  this->Region = image->GetLargestPossibleRegion();
+  this->NumberOfComponents = image->GetNumberOfComponentsPerPixel();
+
+  const std::size_t width = this->Region.GetSize()[0];
+  const std::size_t height = this->Region.GetSize()[1];
+  const std::size_t rowLength = (width + 1) * this->NumberOfComponents;
+  this->Sums.assign((height + 1) * rowLength, 0.0);
+
+  // Row y + 1 of the table is row y of the table plus the running sum of row y of the image
+  std::vector<double> rowSums(this->NumberOfComponents);
+  itk::ImageRegionConstIterator<TImage> imageIterator(image, this->Region);
+  for(std::size_t y = 0; y < height; ++y)
+  {
+    std::fill(rowSums.begin(), rowSums.end(), 0.0);
+    const double* above = &this->Sums[y * rowLength];
+    double* current = &this->Sums[(y + 1) * rowLength];
+    for(std::size_t x = 0; x < width; ++x)
+    {
+      typename TImage::PixelType pixel = imageIterator.Get();
+      for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+      {
+        rowSums[component] += Helpers::index(pixel, component);
+        const std::size_t tableOffset = (x + 1) * this->NumberOfComponents + component;
+        current[tableOffset] = above[tableOffset] + rowSums[component];
+      }
+      ++imageIterator;
+    }
+  }
+}
+
+template <typename TImage>
+void SummedAreaTable<TImage>::AddSum(const itk::ImageRegion<2>& region, double* const sums) const
+{
+  const itk::IndexValueType x0 = region.GetIndex()[0];
+  const itk::IndexValueType y0 = region.GetIndex()[1];
+  const itk::IndexValueType x1 = x0 + static_cast<itk::IndexValueType>(region.GetSize()[0]);
+  const itk::IndexValueType y1 = y0 + static_cast<itk::IndexValueType>(region.GetSize()[1]);
+
+  const double* bottomRight = &this->Sums[GetTableOffset(x1, y1)];
+  const double* bottomLeft = &this->Sums[GetTableOffset(x0, y1)];
+  const double* topRight = &this->Sums[GetTableOffset(x1, y0)];
+  const double* topLeft = &this->Sums[GetTableOffset(x0, y0)];
+  for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+  {
+    sums[component] += bottomRight[component] - bottomLeft[component] - topRight[component] + topLeft[component];
+  }
+}
+
+template <typename TImage>
+unsigned int SummedAreaTable<TImage>::GetNumberOfComponents() const
+{
+  return this->NumberOfComponents;
+}
+
+template <typename TImage>
+const itk::ImageRegion<2>& SummedAreaTable<TImage>::GetRegion() const
+{
+  return this->Region;
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "AsyncImageWriter.h"
+
+// STL
+#include <iostream>
+
+// ITK
+#include "itkImage.h"
+
+typedef itk::Image<unsigned char, 2> ImageType;
+
+static ImageType::Pointer CreateImage()
+{
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{20, 20}};
+  itk::ImageRegion<2> region(corner, size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(100);
+  return image;
+}
+
+static bool TestBlock()
+{
+  ImageType::Pointer image = CreateImage();
+
+  AsyncImageWriter writer(2);
+  writer.SetBackPressurePolicy(AsyncImageWriter::BLOCK);
+  for(unsigned int i = 0; i < 10; ++i)
+  {
+    writer.WriteSequentialImage(image.GetPointer(), "TestAsyncImageWriter_Block", i, 3, "png");
+
+    // The snapshot was taken when the request was made, so this must not affect the queued images.
+    image->FillBuffer(i);
+  }
+  writer.Flush();
+
+  if(writer.GetNumberOfWrittenImages() != 10 || writer.GetNumberOfDroppedImages() != 0)
+  {
+    std::cerr << "BLOCK wrote " << writer.GetNumberOfWrittenImages() << " and dropped "
+              << writer.GetNumberOfDroppedImages() << " (should be 10 and 0)." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool TestSample()
+{
+  ImageType::Pointer image = CreateImage();
+
+  AsyncImageWriter writer;
+  writer.SetBackPressurePolicy(AsyncImageWriter::SAMPLE);
+  writer.SetSampleInterval(4);
+  itk::Index<2> corner = {{5, 5}};
+  itk::Size<2> size = {{5, 5}};
+  itk::ImageRegion<2> region(corner, size);
+  for(unsigned int i = 0; i < 10; ++i)
+  {
+    writer.WriteSequentialRegion(image.GetPointer(), region, "TestAsyncImageWriter_Sample", i, 3, "png");
+  }
+  writer.Flush();
+
+  // Iterations 0, 4, and 8
+  if(writer.GetNumberOfWrittenImages() != 3 || writer.GetNumberOfDroppedImages() != 7)
+  {
+    std::cerr << "SAMPLE wrote " << writer.GetNumberOfWrittenImages() << " and dropped "
+              << writer.GetNumberOfDroppedImages() << " (should be 3 and 7)." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool TestDrop()
+{
+  ImageType::Pointer image = CreateImage();
+
+  AsyncImageWriter writer(1);
+  writer.SetBackPressurePolicy(AsyncImageWriter::DROP);
+  for(unsigned int i = 0; i < 10; ++i)
+  {
+    writer.WriteSequentialImage(image.GetPointer(), "TestAsyncImageWriter_Drop", i, 3, "png");
+  }
+  writer.Flush();
+
+  // How many are dropped depends on timing, but every request must be accounted for.
+  if(writer.GetNumberOfWrittenImages() + writer.GetNumberOfDroppedImages() != 10 ||
+     writer.GetNumberOfWrittenImages() == 0)
+  {
+    std::cerr << "DROP wrote " << writer.GetNumberOfWrittenImages() << " and dropped "
+              << writer.GetNumberOfDroppedImages() << "." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool TestZeroQueueSize()
+{
+  ImageType::Pointer image = CreateImage();
+
+  // A queue size of 0 is treated as 1, so BLOCK must not wait forever for room.
+  AsyncImageWriter writer(0);
+  writer.SetBackPressurePolicy(AsyncImageWriter::BLOCK);
+  for(unsigned int i = 0; i < 3; ++i)
+  {
+    writer.WriteSequentialImage(image.GetPointer(), "TestAsyncImageWriter_ZeroQueueSize", i, 3, "png");
+  }
+  writer.Flush();
+
+  if(writer.GetNumberOfWrittenImages() != 3)
+  {
+    std::cerr << "A queue size of 0 wrote " << writer.GetNumberOfWrittenImages() << " (should be 3)." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool TestFailure()
+{
+  ImageType::Pointer image = CreateImage();
+
+  AsyncImageWriter writer;
+  writer.WriteSequentialImage(image.GetPointer(), "TestAsyncImageWriter_NonexistentDirectory/Failure", 0, 3, "png");
+  writer.WriteSequentialImage(image.GetPointer(), "TestAsyncImageWriter_Failure", 1, 3, "png");
+  writer.Flush();
+
+  if(writer.GetNumberOfWrittenImages() != 1 || writer.GetNumberOfFailedImages() != 1)
+  {
+    std::cerr << "Writing to a missing directory wrote " << writer.GetNumberOfWrittenImages() << " and failed "
+              << writer.GetNumberOfFailedImages() << " (should be 1 and 1)." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int, char*[])
+{
+  bool allPass = true;
+
+  allPass &= TestBlock();
+  allPass &= TestSample();
+  allPass &= TestDrop();
+  allPass &= TestZeroQueueSize();
+  allPass &= TestFailure();
+
+  if(allPass)
+  {
+    return EXIT_SUCCESS;
+  }
+  else
+  {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,108 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "BatchManifest.h"
+
+// STL
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+static bool ThrowsOnCSV(const std::string& manifest)
+{
+  std::stringstream stream(manifest);
+  try
+  {
+    BatchManifest::ReadCSV(stream);
+  }
+  catch(const std::runtime_error&)
+  {
+    return true;
+  }
+  return false;
+}
+
+int main(int, char*[])
+{
+  std::stringstream csv;
+  csv << "# A comment\n"
+      << "image, mask, radius, driver, output, workingSetSearchRadius\n"
+      << "\n"
+      << "a.png, a.mask, 15, classical, a_filled.png,\n"
+      << "b.png, b.mask, 7, pyramid, b_filled.mha, 100\n";
+
+  std::vector<BatchJob> csvJobs = BatchManifest::ReadCSV(csv);
+  if(csvJobs.size() != 2 ||
+     csvJobs[0].ImageFileName != "a.png" || csvJobs[0].MaskFileName != "a.mask" ||
+     csvJobs[0].PatchHalfWidth != 15 || csvJobs[0].Driver != "classical" ||
+     csvJobs[0].OutputFileName != "a_filled.png" || csvJobs[0].WorkingSetSearchRadius != 0 ||
+     csvJobs[1].Driver != "pyramid" || csvJobs[1].NumberOfPyramidLevels != 3 ||
+     csvJobs[1].WorkingSetSearchRadius != 100)
+  {
+    std::cerr << "The CSV manifest was not read correctly." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::stringstream json;
+  json << "[ { \"image\": \"a.png\", \"mask\": \"a.mask\", \"radius\": 15, \"output\": \"a_filled.png\" },\n"
+       << "  { \"image\": \"b.png\", \"mask\": \"b.mask\", \"radius\": \"7\", \"driver\": \"pyramid\",\n"
+       << "    \"levels\": 2, \"pyramidSearchRadius\": 6, \"output\": \"b_filled.png\" } ]\n";
+
+  std::vector<BatchJob> jsonJobs = BatchManifest::ReadJSON(json);
+  if(jsonJobs.size() != 2 ||
+     jsonJobs[0].PatchHalfWidth != 15 || jsonJobs[0].Driver != "classical" ||
+     jsonJobs[1].PatchHalfWidth != 7 || jsonJobs[1].NumberOfPyramidLevels != 2 ||
+     jsonJobs[1].PyramidSearchRadius != 6 || jsonJobs[1].OutputFileName != "b_filled.png")
+  {
+    std::cerr << "The JSON manifest was not read correctly." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(!ThrowsOnCSV("image,mask,radius,output\na.png,a.mask,15\n") ||
+     !ThrowsOnCSV("image,mask,radius,output\na.png,a.mask,-1,a_filled.png\n") ||
+     !ThrowsOnCSV("image,mask,radius,output\na.png,a.mask,,a_filled.png\n") ||
+     !ThrowsOnCSV("image,mask,radius,driver,output\na.png,a.mask,15,magic,a_filled.png\n"))
+  {
+    std::cerr << "An invalid manifest was accepted." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // 8 threads, 3 jobs, 4 requested workers: 3 workers with 2 threads each
+  unsigned int numberOfWorkers = 4;
+  unsigned int threadsPerJob = 0;
+  BatchManifest::DivideThreads(8, 3, numberOfWorkers, threadsPerJob);
+  if(numberOfWorkers != 3 || threadsPerJob != 2)
+  {
+    std::cerr << "DivideThreads(8, 3) gave " << numberOfWorkers << " workers with "
+              << threadsPerJob << " threads." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // More workers than threads: one thread per worker
+  numberOfWorkers = 16;
+  BatchManifest::DivideThreads(4, 100, numberOfWorkers, threadsPerJob);
+  if(numberOfWorkers != 4 || threadsPerJob != 1)
+  {
+    std::cerr << "DivideThreads(4, 100) gave " << numberOfWorkers << " workers with "
+              << threadsPerJob << " threads." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
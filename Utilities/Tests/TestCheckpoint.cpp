@@ -0,0 +1,230 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "Checkpoint.h"
+#include "IndirectPriorityQueue.h"
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Boost
+#include <boost/graph/grid_graph.hpp>
+
+// STL
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+  typedef boost::grid_graph<2> GraphType;
+  typedef boost::graph_traits<GraphType>::vertex_descriptor VertexDescriptorType;
+  typedef IndirectPriorityQueue<GraphType> QueueType;
+
+  /** Push a pattern of nodes with many equal priorities, and invalidate some of them. */
+  void FillQueue(QueueType& queue, const GraphType& graph)
+  {
+    for(unsigned int i = 0; i < num_vertices(graph); i += 3)
+    {
+      queue.push_or_update(vertex(i, graph), static_cast<float>(i % 5));
+    }
+
+    for(unsigned int i = 0; i < num_vertices(graph); i += 7)
+    {
+      queue.mark_as_invalid(vertex(i, graph));
+    }
+  }
+
+  /** Pop all of the valid nodes. */
+  std::vector<VertexDescriptorType> Drain(QueueType& queue)
+  {
+    std::vector<VertexDescriptorType> nodes;
+    while(!queue.empty())
+    {
+      nodes.push_back(queue.top());
+    }
+    return nodes;
+  }
+}
+
+int main(int, char*[])
+{
+  const std::string fileName = "TestCheckpoint.ckpt";
+
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{13, 7}};
+  itk::ImageRegion<2> region(corner, size);
+
+  typedef itk::Image<float, 2> ImageType;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  PixelBitmap pixelBitmap(region);
+
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIterator(image, region);
+  while(!imageIterator.IsAtEnd())
+  {
+    imageIterator.Set(0.5f * image->ComputeOffset(imageIterator.GetIndex()));
+    if(imageIterator.GetIndex()[0] % 3 == 0)
+    {
+      pixelBitmap.Insert(imageIterator.GetIndex());
+    }
+    ++imageIterator;
+  }
+
+  boost::array<std::size_t, 2> graphSideLengths = { { 10, 10 } };
+  GraphType graph(graphSideLengths);
+  QueueType queue(graph);
+  FillQueue(queue, graph);
+
+  std::unique_ptr<Checkpoint> checkpoint(new Checkpoint);
+  checkpoint->AddValue("Iteration", 9000u);
+  checkpoint->AddImage("Image", image.GetPointer());
+  checkpoint->AddPixelBitmap("Bitmap", pixelBitmap);
+  queue.SaveState(*checkpoint);
+
+  {
+  CheckpointWriter writer(fileName);
+  writer.Submit(std::move(checkpoint));
+  writer.Flush();
+  if(writer.GetNumberOfCheckpointsWritten() != 1)
+  {
+    std::cerr << "The checkpoint was not written." << std::endl;
+    return EXIT_FAILURE;
+  }
+  }
+
+  if(!Checkpoint::IsCheckpoint(fileName))
+  {
+    std::cerr << fileName << " is not recognized as a checkpoint." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Checkpoint readCheckpoint;
+  readCheckpoint.Read(fileName);
+
+  if(readCheckpoint.GetValue<unsigned int>("Iteration") != 9000u)
+  {
+    std::cerr << "The value was not restored." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ImageType::Pointer readImage = ImageType::New();
+  readImage->SetRegions(region);
+  readImage->Allocate();
+  readCheckpoint.GetImage("Image", readImage.GetPointer());
+
+  PixelBitmap readPixelBitmap(region);
+  readCheckpoint.GetPixelBitmap("Bitmap", readPixelBitmap);
+
+  imageIterator.GoToBegin();
+  while(!imageIterator.IsAtEnd())
+  {
+    if(readImage->GetPixel(imageIterator.GetIndex()) != imageIterator.Get() ||
+       readPixelBitmap.Contains(imageIterator.GetIndex()) != pixelBitmap.Contains(imageIterator.GetIndex()))
+    {
+      std::cerr << "Pixel " << imageIterator.GetIndex() << " was not restored." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++imageIterator;
+  }
+
+  if(readPixelBitmap.Count() != pixelBitmap.Count())
+  {
+    std::cerr << "The bitmap count was not restored." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A queue restored into a queue with different contents must pop in the same order as the original
+  QueueType restoredQueue(graph);
+  restoredQueue.push_or_update(vertex(1, graph), 100.0f);
+  restoredQueue.LoadState(readCheckpoint);
+
+  std::vector<VertexDescriptorType> expectedNodes = Drain(queue);
+  std::vector<VertexDescriptorType> restoredNodes = Drain(restoredQueue);
+  if(expectedNodes != restoredNodes)
+  {
+    std::cerr << "The restored queue pops " << restoredNodes.size() << " nodes in a different order than the "
+              << expectedNodes.size() << " nodes of the original queue." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Loading into an image of a different size must fail
+  itk::Size<2> otherSize = {{7, 13}};
+  ImageType::Pointer otherImage = ImageType::New();
+  otherImage->SetRegions(itk::ImageRegion<2>(corner, otherSize));
+  otherImage->Allocate();
+  try
+  {
+    readCheckpoint.GetImage("Image", otherImage.GetPointer());
+    std::cerr << "Loading into an image of a different region did not fail." << std::endl;
+    return EXIT_FAILURE;
+  }
+  catch(const std::runtime_error&)
+  {
+  }
+
+  // Lengths that do not fit in the file, and a file that ends inside a name, must be rejected before allocating
+  {
+    std::ifstream checkpointFile(fileName.c_str(), std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(checkpointFile)), std::istreambuf_iterator<char>());
+
+    const std::size_t firstSection = 16; // The magic, the version and the number of sections
+    std::uint32_t nameLength = 0;
+    std::copy(bytes.begin() + firstSection, bytes.begin() + firstSection + sizeof(nameLength),
+              reinterpret_cast<char*>(&nameLength));
+
+    std::vector<std::vector<char> > corruptFiles(3, bytes);
+    std::uint32_t hugeNameLength = 1u << 31;
+    std::copy(reinterpret_cast<char*>(&hugeNameLength), reinterpret_cast<char*>(&hugeNameLength + 1),
+              corruptFiles[0].begin() + firstSection);
+    std::uint64_t hugeDataLength = std::uint64_t(1) << 40;
+    std::copy(reinterpret_cast<char*>(&hugeDataLength), reinterpret_cast<char*>(&hugeDataLength + 1),
+              corruptFiles[1].begin() + firstSection + sizeof(nameLength) + nameLength);
+    corruptFiles[2].resize(firstSection + sizeof(nameLength) + nameLength / 2);
+
+    const std::string corruptFileName = "TestCheckpointCorrupt.ckpt";
+    for(std::size_t corruptFileId = 0; corruptFileId < corruptFiles.size(); ++corruptFileId)
+    {
+      std::ofstream corruptFile(corruptFileName.c_str(), std::ios::binary);
+      corruptFile.write(corruptFiles[corruptFileId].data(), corruptFiles[corruptFileId].size());
+      corruptFile.close();
+
+      try
+      {
+        Checkpoint corruptCheckpoint;
+        corruptCheckpoint.Read(corruptFileName);
+        std::cerr << "Corrupt checkpoint " << corruptFileId << " was not rejected." << std::endl;
+        return EXIT_FAILURE;
+      }
+      catch(const std::runtime_error&)
+      {
+      }
+    }
+    std::remove(corruptFileName.c_str());
+  }
+
+  std::remove(fileName.c_str());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "ColorClusterIndex.h"
+
+// STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+int main(int, char*[])
+{
+  const unsigned int dimension = 3;
+  const unsigned int numberOfPixels = 25;
+  const unsigned int numberOfPoints = 3000;
+
+  // Patches of noisy colors around a few dominant colors
+  std::mt19937 generator(0);
+  std::normal_distribution<float> noise(0.0f, 10.0f);
+  auto createPatch = [&generator, &noise](const unsigned int patchId, float* const pixels)
+  {
+    for(unsigned int valueId = 0; valueId < numberOfPixels * dimension; ++valueId)
+    {
+      pixels[valueId] = 50.0f * static_cast<float>((patchId * (valueId % dimension + 1)) % 5) + noise(generator);
+    }
+  };
+
+  std::vector<float> pixels(numberOfPoints * numberOfPixels * dimension);
+  std::vector<float> means(numberOfPoints * dimension, 0.0f);
+  std::vector<float> minimums(numberOfPoints * dimension, 1e9f);
+  std::vector<float> maximums(numberOfPoints * dimension, -1e9f);
+  for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    float* patch = &pixels[pointId * numberOfPixels * dimension];
+    createPatch(pointId, patch);
+    for(unsigned int valueId = 0; valueId < numberOfPixels * dimension; ++valueId)
+    {
+      const unsigned int component = pointId * dimension + valueId % dimension;
+      means[component] += patch[valueId] / numberOfPixels;
+      minimums[component] = std::min(minimums[component], patch[valueId]);
+      maximums[component] = std::max(maximums[component], patch[valueId]);
+    }
+  }
+
+  ColorClusterIndex index(32);
+  index.Build(means, minimums, maximums, dimension);
+  if(index.GetNumberOfClusters() != 32 || index.GetNumberOfPoints() != numberOfPoints)
+  {
+    std::cerr << "The index has " << index.GetNumberOfClusters() << " clusters of " << index.GetNumberOfPoints()
+              << " points but should have 32 of " << numberOfPoints << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Every point is in exactly one cluster
+  std::vector<unsigned int> counts(numberOfPoints, 0);
+  for(unsigned int clusterId = 0; clusterId < index.GetNumberOfClusters(); ++clusterId)
+  {
+    for(unsigned int pointId : index.GetMembers(clusterId))
+    {
+      counts[pointId]++;
+      if(index.GetCluster(pointId) != clusterId)
+      {
+        std::cerr << "Point " << pointId << " is a member of cluster " << clusterId << " but GetCluster() is "
+                  << index.GetCluster(pointId) << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  if(std::count(counts.begin(), counts.end(), 1u) != numberOfPoints)
+  {
+    std::cerr << "Not every point is in exactly one cluster." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The ties of the bounds are broken by the distance to the centroid, not by the id
+  auto byBound = [](const ColorClusterIndex::ClusterDistanceType& a, const ColorClusterIndex::ClusterDistanceType& b)
+  {
+    return a.first < b.first;
+  };
+
+  // The bounds are never larger than the differences to the members, for queries with only some valid pixels
+  for(unsigned int queryId = 0; queryId < 50; ++queryId)
+  {
+    std::vector<float> query(numberOfPixels * dimension);
+    createPatch(queryId * 7 + 1, query.data());
+    const unsigned int numberOfValidPixels = 5 + queryId % (numberOfPixels - 5);
+
+    std::vector<float> queryMean(dimension, 0.0f);
+    for(unsigned int valueId = 0; valueId < numberOfValidPixels * dimension; ++valueId)
+    {
+      queryMean[valueId % dimension] += query[valueId] / numberOfValidPixels;
+    }
+
+    std::vector<ColorClusterIndex::ClusterDistanceType> clusters =
+        index.GetClustersByBox(query.data(), numberOfValidPixels);
+    if(clusters.size() != index.GetNumberOfClusters() || !std::is_sorted(clusters.begin(), clusters.end(), byBound))
+    {
+      std::cerr << "GetClustersByBox() did not return every cluster in order of its bound." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    for(const ColorClusterIndex::ClusterDistanceType& cluster : clusters)
+    {
+      const float meanBound = index.ComputeMeanLowerBound(cluster.second, queryMean.data());
+      for(unsigned int pointId : index.GetMembers(cluster.second))
+      {
+        float meanDistance = 0.0f;
+        for(unsigned int component = 0; component < dimension; ++component)
+        {
+          const float difference = queryMean[component] - means[pointId * dimension + component];
+          meanDistance += difference * difference;
+        }
+
+        float difference = 0.0f;
+        for(unsigned int valueId = 0; valueId < numberOfValidPixels * dimension; ++valueId)
+        {
+          const float valueDifference = query[valueId] - pixels[pointId * numberOfPixels * dimension + valueId];
+          difference += valueDifference * valueDifference;
+        }
+        difference /= numberOfValidPixels;
+
+        if(meanBound > meanDistance || cluster.first > difference ||
+           index.ComputeBoxLowerBound(&minimums[pointId * dimension], &maximums[pointId * dimension],
+                                      query.data(), numberOfValidPixels) > difference)
+        {
+          std::cerr << "A bound of cluster " << cluster.second << " is larger than the difference of query "
+                    << queryId << " to point " << pointId << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    std::vector<ColorClusterIndex::ClusterDistanceType> clustersByMean = index.GetClustersByMean(queryMean.data());
+    if(clustersByMean.size() != index.GetNumberOfClusters() ||
+       !std::is_sorted(clustersByMean.begin(), clustersByMean.end(), byBound))
+    {
+      std::cerr << "GetClustersByMean() did not return every cluster in order of its bound." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // There are never more clusters than points
+  ColorClusterIndex smallIndex(32);
+  smallIndex.Build(std::vector<float>(means.begin(), means.begin() + 5 * dimension),
+                   std::vector<float>(minimums.begin(), minimums.begin() + 5 * dimension),
+                   std::vector<float>(maximums.begin(), maximums.begin() + 5 * dimension), dimension);
+  if(smallIndex.GetNumberOfClusters() != 5)
+  {
+    std::cerr << "The index of 5 points has " << smallIndex.GetNumberOfClusters() << " clusters." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "DeadlineController.h"
+
+// STL
+#include <iostream>
+#include <sstream>
+
+int main(int, char*[])
+{
+  // A budget of 10s with 1000 hole pixels
+  DeadlineController controller(10.0, 8, 20, 4);
+  controller.SetMinimumIterations(2);
+  controller.Start(1000);
+
+  // 150 pixels per second finishes in time, so nothing is degraded
+  if(controller.Update(2, 700, 2.0) || controller.Update(4, 400, 4.0) || !controller.GetDegradations().empty())
+  {
+    std::cerr << "Nothing should be degraded while the run is on schedule." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The rate drops to 76 pixels per second, which would take 5 more seconds
+  if(!controller.Update(6, 390, 8.0) || controller.GetSettings().K != 4)
+  {
+    std::cerr << "K should have been halved to 4, but it is " << controller.GetSettings().K << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The rate of the new settings is not known until MinimumIterations more iterations have been done
+  if(controller.Update(7, 389, 8.1))
+  {
+    std::cerr << "A degradation should not be applied before the new rate is measured." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Keep falling behind, so everything is applied in order
+  unsigned int numberOfHolePixels = 389;
+  double seconds = 8.1;
+  for(unsigned int iteration = 8; iteration < 100 && !controller.IsFullyDegraded(); ++iteration)
+  {
+    seconds += 0.01;
+    controller.Update(iteration, --numberOfHolePixels, seconds);
+  }
+
+  const DeadlineSearchSettings& settings = controller.GetSettings();
+  if(!controller.IsFullyDegraded() || settings.K != 1 || !settings.LocalSearch || settings.Stride != 4)
+  {
+    std::cerr << "All of the degradations should have been applied." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // K 8 -> 4 -> 2 -> 1, local search, stride 2 -> 4
+  if(controller.GetDegradations().size() != 6 ||
+     controller.GetDegradations()[3].Description != "search restricted to a radius of 20")
+  {
+    std::cerr << "There should be 6 degradations, but there are " << controller.GetDegradations().size()
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::stringstream report;
+  controller.WriteReport(report);
+  std::cout << report.str();
+  if(report.str().find("candidate stride raised to 4") == std::string::npos)
+  {
+    std::cerr << "The report should list the degradations." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A run that makes no progress at all is degraded once it is past the planned time
+  DeadlineController stalledController(1.0, 1, 0, 2);
+  stalledController.SetMinimumIterations(1);
+  stalledController.Start(100);
+  if(stalledController.Update(1, 100, 0.5) || !stalledController.Update(2, 100, 0.95) ||
+     stalledController.GetSettings().Stride != 2)
+  {
+    std::cerr << "A stalled run should have its stride raised once it is past the planned time." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,247 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "FillLog.h"
+
+// STL
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+  /** The target and source of the ith fake fill. */
+  void GetPair(const unsigned int i, const itk::Size<2>& size, itk::Index<2>& target, itk::Index<2>& source)
+  {
+    target[0] = (i * 7) % size[0];
+    target[1] = (i * 3) % size[1];
+    source[0] = (i * 13) % size[0];
+    source[1] = (i * 5) % size[1];
+  }
+
+  /** Check that 'reader' contains the first 'numberOfRecords' fake fills. */
+  bool CheckReader(const FillLogReader& reader, const itk::Size<2>& size, const unsigned int numberOfRecords)
+  {
+    if(reader.GetNumberOfRecords() != numberOfRecords)
+    {
+      std::cerr << "There are " << reader.GetNumberOfRecords() << " records but there should be "
+                << numberOfRecords << std::endl;
+      return false;
+    }
+
+    for(unsigned int i = 0; i < numberOfRecords; ++i)
+    {
+      itk::Index<2> target;
+      itk::Index<2> expectedSource;
+      GetPair(i, size, target, expectedSource);
+
+      const FillLog::Record& record = reader.GetRecord(i);
+      if(record.TargetX != target[0] || record.TargetY != target[1] ||
+         record.SourceX != expectedSource[0] || record.SourceY != expectedSource[1])
+      {
+        std::cerr << "Record " << i << " is wrong." << std::endl;
+        return false;
+      }
+
+      itk::Index<2> source;
+      if(!reader.FindSource(target, source) || source != expectedSource)
+      {
+        std::cerr << "FindSource() failed for " << target << std::endl;
+        return false;
+      }
+    }
+
+    // A pixel that was never filled
+    itk::Index<2> unfilled = {{static_cast<itk::Index<2>::IndexValueType>(size[0] - 1),
+                               static_cast<itk::Index<2>::IndexValueType>(size[1] - 1)}};
+    itk::Index<2> source;
+    if(reader.FindSource(unfilled, source))
+    {
+      std::cerr << "FindSource() found " << unfilled << " which was never filled." << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+}
+
+int main(int, char*[])
+{
+  // 7 and 3 are coprime to the size, so the first 'numberOfRecords' targets are all different.
+  itk::Size<2> size = {{101, 67}};
+  itk::Index<2> corner = {{0, 0}};
+  itk::ImageRegion<2> region(corner, size);
+  const unsigned int numberOfRecords = 60;
+
+  std::vector<unsigned char> input(size[0] * size[1], 7);
+  std::uint64_t checksum = FillLog::ComputeChecksum(input.data(), input.size());
+  input[10] = 8;
+  if(FillLog::ComputeChecksum(input.data(), input.size()) == checksum)
+  {
+    std::cerr << "The checksum did not change when the input changed." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  {
+    FillLogWriter writer("TestFillLog.fill", region, 4, checksum);
+    for(unsigned int i = 0; i < numberOfRecords; ++i)
+    {
+      itk::Index<2> target;
+      itk::Index<2> source;
+      GetPair(i, size, target, source);
+      writer.Write(target, source);
+    }
+    writer.Close();
+  }
+
+  if(!FillLog::IsFillLog("TestFillLog.fill"))
+  {
+    std::cerr << "IsFillLog() did not recognize the log." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  {
+    FillLogReader reader("TestFillLog.fill");
+    if(reader.GetImageSize() != size || reader.GetPatchRadius() != 4 || reader.GetInputChecksum() != checksum)
+    {
+      std::cerr << "The header was not read correctly." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if(!CheckReader(reader, size, numberOfRecords))
+    {
+      return EXIT_FAILURE;
+    }
+
+    // The text export must match what LoggerVisitor writes
+    reader.ExportText("TestFillLog.txt");
+    std::ifstream textStream("TestFillLog.txt");
+    itk::Index<2> target;
+    itk::Index<2> source;
+    GetPair(0, size, target, source);
+    std::stringstream expectedLine;
+    expectedLine << source[0] << " " << source[1] << " : " << target[0] << " " << target[1];
+    std::string line;
+    getline(textStream, line);
+    if(line != expectedLine.str() || FillLog::IsFillLog("TestFillLog.txt"))
+    {
+      std::cerr << "The text export is wrong: " << line << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A log whose writer was never closed (e.g. a crash) must still be readable.
+  {
+    std::ifstream closedLog("TestFillLog.fill", std::ios::binary);
+    std::vector<char> bytes(sizeof(FillLog::Header) + numberOfRecords * sizeof(FillLog::Record));
+    closedLog.read(bytes.data(), bytes.size());
+
+    FillLog::Header header;
+    std::copy(bytes.begin(), bytes.begin() + sizeof(header), reinterpret_cast<char*>(&header));
+    header.NumberOfRecords = 0;
+    header.HashTableOffset = 0;
+    header.HashTableSize = 0;
+    std::copy(reinterpret_cast<char*>(&header), reinterpret_cast<char*>(&header) + sizeof(header), bytes.begin());
+
+    std::ofstream unclosedLog("TestFillLogUnclosed.fill", std::ios::binary);
+    unclosedLog.write(bytes.data(), bytes.size() - sizeof(FillLog::Record) / 2); // The last record is incomplete
+    unclosedLog.close();
+
+    FillLogReader reader("TestFillLogUnclosed.fill");
+    if(!CheckReader(reader, size, numberOfRecords - 1))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Logs whose hash table or number of records does not match the file must be rejected.
+  {
+    std::ifstream closedLog("TestFillLog.fill", std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(closedLog)), std::istreambuf_iterator<char>());
+
+    FillLog::Header closedHeader;
+    std::copy(bytes.begin(), bytes.begin() + sizeof(closedHeader), reinterpret_cast<char*>(&closedHeader));
+
+    std::vector<FillLog::Header> corruptHeaders(5, closedHeader);
+    corruptHeaders[0].HashTableSize = 0;
+    corruptHeaders[1].HashTableSize = 3;
+    corruptHeaders[2].HashTableSize = 32; // A power of two, but not larger than the number of records
+    corruptHeaders[3].NumberOfRecords = bytes.size();
+    corruptHeaders[4].HashTableOffset += 2; // Not aligned, although the (smaller) table fits in the file
+    corruptHeaders[4].HashTableSize /= 2;
+
+    std::vector<std::vector<char> > corruptLogs;
+    for(std::size_t headerId = 0; headerId < corruptHeaders.size(); ++headerId)
+    {
+      corruptLogs.push_back(bytes);
+      std::copy(reinterpret_cast<char*>(&corruptHeaders[headerId]),
+                reinterpret_cast<char*>(&corruptHeaders[headerId]) + sizeof(FillLog::Header),
+                corruptLogs.back().begin());
+    }
+
+    // A slot that refers to a record that does not exist
+    std::vector<std::uint32_t> hashTable(closedHeader.HashTableSize, 0);
+    hashTable[0] = closedHeader.NumberOfRecords + 1;
+    corruptLogs.push_back(bytes);
+    std::copy(reinterpret_cast<char*>(hashTable.data()),
+              reinterpret_cast<char*>(hashTable.data() + hashTable.size()),
+              corruptLogs.back().begin() + closedHeader.HashTableOffset);
+
+    // A table without an empty slot, where probing for a missing target would never end
+    hashTable.assign(closedHeader.HashTableSize, 1);
+    corruptLogs.push_back(bytes);
+    std::copy(reinterpret_cast<char*>(hashTable.data()),
+              reinterpret_cast<char*>(hashTable.data() + hashTable.size()),
+              corruptLogs.back().begin() + closedHeader.HashTableOffset);
+
+    for(std::size_t logId = 0; logId < corruptLogs.size(); ++logId)
+    {
+      std::ofstream corruptLog("TestFillLogCorrupt.fill", std::ios::binary);
+      corruptLog.write(corruptLogs[logId].data(), corruptLogs[logId].size());
+      corruptLog.close();
+
+      bool rejected = false;
+      try
+      {
+        FillLogReader reader("TestFillLogCorrupt.fill");
+      }
+      catch(const std::runtime_error&)
+      {
+        rejected = true;
+      }
+
+      if(!rejected)
+      {
+        std::cerr << "Corrupt log " << logId << " was not rejected." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::remove("TestFillLog.fill");
+  std::remove("TestFillLog.txt");
+  std::remove("TestFillLogUnclosed.fill");
+  std::remove("TestFillLogCorrupt.fill");
+
+  return EXIT_SUCCESS;
+}
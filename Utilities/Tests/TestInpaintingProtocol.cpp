@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "InpaintingProtocol.h"
+#include "UnixSocket.h"
+
+// STL
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// POSIX
+#include <unistd.h>
+
+int main(int, char*[])
+{
+  InpaintingProtocol::Message request;
+  request.Command = "INPAINT";
+  request.Values["image"] = "/data/a file with spaces.png";
+  request.Values["radius"] = "15";
+  request.Values["expression"] = "a=b";
+
+  InpaintingProtocol::Message parsed = InpaintingProtocol::ParseMessage(InpaintingProtocol::FormatMessage(request));
+  if(parsed.Command != request.Command || parsed.Values != request.Values)
+  {
+    std::cerr << "Formatting and parsing changed the message to " << InpaintingProtocol::ToString(parsed) << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool invalidValueThrew = false;
+  try
+  {
+    InpaintingProtocol::Message invalid;
+    invalid.Command = "INPAINT";
+    invalid.Values["image"] = "two\nlines";
+    InpaintingProtocol::FormatMessage(invalid);
+  }
+  catch(const std::runtime_error&)
+  {
+    invalidValueThrew = true;
+  }
+
+  if(!invalidValueThrew)
+  {
+    std::cerr << "A value with a line break was accepted." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Send the message over a socket and back
+  std::stringstream ssSocketPath;
+  ssSocketPath << "/tmp/TestInpaintingProtocol" << getpid() << ".sock";
+  std::string socketPath = ssSocketPath.str();
+
+  std::unique_ptr<UnixSocket> listeningSocket = UnixSocket::Listen(socketPath);
+
+  std::thread server([&listeningSocket]()
+  {
+    std::unique_ptr<UnixSocket> client = listeningSocket->Accept();
+    InpaintingProtocol::Message message;
+    while(InpaintingProtocol::ReadMessage(*client, message))
+    {
+      message.Command = "ECHO";
+      InpaintingProtocol::WriteMessage(*client, message);
+    }
+  });
+
+  InpaintingProtocol::Message reply;
+  {
+    std::unique_ptr<UnixSocket> connection = UnixSocket::Connect(socketPath);
+    InpaintingProtocol::WriteMessage(*connection, request);
+    InpaintingProtocol::WriteMessage(*connection, request);
+    for(unsigned int i = 0; i < 2; ++i)
+    {
+      if(!InpaintingProtocol::ReadMessage(*connection, reply) || reply.Command != "ECHO" ||
+         reply.Values != request.Values)
+      {
+        std::cerr << "Reply " << i << " is wrong: " << InpaintingProtocol::ToString(reply) << std::endl;
+        server.detach();
+        return EXIT_FAILURE;
+      }
+    }
+  } // Disconnect, which ends the server loop
+
+  server.join();
+
+  // A line longer than the maximum line length is rejected instead of being buffered
+  {
+    std::unique_ptr<UnixSocket> connection = UnixSocket::Connect(socketPath);
+    std::unique_ptr<UnixSocket> client = listeningSocket->Accept();
+    client->SetMaximumLineLength(100);
+    connection->WriteLine(std::string(100, 'a'));
+    connection->WriteLine(std::string(5000, 'b'));
+
+    std::string line;
+    if(!client->ReadLine(line) || line.size() != 100)
+    {
+      std::cerr << "A line of the maximum length was not read." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bool longLineThrew = false;
+    try
+    {
+      client->ReadLine(line);
+    }
+    catch(const std::runtime_error&)
+    {
+      longLineThrew = true;
+    }
+
+    if(!longLineThrew)
+    {
+      std::cerr << "A line longer than the maximum length was accepted." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Accept() returns a null pointer after the listening socket is shut down
+  std::thread acceptor([&listeningSocket]()
+  {
+    if(listeningSocket->Accept())
+    {
+      std::cerr << "Accept() should fail after Shutdown()." << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  });
+  usleep(100000);
+  listeningSocket->Shutdown();
+  acceptor.join();
+
+  std::remove(socketPath.c_str());
+
+  // Listen() must not take over the socket of a live server, but replaces a stale socket
+  {
+    std::string livePath = socketPath + ".live";
+    std::unique_ptr<UnixSocket> liveSocket = UnixSocket::Listen(livePath);
+
+    bool liveSocketThrew = false;
+    try
+    {
+      UnixSocket::Listen(livePath);
+    }
+    catch(const std::runtime_error&)
+    {
+      liveSocketThrew = true;
+    }
+
+    if(!liveSocketThrew)
+    {
+      std::cerr << "Listen() took over the socket of a live server." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    liveSocket.reset(); // The socket file is left behind, as after a crash
+    UnixSocket::Listen(livePath);
+    std::remove(livePath.c_str());
+  }
+
+  // Listen() must not remove a file that is not a socket
+  {
+    std::string filePath = socketPath + ".txt";
+    std::ofstream(filePath.c_str()) << "not a socket" << std::endl;
+
+    bool fileThrew = false;
+    try
+    {
+      UnixSocket::Listen(filePath);
+    }
+    catch(const std::runtime_error&)
+    {
+      fileThrew = true;
+    }
+
+    std::ifstream fileStream(filePath.c_str());
+    if(!fileThrew || !fileStream)
+    {
+      std::cerr << "Listen() accepted or removed a regular file." << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::remove(filePath.c_str());
+  }
+
+  return EXIT_SUCCESS;
+}
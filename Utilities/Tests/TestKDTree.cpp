@@ -0,0 +1,108 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "KDTree.h"
+
+// STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+int main(int, char*[])
+{
+  const unsigned int dimension = 24;
+  const unsigned int numberOfPoints = 3000;
+  const unsigned int k = 20;
+
+  // Clustered points, with many duplicates, so the tree has uneven and degenerate splits
+  std::mt19937 generator(0);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::vector<float> points(numberOfPoints * dimension);
+  for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    for(unsigned int dimensionId = 0; dimensionId < dimension; ++dimensionId)
+    {
+      points[pointId * dimension + dimensionId] = pointId % 7 == 0 ? 1.0f :
+          10.0f * static_cast<float>(pointId % 5) + noise(generator) / (dimensionId + 1);
+    }
+  }
+
+  KDTree tree;
+  tree.Build(points, dimension);
+  if(tree.GetNumberOfPoints() != numberOfPoints || tree.GetDimension() != dimension)
+  {
+    std::cerr << "The tree has " << tree.GetNumberOfPoints() << " points of dimension " << tree.GetDimension()
+              << " but should have " << numberOfPoints << " of dimension " << dimension << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<KDTree::NeighborType> neighbors;
+  for(unsigned int queryId = 0; queryId < 100; ++queryId)
+  {
+    std::vector<float> query(dimension);
+    for(unsigned int dimensionId = 0; dimensionId < dimension; ++dimensionId)
+    {
+      query[dimensionId] = 10.0f * static_cast<float>(queryId % 5) + 3.0f * noise(generator);
+    }
+
+    // Compare the distances (not the ids, which may tie) to a brute force search
+    std::vector<float> distances(numberOfPoints);
+    for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      distances[pointId] = 0.0f;
+      for(unsigned int dimensionId = 0; dimensionId < dimension; ++dimensionId)
+      {
+        const float difference = points[pointId * dimension + dimensionId] - query[dimensionId];
+        distances[pointId] += difference * difference;
+      }
+    }
+    std::sort(distances.begin(), distances.end());
+
+    tree.FindNearest(query.data(), k, neighbors);
+    if(neighbors.size() != k)
+    {
+      std::cerr << "FindNearest() returned " << neighbors.size() << " neighbors but should return " << k << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    for(unsigned int neighborId = 0; neighborId < k; ++neighborId)
+    {
+      if(neighbors[neighborId].first != distances[neighborId])
+      {
+        std::cerr << "Neighbor " << neighborId << " of query " << queryId << " is at distance "
+                  << neighbors[neighborId].first << " but should be at " << distances[neighborId] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Asking for more neighbors than there are points returns all of them
+  KDTree smallTree;
+  smallTree.Build(std::vector<float>(points.begin(), points.begin() + 5 * dimension), dimension);
+  smallTree.FindNearest(points.data(), k, neighbors);
+  if(neighbors.size() != 5 || neighbors[0].first != 0.0f)
+  {
+    std::cerr << "FindNearest() on a tree of 5 points returned " << neighbors.size() << " neighbors" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "LRUCache.h"
+
+// STL
+#include <iostream>
+#include <string>
+
+int main(int, char*[])
+{
+  LRUCache<std::string, int> cache(2);
+
+  cache.Insert("a", 1);
+  cache.Insert("b", 2);
+
+  // "a" is now the most recently used, so "b" is discarded by the next insertion
+  int value = 0;
+  if(!cache.Get("a", value) || value != 1)
+  {
+    std::cerr << "'a' should be cached with value 1." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  cache.Insert("c", 3);
+
+  if(cache.Get("b", value))
+  {
+    std::cerr << "'b' should have been discarded." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(!cache.Get("a", value) || !cache.Get("c", value) || value != 3 || cache.GetSize() != 2)
+  {
+    std::cerr << "'a' and 'c' should be cached." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Replacing a value does not discard anything
+  cache.Insert("a", 10);
+  if(!cache.Get("a", value) || value != 10 || !cache.Get("c", value))
+  {
+    std::cerr << "Replacing 'a' failed." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(cache.GetNumberOfHits() != 5 || cache.GetNumberOfMisses() != 1)
+  {
+    std::cerr << "There should be 5 hits and 1 miss, but there are " << cache.GetNumberOfHits() << " hits and "
+              << cache.GetNumberOfMisses() << " misses." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
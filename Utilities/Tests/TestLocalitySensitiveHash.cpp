@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "LocalitySensitiveHash.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+/** The distance that each hash family is sensitive to. */
+static float Distance(const LocalitySensitiveHash::FamilyEnum family, const float* const a, const float* const b,
+                      const unsigned int dimension)
+{
+  float sum = 0.0f;
+  float normA = 0.0f;
+  float normB = 0.0f;
+  for(unsigned int componentId = 0; componentId < dimension; ++componentId)
+  {
+    const float difference = a[componentId] - b[componentId];
+    if(family == LocalitySensitiveHash::HYPERPLANE)
+    {
+      sum += a[componentId] * b[componentId];
+      normA += a[componentId] * a[componentId];
+      normB += b[componentId] * b[componentId];
+    }
+    else
+    {
+      sum += family == LocalitySensitiveHash::MANHATTAN ? std::fabs(difference) : difference * difference;
+    }
+  }
+
+  if(family == LocalitySensitiveHash::HYPERPLANE)
+  {
+    return std::acos(std::max(-1.0f, std::min(1.0f, sum / std::sqrt(normA * normB))));
+  }
+
+  return family == LocalitySensitiveHash::MANHATTAN ? sum : std::sqrt(sum);
+}
+
+/** Compute the fraction of the 'k' nearest points to the queries that are candidates, and the average fraction
+  * of the points that are candidates. */
+static void MeasureRecall(const LocalitySensitiveHash& hash, const std::vector<float>& points,
+                          const std::vector<float>& queries, const unsigned int k, float& recall, float& selectivity)
+{
+  const unsigned int dimension = hash.GetDimension();
+  const unsigned int numberOfPoints = static_cast<unsigned int>(points.size() / dimension);
+  const unsigned int numberOfQueries = static_cast<unsigned int>(queries.size() / dimension);
+
+  unsigned int numberOfFound = 0;
+  std::size_t numberOfCandidates = 0;
+  std::vector<unsigned int> candidates;
+  std::vector<std::pair<float, unsigned int> > distances(numberOfPoints);
+  for(unsigned int queryId = 0; queryId < numberOfQueries; ++queryId)
+  {
+    const float* query = &queries[queryId * dimension];
+    for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      distances[pointId] = std::make_pair(Distance(hash.GetFamily(), query, &points[pointId * dimension], dimension),
+                                          pointId);
+    }
+    std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+
+    hash.FindCandidates(query, candidates);
+    numberOfCandidates += candidates.size();
+    for(unsigned int neighborId = 0; neighborId < k; ++neighborId)
+    {
+      if(std::binary_search(candidates.begin(), candidates.end(), distances[neighborId].second))
+      {
+        numberOfFound++;
+      }
+    }
+  }
+
+  recall = static_cast<float>(numberOfFound) / (numberOfQueries * k);
+  selectivity = static_cast<float>(numberOfCandidates) / (numberOfQueries * numberOfPoints);
+}
+
+int main(int, char*[])
+{
+  // Descriptors of the size of FPFH descriptors around a few hundred centers
+  const unsigned int dimension = 33;
+  const unsigned int numberOfPoints = 6000;
+  const unsigned int numberOfQueries = 200;
+  const unsigned int numberOfCenters = 300;
+  const unsigned int k = 10;
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> centerDistribution(-15.0f, 15.0f);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::vector<float> centers(numberOfCenters * dimension);
+  for(std::size_t valueId = 0; valueId < centers.size(); ++valueId)
+  {
+    centers[valueId] = centerDistribution(generator);
+  }
+
+  auto createPoints = [&](const unsigned int count, std::vector<float>& created)
+  {
+    created.resize(count * dimension);
+    for(unsigned int pointId = 0; pointId < count; ++pointId)
+    {
+      const unsigned int centerId = generator() % numberOfCenters;
+      for(unsigned int componentId = 0; componentId < dimension; ++componentId)
+      {
+        created[pointId * dimension + componentId] = centers[centerId * dimension + componentId] + noise(generator);
+      }
+    }
+  };
+
+  std::vector<float> points;
+  createPoints(numberOfPoints, points);
+  std::vector<float> queries;
+  createPoints(numberOfQueries, queries);
+
+  const LocalitySensitiveHash::FamilyEnum families[] = {LocalitySensitiveHash::HYPERPLANE,
+                                                        LocalitySensitiveHash::EUCLIDEAN,
+                                                        LocalitySensitiveHash::MANHATTAN};
+  const float bucketWidths[] = {0.0f, 30.0f, 400.0f};
+  for(unsigned int familyId = 0; familyId < 3; ++familyId)
+  {
+    LocalitySensitiveHash hash(families[familyId], 8, 12, 1, bucketWidths[familyId]);
+    hash.Initialize(dimension);
+    for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      if(hash.Insert(&points[pointId * dimension]) != pointId)
+      {
+        std::cerr << "Insert() returned the wrong id for point " << pointId << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Probing more buckets finds more of the neighbors
+    float singleProbeRecall = 0.0f;
+    float singleProbeSelectivity = 0.0f;
+    MeasureRecall(hash, points, queries, k, singleProbeRecall, singleProbeSelectivity);
+
+    hash.SetNumberOfProbes(32);
+    float recall = 0.0f;
+    float selectivity = 0.0f;
+    MeasureRecall(hash, points, queries, k, recall, selectivity);
+
+    std::cout << "Family " << familyId << ": recall " << singleProbeRecall << " with 1 probe ("
+              << singleProbeSelectivity << " of the points are candidates), " << recall << " with 32 probes ("
+              << selectivity << " of the points are candidates)" << std::endl;
+
+    if(recall < 0.9f || recall < singleProbeRecall || selectivity > 0.25f)
+    {
+      std::cerr << "The recall or the selectivity of family " << familyId << " is too low." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
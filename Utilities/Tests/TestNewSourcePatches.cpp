@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "NewSourcePatches.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+// ITK
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <iostream>
+#include <random>
+
+/** Get the centers (in raster order) of the patches inside 'mask' that are valid and contain a pixel of 'filled'
+  * by testing every pixel of every patch. */
+static std::vector<itk::Index<2> > ComputeNewlyValidPatchCenters(const Mask* const mask, const Mask* const filled,
+                                                                 const unsigned int patchHalfWidth)
+{
+  std::vector<itk::Index<2> > newlyValidCenters;
+
+  itk::ImageRegionConstIteratorWithIndex<Mask> centerIterator(mask, mask->GetLargestPossibleRegion());
+  while(!centerIterator.IsAtEnd())
+  {
+    itk::ImageRegion<2> patchRegion =
+        ITKHelpers::GetRegionInRadiusAroundPixel(centerIterator.GetIndex(), patchHalfWidth);
+    if(mask->GetLargestPossibleRegion().IsInside(patchRegion))
+    {
+      bool valid = true;
+      bool containsFilledPixel = false;
+      itk::ImageRegionConstIteratorWithIndex<Mask> patchIterator(mask, patchRegion);
+      while(!patchIterator.IsAtEnd())
+      {
+        valid = valid && mask->IsValid(patchIterator.GetIndex());
+        containsFilledPixel = containsFilledPixel || filled->IsHole(patchIterator.GetIndex());
+        ++patchIterator;
+      }
+
+      if(valid && containsFilledPixel)
+      {
+        newlyValidCenters.push_back(centerIterator.GetIndex());
+      }
+    }
+    ++centerIterator;
+  }
+
+  return newlyValidCenters;
+}
+
+int main(int, char*[])
+{
+  const unsigned int patchHalfWidth = 3;
+
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{60, 50}};
+  itk::ImageRegion<2> fullRegion(corner, size);
+
+  Mask::Pointer mask = Mask::New();
+  mask->SetRegions(fullRegion);
+  mask->Allocate();
+
+  // A large hole that touches the left side of the image, and some small holes
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  itk::Index<2> holeCorner = {{0, 15}};
+  itk::Size<2> holeSize = {{25, 20}};
+  itk::ImageRegion<2> hole(holeCorner, holeSize);
+
+  itk::ImageRegionIteratorWithIndex<Mask> maskIterator(mask, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    if(hole.IsInside(maskIterator.GetIndex()) || distribution(generator) < 0.01f)
+    {
+      maskIterator.Set(mask->GetHoleValue());
+    }
+    else
+    {
+      maskIterator.Set(mask->GetValidValue());
+    }
+    ++maskIterator;
+  }
+
+  // Without newly filled pixels no patch can become valid
+  if(!NewSourcePatches::GetNewlyValidPatchCenters(mask, std::vector<itk::Index<2> >(), patchHalfWidth).empty())
+  {
+    std::cerr << "There should be no newly valid patches if no pixels were filled." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Fill patches around hole pixels (some of which are partially outside the image), as an inpainting does
+  unsigned int numberOfNewlyValidPatches = 0;
+  Mask::Pointer filled = Mask::New();
+  filled->SetRegions(fullRegion);
+  filled->Allocate();
+  for(unsigned int fillId = 0; fillId < 40; ++fillId)
+  {
+    std::vector<itk::Index<2> > holePixels;
+    maskIterator.GoToBegin();
+    while(!maskIterator.IsAtEnd())
+    {
+      if(mask->IsHole(maskIterator.GetIndex()))
+      {
+        holePixels.push_back(maskIterator.GetIndex());
+      }
+      ++maskIterator;
+    }
+
+    if(holePixels.empty())
+    {
+      break;
+    }
+
+    itk::Index<2> target = holePixels[static_cast<std::size_t>(distribution(generator) * holePixels.size()) %
+                                      holePixels.size()];
+    itk::ImageRegion<2> regionToFinish = ITKHelpers::GetRegionInRadiusAroundPixel(target, patchHalfWidth);
+    regionToFinish.Crop(fullRegion);
+
+    filled->FillBuffer(filled->GetValidValue());
+    std::vector<itk::Index<2> > newlyFilledPixels;
+    itk::ImageRegionIteratorWithIndex<Mask> fillIterator(mask, regionToFinish);
+    while(!fillIterator.IsAtEnd())
+    {
+      if(mask->IsHole(fillIterator.GetIndex()))
+      {
+        newlyFilledPixels.push_back(fillIterator.GetIndex());
+        filled->SetPixel(fillIterator.GetIndex(), filled->GetHoleValue());
+        fillIterator.Set(mask->GetValidValue());
+      }
+      ++fillIterator;
+    }
+
+    std::vector<itk::Index<2> > newlyValidCenters =
+        NewSourcePatches::GetNewlyValidPatchCenters(mask, newlyFilledPixels, patchHalfWidth);
+    std::vector<itk::Index<2> > expectedCenters = ComputeNewlyValidPatchCenters(mask, filled, patchHalfWidth);
+
+    if(newlyValidCenters != expectedCenters)
+    {
+      std::cerr << "Fill " << fillId << " around " << target << ": there are " << newlyValidCenters.size()
+                << " newly valid patches but there should be " << expectedCenters.size() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    numberOfNewlyValidPatches += newlyValidCenters.size();
+  }
+
+  if(numberOfNewlyValidPatches == 0)
+  {
+    std::cerr << "No patches became valid, so nothing was tested." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << numberOfNewlyValidPatches << " patches became valid." << std::endl;
+
+  return EXIT_SUCCESS;
+}
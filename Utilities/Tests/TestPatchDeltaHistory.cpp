@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Submodules
+#include <Mask/Mask.h>
+#include <ITKHelpers/ITKHelpers.h>
+
+// Custom
+#include "PatchDeltaHistory.h"
+
+// STL
+#include <iostream>
+#include <vector>
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+typedef itk::Image<unsigned char, 2> ImageType;
+
+/** Mask is an itk::Image<unsigned char, 2>, so this compares both images and masks. */
+static bool ImagesEqual(const ImageType* const image1, const ImageType* const image2)
+{
+  itk::ImageRegionConstIteratorWithIndex<ImageType> iterator(image1, image1->GetLargestPossibleRegion());
+  while(!iterator.IsAtEnd())
+  {
+    if(iterator.Get() != image2->GetPixel(iterator.GetIndex()))
+    {
+      return false;
+    }
+    ++iterator;
+  }
+  return true;
+}
+
+int main(int, char*[])
+{
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{30, 30}};
+  itk::ImageRegion<2> fullRegion(corner, size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(fullRegion);
+  image->Allocate();
+  image->FillBuffer(0);
+
+  Mask::Pointer mask = Mask::New();
+  mask->SetRegions(fullRegion);
+  mask->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<Mask> maskIterator(mask, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    bool hole = maskIterator.GetIndex()[0] >= 10 && maskIterator.GetIndex()[0] < 20 &&
+                maskIterator.GetIndex()[1] >= 10 && maskIterator.GetIndex()[1] < 20;
+    maskIterator.Set(hole ? mask->GetHoleValue() : mask->GetValidValue());
+    ++maskIterator;
+  }
+
+  const unsigned int patchRadius = 2;
+  PatchDeltaHistory<ImageType> history(image, mask, 3);
+
+  // Keep a full copy of every state to compare against
+  std::vector<ImageType::Pointer> images;
+  std::vector<Mask::Pointer> masks;
+
+  images.push_back(ImageType::New());
+  ITKHelpers::DeepCopy(image.GetPointer(), images.back().GetPointer());
+  masks.push_back(Mask::New());
+  masks.back()->DeepCopyFrom(mask);
+
+  // Fill the hole from the corner, as the inpainting would
+  unsigned int iteration = 0;
+  for(int y = 10; y < 20; y += 3)
+  {
+    for(int x = 10; x < 20; x += 3)
+    {
+      itk::Index<2> target = {{x, y}};
+      itk::Index<2> source = {{x - 8, y - 8}};
+      history.BeginIteration(target, source, patchRadius);
+
+      // Replace the source of the first iteration, as a manual selection would
+      if(iteration == 0)
+      {
+        itk::Index<2> manualSource = {{1, 1}};
+        history.SetSourcePixel(manualSource);
+      }
+
+      itk::ImageRegion<2> region = ITKHelpers::GetRegionInRadiusAroundPixel(target, patchRadius);
+      region.Crop(fullRegion);
+      itk::ImageRegionIteratorWithIndex<ImageType> imageIterator(image, region);
+      while(!imageIterator.IsAtEnd())
+      {
+        if(mask->IsHole(imageIterator.GetIndex()))
+        {
+          imageIterator.Set(iteration + 1);
+          mask->SetPixel(imageIterator.GetIndex(), mask->GetValidValue());
+        }
+        ++imageIterator;
+      }
+
+      history.EndIteration();
+
+      images.push_back(ImageType::New());
+      ITKHelpers::DeepCopy(image.GetPointer(), images.back().GetPointer());
+      masks.push_back(Mask::New());
+      masks.back()->DeepCopyFrom(mask);
+
+      iteration++;
+    }
+  }
+
+  if(history.GetNumberOfIterations() != iteration)
+  {
+    std::cerr << "There should be " << iteration << " iterations but there are "
+              << history.GetNumberOfIterations() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  itk::Index<2> manualSource = {{1, 1}};
+  if(history.GetDelta(0).SourcePixel != manualSource)
+  {
+    std::cerr << "The source of the first iteration should be " << manualSource << " but is "
+              << history.GetDelta(0).SourcePixel << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Seek forward, backward, and to keyframes in no particular order
+  unsigned int states[] = {5, 2, 9, 0, iteration, 7, 8, 1, iteration - 1, 4};
+  for(unsigned int i = 0; i < sizeof(states) / sizeof(states[0]); ++i)
+  {
+    history.Seek(states[i]);
+    if(!ImagesEqual(history.GetReplayImage(), images[states[i]].GetPointer()) ||
+       !ImagesEqual(history.GetReplayMask(), masks[states[i]].GetPointer()))
+    {
+      std::cerr << "The replayed state " << states[i] << " is not correct!" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Only the hole pixels are stored in the deltas, so the deltas together store each hole pixel once.
+  unsigned int numberOfStoredPixels = 0;
+  for(unsigned int i = 0; i < history.GetNumberOfIterations(); ++i)
+  {
+    numberOfStoredPixels += history.GetDelta(i).Offsets.size();
+  }
+
+  if(numberOfStoredPixels != 100)
+  {
+    std::cerr << "The deltas store " << numberOfStoredPixels << " pixels but should store 100." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "The history uses " << history.GetMemoryUsage() << " bytes." << std::endl;
+
+  return EXIT_SUCCESS;
+}
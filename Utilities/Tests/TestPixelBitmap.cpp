@@ -0,0 +1,100 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "PixelBitmap.h"
+
+// STL
+#include <iostream>
+#include <set>
+
+int main(int, char*[])
+{
+  // Use a width that is not a multiple of the word size so that rows straddle words
+  itk::Index<2> corner = {{5, 7}};
+  itk::Size<2> size = {{70, 40}};
+  itk::ImageRegion<2> region(corner, size);
+
+  PixelBitmap bitmap(region);
+
+  // Compare against a std::set, which is what PixelBitmap replaces
+  typedef std::set<itk::Index<2>, itk::Index<2>::LexicographicCompare> SetType;
+  SetType reference;
+
+  for(unsigned int i = 0; i < 500; ++i)
+  {
+    itk::Index<2> index = {{corner[0] + static_cast<itk::Index<2>::IndexValueType>((i * 37) % size[0]),
+                            corner[1] + static_cast<itk::Index<2>::IndexValueType>((i * 11) % size[1])}};
+    bool newlyInserted = bitmap.Insert(index);
+    if(newlyInserted != reference.insert(index).second)
+    {
+      std::cerr << "Insert() disagrees with std::set for " << index << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if(bitmap.GetIndex(bitmap.GetLinearIndex(index)) != index)
+    {
+      std::cerr << "GetIndex() is not the inverse of GetLinearIndex() for " << index << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if(bitmap.Count() != reference.size())
+  {
+    std::cerr << "Count() is " << bitmap.Count() << " but should be " << reference.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Pixels outside of the region are never set
+  itk::Index<2> outside = {{0, 0}};
+  if(bitmap.Contains(outside))
+  {
+    std::cerr << "Contains() should be false outside of the region!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Count a region that is partially outside of the bitmap
+  itk::Index<2> queryCorner = {{-3, 20}};
+  itk::Size<2> querySize = {{60, 30}};
+  itk::ImageRegion<2> queryRegion(queryCorner, querySize);
+
+  unsigned int expectedCount = 0;
+  for(SetType::const_iterator iterator = reference.begin(); iterator != reference.end(); ++iterator)
+  {
+    if(queryRegion.IsInside(*iterator))
+    {
+      expectedCount++;
+    }
+  }
+
+  if(bitmap.CountInRegion(queryRegion) != expectedCount)
+  {
+    std::cerr << "CountInRegion() is " << bitmap.CountInRegion(queryRegion)
+              << " but should be " << expectedCount << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bitmap.Erase(*reference.begin());
+  if(bitmap.Contains(*reference.begin()) || bitmap.Count() != reference.size() - 1)
+  {
+    std::cerr << "Erase() failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
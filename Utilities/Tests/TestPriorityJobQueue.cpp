@@ -0,0 +1,102 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "PriorityJobQueue.h"
+
+// STL
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main(int, char*[])
+{
+  PriorityJobQueue<int> queue;
+
+  // Higher priorities first, and the push order among jobs of the same priority
+  queue.Push(1, 0);
+  queue.Push(2, 5);
+  queue.Push(3, 0);
+  std::size_t position = queue.Push(4, 5);
+  if(position != 1)
+  {
+    std::cerr << "Job 4 should be handed out after 1 job, but its position is " << position << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const int expectedOrder[] = {2, 4, 1, 3};
+  for(unsigned int i = 0; i < 4; ++i)
+  {
+    int job = 0;
+    if(!queue.Pop(job) || job != expectedOrder[i])
+    {
+      std::cerr << "Pop " << i << " returned " << job << " instead of " << expectedOrder[i] << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Workers block until there is a job, and stop when the queue is closed and empty
+  std::vector<int> jobsDone(2, 0);
+  std::vector<std::thread> workers;
+  for(unsigned int workerId = 0; workerId < jobsDone.size(); ++workerId)
+  {
+    workers.push_back(std::thread([&queue, &jobsDone, workerId]()
+    {
+      int job = 0;
+      while(queue.Pop(job))
+      {
+        jobsDone[workerId]++;
+      }
+    }));
+  }
+
+  for(int job = 0; job < 100; ++job)
+  {
+    queue.Push(job);
+  }
+  queue.Close();
+
+  for(unsigned int workerId = 0; workerId < workers.size(); ++workerId)
+  {
+    workers[workerId].join();
+  }
+
+  if(jobsDone[0] + jobsDone[1] != 100 || queue.GetNumberOfQueuedJobs() != 0)
+  {
+    std::cerr << "The workers ran " << jobsDone[0] + jobsDone[1] << " jobs instead of 100." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool pushAfterCloseThrew = false;
+  try
+  {
+    queue.Push(0);
+  }
+  catch(const std::runtime_error&)
+  {
+    pushAfterCloseThrew = true;
+  }
+
+  if(!pushAfterCloseThrew)
+  {
+    std::cerr << "A closed queue accepted a job." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "PyramidHelpers.h"
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <iostream>
+
+int main(int, char*[])
+{
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> fineSize = {{9, 6}};
+  itk::ImageRegion<2> fineRegion(corner, fineSize);
+
+  itk::ImageRegion<2> coarseRegion = PyramidHelpers::GetCoarseRegion(fineRegion);
+  if(coarseRegion.GetSize()[0] != 5 || coarseRegion.GetSize()[1] != 3)
+  {
+    std::cerr << "The coarse region is " << coarseRegion.GetSize() << " but should be 5x3." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Each coarse pixel is the average of its block, which only has two pixels in the last column
+  typedef itk::Image<float, 2> FloatImageType;
+  FloatImageType::Pointer fineImage = FloatImageType::New();
+  fineImage->SetRegions(fineRegion);
+  fineImage->Allocate();
+  itk::ImageRegionIteratorWithIndex<FloatImageType> fineImageIterator(fineImage, fineRegion);
+  while(!fineImageIterator.IsAtEnd())
+  {
+    fineImageIterator.Set(fineImageIterator.GetIndex()[0] + 10 * fineImageIterator.GetIndex()[1]);
+    ++fineImageIterator;
+  }
+
+  FloatImageType::Pointer coarseImage = FloatImageType::New();
+  PyramidHelpers::DownsampleImage(fineImage.GetPointer(), coarseImage.GetPointer());
+
+  itk::ImageRegionIteratorWithIndex<FloatImageType> coarseImageIterator(coarseImage, coarseRegion);
+  while(!coarseImageIterator.IsAtEnd())
+  {
+    float expected = 2 * coarseImageIterator.GetIndex()[0] + 20 * coarseImageIterator.GetIndex()[1] + 5.5f;
+    if(coarseImageIterator.GetIndex()[0] == 4)
+    {
+      expected -= 0.5f;
+    }
+    if(coarseImageIterator.Get() != expected)
+    {
+      std::cerr << "Coarse pixel " << coarseImageIterator.GetIndex() << " is " << coarseImageIterator.Get()
+                << " but should be " << expected << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++coarseImageIterator;
+  }
+
+  // A single hole pixel at (3,3) must make coarse pixel (1,1) a hole, and nothing else
+  Mask::Pointer fineMask = Mask::New();
+  fineMask->SetRegions(fineRegion);
+  fineMask->Allocate();
+  itk::ImageRegionIteratorWithIndex<Mask> fineMaskIterator(fineMask, fineRegion);
+  while(!fineMaskIterator.IsAtEnd())
+  {
+    fineMaskIterator.Set(fineMask->GetValidValue());
+    ++fineMaskIterator;
+  }
+  itk::Index<2> holePixel = {{3, 3}};
+  fineMask->SetPixel(holePixel, fineMask->GetHoleValue());
+
+  Mask::Pointer coarseMask = Mask::New();
+  PyramidHelpers::DownsampleMask(fineMask, coarseMask);
+
+  itk::ImageRegionIteratorWithIndex<Mask> coarseMaskIterator(coarseMask, coarseRegion);
+  while(!coarseMaskIterator.IsAtEnd())
+  {
+    bool shouldBeHole = (coarseMaskIterator.GetIndex()[0] == 1 && coarseMaskIterator.GetIndex()[1] == 1);
+    if(coarseMask->IsHole(coarseMaskIterator.GetIndex()) != shouldBeHole)
+    {
+      std::cerr << "Coarse mask pixel " << coarseMaskIterator.GetIndex() << " is wrong." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++coarseMaskIterator;
+  }
+
+  // Coarse pixel (1,1) was copied from (3,0), so fine pixel (3,3) should be guessed to come from (7,1)
+  SourcePixelMap::ImageType::Pointer coarseSourcePixelMap = SourcePixelMap::ImageType::New();
+  coarseSourcePixelMap->SetRegions(coarseRegion);
+  coarseSourcePixelMap->Allocate();
+  itk::ImageRegionIteratorWithIndex<SourcePixelMap::ImageType> coarseMapIterator(coarseSourcePixelMap, coarseRegion);
+  while(!coarseMapIterator.IsAtEnd())
+  {
+    coarseMapIterator.Set(coarseSourcePixelMap->ComputeOffset(coarseMapIterator.GetIndex()));
+    ++coarseMapIterator;
+  }
+  itk::Index<2> coarseHole = {{1, 1}};
+  itk::Index<2> coarseSource = {{3, 0}};
+  coarseSourcePixelMap->SetPixel(coarseHole, coarseSourcePixelMap->ComputeOffset(coarseSource));
+
+  SourcePixelMap::ImageType::Pointer fineSourcePixelGuess = SourcePixelMap::ImageType::New();
+  PyramidHelpers::UpsampleSourcePixelMap(coarseSourcePixelMap, fineMask, fineSourcePixelGuess);
+
+  itk::ImageRegionIteratorWithIndex<SourcePixelMap::ImageType> guessIterator(fineSourcePixelGuess, fineRegion);
+  while(!guessIterator.IsAtEnd())
+  {
+    if(guessIterator.GetIndex() == holePixel)
+    {
+      itk::Index<2> expectedSource = {{7, 1}};
+      if(SourcePixelMap::GetIndex(fineSourcePixelGuess, guessIterator.Get()) != expectedSource)
+      {
+        std::cerr << "The guess for " << holePixel << " is wrong." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    else if(guessIterator.Get() != SourcePixelMap::InvalidSourcePixel)
+    {
+      std::cerr << "Valid pixel " << guessIterator.GetIndex() << " should not have a guess." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++guessIterator;
+  }
+
+  return EXIT_SUCCESS;
+}
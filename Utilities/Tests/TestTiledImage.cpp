@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "TiledImage.h"
+
+// ITK
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <cstdio>
+#include <iostream>
+
+typedef itk::Image<int, 2> ImageType;
+
+namespace
+{
+  /** The value of 'pixel' before anything is written. */
+  int GetOriginalValue(const ImageType* const image, const itk::Index<2>& pixel)
+  {
+    return static_cast<int>(image->ComputeOffset(pixel));
+  }
+}
+
+int main(int, char*[])
+{
+  const std::string fileName = "TestTiledImage.mha";
+
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{100, 70}};
+  itk::ImageRegion<2> fullRegion(corner, size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(fullRegion);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIterator(image, fullRegion);
+  while(!imageIterator.IsAtEnd())
+  {
+    imageIterator.Set(GetOriginalValue(image, imageIterator.GetIndex()));
+    ++imageIterator;
+  }
+
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(fileName);
+  writer->SetInput(image);
+  writer->Update();
+
+  // The region that is read and written spans 3x3 tiles
+  itk::Index<2> regionCorner = {{10, 20}};
+  itk::Size<2> regionSize = {{30, 25}};
+  itk::ImageRegion<2> region(regionCorner, regionSize);
+
+  {
+  // Only 4 16x16 tiles fit in the budget, so tiles are evicted (and written back) while the region is processed
+  const std::size_t memoryBudget = 4 * 16 * 16 * sizeof(int);
+  TiledImage<ImageType> tiledImage(fileName, 16, memoryBudget);
+
+  if(tiledImage.GetLargestPossibleRegion() != fullRegion)
+  {
+    std::cerr << "The tiled image region is wrong." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ImageType::Pointer regionImage = ImageType::New();
+  tiledImage.ReadRegion(region, regionImage);
+
+  itk::ImageRegionIteratorWithIndex<ImageType> regionIterator(regionImage, regionImage->GetLargestPossibleRegion());
+  while(!regionIterator.IsAtEnd())
+  {
+    itk::Index<2> pixel = {{regionIterator.GetIndex()[0] + regionCorner[0],
+                            regionIterator.GetIndex()[1] + regionCorner[1]}};
+    if(regionIterator.Get() != GetOriginalValue(image, pixel))
+    {
+      std::cerr << "ReadRegion: pixel " << pixel << " is wrong." << std::endl;
+      return EXIT_FAILURE;
+    }
+    regionIterator.Set(-1);
+    ++regionIterator;
+  }
+
+  if(tiledImage.GetMemoryUsage() > memoryBudget)
+  {
+    std::cerr << "The tiles use " << tiledImage.GetMemoryUsage() << " bytes but the budget is "
+              << memoryBudget << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  tiledImage.WriteRegion(regionImage, region);
+
+  itk::Index<2> lastPixel = {{99, 69}};
+  tiledImage.SetPixel(lastPixel, -2);
+  if(tiledImage.GetPixel(lastPixel) != -2 || tiledImage.GetPixel(regionCorner) != -1)
+  {
+    std::cerr << "GetPixel does not return the written values." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Tile reads: " << tiledImage.GetNumberOfTileReads()
+            << " tile writes: " << tiledImage.GetNumberOfTileWrites() << std::endl;
+  } // The destructor writes the remaining modified tiles
+
+  typedef itk::ImageFileReader<ImageType> ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->Update();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> readerIterator(reader->GetOutput(), fullRegion);
+  while(!readerIterator.IsAtEnd())
+  {
+    const itk::Index<2>& pixel = readerIterator.GetIndex();
+    int expectedValue = GetOriginalValue(image, pixel);
+    if(region.IsInside(pixel))
+    {
+      expectedValue = -1;
+    }
+    else if(pixel[0] == 99 && pixel[1] == 69)
+    {
+      expectedValue = -2;
+    }
+
+    if(readerIterator.Get() != expectedValue)
+    {
+      std::cerr << "The file has " << readerIterator.Get() << " at " << pixel << " but should have "
+                << expectedValue << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++readerIterator;
+  }
+
+  std::remove(fileName.c_str());
+
+  return EXIT_SUCCESS;
+}
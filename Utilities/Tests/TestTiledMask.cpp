@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "TiledMask.h"
+
+// ITK
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+typedef TiledMask::ImageType ImageType;
+
+namespace
+{
+  /** The value of 'pixel' in the mask image: a hole in the left half, with an antialiased border. */
+  unsigned char GetMaskValue(const itk::Index<2>& pixel)
+  {
+    if(pixel[0] < 20)
+    {
+      return 0;
+    }
+    if(pixel[0] == 20)
+    {
+      return 100; // Closer to the hole value
+    }
+    if(pixel[0] == 21)
+    {
+      return 200; // Closer to the valid value
+    }
+    return 255;
+  }
+}
+
+int main(int, char*[])
+{
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{50, 40}};
+  itk::ImageRegion<2> fullRegion(corner, size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(fullRegion);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIterator(image, fullRegion);
+  while(!imageIterator.IsAtEnd())
+  {
+    imageIterator.Set(GetMaskValue(imageIterator.GetIndex()));
+    ++imageIterator;
+  }
+
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName("TestTiledMask_mask.png");
+  writer->SetInput(image);
+  writer->Update();
+
+  {
+  std::ofstream maskFile("TestTiledMask.mask");
+  maskFile << "0 255 TestTiledMask_mask.png" << std::endl;
+  }
+
+  unsigned char holeValue = 1;
+  unsigned char validValue = 1;
+  std::string imageFileName;
+  TiledMask::ReadMaskFile("TestTiledMask.mask", holeValue, validValue, imageFileName);
+  if(holeValue != 0 || validValue != 255 || imageFileName != "TestTiledMask_mask.png")
+  {
+    std::cerr << "ReadMaskFile read " << static_cast<int>(holeValue) << " " << static_cast<int>(validValue)
+              << " " << imageFileName << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The .png can not be written a tile at a time, so it is copied to a .mha
+  TiledMask::CopyMaskImage(imageFileName, "TestTiledMask.mha", 16);
+
+  itk::Index<2> filledPixel = {{5, 33}};
+  {
+  TiledMask tiledMask("TestTiledMask.mha", holeValue, validValue, 16, 2 * 16 * 16);
+
+  itk::ImageRegionIteratorWithIndex<ImageType> maskIterator(image, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    if(tiledMask.IsHole(maskIterator.GetIndex()) != (maskIterator.GetIndex()[0] <= 20))
+    {
+      std::cerr << "IsHole is wrong at " << maskIterator.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++maskIterator;
+  }
+
+  tiledMask.MarkAsValid(filledPixel);
+  } // The destructor writes the modified tile
+
+  typedef itk::ImageFileReader<ImageType> ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName("TestTiledMask.mha");
+  reader->Update();
+
+  if(reader->GetOutput()->GetPixel(filledPixel) != validValue)
+  {
+    std::cerr << "The pixel that was marked as valid was not written." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::remove("TestTiledMask_mask.png");
+  std::remove("TestTiledMask.mask");
+  std::remove("TestTiledMask.mha");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// Custom
+#include "VantagePointTree.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+/** Check that the tree finds the same neighbor distances (not the ids, which may tie) as a brute force search. */
+static bool CheckNearest(const VantagePointTree& tree, const std::vector<float>& points, const float* const query,
+                         const unsigned int k, const std::vector<unsigned int>* const validComponents)
+{
+  const unsigned int dimension = tree.GetDimension();
+  const unsigned int numberOfPoints = static_cast<unsigned int>(points.size() / dimension);
+
+  std::vector<float> distances(numberOfPoints);
+  for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    float distance = 0.0f;
+    for(unsigned int componentId = 0; componentId < dimension; ++componentId)
+    {
+      if(validComponents &&
+         std::find(validComponents->begin(), validComponents->end(), componentId) == validComponents->end())
+      {
+        continue;
+      }
+
+      const float difference = query[componentId] - points[pointId * dimension + componentId];
+      distance += tree.GetMetric() == VantagePointTree::MANHATTAN ? std::fabs(difference) : difference * difference;
+    }
+    distances[pointId] = tree.GetMetric() == VantagePointTree::MANHATTAN ? distance : std::sqrt(distance);
+  }
+  std::sort(distances.begin(), distances.end());
+
+  std::vector<VantagePointTree::NeighborType> neighbors;
+  tree.FindNearest(query, k, neighbors, validComponents);
+  if(neighbors.size() != std::min(k, numberOfPoints))
+  {
+    std::cerr << "FindNearest() returned " << neighbors.size() << " neighbors but should return "
+              << std::min(k, numberOfPoints) << std::endl;
+    return false;
+  }
+
+  for(unsigned int neighborId = 0; neighborId < neighbors.size(); ++neighborId)
+  {
+    if(neighbors[neighborId].first != distances[neighborId])
+    {
+      std::cerr << "Neighbor " << neighborId << " is at distance " << neighbors[neighborId].first
+                << " but should be at " << distances[neighborId] << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int, char*[])
+{
+  const unsigned int dimension = 27;
+  const unsigned int numberOfPoints = 5000;
+  const unsigned int k = 20;
+
+  // Clustered points, with many duplicates, so the tree has uneven and degenerate splits
+  std::mt19937 generator(0);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  auto createPoint = [&generator, &noise, dimension](const unsigned int pointId, float* const point)
+  {
+    for(unsigned int componentId = 0; componentId < dimension; ++componentId)
+    {
+      point[componentId] = pointId % 7 == 0 ? 1.0f :
+          10.0f * static_cast<float>(pointId % 5) + noise(generator) / (componentId % 3 + 1);
+    }
+  };
+
+  std::vector<float> points(numberOfPoints * dimension);
+  for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    createPoint(pointId, &points[pointId * dimension]);
+  }
+
+  std::vector<float> queries(100 * dimension);
+  for(unsigned int queryId = 0; queryId < 100; ++queryId)
+  {
+    createPoint(queryId, &queries[queryId * dimension]);
+    queries[queryId * dimension] += 3.0f * noise(generator);
+  }
+
+  // The valid pixels of a target patch, e.g. the left two thirds of a patch of 3x3 pixels of 3 components
+  std::vector<unsigned int> validComponents;
+  for(unsigned int componentId = 0; componentId < dimension; ++componentId)
+  {
+    if(componentId % 9 < 6)
+    {
+      validComponents.push_back(componentId);
+    }
+  }
+
+  const VantagePointTree::MetricEnum metrics[] = {VantagePointTree::MANHATTAN, VantagePointTree::EUCLIDEAN};
+  for(unsigned int metricId = 0; metricId < 2; ++metricId)
+  {
+    VantagePointTree tree(metrics[metricId]);
+    tree.Build(points, dimension);
+    if(tree.GetNumberOfPoints() != numberOfPoints || tree.GetDimension() != dimension)
+    {
+      std::cerr << "The tree has " << tree.GetNumberOfPoints() << " points of dimension " << tree.GetDimension()
+                << " but should have " << numberOfPoints << " of dimension " << dimension << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    for(unsigned int queryId = 0; queryId < 100; ++queryId)
+    {
+      if(!CheckNearest(tree, points, &queries[queryId * dimension], k, nullptr) ||
+         !CheckNearest(tree, points, &queries[queryId * dimension], k, &validComponents))
+      {
+        std::cerr << "Query " << queryId << " with metric " << metricId << " failed." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The batched queries find the same neighbors as the single ones
+    std::vector<std::vector<VantagePointTree::NeighborType> > batchNeighbors;
+    tree.FindNearest(queries, k, batchNeighbors);
+    std::vector<VantagePointTree::NeighborType> neighbors;
+    for(unsigned int queryId = 0; queryId < 100; ++queryId)
+    {
+      tree.FindNearest(&queries[queryId * dimension], k, neighbors);
+      if(batchNeighbors[queryId] != neighbors)
+      {
+        std::cerr << "The batched query " << queryId << " differs from the single query." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Inserted points are found, both while they are pending and after the tree is rebuilt
+    std::vector<float> allPoints = points;
+    for(unsigned int insertId = 0; insertId < 1000; ++insertId)
+    {
+      std::vector<float> point(dimension);
+      createPoint(insertId, point.data());
+      point[0] -= 2.0f;
+      const unsigned int pointId = tree.Insert(point.data());
+      allPoints.insert(allPoints.end(), point.begin(), point.end());
+      if(pointId != numberOfPoints + insertId || tree.GetNumberOfPoints() != numberOfPoints + insertId + 1)
+      {
+        std::cerr << "Insert() returned id " << pointId << " but should return " << numberOfPoints + insertId
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      if(insertId % 100 == 0 &&
+         !CheckNearest(tree, allPoints, &queries[(insertId / 10) * dimension], k, nullptr))
+      {
+        std::cerr << "Query after inserting " << insertId + 1 << " points with metric " << metricId << " failed"
+                  << " (" << tree.GetNumberOfPendingPoints() << " pending)." << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      tree.FindNearest(point.data(), 1, neighbors);
+      if(neighbors.size() != 1 || neighbors[0].first != 0.0f)
+      {
+        std::cerr << "Inserted point " << pointId << " was not found." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Asking for more neighbors than there are points returns all of them
+  VantagePointTree smallTree;
+  smallTree.Build(std::vector<float>(points.begin(), points.begin() + 5 * dimension), dimension);
+  if(!CheckNearest(smallTree, std::vector<float>(points.begin(), points.begin() + 5 * dimension), points.data(), k,
+                   nullptr))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Custom
+#include "WorkingSet.h"
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// STL
+#include <iostream>
+
+int main(int, char*[])
+{
+  itk::Index<2> corner = {{0, 0}};
+  itk::Size<2> size = {{100, 80}};
+  itk::ImageRegion<2> fullRegion(corner, size);
+
+  Mask::Pointer mask = Mask::New();
+  mask->SetRegions(fullRegion);
+  mask->Allocate();
+
+  typedef itk::Image<int, 2> ImageType;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(fullRegion);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<Mask> maskIterator(mask, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    maskIterator.Set(mask->GetValidValue());
+    image->SetPixel(maskIterator.GetIndex(), image->ComputeOffset(maskIterator.GetIndex()));
+    ++maskIterator;
+  }
+
+  // With no hole, the whole image is the working set
+  if(WorkingSet::GetWorkingRegion(mask, 3, 10) != fullRegion)
+  {
+    std::cerr << "The working region of a mask without a hole should be the full region." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A hole from (10,40) to (19,49)
+  itk::Index<2> holeCorner = {{10, 40}};
+  itk::Size<2> holeSize = {{10, 10}};
+  itk::ImageRegion<2> hole(holeCorner, holeSize);
+  itk::ImageRegionIteratorWithIndex<Mask> holeIterator(mask, hole);
+  while(!holeIterator.IsAtEnd())
+  {
+    holeIterator.Set(mask->GetHoleValue());
+    ++holeIterator;
+  }
+
+  if(WorkingSet::GetHoleBoundingBox(mask) != hole)
+  {
+    std::cerr << "The hole bounding box is wrong." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The margin is 3 + 10 + 1 = 14, which is cropped by the left side of the image
+  itk::ImageRegion<2> workingRegion = WorkingSet::GetWorkingRegion(mask, 3, 10);
+  itk::Index<2> expectedCorner = {{0, 26}};
+  itk::Size<2> expectedSize = {{34, 38}};
+  if(workingRegion != itk::ImageRegion<2>(expectedCorner, expectedSize))
+  {
+    std::cerr << "The working region is " << workingRegion.GetIndex() << " " << workingRegion.GetSize()
+              << " but should be " << expectedCorner << " " << expectedSize << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(WorkingSet::GetWorkingRegion(mask, 3, WorkingSet::FullImageSearch) != fullRegion)
+  {
+    std::cerr << "The working region of a full image search should be the full region." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Extract, "fill" the cropped hole and paste back
+  ImageType::Pointer croppedImage = ImageType::New();
+  WorkingSet::ExtractRegion(image.GetPointer(), workingRegion, croppedImage.GetPointer());
+
+  Mask::Pointer croppedMask = Mask::New();
+  WorkingSet::ExtractMask(mask, workingRegion, croppedMask);
+
+  if(croppedImage->GetLargestPossibleRegion().GetIndex() != corner ||
+     croppedImage->GetLargestPossibleRegion().GetSize() != expectedSize)
+  {
+    std::cerr << "The cropped image region is wrong." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  itk::ImageRegionIteratorWithIndex<Mask> croppedMaskIterator(croppedMask, croppedMask->GetLargestPossibleRegion());
+  while(!croppedMaskIterator.IsAtEnd())
+  {
+    const itk::Index<2>& croppedPixel = croppedMaskIterator.GetIndex();
+    itk::Index<2> pixel = {{croppedPixel[0] + workingRegion.GetIndex()[0],
+                            croppedPixel[1] + workingRegion.GetIndex()[1]}};
+    if(croppedImage->GetPixel(croppedPixel) != image->GetPixel(pixel) ||
+       croppedMask->IsHole(croppedPixel) != mask->IsHole(pixel))
+    {
+      std::cerr << "Cropped pixel " << croppedPixel << " is wrong." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if(croppedMask->IsHole(croppedPixel))
+    {
+      croppedImage->SetPixel(croppedPixel, -1);
+      croppedMaskIterator.Set(croppedMask->GetValidValue());
+    }
+    ++croppedMaskIterator;
+  }
+
+  WorkingSet::PasteRegion(croppedImage.GetPointer(), workingRegion, image.GetPointer());
+  WorkingSet::PasteRegion<Mask>(croppedMask, workingRegion, mask);
+
+  maskIterator.GoToBegin();
+  while(!maskIterator.IsAtEnd())
+  {
+    const itk::Index<2>& pixel = maskIterator.GetIndex();
+    int expectedValue = hole.IsInside(pixel) ? -1 : static_cast<int>(image->ComputeOffset(pixel));
+    if(mask->IsHole(pixel) || image->GetPixel(pixel) != expectedValue)
+    {
+      std::cerr << "Pixel " << pixel << " was not pasted correctly." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++maskIterator;
+  }
+
+  return EXIT_SUCCESS;
+}
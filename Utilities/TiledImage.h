@@ -0,0 +1,154 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef TiledImage_H
+#define TiledImage_H
+
+// ITK
+#include "itkImage.h"
+#include "itkImageRegion.h"
+
+// STL
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+\class TiledImage
+\brief This class gives access to an image file that is too large to be loaded into memory.
+
+       The image is split into square tiles of TileSize x TileSize pixels. Tiles are read on demand
+       with ITK's streaming ImageIO (only the tile's region is requested from the reader, so formats
+       that support streamed reading, such as MetaImage or NRRD, do not read the rest of the file)
+       and are kept in a least recently used cache. When the cached tiles use more than MemoryBudget
+       bytes, the least recently used tiles are evicted. Tiles that were modified are written back
+       to the same file with a streaming (pasting) writer when they are evicted or when Flush() is called,
+       so the file must be in a format that supports streamed writing and must not be compressed.
+
+       ReadRegion() and Prefetch() load tiles in row-major order, which is the order in which the
+       grid graph (and therefore every linear search over it) visits the source patches.
+*/
+template <typename TImage>
+class TiledImage
+{
+public:
+
+  typedef typename TImage::PixelType PixelType;
+
+  /** Open 'fileName'. Only the image information is read here. */
+  TiledImage(const std::string& fileName, const unsigned int tileSize = 256,
+             const std::size_t memoryBudget = 256 * 1024 * 1024);
+
+  /** Write the modified tiles back to the file. */
+  ~TiledImage();
+
+  TiledImage(const TiledImage&) = delete;
+  TiledImage& operator=(const TiledImage&) = delete;
+
+  itk::ImageRegion<2> GetLargestPossibleRegion() const;
+
+  unsigned int GetTileSize() const;
+
+  PixelType GetPixel(const itk::Index<2>& pixel);
+
+  void SetPixel(const itk::Index<2>& pixel, const PixelType& value);
+
+  /** Load the tiles that overlap 'region' (in row-major order). If they do not all fit in the memory budget,
+    * the first ones are evicted again. */
+  void Prefetch(const itk::ImageRegion<2>& region);
+
+  /** Copy 'region' into 'image', whose region will start at (0,0). */
+  void ReadRegion(const itk::ImageRegion<2>& region, TImage* const image);
+
+  /** Copy all of 'image' (whose region starts at (0,0)) into 'region'. */
+  void WriteRegion(const TImage* const image, const itk::ImageRegion<2>& region);
+
+  /** Write all modified tiles back to the file. The tiles stay in the cache. */
+  void Flush();
+
+  void SetMemoryBudget(const std::size_t memoryBudget);
+
+  /** Get the number of bytes used by the cached tiles. */
+  std::size_t GetMemoryUsage() const;
+
+  unsigned int GetNumberOfTileReads() const;
+
+  unsigned int GetNumberOfTileWrites() const;
+
+private:
+
+  struct Tile
+  {
+    typename TImage::Pointer Image;
+
+    bool Dirty = false;
+
+    std::size_t Bytes = 0;
+
+    /** The position of the tile in RecentlyUsed. */
+    std::list<unsigned int>::iterator Position;
+  };
+
+  /** Get the id of the tile that contains 'pixel'. */
+  unsigned int GetTileId(const itk::Index<2>& pixel) const;
+
+  /** Get the region of tile 'tileId' (cropped to the image). */
+  itk::ImageRegion<2> GetTileRegion(const unsigned int tileId) const;
+
+  /** Get the ids of the tiles that overlap 'region', in row-major order. */
+  std::vector<unsigned int> GetTileIds(const itk::ImageRegion<2>& region) const;
+
+  /** Get tile 'tileId', loading it if necessary, and mark it as the most recently used tile. */
+  Tile& GetTile(const unsigned int tileId);
+
+  void LoadTile(const unsigned int tileId, Tile& tile);
+
+  void WriteTile(const unsigned int tileId, Tile& tile);
+
+  /** Evict least recently used tiles (but never the most recently used one) until the budget is met. */
+  void EvictTiles();
+
+  std::string FileName;
+
+  unsigned int TileSize;
+
+  std::size_t MemoryBudget;
+
+  /** The image information (region, spacing, ...) without a buffer. */
+  typename TImage::Pointer Information;
+
+  itk::ImageRegion<2> FullRegion;
+
+  unsigned int NumberOfTilesX;
+
+  std::unordered_map<unsigned int, Tile> Tiles;
+
+  /** Tile ids, most recently used first. */
+  std::list<unsigned int> RecentlyUsed;
+
+  std::size_t MemoryUsage = 0;
+
+  unsigned int NumberOfTileReads = 0;
+
+  unsigned int NumberOfTileWrites = 0;
+};
+
+#include "TiledImage.hpp"
+
+#endif
@@ -0,0 +1,364 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef TiledImage_HPP
+#define TiledImage_HPP
+
+#include "TiledImage.h" // Make syntax parser happy
+
+// ITK
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageIORegion.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+// STL
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+template <typename TImage>
+TiledImage<TImage>::TiledImage(const std::string& fileName, const unsigned int tileSize,
+                               const std::size_t memoryBudget) :
+  FileName(fileName), TileSize(tileSize), MemoryBudget(memoryBudget)
+{
+  if(tileSize == 0)
+  {
+    throw std::runtime_error("TiledImage: the tile size must be positive!");
+  }
+
+  typedef itk::ImageFileReader<TImage> ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->UpdateOutputInformation();
+
+  this->Information = TImage::New();
+  this->Information->CopyInformation(reader->GetOutput());
+  this->FullRegion = reader->GetOutput()->GetLargestPossibleRegion();
+
+  this->NumberOfTilesX = (this->FullRegion.GetSize()[0] + tileSize - 1) / tileSize;
+}
+
+template <typename TImage>
+TiledImage<TImage>::~TiledImage()
+{
+  try
+  {
+    Flush();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "TiledImage: could not write the modified tiles of " << this->FileName << ": " << e.what() << std::endl;
+  }
+}
+
+template <typename TImage>
+itk::ImageRegion<2> TiledImage<TImage>::GetLargestPossibleRegion() const
+{
+  return this->FullRegion;
+}
+
+template <typename TImage>
+unsigned int TiledImage<TImage>::GetTileSize() const
+{
+  return this->TileSize;
+}
+
+template <typename TImage>
+typename TiledImage<TImage>::PixelType TiledImage<TImage>::GetPixel(const itk::Index<2>& pixel)
+{
+  return GetTile(GetTileId(pixel)).Image->GetPixel(pixel);
+}
+
+template <typename TImage>
+void TiledImage<TImage>::SetPixel(const itk::Index<2>& pixel, const PixelType& value)
+{
+  Tile& tile = GetTile(GetTileId(pixel));
+  tile.Image->SetPixel(pixel, value);
+  tile.Dirty = true;
+}
+
+template <typename TImage>
+void TiledImage<TImage>::Prefetch(const itk::ImageRegion<2>& region)
+{
+  std::vector<unsigned int> tileIds = GetTileIds(region);
+  for(unsigned int i = 0; i < tileIds.size(); ++i)
+  {
+    GetTile(tileIds[i]);
+  }
+}
+
+template <typename TImage>
+void TiledImage<TImage>::ReadRegion(const itk::ImageRegion<2>& region, TImage* const image)
+{
+  if(!this->FullRegion.IsInside(region))
+  {
+    std::stringstream ss;
+    ss << "TiledImage::ReadRegion: the region (" << region.GetIndex() << " " << region.GetSize()
+       << ") is not inside the image!";
+    throw std::runtime_error(ss.str());
+  }
+
+  itk::Index<2> corner = {{0, 0}};
+  itk::ImageRegion<2> imageRegion(corner, region.GetSize());
+
+  image->CopyInformation(this->Information); // Spacing, origin and (for VectorImage) the number of components
+  image->SetRegions(imageRegion);
+  image->Allocate();
+
+  std::vector<unsigned int> tileIds = GetTileIds(region);
+  for(unsigned int i = 0; i < tileIds.size(); ++i)
+  {
+    Tile& tile = GetTile(tileIds[i]);
+
+    itk::ImageRegion<2> part = tile.Image->GetBufferedRegion();
+    part.Crop(region);
+
+    itk::Index<2> imagePartCorner = {{part.GetIndex()[0] - region.GetIndex()[0],
+                                      part.GetIndex()[1] - region.GetIndex()[1]}};
+    itk::ImageRegion<2> imagePart(imagePartCorner, part.GetSize());
+
+    itk::ImageRegionConstIterator<TImage> tileIterator(tile.Image, part);
+    itk::ImageRegionIterator<TImage> imageIterator(image, imagePart);
+    while(!tileIterator.IsAtEnd())
+    {
+      imageIterator.Set(tileIterator.Get());
+      ++tileIterator;
+      ++imageIterator;
+    }
+  }
+}
+
+template <typename TImage>
+void TiledImage<TImage>::WriteRegion(const TImage* const image, const itk::ImageRegion<2>& region)
+{
+  if(!this->FullRegion.IsInside(region) || image->GetLargestPossibleRegion().GetSize() != region.GetSize())
+  {
+    std::stringstream ss;
+    ss << "TiledImage::WriteRegion: the region (" << region.GetIndex() << " " << region.GetSize()
+       << ") is not inside the image or does not match the size of the image to write!";
+    throw std::runtime_error(ss.str());
+  }
+
+  std::vector<unsigned int> tileIds = GetTileIds(region);
+  for(unsigned int i = 0; i < tileIds.size(); ++i)
+  {
+    Tile& tile = GetTile(tileIds[i]);
+
+    itk::ImageRegion<2> part = tile.Image->GetBufferedRegion();
+    part.Crop(region);
+
+    itk::Index<2> imagePartCorner = {{part.GetIndex()[0] - region.GetIndex()[0],
+                                      part.GetIndex()[1] - region.GetIndex()[1]}};
+    itk::ImageRegion<2> imagePart(imagePartCorner, part.GetSize());
+
+    itk::ImageRegionConstIterator<TImage> imageIterator(image, imagePart);
+    itk::ImageRegionIterator<TImage> tileIterator(tile.Image, part);
+    while(!imageIterator.IsAtEnd())
+    {
+      tileIterator.Set(imageIterator.Get());
+      ++imageIterator;
+      ++tileIterator;
+    }
+
+    tile.Dirty = true;
+  }
+}
+
+template <typename TImage>
+void TiledImage<TImage>::Flush()
+{
+  for(typename std::unordered_map<unsigned int, Tile>::iterator iterator = this->Tiles.begin();
+      iterator != this->Tiles.end(); ++iterator)
+  {
+    if(iterator->second.Dirty)
+    {
+      WriteTile(iterator->first, iterator->second);
+    }
+  }
+}
+
+template <typename TImage>
+void TiledImage<TImage>::SetMemoryBudget(const std::size_t memoryBudget)
+{
+  this->MemoryBudget = memoryBudget;
+  EvictTiles();
+}
+
+template <typename TImage>
+std::size_t TiledImage<TImage>::GetMemoryUsage() const
+{
+  return this->MemoryUsage;
+}
+
+template <typename TImage>
+unsigned int TiledImage<TImage>::GetNumberOfTileReads() const
+{
+  return this->NumberOfTileReads;
+}
+
+template <typename TImage>
+unsigned int TiledImage<TImage>::GetNumberOfTileWrites() const
+{
+  return this->NumberOfTileWrites;
+}
+
+template <typename TImage>
+unsigned int TiledImage<TImage>::GetTileId(const itk::Index<2>& pixel) const
+{
+  if(!this->FullRegion.IsInside(pixel))
+  {
+    std::stringstream ss;
+    ss << "TiledImage: " << pixel << " is outside of the image!";
+    throw std::runtime_error(ss.str());
+  }
+
+  unsigned int tileX = (pixel[0] - this->FullRegion.GetIndex()[0]) / this->TileSize;
+  unsigned int tileY = (pixel[1] - this->FullRegion.GetIndex()[1]) / this->TileSize;
+  return tileY * this->NumberOfTilesX + tileX;
+}
+
+template <typename TImage>
+itk::ImageRegion<2> TiledImage<TImage>::GetTileRegion(const unsigned int tileId) const
+{
+  itk::Index<2> corner = {{this->FullRegion.GetIndex()[0] + (tileId % this->NumberOfTilesX) * this->TileSize,
+                           this->FullRegion.GetIndex()[1] + (tileId / this->NumberOfTilesX) * this->TileSize}};
+  itk::Size<2> size = {{this->TileSize, this->TileSize}};
+  itk::ImageRegion<2> tileRegion(corner, size);
+  tileRegion.Crop(this->FullRegion);
+  return tileRegion;
+}
+
+template <typename TImage>
+std::vector<unsigned int> TiledImage<TImage>::GetTileIds(const itk::ImageRegion<2>& region) const
+{
+  std::vector<unsigned int> tileIds;
+  if(region.GetNumberOfPixels() == 0)
+  {
+    return tileIds;
+  }
+
+  unsigned int firstTile = GetTileId(region.GetIndex());
+  unsigned int lastTile = GetTileId(region.GetUpperIndex());
+  for(unsigned int tileY = firstTile / this->NumberOfTilesX; tileY <= lastTile / this->NumberOfTilesX; ++tileY)
+  {
+    for(unsigned int tileX = firstTile % this->NumberOfTilesX; tileX <= lastTile % this->NumberOfTilesX; ++tileX)
+    {
+      tileIds.push_back(tileY * this->NumberOfTilesX + tileX);
+    }
+  }
+  return tileIds;
+}
+
+template <typename TImage>
+typename TiledImage<TImage>::Tile& TiledImage<TImage>::GetTile(const unsigned int tileId)
+{
+  typename std::unordered_map<unsigned int, Tile>::iterator iterator = this->Tiles.find(tileId);
+  if(iterator != this->Tiles.end())
+  {
+    this->RecentlyUsed.splice(this->RecentlyUsed.begin(), this->RecentlyUsed, iterator->second.Position);
+    return iterator->second;
+  }
+
+  Tile& tile = this->Tiles[tileId];
+  LoadTile(tileId, tile);
+  this->RecentlyUsed.push_front(tileId);
+  tile.Position = this->RecentlyUsed.begin();
+  this->MemoryUsage += tile.Bytes;
+
+  EvictTiles();
+  return tile; // The most recently used tile is never evicted, and unordered_map references are stable
+}
+
+template <typename TImage>
+void TiledImage<TImage>::LoadTile(const unsigned int tileId, Tile& tile)
+{
+  itk::ImageRegion<2> tileRegion = GetTileRegion(tileId);
+
+  typedef itk::ImageFileReader<TImage> ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(this->FileName);
+  reader->UpdateOutputInformation();
+  reader->GetOutput()->SetRequestedRegion(tileRegion);
+  reader->GetOutput()->Update();
+
+  // The tile knows the full region, so that the streaming writer can paste it back into the file
+  tile.Image = TImage::New();
+  tile.Image->CopyInformation(this->Information);
+  tile.Image->SetBufferedRegion(tileRegion);
+  tile.Image->SetRequestedRegion(tileRegion);
+  tile.Image->Allocate();
+
+  // Readers that can not stream may have read more than the tile
+  itk::ImageRegionConstIterator<TImage> readerIterator(reader->GetOutput(), tileRegion);
+  itk::ImageRegionIterator<TImage> tileIterator(tile.Image, tileRegion);
+  while(!readerIterator.IsAtEnd())
+  {
+    tileIterator.Set(readerIterator.Get());
+    ++readerIterator;
+    ++tileIterator;
+  }
+
+  tile.Dirty = false;
+  tile.Bytes = tile.Image->GetPixelContainer()->Size() * sizeof(typename TImage::InternalPixelType);
+  this->NumberOfTileReads++;
+}
+
+template <typename TImage>
+void TiledImage<TImage>::WriteTile(const unsigned int tileId, Tile& tile)
+{
+  itk::ImageRegion<2> tileRegion = GetTileRegion(tileId);
+
+  itk::ImageIORegion ioRegion(2);
+  for(unsigned int dimension = 0; dimension < 2; ++dimension)
+  {
+    ioRegion.SetIndex(dimension, tileRegion.GetIndex()[dimension]);
+    ioRegion.SetSize(dimension, tileRegion.GetSize()[dimension]);
+  }
+
+  typedef itk::ImageFileWriter<TImage> WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(this->FileName);
+  writer->SetInput(tile.Image);
+  writer->SetIORegion(ioRegion);
+  writer->Update();
+
+  tile.Dirty = false;
+  this->NumberOfTileWrites++;
+}
+
+template <typename TImage>
+void TiledImage<TImage>::EvictTiles()
+{
+  while(this->MemoryUsage > this->MemoryBudget && this->RecentlyUsed.size() > 1)
+  {
+    unsigned int tileId = this->RecentlyUsed.back();
+    Tile& tile = this->Tiles[tileId];
+    if(tile.Dirty)
+    {
+      WriteTile(tileId, tile);
+    }
+
+    this->MemoryUsage -= tile.Bytes;
+    this->RecentlyUsed.pop_back();
+    this->Tiles.erase(tileId);
+  }
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "TiledMask.h"
+
+// ITK
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+
+// STL
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+TiledMask::TiledMask(const std::string& fileName, const unsigned char holeValue, const unsigned char validValue,
+                     const unsigned int tileSize, const std::size_t memoryBudget) :
+  TiledImage<ImageType>(fileName, tileSize, memoryBudget), HoleValue(holeValue), ValidValue(validValue)
+{
+  if(holeValue == validValue)
+  {
+    throw std::runtime_error("TiledMask: the hole value and the valid value must be different!");
+  }
+}
+
+bool TiledMask::IsHole(const itk::Index<2>& pixel)
+{
+  return IsHoleValue(GetPixel(pixel));
+}
+
+bool TiledMask::IsHoleValue(const unsigned char value) const
+{
+  return std::abs(static_cast<int>(value) - static_cast<int>(this->HoleValue)) <
+         std::abs(static_cast<int>(value) - static_cast<int>(this->ValidValue));
+}
+
+void TiledMask::MarkAsValid(const itk::Index<2>& pixel)
+{
+  SetPixel(pixel, this->ValidValue);
+}
+
+unsigned char TiledMask::GetHoleValue() const
+{
+  return this->HoleValue;
+}
+
+unsigned char TiledMask::GetValidValue() const
+{
+  return this->ValidValue;
+}
+
+void TiledMask::ReadMaskFile(const std::string& maskFileName, unsigned char& holeValue, unsigned char& validValue,
+                             std::string& imageFileName)
+{
+  std::ifstream stream(maskFileName.c_str());
+  if(!stream)
+  {
+    throw std::runtime_error("TiledMask::ReadMaskFile: cannot open " + maskFileName);
+  }
+
+  int hole = 0;
+  int valid = 0;
+  std::string relativeImageFileName;
+  stream >> hole >> valid >> relativeImageFileName;
+  if(!stream || hole < 0 || hole > 255 || valid < 0 || valid > 255)
+  {
+    throw std::runtime_error("TiledMask::ReadMaskFile: " + maskFileName +
+                             " must contain 'holeValue validValue imageFileName'");
+  }
+
+  holeValue = static_cast<unsigned char>(hole);
+  validValue = static_cast<unsigned char>(valid);
+
+  std::string::size_type lastSeparator = maskFileName.find_last_of("/\\");
+  if(lastSeparator == std::string::npos)
+  {
+    imageFileName = relativeImageFileName;
+  }
+  else
+  {
+    imageFileName = maskFileName.substr(0, lastSeparator + 1) + relativeImageFileName;
+  }
+}
+
+void TiledMask::CopyMaskImage(const std::string& imageFileName, const std::string& fileName,
+                              const unsigned int tileSize)
+{
+  typedef itk::ImageFileReader<ImageType> ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(imageFileName);
+  reader->UpdateOutputInformation();
+
+  // Write a band of tile rows at a time
+  unsigned int height = reader->GetOutput()->GetLargestPossibleRegion().GetSize()[1];
+  unsigned int numberOfBands = (height + tileSize - 1) / tileSize;
+
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(fileName);
+  writer->SetInput(reader->GetOutput());
+  writer->SetNumberOfStreamDivisions(numberOfBands > 0 ? numberOfBands : 1);
+  writer->Update();
+}
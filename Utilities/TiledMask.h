@@ -0,0 +1,73 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef TiledMask_H
+#define TiledMask_H
+
+// Custom
+#include "TiledImage.h"
+
+// STL
+#include <string>
+
+/**
+\class TiledMask
+\brief A mask that is too large to be loaded into memory. The mask image is accessed through the tile cache of
+       TiledImage, so it must be in a format that supports streamed writing (see CopyMaskImage()).
+
+       A pixel is a hole if its value is closer to the hole value than to the valid value (mask images are often
+       antialiased), and filled pixels are set to the valid value.
+*/
+class TiledMask : public TiledImage<itk::Image<unsigned char, 2> >
+{
+public:
+
+  typedef itk::Image<unsigned char, 2> ImageType;
+
+  TiledMask(const std::string& fileName, const unsigned char holeValue, const unsigned char validValue,
+            const unsigned int tileSize = 256, const std::size_t memoryBudget = 64 * 1024 * 1024);
+
+  bool IsHole(const itk::Index<2>& pixel);
+
+  bool IsHoleValue(const unsigned char value) const;
+
+  void MarkAsValid(const itk::Index<2>& pixel);
+
+  unsigned char GetHoleValue() const;
+
+  unsigned char GetValidValue() const;
+
+  /** Read a .mask file, which is a line "holeValue validValue imageFileName". The returned image file name
+    * includes the path of the .mask file. */
+  static void ReadMaskFile(const std::string& maskFileName, unsigned char& holeValue, unsigned char& validValue,
+                           std::string& imageFileName);
+
+  /** Copy the mask image 'imageFileName' to 'fileName', which should be in a format that can be written a tile at a
+    * time (e.g. uncompressed .mha). The copy is streamed if the format of 'imageFileName' can be read a part at a
+    * time; otherwise (e.g. .png) the mask image is loaded once here. */
+  static void CopyMaskImage(const std::string& imageFileName, const std::string& fileName,
+                            const unsigned int tileSize = 256);
+
+private:
+
+  unsigned char HoleValue;
+
+  unsigned char ValidValue;
+};
+
+#endif
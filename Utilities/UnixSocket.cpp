@@ -0,0 +1,259 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "UnixSocket.h"
+
+// STL
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+// POSIX
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+sockaddr_un CreateAddress(const std::string& path)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(address.sun_path))
+  {
+    throw std::runtime_error("UnixSocket: the path " + path + " is too long!");
+  }
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  return address;
+}
+
+std::string GetErrorString(const std::string& function)
+{
+  return "UnixSocket: " + function + " failed: " + std::strerror(errno);
+}
+
+/** Remove the socket at 'path' if it was left over by a server that exited without removing it. Throw if 'path'
+  * is not a socket (so that e.g. a typo in the path can not delete a regular file) or if a server is still
+  * listening at it. */
+void RemoveStaleSocket(const std::string& path)
+{
+  struct stat fileStatus;
+  if(lstat(path.c_str(), &fileStatus) != 0)
+  {
+    if(errno == ENOENT)
+    {
+      return;
+    }
+    throw std::runtime_error(GetErrorString("lstat(" + path + ")"));
+  }
+
+  if(!S_ISSOCK(fileStatus.st_mode))
+  {
+    throw std::runtime_error("UnixSocket: " + path + " already exists and is not a socket!");
+  }
+
+  sockaddr_un address = CreateAddress(path);
+  int probeFileDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(probeFileDescriptor < 0)
+  {
+    throw std::runtime_error(GetErrorString("socket()"));
+  }
+  bool connected = connect(probeFileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+  int connectError = errno;
+  close(probeFileDescriptor);
+
+  if(connected)
+  {
+    throw std::runtime_error("UnixSocket: a server is already listening at " + path + "!");
+  }
+
+  if(connectError != ECONNREFUSED)
+  {
+    errno = connectError;
+    throw std::runtime_error(GetErrorString("connect(" + path + ")"));
+  }
+
+  if(unlink(path.c_str()) != 0)
+  {
+    throw std::runtime_error(GetErrorString("unlink(" + path + ")"));
+  }
+}
+
+} // end anonymous namespace
+
+UnixSocket::UnixSocket(const int fileDescriptor) : FileDescriptor(fileDescriptor)
+{
+
+}
+
+UnixSocket::~UnixSocket()
+{
+  close(this->FileDescriptor);
+}
+
+std::unique_ptr<UnixSocket> UnixSocket::Listen(const std::string& path)
+{
+  sockaddr_un address = CreateAddress(path);
+
+  int fileDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fileDescriptor < 0)
+  {
+    throw std::runtime_error(GetErrorString("socket()"));
+  }
+  std::unique_ptr<UnixSocket> listeningSocket(new UnixSocket(fileDescriptor));
+
+  RemoveStaleSocket(path);
+  if(bind(fileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+  {
+    throw std::runtime_error(GetErrorString("bind(" + path + ")"));
+  }
+
+  if(listen(fileDescriptor, SOMAXCONN) != 0)
+  {
+    throw std::runtime_error(GetErrorString("listen(" + path + ")"));
+  }
+
+  return listeningSocket;
+}
+
+std::unique_ptr<UnixSocket> UnixSocket::Connect(const std::string& path)
+{
+  sockaddr_un address = CreateAddress(path);
+
+  int fileDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fileDescriptor < 0)
+  {
+    throw std::runtime_error(GetErrorString("socket()"));
+  }
+  std::unique_ptr<UnixSocket> connectedSocket(new UnixSocket(fileDescriptor));
+
+  if(connect(fileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+  {
+    throw std::runtime_error(GetErrorString("connect(" + path + ")"));
+  }
+
+  return connectedSocket;
+}
+
+std::unique_ptr<UnixSocket> UnixSocket::Accept()
+{
+  while(true)
+  {
+    int fileDescriptor = accept(this->FileDescriptor, nullptr, nullptr);
+    if(fileDescriptor >= 0)
+    {
+      return std::unique_ptr<UnixSocket>(new UnixSocket(fileDescriptor));
+    }
+
+    if(errno != EINTR && errno != ECONNABORTED)
+    {
+      // This is how Shutdown() wakes up a waiting Accept()
+      return std::unique_ptr<UnixSocket>();
+    }
+  }
+}
+
+bool UnixSocket::ReadLine(std::string& line)
+{
+  std::size_t endOfLine = this->ReceiveBuffer.find('\n');
+  while(endOfLine == std::string::npos)
+  {
+    char buffer[4096];
+    ssize_t numberOfBytes = recv(this->FileDescriptor, buffer, sizeof(buffer), 0);
+    if(numberOfBytes < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if(numberOfBytes <= 0)
+    {
+      return false;
+    }
+
+    std::size_t searchStart = this->ReceiveBuffer.size();
+    this->ReceiveBuffer.append(buffer, numberOfBytes);
+    endOfLine = this->ReceiveBuffer.find('\n', searchStart);
+
+    if(endOfLine == std::string::npos && this->ReceiveBuffer.size() > this->MaximumLineLength)
+    {
+      break;
+    }
+  }
+
+  if(endOfLine == std::string::npos || endOfLine > this->MaximumLineLength)
+  {
+    // The rest of the stream can not be parsed, so the caller should close the connection
+    this->ReceiveBuffer.clear();
+    std::stringstream ss;
+    ss << "UnixSocket: received a line longer than " << this->MaximumLineLength << " bytes!";
+    throw std::runtime_error(ss.str());
+  }
+
+  line = this->ReceiveBuffer.substr(0, endOfLine);
+  this->ReceiveBuffer.erase(0, endOfLine + 1);
+  return true;
+}
+
+void UnixSocket::SetMaximumLineLength(const std::size_t maximumLineLength)
+{
+  this->MaximumLineLength = maximumLineLength;
+}
+
+void UnixSocket::WriteLine(const std::string& line)
+{
+  std::string data = line + "\n";
+
+  std::lock_guard<std::mutex> lock(this->WriteMutex);
+  std::size_t numberOfBytesSent = 0;
+  while(numberOfBytesSent < data.size())
+  {
+    // MSG_NOSIGNAL: report a disconnected peer as an error instead of raising SIGPIPE
+    ssize_t numberOfBytes = send(this->FileDescriptor, data.data() + numberOfBytesSent,
+                                 data.size() - numberOfBytesSent, MSG_NOSIGNAL);
+    if(numberOfBytes < 0)
+    {
+      if(errno == EINTR)
+      {
+        continue;
+      }
+      throw std::runtime_error(GetErrorString("send()"));
+    }
+    numberOfBytesSent += numberOfBytes;
+  }
+}
+
+void UnixSocket::SetReceiveTimeout(const unsigned int seconds)
+{
+  timeval timeout;
+  timeout.tv_sec = seconds;
+  timeout.tv_usec = 0;
+  if(setsockopt(this->FileDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0)
+  {
+    throw std::runtime_error(GetErrorString("setsockopt()"));
+  }
+}
+
+void UnixSocket::Shutdown()
+{
+  shutdown(this->FileDescriptor, SHUT_RDWR);
+}
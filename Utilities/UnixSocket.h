@@ -0,0 +1,84 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef UnixSocket_H
+#define UnixSocket_H
+
+// STL
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+\class UnixSocket
+\brief A connected or listening Unix domain stream socket that sends and receives text lines.
+       Errors are reported by throwing std::runtime_error. The socket is closed when the object is destroyed.
+*/
+class UnixSocket
+{
+public:
+
+  /** Take ownership of the file descriptor 'fileDescriptor'. */
+  explicit UnixSocket(const int fileDescriptor);
+
+  ~UnixSocket();
+
+  UnixSocket(const UnixSocket&) = delete;
+  UnixSocket& operator=(const UnixSocket&) = delete;
+
+  /** Listen at 'path'. A socket that is already at 'path' is removed first if no server is listening at it (e.g. it
+    * was left over by a server that crashed). Throws if 'path' exists and is not a socket, or if a server is
+    * listening at it. */
+  static std::unique_ptr<UnixSocket> Listen(const std::string& path);
+
+  static std::unique_ptr<UnixSocket> Connect(const std::string& path);
+
+  /** Wait for a client. A null pointer is returned if the socket was shut down (see Shutdown()). */
+  std::unique_ptr<UnixSocket> Accept();
+
+  /** Read the next line (without its '\n'). False is returned at the end of the stream, or if no data
+    * arrived within the receive timeout. Throws if the line is longer than the maximum line length, so a peer
+    * can not make us buffer an endless line. */
+  bool ReadLine(std::string& line);
+
+  /** Set the length (in bytes, without the '\n') of the longest line that ReadLine() accepts. */
+  void SetMaximumLineLength(const std::size_t maximumLineLength);
+
+  /** Send 'line' followed by '\n'. This may be called from several threads at once. */
+  void WriteLine(const std::string& line);
+
+  /** Give up on ReadLine() after 'seconds' seconds without data (0 waits forever). */
+  void SetReceiveTimeout(const unsigned int seconds);
+
+  /** Stop all reads, writes and Accept() calls on this socket, including those waiting in other threads. */
+  void Shutdown();
+
+private:
+
+  int FileDescriptor;
+
+  /** Data that has been received but not returned by ReadLine() yet. */
+  std::string ReceiveBuffer;
+
+  std::size_t MaximumLineLength = 64 * 1024;
+
+  std::mutex WriteMutex;
+};
+
+#endif
@@ -0,0 +1,321 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "VantagePointTree.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+VantagePointTree::VantagePointTree(const MetricEnum metric) : Metric(metric)
+{
+
+}
+
+void VantagePointTree::Build(const std::vector<float>& points, const unsigned int dimension)
+{
+  this->Dimension = dimension;
+  this->PendingPoints.clear();
+  this->PendingIds.clear();
+
+  const unsigned int numberOfPoints = dimension > 0 ? static_cast<unsigned int>(points.size() / dimension) : 0;
+  this->Nodes.assign(numberOfPoints, Node());
+
+  std::vector<BuildItemType> items(numberOfPoints);
+  for(unsigned int pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    items[pointId] = BuildItemType(0.0f, pointId);
+  }
+
+  // The subtrees cover disjoint ranges of 'items' and 'Nodes', so they are constructed by independent tasks
+  #pragma omp parallel
+  {
+    #pragma omp single
+    BuildRange(0, numberOfPoints, points, items);
+  }
+
+  // Store the points in tree order, so a leaf reads one contiguous block
+  this->Ids.resize(numberOfPoints);
+  this->Points.resize(static_cast<std::size_t>(numberOfPoints) * dimension);
+  for(unsigned int position = 0; position < numberOfPoints; ++position)
+  {
+    this->Ids[position] = items[position].second;
+    std::copy(&points[static_cast<std::size_t>(items[position].second) * dimension],
+              &points[static_cast<std::size_t>(items[position].second) * dimension] + dimension,
+              &this->Points[static_cast<std::size_t>(position) * dimension]);
+  }
+}
+
+void VantagePointTree::BuildRange(const unsigned int begin, const unsigned int end,
+                                  const std::vector<float>& points, std::vector<BuildItemType>& items)
+{
+  if(end - begin <= LeafSize)
+  {
+    return;
+  }
+
+  const unsigned int numberOfPoints = end - begin;
+  auto point = [&points, this](const unsigned int pointId)
+  {
+    return &points[static_cast<std::size_t>(pointId) * this->Dimension];
+  };
+
+  // Choose the vantage point, among a few evenly spaced candidates, whose distances to a sample of the range
+  // have the largest spread, so the median splits the range well
+  const unsigned int numberOfCandidates = 5;
+  const unsigned int sampleSize = std::min(numberOfPoints, 32u);
+  unsigned int bestCandidate = begin;
+  float bestSpread = -1.0f;
+  for(unsigned int candidateId = 0; candidateId < numberOfCandidates; ++candidateId)
+  {
+    const unsigned int candidate = begin + candidateId * numberOfPoints / numberOfCandidates;
+    float sum = 0.0f;
+    float sumOfSquares = 0.0f;
+    for(unsigned int sampleId = 0; sampleId < sampleSize; ++sampleId)
+    {
+      const unsigned int sample = begin + (sampleId * numberOfPoints + numberOfPoints / 2) / sampleSize;
+      const float distance = Distance(point(items[candidate].second), point(items[sample].second), nullptr);
+      sum += distance;
+      sumOfSquares += distance * distance;
+    }
+
+    const float spread = sumOfSquares / sampleSize - (sum / sampleSize) * (sum / sampleSize);
+    if(spread > bestSpread)
+    {
+      bestSpread = spread;
+      bestCandidate = candidate;
+    }
+  }
+
+  std::swap(items[begin], items[bestCandidate]);
+
+  const float* vantagePoint = point(items[begin].second);
+  for(unsigned int position = begin + 1; position < end; ++position)
+  {
+    items[position].first = Distance(vantagePoint, point(items[position].second), nullptr);
+  }
+
+  // The closer half of the points is the inside subtree, and the rest is the outside subtree
+  const unsigned int split = begin + 1 + (numberOfPoints - 1) / 2;
+  std::nth_element(items.begin() + begin + 1, items.begin() + split, items.begin() + end);
+
+  Node& node = this->Nodes[begin];
+  node.Split = split;
+  node.InsideRadius = 0.0f;
+  for(unsigned int position = begin + 1; position < split; ++position)
+  {
+    node.InsideRadius = std::max(node.InsideRadius, items[position].first);
+  }
+  node.OutsideRadius = items[split].first;
+
+  if(split - begin - 1 > ParallelBuildSize)
+  {
+    #pragma omp task shared(points, items)
+    BuildRange(begin + 1, split, points, items);
+  }
+  else
+  {
+    BuildRange(begin + 1, split, points, items);
+  }
+
+  BuildRange(split, end, points, items);
+
+  #pragma omp taskwait
+}
+
+unsigned int VantagePointTree::Insert(const float* const point)
+{
+  const unsigned int pointId = GetNumberOfPoints();
+  this->PendingPoints.insert(this->PendingPoints.end(), point, point + this->Dimension);
+  this->PendingIds.push_back(pointId);
+
+  if(this->PendingIds.size() > GetNumberOfPoints() / RebuildDivisor)
+  {
+    // The ids are the positions of the points in the order they were given, so rebuilding from all of the points
+    // in that order keeps them
+    std::vector<float> points(static_cast<std::size_t>(GetNumberOfPoints()) * this->Dimension);
+    for(unsigned int position = 0; position < this->Ids.size(); ++position)
+    {
+      std::copy(&this->Points[static_cast<std::size_t>(position) * this->Dimension],
+                &this->Points[static_cast<std::size_t>(position) * this->Dimension] + this->Dimension,
+                &points[static_cast<std::size_t>(this->Ids[position]) * this->Dimension]);
+    }
+
+    for(unsigned int position = 0; position < this->PendingIds.size(); ++position)
+    {
+      std::copy(&this->PendingPoints[static_cast<std::size_t>(position) * this->Dimension],
+                &this->PendingPoints[static_cast<std::size_t>(position) * this->Dimension] + this->Dimension,
+                &points[static_cast<std::size_t>(this->PendingIds[position]) * this->Dimension]);
+    }
+
+    Build(points, this->Dimension);
+  }
+
+  return pointId;
+}
+
+unsigned int VantagePointTree::GetNumberOfPoints() const
+{
+  return static_cast<unsigned int>(this->Ids.size() + this->PendingIds.size());
+}
+
+unsigned int VantagePointTree::GetNumberOfPendingPoints() const
+{
+  return static_cast<unsigned int>(this->PendingIds.size());
+}
+
+unsigned int VantagePointTree::GetDimension() const
+{
+  return this->Dimension;
+}
+
+VantagePointTree::MetricEnum VantagePointTree::GetMetric() const
+{
+  return this->Metric;
+}
+
+void VantagePointTree::FindNearest(const float* const query, const unsigned int k,
+                                   std::vector<NeighborType>& neighbors,
+                                   const std::vector<unsigned int>* const validComponents) const
+{
+  neighbors.clear();
+  if(k == 0)
+  {
+    return;
+  }
+
+  // 'neighbors' is a max-heap of the best neighbors so far while searching
+  SearchRange(0, static_cast<unsigned int>(this->Ids.size()), query, k, validComponents, neighbors);
+
+  for(unsigned int position = 0; position < this->PendingIds.size(); ++position)
+  {
+    const float distance = Distance(query, &this->PendingPoints[static_cast<std::size_t>(position) * this->Dimension],
+                                    validComponents);
+    AddCandidate(distance, this->PendingIds[position], k, neighbors);
+  }
+
+  std::sort_heap(neighbors.begin(), neighbors.end());
+}
+
+void VantagePointTree::FindNearest(const std::vector<float>& queries, const unsigned int k,
+                                   std::vector<std::vector<NeighborType> >& neighbors) const
+{
+  const int numberOfQueries = this->Dimension > 0 ? static_cast<int>(queries.size() / this->Dimension) : 0;
+  neighbors.resize(numberOfQueries);
+
+  #pragma omp parallel for schedule(dynamic, 16)
+  for(int queryId = 0; queryId < numberOfQueries; ++queryId)
+  {
+    FindNearest(&queries[static_cast<std::size_t>(queryId) * this->Dimension], k, neighbors[queryId]);
+  }
+}
+
+void VantagePointTree::SearchRange(const unsigned int begin, const unsigned int end, const float* const query,
+                                   const unsigned int k, const std::vector<unsigned int>* const validComponents,
+                                   std::vector<NeighborType>& heap) const
+{
+  if(end - begin <= LeafSize)
+  {
+    for(unsigned int position = begin; position < end; ++position)
+    {
+      const float distance = Distance(query, &this->Points[static_cast<std::size_t>(position) * this->Dimension],
+                                      validComponents);
+      AddCandidate(distance, this->Ids[position], k, heap);
+    }
+    return;
+  }
+
+  const Node& node = this->Nodes[begin];
+  const float distance = Distance(query, &this->Points[static_cast<std::size_t>(begin) * this->Dimension],
+                                  validComponents);
+  AddCandidate(distance, this->Ids[begin], k, heap);
+
+  // By the triangle inequality, no point of a subtree is closer to the query than these bounds. A distance over
+  // only some of the components is at most the full distance, so the inside bound still holds for it, but the
+  // outside bound does not.
+  const float insideBound = distance - node.InsideRadius;
+  const float outsideBound = validComponents ? 0.0f : node.OutsideRadius - distance;
+
+  // Allow for the rounding of the distances, so that no closer point is pruned
+  const float tolerance = 1e-4f;
+  auto worstDistance = [&heap, k]()
+  {
+    return heap.size() < k ? std::numeric_limits<float>::infinity() : heap.front().first;
+  };
+
+  const bool insideFirst = insideBound <= outsideBound;
+  for(unsigned int childId = 0; childId < 2; ++childId)
+  {
+    const bool inside = (childId == 0) == insideFirst;
+    const float bound = inside ? insideBound : outsideBound;
+    if(bound * (1.0f - tolerance) <= worstDistance())
+    {
+      if(inside)
+      {
+        SearchRange(begin + 1, node.Split, query, k, validComponents, heap);
+      }
+      else
+      {
+        SearchRange(node.Split, end, query, k, validComponents, heap);
+      }
+    }
+  }
+}
+
+float VantagePointTree::Distance(const float* const a, const float* const b,
+                                 const std::vector<unsigned int>* const validComponents) const
+{
+  float distance = 0.0f;
+  if(validComponents)
+  {
+    for(std::size_t componentId = 0; componentId < validComponents->size(); ++componentId)
+    {
+      const float difference = a[(*validComponents)[componentId]] - b[(*validComponents)[componentId]];
+      distance += this->Metric == MANHATTAN ? std::fabs(difference) : difference * difference;
+    }
+  }
+  else
+  {
+    for(unsigned int componentId = 0; componentId < this->Dimension; ++componentId)
+    {
+      const float difference = a[componentId] - b[componentId];
+      distance += this->Metric == MANHATTAN ? std::fabs(difference) : difference * difference;
+    }
+  }
+
+  return this->Metric == MANHATTAN ? distance : std::sqrt(distance);
+}
+
+void VantagePointTree::AddCandidate(const float distance, const unsigned int id, const unsigned int k,
+                                    std::vector<NeighborType>& heap) const
+{
+  if(heap.size() < k)
+  {
+    heap.push_back(NeighborType(distance, id));
+    std::push_heap(heap.begin(), heap.end());
+  }
+  else if(distance < heap.front().first)
+  {
+    std::pop_heap(heap.begin(), heap.end());
+    heap.back() = NeighborType(distance, id);
+    std::push_heap(heap.begin(), heap.end());
+  }
+}
@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef VantagePointTree_H
+#define VantagePointTree_H
+
+// STL
+#include <utility>
+#include <vector>
+
+/**
+\class VantagePointTree
+\brief This class finds the K nearest neighbors of a query among a set of points of any dimension (e.g. feature
+       vectors or flattened patches) by the Manhattan (L1) or Euclidean (L2) distance, using only the triangle
+       inequality to prune, so it also works well for high dimensional points.
+
+       Each node is a vantage point that splits the points below it into the half that is closer to it than the
+       median distance (inside) and the half that is farther (outside). The tree is stored in flat arrays: the points
+       are reordered so that every subtree covers a contiguous range of them, and a node is stored at the position
+       of its vantage point, which is the first position of its range. Build() constructs the subtrees in parallel.
+
+       Points can be added after the tree is built with Insert(). They are kept in a list that every query scans
+       linearly, and the tree is rebuilt from all of the points when the list becomes longer than
+       GetNumberOfPoints() / RebuildDivisor.
+
+       Queries do not modify the tree, so they are safe to perform from multiple threads (but not during Insert()).
+*/
+class VantagePointTree
+{
+public:
+
+  /** The distance between two points. */
+  enum MetricEnum {MANHATTAN, EUCLIDEAN};
+
+  /** A neighbor: its distance to the query and its id (its position in the points given to Build(), or the
+    * value returned by Insert()). */
+  typedef std::pair<float, unsigned int> NeighborType;
+
+  VantagePointTree(const MetricEnum metric = EUCLIDEAN);
+
+  /** Build the tree of 'numberOfPoints' points of 'dimension' values each, stored one after another in 'points'.
+    * Points that were inserted before are discarded. */
+  void Build(const std::vector<float>& points, const unsigned int dimension);
+
+  /** Add a point (which has GetDimension() values) and return its id. */
+  unsigned int Insert(const float* const point);
+
+  /** Get the number of points, including the ones that were inserted. */
+  unsigned int GetNumberOfPoints() const;
+
+  /** Get the number of inserted points that are not in the tree yet. */
+  unsigned int GetNumberOfPendingPoints() const;
+
+  unsigned int GetDimension() const;
+
+  MetricEnum GetMetric() const;
+
+  /** Find the (at most) 'k' nearest points to 'query' (which has GetDimension() values), in order of increasing
+    * distance. If 'validComponents' is given, the distance is computed only over these components of the points
+    * (e.g. the valid pixels of a target patch). Since the tree was built with the full distance, only half of the
+    * triangle inequality prunes such a search, so it is slower, but still exact. */
+  void FindNearest(const float* const query, const unsigned int k, std::vector<NeighborType>& neighbors,
+                   const std::vector<unsigned int>* const validComponents = nullptr) const;
+
+  /** Find the (at most) 'k' nearest points to each of the queries, which are stored one after another in
+    * 'queries'. The queries are performed in parallel. */
+  void FindNearest(const std::vector<float>& queries, const unsigned int k,
+                   std::vector<std::vector<NeighborType> >& neighbors) const;
+
+  /** The tree is rebuilt when more than GetNumberOfPoints() / RebuildDivisor points are pending. */
+  static const unsigned int RebuildDivisor = 8;
+
+private:
+
+  struct Node
+  {
+    /** The first position of the outside subtree. The inside subtree starts right after the vantage point. */
+    unsigned int Split;
+
+    /** The largest distance from the vantage point to a point of the inside subtree, and the smallest distance
+      * to a point of the outside subtree. */
+    float InsideRadius;
+    float OutsideRadius;
+  };
+
+  /** The distance of a point to the vantage point of its range, and the id of the point, in Build(). */
+  typedef std::pair<float, unsigned int> BuildItemType;
+
+  void BuildRange(const unsigned int begin, const unsigned int end, const std::vector<float>& points,
+                  std::vector<BuildItemType>& items);
+
+  void SearchRange(const unsigned int begin, const unsigned int end, const float* const query,
+                   const unsigned int k, const std::vector<unsigned int>* const validComponents,
+                   std::vector<NeighborType>& heap) const;
+
+  float Distance(const float* const a, const float* const b,
+                 const std::vector<unsigned int>* const validComponents) const;
+
+  void AddCandidate(const float distance, const unsigned int id, const unsigned int k,
+                    std::vector<NeighborType>& heap) const;
+
+  /** Ranges with at most this many points are scanned linearly. */
+  static const unsigned int LeafSize = 16;
+
+  /** Subtrees with more points than this are constructed in a separate task. */
+  static const unsigned int ParallelBuildSize = 2048;
+
+  MetricEnum Metric;
+
+  unsigned int Dimension = 0;
+
+  /** The points in tree order, and the id of each of them. */
+  std::vector<float> Points;
+  std::vector<unsigned int> Ids;
+
+  /** The node whose vantage point is at each position (only the first position of a range that is not a leaf is
+    * used). */
+  std::vector<Node> Nodes;
+
+  /** The points that were inserted after the tree was built, and their ids. */
+  std::vector<float> PendingPoints;
+  std::vector<unsigned int> PendingIds;
+};
+
+#endif
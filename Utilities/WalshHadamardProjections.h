@@ -0,0 +1,113 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef WalshHadamardProjections_H
+#define WalshHadamardProjections_H
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <utility>
+#include <vector>
+
+/**
+\class WalshHadamardProjections
+\brief This class holds the projections of every square window of an image onto the first few 2D Walsh-Hadamard
+       kernels (in order of increasing sequency), for every power of two window size from 2 up to a maximum.
+
+       The kernels of size 2^m are the leaves of a binary tree whose node [v, v] or [v, -v] is built from its parent
+       v of half the length, so the projection of a node at every position is its parent's projection at that
+       position plus or minus its parent's projection half a kernel further. Every kernel therefore costs one
+       addition per position and channel (per dimension), regardless of the window size, and nodes shared by
+       several kernels are only computed once.
+
+       Because the kernels are orthogonal and have a squared norm of size^2, the squared difference of two windows
+       is at least the sum of the squared differences of their projections divided by size^2.
+
+       Like SummedAreaTable, the projections are a snapshot of the image when Compute() was called.
+*/
+template <typename TImage>
+class WalshHadamardProjections
+{
+public:
+
+  WalshHadamardProjections();
+
+  WalshHadamardProjections(const TImage* const image, const unsigned int maximumWindowSize,
+                           const unsigned int maximumNumberOfKernels);
+
+  /** (Re)compute the projections of the largest possible region of 'image' for the window sizes 2, 4, ...,
+    * up to 'maximumWindowSize', onto (at most) 'maximumNumberOfKernels' kernels each. */
+  void Compute(const TImage* const image, const unsigned int maximumWindowSize,
+               const unsigned int maximumNumberOfKernels);
+
+  /** The window sizes are 2^(sizeId + 1). */
+  unsigned int GetNumberOfWindowSizes() const;
+
+  unsigned int GetWindowSize(const unsigned int sizeId) const;
+
+  unsigned int GetNumberOfKernels(const unsigned int sizeId) const;
+
+  unsigned int GetNumberOfComponents() const;
+
+  /** Get the projections (kernel major, then channel) of the window with top left corner 'windowCorner',
+    * which must be entirely inside the image. */
+  const float* GetProjections(const unsigned int sizeId, const itk::Index<2>& windowCorner) const;
+
+  /** Compute the projections of a single window of 'image' (e.g. a target window, whose pixels may have
+    * changed since Compute()) into 'projections', which must have GetNumberOfKernels() * GetNumberOfComponents()
+    * elements. */
+  void ProjectWindow(const unsigned int sizeId, const TImage* const image, const itk::Index<2>& windowCorner,
+                     float* const projections) const;
+
+  const itk::ImageRegion<2>& GetRegion() const;
+
+private:
+
+  /** The 1D kernels of one window size in order of increasing sequency (the signs that build each of them
+    * from [1], and their values), the pairs of 1D kernels (x, y) of the 2D kernels, and the projections. */
+  struct WindowSizeProjections
+  {
+    std::vector<std::vector<int> > Signs;
+    std::vector<std::vector<float> > Kernels;
+    std::vector<std::pair<unsigned int, unsigned int> > KernelPairs;
+    std::vector<float> Projections;
+  };
+
+  void ComputeWindowSize(const std::vector<float>& image, const unsigned int numberOfLevels,
+                         const unsigned int maximumNumberOfKernels, WindowSizeProjections& windowSizeProjections);
+
+  /** Project 'plane' along 'dimension' onto the 1D kernels 'kernelIds' (which all start with the signs of the
+    * current node, at 'level'), calling 'output' with each projection. */
+  template <typename TOutput>
+  void ProjectTree(const std::vector<float>& plane, const unsigned int dimension, const unsigned int level,
+                   const std::vector<std::vector<int> >& signs, const std::vector<unsigned int>& kernelIds,
+                   TOutput output) const;
+
+  itk::ImageRegion<2> Region;
+
+  unsigned int NumberOfComponents = 0;
+
+  std::vector<WindowSizeProjections> WindowSizes;
+};
+
+#include "WalshHadamardProjections.hpp"
+
+#endif
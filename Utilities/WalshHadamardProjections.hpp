@@ -0,0 +1,325 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef WalshHadamardProjections_HPP
+#define WalshHadamardProjections_HPP
+
+#include "WalshHadamardProjections.h" // Make syntax parser happy
+
+// Submodules
+#include <Helpers/Helpers.h>
+#include <ITKHelpers/ITKContainerInterface.h>
+
+// ITK
+#include "itkImageRegionConstIterator.h"
+
+// STL
+#include <algorithm>
+#include <map>
+
+template <typename TImage>
+WalshHadamardProjections<TImage>::WalshHadamardProjections()
+{
+
+}
+
+template <typename TImage>
+WalshHadamardProjections<TImage>::WalshHadamardProjections(const TImage* const image,
+                                                           const unsigned int maximumWindowSize,
+                                                           const unsigned int maximumNumberOfKernels)
+{
+  Compute(image, maximumWindowSize, maximumNumberOfKernels);
+}
+
+template <typename TImage>
+void WalshHadamardProjections<TImage>::Compute(const TImage* const image, const unsigned int maximumWindowSize,
+                                               const unsigned int maximumNumberOfKernels)
+{
+  this->Region = image->GetLargestPossibleRegion();
+  this->NumberOfComponents = image->GetNumberOfComponentsPerPixel();
+
+  std::vector<float> plane(this->Region.GetNumberOfPixels() * this->NumberOfComponents);
+  std::vector<float>::iterator planeIterator = plane.begin();
+  itk::ImageRegionConstIterator<TImage> imageIterator(image, this->Region);
+  while(!imageIterator.IsAtEnd())
+  {
+    typename TImage::PixelType pixel = imageIterator.Get();
+    for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+    {
+      *planeIterator = Helpers::index(pixel, component);
+      ++planeIterator;
+    }
+    ++imageIterator;
+  }
+
+  this->WindowSizes.clear();
+  for(unsigned int numberOfLevels = 1; (1u << numberOfLevels) <= maximumWindowSize; ++numberOfLevels)
+  {
+    this->WindowSizes.push_back(WindowSizeProjections());
+    ComputeWindowSize(plane, numberOfLevels, maximumNumberOfKernels, this->WindowSizes.back());
+  }
+}
+
+template <typename TImage>
+void WalshHadamardProjections<TImage>::ComputeWindowSize(const std::vector<float>& image,
+                                                         const unsigned int numberOfLevels,
+                                                         const unsigned int maximumNumberOfKernels,
+                                                         WindowSizeProjections& windowSizeProjections)
+{
+  const unsigned int windowSize = 1u << numberOfLevels;
+
+  // Build every 1D kernel from [1] and sort them by their number of sign changes
+  std::vector<std::pair<unsigned int, unsigned int> > sequencies;
+  std::vector<std::vector<int> > signs(windowSize, std::vector<int>(numberOfLevels));
+  std::vector<std::vector<float> > kernels(windowSize);
+  for(unsigned int code = 0; code < windowSize; ++code)
+  {
+    kernels[code].assign(1, 1.0f);
+    for(unsigned int level = 0; level < numberOfLevels; ++level)
+    {
+      signs[code][level] = ((code >> level) & 1) ? -1 : 1;
+      const std::size_t parentLength = kernels[code].size();
+      for(std::size_t position = 0; position < parentLength; ++position)
+      {
+        kernels[code].push_back(signs[code][level] * kernels[code][position]);
+      }
+    }
+
+    unsigned int sequency = 0;
+    for(unsigned int position = 1; position < windowSize; ++position)
+    {
+      if(kernels[code][position] != kernels[code][position - 1])
+      {
+        sequency++;
+      }
+    }
+    sequencies.push_back(std::make_pair(sequency, code));
+  }
+  std::sort(sequencies.begin(), sequencies.end());
+
+  windowSizeProjections.Signs.clear();
+  windowSizeProjections.Kernels.clear();
+  for(const std::pair<unsigned int, unsigned int>& sequency : sequencies)
+  {
+    windowSizeProjections.Signs.push_back(signs[sequency.second]);
+    windowSizeProjections.Kernels.push_back(kernels[sequency.second]);
+  }
+
+  // The 2D kernels with the lowest sequencies (the "zig-zag" order), which carry most of the energy of natural images
+  std::vector<std::pair<unsigned int, unsigned int> > kernelPairs;
+  for(unsigned int y = 0; y < windowSize; ++y)
+  {
+    for(unsigned int x = 0; x < windowSize; ++x)
+    {
+      kernelPairs.push_back(std::make_pair(x, y));
+    }
+  }
+  std::stable_sort(kernelPairs.begin(), kernelPairs.end(),
+                   [](const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b)
+  {
+    return a.first + a.second < b.first + b.second;
+  });
+  kernelPairs.resize(std::min<std::size_t>(kernelPairs.size(), std::max(maximumNumberOfKernels, 1u)));
+  windowSizeProjections.KernelPairs = kernelPairs;
+
+  // Project along x onto the 1D kernels that are needed, then each of those along y
+  std::map<unsigned int, std::vector<unsigned int> > yKernelIds;
+  for(const std::pair<unsigned int, unsigned int>& kernelPair : kernelPairs)
+  {
+    yKernelIds[kernelPair.first].push_back(kernelPair.second);
+  }
+
+  std::vector<unsigned int> xKernelIds;
+  for(const std::pair<const unsigned int, std::vector<unsigned int> >& xKernel : yKernelIds)
+  {
+    xKernelIds.push_back(xKernel.first);
+  }
+
+  const std::size_t numberOfKernels = kernelPairs.size();
+  const std::size_t numberOfPositions = this->Region.GetNumberOfPixels();
+  windowSizeProjections.Projections.assign(numberOfPositions * numberOfKernels * this->NumberOfComponents, 0.0f);
+
+  std::map<unsigned int, std::vector<float> > xProjections;
+  ProjectTree(image, 0, 0, windowSizeProjections.Signs, xKernelIds,
+              [&xProjections](const unsigned int kernelId, const std::vector<float>& projection)
+  {
+    xProjections[kernelId] = projection;
+  });
+
+  for(const unsigned int xKernelId : xKernelIds)
+  {
+    const unsigned int numberOfComponents = this->NumberOfComponents;
+    ProjectTree(xProjections[xKernelId], 1, 0, windowSizeProjections.Signs, yKernelIds[xKernelId],
+                [&](const unsigned int yKernelId, const std::vector<float>& projection)
+    {
+      const std::size_t kernelId = std::find(kernelPairs.begin(), kernelPairs.end(),
+                                             std::make_pair(xKernelId, yKernelId)) - kernelPairs.begin();
+      for(std::size_t position = 0; position < numberOfPositions; ++position)
+      {
+        std::copy(&projection[position * numberOfComponents], &projection[(position + 1) * numberOfComponents],
+                  &windowSizeProjections.Projections[(position * numberOfKernels + kernelId) * numberOfComponents]);
+      }
+    });
+
+    xProjections.erase(xKernelId);
+  }
+}
+
+template <typename TImage>
+template <typename TOutput>
+void WalshHadamardProjections<TImage>::ProjectTree(const std::vector<float>& plane, const unsigned int dimension,
+                                                   const unsigned int level,
+                                                   const std::vector<std::vector<int> >& signs,
+                                                   const std::vector<unsigned int>& kernelIds,
+                                                   TOutput output) const
+{
+  if(level == signs[kernelIds[0]].size())
+  {
+    for(const unsigned int kernelId : kernelIds)
+    {
+      output(kernelId, plane);
+    }
+    return;
+  }
+
+  const std::size_t width = this->Region.GetSize()[0];
+  const std::size_t height = this->Region.GetSize()[1];
+  const std::size_t step = static_cast<std::size_t>(1) << level;
+  const std::size_t stepOffset = step * (dimension == 0 ? 1 : width) * this->NumberOfComponents;
+  const std::size_t rowLength = width * this->NumberOfComponents;
+
+  for(int sign = 1; sign >= -1; sign -= 2)
+  {
+    std::vector<unsigned int> childKernelIds;
+    for(const unsigned int kernelId : kernelIds)
+    {
+      if(signs[kernelId][level] == sign)
+      {
+        childKernelIds.push_back(kernelId);
+      }
+    }
+
+    if(childKernelIds.empty())
+    {
+      continue;
+    }
+
+    // A window that would extend past the image is never used, so its projection is left at 0
+    std::vector<float> child(plane.size(), 0.0f);
+    const std::size_t lastX = dimension == 0 ? (width > step ? width - step : 0) : width;
+    const std::size_t lastY = dimension == 1 ? (height > step ? height - step : 0) : height;
+
+    #pragma omp parallel for
+    for(std::size_t y = 0; y < lastY; ++y)
+    {
+      for(std::size_t position = y * rowLength; position < y * rowLength + lastX * this->NumberOfComponents;
+          ++position)
+      {
+        child[position] = plane[position] + sign * plane[position + stepOffset];
+      }
+    }
+
+    ProjectTree(child, dimension, level + 1, signs, childKernelIds, output);
+  }
+}
+
+template <typename TImage>
+unsigned int WalshHadamardProjections<TImage>::GetNumberOfWindowSizes() const
+{
+  return static_cast<unsigned int>(this->WindowSizes.size());
+}
+
+template <typename TImage>
+unsigned int WalshHadamardProjections<TImage>::GetWindowSize(const unsigned int sizeId) const
+{
+  return 2u << sizeId;
+}
+
+template <typename TImage>
+unsigned int WalshHadamardProjections<TImage>::GetNumberOfKernels(const unsigned int sizeId) const
+{
+  return static_cast<unsigned int>(this->WindowSizes[sizeId].KernelPairs.size());
+}
+
+template <typename TImage>
+unsigned int WalshHadamardProjections<TImage>::GetNumberOfComponents() const
+{
+  return this->NumberOfComponents;
+}
+
+template <typename TImage>
+const float* WalshHadamardProjections<TImage>::GetProjections(const unsigned int sizeId,
+                                                              const itk::Index<2>& windowCorner) const
+{
+  const std::size_t position =
+      static_cast<std::size_t>(windowCorner[1] - this->Region.GetIndex()[1]) * this->Region.GetSize()[0] +
+      static_cast<std::size_t>(windowCorner[0] - this->Region.GetIndex()[0]);
+  return &this->WindowSizes[sizeId].Projections[position * GetNumberOfKernels(sizeId) * this->NumberOfComponents];
+}
+
+template <typename TImage>
+void WalshHadamardProjections<TImage>::ProjectWindow(const unsigned int sizeId, const TImage* const image,
+                                                     const itk::Index<2>& windowCorner,
+                                                     float* const projections) const
+{
+  const WindowSizeProjections& windowSizeProjections = this->WindowSizes[sizeId];
+  const unsigned int windowSize = GetWindowSize(sizeId);
+
+  std::vector<float> window(windowSize * windowSize * this->NumberOfComponents);
+  for(unsigned int y = 0; y < windowSize; ++y)
+  {
+    for(unsigned int x = 0; x < windowSize; ++x)
+    {
+      itk::Index<2> pixelIndex = {{windowCorner[0] + static_cast<itk::IndexValueType>(x),
+                                   windowCorner[1] + static_cast<itk::IndexValueType>(y)}};
+      typename TImage::PixelType pixel = image->GetPixel(pixelIndex);
+      for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+      {
+        window[(y * windowSize + x) * this->NumberOfComponents + component] = Helpers::index(pixel, component);
+      }
+    }
+  }
+
+  for(std::size_t kernelId = 0; kernelId < windowSizeProjections.KernelPairs.size(); ++kernelId)
+  {
+    const std::pair<unsigned int, unsigned int>& kernelPair = windowSizeProjections.KernelPairs[kernelId];
+    const std::vector<float>& xKernel = windowSizeProjections.Kernels[kernelPair.first];
+    const std::vector<float>& yKernel = windowSizeProjections.Kernels[kernelPair.second];
+    for(unsigned int component = 0; component < this->NumberOfComponents; ++component)
+    {
+      float projection = 0.0f;
+      for(unsigned int y = 0; y < windowSize; ++y)
+      {
+        for(unsigned int x = 0; x < windowSize; ++x)
+        {
+          projection += xKernel[x] * yKernel[y] * window[(y * windowSize + x) * this->NumberOfComponents + component];
+        }
+      }
+      projections[kernelId * this->NumberOfComponents + component] = projection;
+    }
+  }
+}
+
+template <typename TImage>
+const itk::ImageRegion<2>& WalshHadamardProjections<TImage>::GetRegion() const
+{
+  return this->Region;
+}
+
+#endif
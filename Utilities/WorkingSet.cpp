@@ -0,0 +1,90 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "WorkingSet.h"
+
+// ITK
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+// STL
+#include <algorithm>
+
+namespace WorkingSet
+{
+
+itk::ImageRegion<2> GetHoleBoundingBox(const Mask* const mask)
+{
+  const itk::ImageRegion<2>& fullRegion = mask->GetLargestPossibleRegion();
+
+  itk::Index<2> minCorner = {{fullRegion.GetUpperIndex()[0], fullRegion.GetUpperIndex()[1]}};
+  itk::Index<2> maxCorner = {{fullRegion.GetIndex()[0] - 1, fullRegion.GetIndex()[1] - 1}};
+
+  itk::ImageRegionConstIteratorWithIndex<Mask> maskIterator(mask, fullRegion);
+  while(!maskIterator.IsAtEnd())
+  {
+    if(mask->IsHole(maskIterator.GetIndex()))
+    {
+      for(unsigned int dimension = 0; dimension < 2; ++dimension)
+      {
+        minCorner[dimension] = std::min(minCorner[dimension], maskIterator.GetIndex()[dimension]);
+        maxCorner[dimension] = std::max(maxCorner[dimension], maskIterator.GetIndex()[dimension]);
+      }
+    }
+    ++maskIterator;
+  }
+
+  if(maxCorner[0] < minCorner[0])
+  {
+    itk::Size<2> emptySize = {{0, 0}};
+    return itk::ImageRegion<2>(fullRegion.GetIndex(), emptySize);
+  }
+
+  itk::Size<2> size = {{static_cast<itk::SizeValueType>(maxCorner[0] - minCorner[0] + 1),
+                        static_cast<itk::SizeValueType>(maxCorner[1] - minCorner[1] + 1)}};
+  return itk::ImageRegion<2>(minCorner, size);
+}
+
+itk::ImageRegion<2> GetWorkingRegion(const Mask* const mask, const unsigned int patchHalfWidth,
+                                     const unsigned int searchRadius)
+{
+  const itk::ImageRegion<2>& fullRegion = mask->GetLargestPossibleRegion();
+
+  itk::ImageRegion<2> holeBoundingBox = GetHoleBoundingBox(mask);
+  if(searchRadius == FullImageSearch || holeBoundingBox.GetNumberOfPixels() == 0)
+  {
+    return fullRegion;
+  }
+
+  // Clamp the margin so that it can not overflow the region arithmetic
+  unsigned int imageDiagonal = fullRegion.GetSize()[0] + fullRegion.GetSize()[1];
+  unsigned int margin = std::min(imageDiagonal, patchHalfWidth) + std::min(imageDiagonal, searchRadius);
+
+  // The target nodes are on the boundary, which is one pixel outside of the hole bounding box
+  holeBoundingBox.PadByRadius(margin + 1);
+  holeBoundingBox.Crop(fullRegion);
+  return holeBoundingBox;
+}
+
+void ExtractMask(const Mask* const mask, const itk::ImageRegion<2>& region, Mask* const croppedMask)
+{
+  ExtractRegion(mask, region, croppedMask);
+  croppedMask->SetHoleValue(mask->GetHoleValue());
+  croppedMask->SetValidValue(mask->GetValidValue());
+}
+
+} // end namespace
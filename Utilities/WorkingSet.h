@@ -0,0 +1,73 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef WorkingSet_H
+#define WorkingSet_H
+
+// Submodules
+#include <Mask/Mask.h>
+
+// ITK
+#include "itkImageRegion.h"
+
+// STL
+#include <limits>
+
+/** Functions to inpaint only the part of an image that the fill can touch (the "working set"): the bounding box
+  * of the hole, dilated by the patch radius plus the search radius plus one. The image and mask are cropped to this
+  * region (the crop starts at (0,0), as the grid graph and the descriptor maps require), so every per-image structure
+  * (priority images, descriptor map, blurred images, the graph, ...) is sized to the crop rather than to the full
+  * image. The result is then pasted back.
+  */
+namespace WorkingSet
+{
+
+/** Pass this as the search radius if source patches may come from anywhere in the image. */
+const unsigned int FullImageSearch = std::numeric_limits<unsigned int>::max();
+
+////////////// Functions //////////////
+
+/** Get the bounding box of the hole pixels of 'mask'. The region has size 0 if there are no hole pixels. */
+itk::ImageRegion<2> GetHoleBoundingBox(const Mask* const mask);
+
+/** Get the region that must be kept to inpaint 'mask' with patches of half width 'patchHalfWidth' whose sources are
+  * within 'searchRadius' of their targets: every target patch is centered on a boundary pixel, which is at most one
+  * pixel outside of the hole bounding box, and every source patch is centered within 'searchRadius' of a target
+  * center, so the bounding box is dilated by patchHalfWidth + searchRadius + 1. If 'searchRadius' is FullImageSearch, or there is no
+  * hole, the full region is returned. */
+itk::ImageRegion<2> GetWorkingRegion(const Mask* const mask, const unsigned int patchHalfWidth,
+                                     const unsigned int searchRadius);
+
+/** Copy 'region' of 'mask' into 'croppedMask', whose region will start at (0,0). */
+void ExtractMask(const Mask* const mask, const itk::ImageRegion<2>& region, Mask* const croppedMask);
+
+////////////// Function templates //////////////
+
+/** Copy 'region' of 'image' into 'croppedImage', whose region will start at (0,0). */
+template <typename TImage>
+void ExtractRegion(const TImage* const image, const itk::ImageRegion<2>& region, TImage* const croppedImage);
+
+/** Copy all of 'croppedImage' (whose region starts at (0,0)) back into 'region' of 'image'. */
+template <typename TImage>
+void PasteRegion(const TImage* const croppedImage, const itk::ImageRegion<2>& region, TImage* const image);
+
+} // end namespace
+
+#include "WorkingSet.hpp"
+
+#endif
@@ -0,0 +1,85 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef WorkingSet_HPP
+#define WorkingSet_HPP
+
+#include "WorkingSet.h" // Make syntax parser happy
+
+// ITK
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+// STL
+#include <sstream>
+#include <stdexcept>
+
+namespace WorkingSet
+{
+
+template <typename TImage>
+void ExtractRegion(const TImage* const image, const itk::ImageRegion<2>& region, TImage* const croppedImage)
+{
+  if(!image->GetLargestPossibleRegion().IsInside(region))
+  {
+    std::stringstream ss;
+    ss << "WorkingSet::ExtractRegion: " << region << " is not inside the image!";
+    throw std::runtime_error(ss.str());
+  }
+
+  itk::Index<2> corner = {{0, 0}};
+  itk::ImageRegion<2> croppedRegion(corner, region.GetSize());
+
+  croppedImage->SetRegions(croppedRegion);
+  croppedImage->SetNumberOfComponentsPerPixel(image->GetNumberOfComponentsPerPixel()); // For VectorImage
+  croppedImage->Allocate();
+
+  itk::ImageRegionConstIterator<TImage> imageIterator(image, region);
+  itk::ImageRegionIterator<TImage> croppedIterator(croppedImage, croppedRegion);
+  while(!imageIterator.IsAtEnd())
+  {
+    croppedIterator.Set(imageIterator.Get());
+    ++imageIterator;
+    ++croppedIterator;
+  }
+}
+
+template <typename TImage>
+void PasteRegion(const TImage* const croppedImage, const itk::ImageRegion<2>& region, TImage* const image)
+{
+  if(croppedImage->GetLargestPossibleRegion().GetSize() != region.GetSize())
+  {
+    std::stringstream ss;
+    ss << "WorkingSet::PasteRegion: the cropped image is " << croppedImage->GetLargestPossibleRegion().GetSize()
+       << " but the region is " << region.GetSize() << "!";
+    throw std::runtime_error(ss.str());
+  }
+
+  itk::ImageRegionConstIterator<TImage> croppedIterator(croppedImage, croppedImage->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<TImage> imageIterator(image, region);
+  while(!croppedIterator.IsAtEnd())
+  {
+    imageIterator.Set(croppedIterator.Get());
+    ++croppedIterator;
+    ++imageIterator;
+  }
+}
+
+} // end namespace
+
+#endif
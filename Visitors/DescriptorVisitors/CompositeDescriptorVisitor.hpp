@@ -23,6 +23,9 @@
 
 #include <boost/graph/graph_traits.hpp>
 
+#include <memory>
+#include <vector>
+
 /**
  * This is a composite visitor type that models the DescriptorVisitorConcept and forwards
  * all calls to all of its internal visitors.
@@ -42,6 +45,16 @@ struct CompositeDescriptorVisitor
     }
   }
 
+  /** Each visitor initializes all of the vertices before the next visitor is called, so that e.g. an
+    * IndexUpdateDescriptorVisitor sees the descriptors created by the visitors before it. */
+  void InitializeVertices(const std::vector<VertexDescriptorType>& vertices) const
+  {
+    for(unsigned int visitorId = 0; visitorId < Visitors.size(); ++visitorId)
+    {
+      this->Visitors[visitorId]->InitializeVertices(vertices);
+    }
+  }
+
   void DiscoverVertex(VertexDescriptorType v)
   { 
     for(unsigned int visitorId = 0; visitorId < Visitors.size(); ++visitorId)
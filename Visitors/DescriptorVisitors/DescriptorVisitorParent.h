@@ -22,6 +22,9 @@
 // Boost
 #include <boost/graph/graph_traits.hpp>
 
+// STL
+#include <vector>
+
 /**
  * This is an abstract visitor that complies with the DescriptorVisitorConcept. It is available
  * so that we can store a container of DescriptorVisitors via their parent class pointer (e.g.
@@ -33,6 +36,18 @@ struct DescriptorVisitorParent
   typedef typename boost::graph_traits<TGraph>::vertex_descriptor VertexDescriptorType;
 
   virtual void InitializeVertex(VertexDescriptorType v) const = 0;
+
+  /** Initialize all of 'vertices' (e.g. the patches that became valid when a target patch was filled, see
+    * InpaintingVisitor::SetAllowNewPatches()). Visitors that can initialize vertices independently, or that
+    * benefit from seeing all of them at once, should override this. */
+  virtual void InitializeVertices(const std::vector<VertexDescriptorType>& vertices) const
+  {
+    for(typename std::vector<VertexDescriptorType>::const_iterator vertexIterator = vertices.begin();
+        vertexIterator != vertices.end(); ++vertexIterator)
+    {
+      InitializeVertex(*vertexIterator);
+    }
+  }
   
   /** This is not const because we typically have to set some properties of the
     * target patch when it is discovered. */
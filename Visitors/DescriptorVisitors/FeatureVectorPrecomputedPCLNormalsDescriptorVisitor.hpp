@@ -59,7 +59,7 @@ struct FeatureVectorPrecomputedPCLNormalsDescriptorVisitor : public DescriptorVi
     
   }
 
-  void InitializeVertex(VertexDescriptorType v, TGraph& g) const override
+  void InitializeVertex(VertexDescriptorType v) const override
   {
     //std::cout << "Initializing " << v[0] << " " << v[1] << std::endl;
     pcl::Normal n = this->Normals(v[0], v[1]);
@@ -69,7 +69,7 @@ struct FeatureVectorPrecomputedPCLNormalsDescriptorVisitor : public DescriptorVi
       std::vector<float> featureVector(n.normal, n.normal + sizeof(n.normal) / sizeof(float) );
       // std::cout << "Normal has length: " << featureVector.size() << std::endl; // To test if the above worked correctly
       assert(featureVector.size() == 3);
-      std::cout << "initialize_vertex: featureVector: " << featureVector << std::endl;
+      //std::cout << "InitializeVertex: featureVector: " << featureVector << std::endl;
       DescriptorType descriptor(featureVector);
       descriptor.SetVertex(v);
       descriptor.SetStatus(PixelDescriptor::SOURCE_NODE);
@@ -77,7 +77,7 @@ struct FeatureVectorPrecomputedPCLNormalsDescriptorVisitor : public DescriptorVi
     }
     else
     {
-      std::cout << "Not finite! " << n.normal_x << " " << n.normal_y << " " << n.normal_z << std::endl;
+      //std::cout << "Not finite! " << n.normal_x << " " << n.normal_y << " " << n.normal_z << std::endl;
 
       std::vector<float> featureVector(3, 0);
 
@@ -90,9 +90,9 @@ struct FeatureVectorPrecomputedPCLNormalsDescriptorVisitor : public DescriptorVi
     //std::cout << "There were " << numberOfMissingPoints << " missing points when computing the descriptor for node " << index << std::endl;
   }
 
-  void DiscoverVertex(VertexDescriptorType v, TGraph& g) const override
+  void DiscoverVertex(VertexDescriptorType v) override
   {
-    std::cout << "Discovered " << v[0] << " " << v[1] << std::endl;
+    //std::cout << "Discovered " << v[0] << " " << v[1] << std::endl;
     DescriptorType& descriptor = get(this->DescriptorMap, v);
     descriptor.SetStatus(DescriptorType::TARGET_NODE);
   }
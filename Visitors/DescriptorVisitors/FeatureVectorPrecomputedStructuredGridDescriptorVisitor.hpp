@@ -72,12 +72,12 @@ struct FeatureVectorPrecomputedStructuredGridDescriptorVisitor : public Descript
     std::cout << "Feature " << featureName << " has " << FeatureArray->GetNumberOfComponents() << " components." << std::endl;
   }
 
-  void InitializeVertex(VertexDescriptorType v, TGraph& g) const override
+  void InitializeVertex(VertexDescriptorType v) const override
   {
     //std::cout << "Initializing " << v[0] << " " << v[1] << std::endl;
     unsigned int numberOfMissingPoints = 0;
 
-    int queryPoint[3] = {v[0], v[1], 0};
+    int queryPoint[3] = {static_cast<int>(v[0]), static_cast<int>(v[1]), 0};
     int dimensions[3];
     this->FeatureStructuredGrid->GetDimensions(dimensions);
     vtkIdType pointId = vtkStructuredData::ComputePointId(dimensions, queryPoint);
@@ -109,7 +109,7 @@ struct FeatureVectorPrecomputedStructuredGridDescriptorVisitor : public Descript
     //std::cout << "There were " << numberOfMissingPoints << " missing points when computing the descriptor for node " << index << std::endl;
   }
 
-  void DiscoverVertex(VertexDescriptorType v, TGraph& g) const override
+  void DiscoverVertex(VertexDescriptorType v) override
   {
     // std::cout << "Discovered " << v[0] << " " << v[1] << std::endl;
     DescriptorType& descriptor = get(this->DescriptorMap, v);
@@ -35,6 +35,7 @@
 
 // STL
 #include <memory>
+#include <vector>
 
 /**
  * This is a visitor that complies with the InpaintingVisitorConcept. It creates
@@ -83,6 +84,18 @@ struct ImagePatchDescriptorVisitor : public DescriptorVisitorParent<TGraph>
 //       }
   }
 
+  /** The descriptors are independent, so they are created in parallel. (The descriptor map must already have
+    * an element for every vertex, so that put() does not resize it.) */
+  void InitializeVertices(const std::vector<VertexDescriptorType>& vertices) const override
+  {
+    const int numberOfVertices = static_cast<int>(vertices.size());
+    #pragma omp parallel for
+    for(int vertexId = 0; vertexId < numberOfVertices; ++vertexId)
+    {
+      InitializeVertex(vertices[vertexId]);
+    }
+  }
+
   void DiscoverVertex(VertexDescriptorType v) override
   {
     itk::ImageRegion<2> region = get(*(this->DescriptorMap), v).GetRegion();
@@ -0,0 +1,63 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef IndexUpdateDescriptorVisitor_HPP
+#define IndexUpdateDescriptorVisitor_HPP
+
+// Custom
+#include "DescriptorVisitorParent.h"
+
+// Boost
+#include <boost/graph/graph_traits.hpp>
+
+/**
+ * This is a visitor that complies with the DescriptorVisitorConcept. It does not create descriptors, but adds
+ * every initialized vertex to a search index (e.g. LocalitySensitiveHashKNN or VantagePointTreeKNN) with
+ * AddSources(), which ignores the vertices whose descriptors are not source descriptors. It must be added to a
+ * CompositeDescriptorVisitor after the visitor that creates the descriptors that the index uses.
+ */
+template <typename TGraph, typename TIndex>
+struct IndexUpdateDescriptorVisitor : public DescriptorVisitorParent<TGraph>
+{
+  typedef typename boost::graph_traits<TGraph>::vertex_descriptor VertexDescriptorType;
+
+  TIndex* Index;
+
+  IndexUpdateDescriptorVisitor(TIndex* const index) : Index(index)
+  {
+  }
+
+  void InitializeVertex(VertexDescriptorType v) const override
+  {
+    this->Index->AddSources(&v, &v + 1);
+  }
+
+  /** Add all of the vertices to the index at once. */
+  void InitializeVertices(const std::vector<VertexDescriptorType>& vertices) const override
+  {
+    this->Index->AddSources(vertices.begin(), vertices.end());
+  }
+
+  void DiscoverVertex(VertexDescriptorType) override
+  {
+  }
+
+}; // IndexUpdateDescriptorVisitor
+
+#endif
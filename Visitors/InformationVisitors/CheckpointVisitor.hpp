@@ -0,0 +1,99 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef CheckpointVisitor_HPP
+#define CheckpointVisitor_HPP
+
+// Custom
+#include "Visitors/InpaintingVisitors/InpaintingVisitorParent.h"
+#include "Utilities/Checkpoint.h"
+
+// STL
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+/**
+  * This visitor saves a checkpoint every 'iterationInterval' iterations or every 'secondsInterval' seconds
+  * (whichever comes first; 0 disables either trigger). The snapshot is taken by 'saveState' at the end of
+  * FinishVertex() (so this visitor must be the last one to finish a vertex), and is written on a background
+  * thread by a CheckpointWriter. When the inpainting is complete, the checkpoint file is removed, as it is
+  * no longer needed to resume.
+  */
+template <typename TGraph>
+struct CheckpointVisitor : public InpaintingVisitorParent<TGraph>
+{
+  typedef InpaintingVisitorParent<TGraph> Superclass;
+  typedef typename Superclass::VertexDescriptorType VertexDescriptorType;
+
+  typedef std::function<void(Checkpoint&)> SaveStateFunctionType;
+
+  typedef std::chrono::steady_clock ClockType;
+
+  SaveStateFunctionType SaveState;
+
+  unsigned int IterationInterval;
+
+  double SecondsInterval;
+
+  std::shared_ptr<CheckpointWriter> Writer;
+
+  unsigned int IterationsSinceCheckpoint = 0;
+
+  ClockType::time_point LastCheckpointTime;
+
+  CheckpointVisitor(SaveStateFunctionType saveState, const std::string& fileName,
+                    const unsigned int iterationInterval, const double secondsInterval,
+                    const std::string& visitorName = "CheckpointVisitor") :
+    InpaintingVisitorParent<TGraph>(visitorName),
+    SaveState(saveState), IterationInterval(iterationInterval), SecondsInterval(secondsInterval),
+    Writer(new CheckpointWriter(fileName)), LastCheckpointTime(ClockType::now())
+  {
+
+  }
+
+  void FinishVertex(VertexDescriptorType targetNode, VertexDescriptorType sourceNode) override
+  {
+    this->IterationsSinceCheckpoint++;
+
+    bool iterationsElapsed = this->IterationInterval > 0 && this->IterationsSinceCheckpoint >= this->IterationInterval;
+
+    std::chrono::duration<double> secondsElapsed = ClockType::now() - this->LastCheckpointTime;
+    bool timeElapsed = this->SecondsInterval > 0 && secondsElapsed.count() >= this->SecondsInterval;
+
+    if(iterationsElapsed || timeElapsed)
+    {
+      std::unique_ptr<Checkpoint> checkpoint(new Checkpoint);
+      this->SaveState(*checkpoint);
+      this->Writer->Submit(std::move(checkpoint));
+
+      this->IterationsSinceCheckpoint = 0;
+      this->LastCheckpointTime = ClockType::now();
+    }
+  }
+
+  void InpaintingComplete() const override
+  {
+    this->Writer->Flush();
+    std::remove(this->Writer->GetFileName().c_str());
+  }
+
+};
+
+#endif
@@ -66,6 +66,9 @@ signals:
   void signal_RefreshResult(const itk::ImageRegion<2> sourceRegion,
                             const itk::ImageRegion<2> targetRegion);
 
+  /** Indicate that the inpainting has finished. */
+  void signal_InpaintingComplete() const;
+
 };
 
 /**
@@ -155,6 +158,11 @@ public:
     emit signal_RefreshImage();
   }
 
+  void InpaintingComplete() const override
+  {
+    emit signal_InpaintingComplete();
+  }
+
 };
 
 #endif
@@ -0,0 +1,59 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef FillCallbackVisitor_HPP
+#define FillCallbackVisitor_HPP
+
+// Custom
+#include "Visitors/InpaintingVisitors/InpaintingVisitorParent.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+// STL
+#include <functional>
+
+/** Called with the center of each target patch and the center of the source patch it was filled from. */
+typedef std::function<void(const itk::Index<2>&, const itk::Index<2>&)> InpaintingFillCallback;
+
+/**
+  * This visitor passes every (target, source) pair to a callback as the patches are filled, e.g. to collect
+  * the fill order of a run that is part of a larger fill (see IncrementalInpainting).
+  */
+template <typename TGraph>
+struct FillCallbackVisitor : public InpaintingVisitorParent<TGraph>
+{
+  typedef InpaintingVisitorParent<TGraph> Superclass;
+  typedef typename Superclass::VertexDescriptorType VertexDescriptorType;
+
+  InpaintingFillCallback Callback;
+
+  FillCallbackVisitor(InpaintingFillCallback callback, const std::string& visitorName = "FillCallbackVisitor") :
+    InpaintingVisitorParent<TGraph>(visitorName), Callback(callback)
+  {
+
+  }
+
+  void FinishVertex(VertexDescriptorType targetNode, VertexDescriptorType sourceNode) override
+  {
+    this->Callback(ITKHelpers::CreateIndex(targetNode), ITKHelpers::CreateIndex(sourceNode));
+  }
+
+};
+
+#endif
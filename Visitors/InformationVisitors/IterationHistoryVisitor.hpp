@@ -0,0 +1,80 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef IterationHistoryVisitor_HPP
+#define IterationHistoryVisitor_HPP
+
+// Custom
+#include "Visitors/InpaintingVisitors/InpaintingVisitorParent.h"
+#include "Utilities/PatchDeltaHistory.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+/**
+  * This visitor records every iteration into a PatchDeltaHistory so that any iteration can be
+  * inspected or reconstructed later without storing a copy of the image at every iteration.
+  * It can also be used as the nearest neighbors visitor of TwoStepNearestNeighbor
+  * (FoundNeighbors()) to record the candidate patches of each iteration.
+ */
+template <typename TGraph, typename TImage>
+struct IterationHistoryVisitor : public InpaintingVisitorParent<TGraph>
+{
+  typedef InpaintingVisitorParent<TGraph> Superclass;
+  typedef typename Superclass::VertexDescriptorType VertexDescriptorType;
+
+  /** The history to record into. This is not owned by the visitor. */
+  PatchDeltaHistory<TImage>* History;
+
+  unsigned int PatchHalfWidth;
+
+  IterationHistoryVisitor(PatchDeltaHistory<TImage>* const history, const unsigned int patchHalfWidth,
+                          const std::string& visitorName = "IterationHistoryVisitor") :
+    InpaintingVisitorParent<TGraph>(visitorName),
+    History(history), PatchHalfWidth(patchHalfWidth)
+  {
+
+  }
+
+  template <typename TContainer>
+  void FoundNeighbors(const TContainer& container)
+  {
+    this->History->SetCandidates(container.begin(), container.end());
+  }
+
+  void PotentialMatchMade(VertexDescriptorType targetNode, VertexDescriptorType sourceNode) override
+  {
+    // This is called before the patch is painted, and the iteration is finished by the next call.
+    this->History->BeginIteration(ITKHelpers::CreateIndex(targetNode), ITKHelpers::CreateIndex(sourceNode),
+                                  this->PatchHalfWidth);
+  }
+
+  void FinishVertex(VertexDescriptorType targetNode, VertexDescriptorType sourceNode) override
+  {
+    // The source may have been replaced since PotentialMatchMade() (e.g. by a manual selection).
+    this->History->SetSourcePixel(ITKHelpers::CreateIndex(sourceNode));
+  }
+
+  void InpaintingComplete() const override
+  {
+    this->History->EndIteration();
+  }
+
+};
+
+#endif
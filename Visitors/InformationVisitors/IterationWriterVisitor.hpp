@@ -24,6 +24,7 @@
 
 // Custom
 #include "Visitors/InpaintingVisitors/InpaintingVisitorParent.h"
+#include "Utilities/AsyncImageWriter.h"
 
 // Submodules
 #include <Mask/Mask.h>
@@ -64,12 +65,10 @@ struct IterationWriterVisitor : public InpaintingVisitorParent<TGraph>
 
   void FinishVertex(VertexDescriptorType target, VertexDescriptorType sourceNode) override
   {
-    ITKHelpers::WriteRGBImage(this->MaskImage,
-                              Helpers::GetSequentialFileName(this->Prefix + "_mask",
-                                                             this->NumberOfFinishedVertices, "png"));
-    ITKHelpers::WriteRGBImage(this->Image,
-                              Helpers::GetSequentialFileName(this->Prefix,
-                                                             this->NumberOfFinishedVertices, "png"));
+    AsyncImageWriter::GetInstance().WriteSequentialRGBImage(this->MaskImage, this->Prefix + "_mask",
+                                                            this->NumberOfFinishedVertices, 3, "png");
+    AsyncImageWriter::GetInstance().WriteSequentialRGBImage(this->Image, this->Prefix,
+                                                            this->NumberOfFinishedVertices, 3, "png");
 
   // MHA versions
 //    ITKHelpers::WriteImage(this->MaskImage,
@@ -21,9 +21,11 @@
 
 // STL
 #include <fstream>
+#include <memory>
 
 // Custom
 #include "Visitors/InpaintingVisitors/InpaintingVisitorParent.h"
+#include "Utilities/FillLog.h"
 
 // Can't do this - ambiguous overload errors
 // template <typename T>
@@ -35,6 +37,8 @@
 
 /**
   * This visitor saves the information needed to reproduce the inpainting.
+  * The log is either the text format ("sx sy : tx ty" per line) or the binary fill log
+  * (see FillLog.h), which is much smaller and can be looked up without parsing it.
  */
 template <typename TGraph>
 struct LoggerVisitor : public InpaintingVisitorParent<TGraph>
@@ -43,12 +47,26 @@ struct LoggerVisitor : public InpaintingVisitorParent<TGraph>
 
   std::ofstream OutputStream;
 
+  /** Only used for the binary format. */
+  std::unique_ptr<FillLogWriter> Writer;
+
+  /** Write a text log. */
   LoggerVisitor(const std::string& filename, const std::string& visitorName = "LoggerVisitor") :
   InpaintingVisitorParent<TGraph>(visitorName), OutputStream(filename.c_str())
   {
 
   }
 
+  /** Write a binary fill log. 'inputChecksum' should be computed with FillLog::ComputeInputChecksum()
+    * before the inpainting starts. */
+  LoggerVisitor(const std::string& filename, const itk::ImageRegion<2>& fullRegion, const unsigned int patchHalfWidth,
+                const std::uint64_t inputChecksum, const std::string& visitorName = "LoggerVisitor") :
+  InpaintingVisitorParent<TGraph>(visitorName),
+  Writer(new FillLogWriter(filename, fullRegion, patchHalfWidth, inputChecksum))
+  {
+
+  }
+
   ~LoggerVisitor()
   {
     this->OutputStream.close();
@@ -56,11 +74,29 @@ struct LoggerVisitor : public InpaintingVisitorParent<TGraph>
 
   void FinishVertex(VertexDescriptorType targetNode, VertexDescriptorType sourceNode) override
   {
+    if(this->Writer)
+    {
+      itk::Index<2> targetPixel = {{static_cast<itk::Index<2>::IndexValueType>(targetNode[0]),
+                                    static_cast<itk::Index<2>::IndexValueType>(targetNode[1])}};
+      itk::Index<2> sourcePixel = {{static_cast<itk::Index<2>::IndexValueType>(sourceNode[0]),
+                                    static_cast<itk::Index<2>::IndexValueType>(sourceNode[1])}};
+      this->Writer->Write(targetPixel, sourcePixel);
+      return;
+    }
+
     //OutputStream << sourceNode << " : " << targetNode << std::endl;
      this->OutputStream << sourceNode[0] << " " << sourceNode[1] << " : "
                         << targetNode[0] << " " << targetNode[1] << std::endl;
   }
 
+  void InpaintingComplete() const override
+  {
+    if(this->Writer)
+    {
+      this->Writer->Close();
+    }
+  }
+
 };
 
 #endif
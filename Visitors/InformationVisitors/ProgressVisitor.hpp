@@ -0,0 +1,91 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef ProgressVisitor_HPP
+#define ProgressVisitor_HPP
+
+// Custom
+#include "Visitors/InpaintingVisitors/InpaintingVisitorParent.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+#include <Mask/Mask.h>
+
+// STL
+#include <algorithm>
+#include <functional>
+
+/** Called with the number of patches that have been filled and the number of hole pixels that remain. */
+typedef std::function<void(unsigned int, unsigned int)> InpaintingProgressCallback;
+
+/**
+  * This visitor reports the progress of the inpainting after every iteration (and once more when it is complete).
+  * The number of remaining hole pixels is counted once, and then the hole pixels of each target patch are
+  * subtracted when it is discovered (before it is filled), so no iteration looks at more than one patch of the mask.
+  */
+template <typename TGraph>
+struct ProgressVisitor : public InpaintingVisitorParent<TGraph>
+{
+  typedef InpaintingVisitorParent<TGraph> Superclass;
+  typedef typename Superclass::VertexDescriptorType VertexDescriptorType;
+
+  const Mask* MaskImage;
+
+  unsigned int PatchHalfWidth;
+
+  InpaintingProgressCallback Callback;
+
+  unsigned int NumberOfFinishedPatches;
+
+  unsigned int NumberOfHolePixels;
+
+  /** 'numberOfFinishedPatches' is the iteration to start counting from (non-zero when a run is resumed). */
+  ProgressVisitor(const Mask* const mask, const unsigned int patchHalfWidth, InpaintingProgressCallback callback,
+                  const unsigned int numberOfFinishedPatches = 0,
+                  const std::string& visitorName = "ProgressVisitor") :
+    InpaintingVisitorParent<TGraph>(visitorName), MaskImage(mask), PatchHalfWidth(patchHalfWidth),
+    Callback(callback), NumberOfFinishedPatches(numberOfFinishedPatches)
+  {
+    this->NumberOfHolePixels = mask->CountHolePixels(mask->GetLargestPossibleRegion());
+  }
+
+  void DiscoverVertex(VertexDescriptorType target) override
+  {
+    itk::ImageRegion<2> targetRegion =
+        ITKHelpers::GetRegionInRadiusAroundPixel(ITKHelpers::CreateIndex(target), this->PatchHalfWidth);
+    targetRegion.Crop(this->MaskImage->GetLargestPossibleRegion());
+
+    unsigned int numberOfFilledPixels = this->MaskImage->CountHolePixels(targetRegion);
+    this->NumberOfHolePixels -= std::min(numberOfFilledPixels, this->NumberOfHolePixels);
+  }
+
+  void FinishVertex(VertexDescriptorType targetNode, VertexDescriptorType sourceNode) override
+  {
+    this->NumberOfFinishedPatches++;
+    this->Callback(this->NumberOfFinishedPatches, this->NumberOfHolePixels);
+  }
+
+  void InpaintingComplete() const override
+  {
+    this->Callback(this->NumberOfFinishedPatches, this->MaskImage->CountHolePixels(
+                     this->MaskImage->GetLargestPossibleRegion()));
+  }
+
+};
+
+#endif
@@ -23,6 +23,7 @@
 
 // STL
 #include <memory>
+#include <vector>
 
 // Concepts
 #include "Concepts/DescriptorVisitorConcept.hpp"
@@ -30,6 +31,13 @@
 // Accept criteria
 #include "ImageProcessing/BoundaryEnergy.h"
 
+// Utilities
+#include "Utilities/AsyncImageWriter.h"
+#include "Utilities/Checkpoint.h"
+#include "Utilities/NewSourcePatches.h"
+#include "Utilities/PixelBitmap.h"
+#include "Utilities/SourcePixelMap.h"
+
 // Boost
 #include <boost/graph/graph_traits.hpp>
 #include <boost/property_map/property_map.hpp>
@@ -86,22 +94,27 @@ class InpaintingVisitor : public InpaintingVisitorParent<TGraph>, public Debug
   itk::ImageRegion<2> FullRegion;
 
   /** Track which nodes have been used as source nodes. */
-  typedef std::set<itk::Index<2>, itk::Index<2>::LexicographicCompare> UsedNodesSetType;
+  typedef PixelBitmap UsedNodesSetType;
   UsedNodesSetType UsedNodesSet;
 
   /** Track which pixels have been used as source pixels. */
-  typedef itk::Image<bool, 2> CopiedPixelsImageType;
-  CopiedPixelsImageType::Pointer CopiedPixelsImage;
+  PixelBitmap CopiedPixels;
 
-  /** Track where pixels have been copied from. */
-  typedef itk::Image<itk::Index<2>, 2> SourcePixelMapImageType;
+  /** Track where pixels have been copied from (see SourcePixelMap). */
+  typedef SourcePixelMap::ImageType SourcePixelMapImageType;
   SourcePixelMapImageType::Pointer SourcePixelMapImage;
 
 public:
 
-  CopiedPixelsImageType* GetCopiedPixelsImage()
+  const PixelBitmap* GetCopiedPixels() const
+  {
+    return &this->CopiedPixels;
+  }
+
+  /** Determine if 'pixel' has ever been copied into the hole. This is O(1). */
+  bool WasPixelCopied(const itk::Index<2>& pixel) const
   {
-    return this->CopiedPixelsImage;
+    return this->CopiedPixels.Contains(pixel);
   }
 
   SourcePixelMapImageType* GetSourcePixelMapImage()
@@ -109,6 +122,13 @@ public:
     return this->SourcePixelMapImage;
   }
 
+  /** Get the pixel that the value at 'pixel' was originally copied from. This is (-1, -1) for hole pixels
+    * that have not been filled yet. */
+  itk::Index<2> GetSourcePixel(const itk::Index<2>& pixel) const
+  {
+    return SourcePixelMap::GetIndex(this->SourcePixelMapImage, this->SourcePixelMapImage->GetPixel(pixel));
+  }
+
   UsedNodesSetType* GetUsedNodesSetPointer()
   {
     return &this->UsedNodesSet;
@@ -119,6 +139,30 @@ public:
     this->AllowNewPatches = allowNewPatches;
   }
 
+  unsigned int GetNumberOfFinishedPatches() const
+  {
+    return this->NumberOfFinishedPatches;
+  }
+
+  /** Add the used nodes, copied pixels, source pixel map and number of finished patches to 'checkpoint'.
+    * The mask, queue and priority function are saved by their owners. */
+  void SaveState(Checkpoint& checkpoint) const
+  {
+    checkpoint.AddPixelBitmap("InpaintingVisitor.UsedNodes", this->UsedNodesSet);
+    checkpoint.AddPixelBitmap("InpaintingVisitor.CopiedPixels", this->CopiedPixels);
+    checkpoint.AddImage("InpaintingVisitor.SourcePixelMap", this->SourcePixelMapImage.GetPointer());
+    checkpoint.AddValue("InpaintingVisitor.NumberOfFinishedPatches", this->NumberOfFinishedPatches);
+  }
+
+  /** Restore the state saved by SaveState(). */
+  void LoadState(const Checkpoint& checkpoint)
+  {
+    checkpoint.GetPixelBitmap("InpaintingVisitor.UsedNodes", this->UsedNodesSet);
+    checkpoint.GetPixelBitmap("InpaintingVisitor.CopiedPixels", this->CopiedPixels);
+    checkpoint.GetImage("InpaintingVisitor.SourcePixelMap", this->SourcePixelMapImage.GetPointer());
+    this->NumberOfFinishedPatches = checkpoint.GetValue<unsigned int>("InpaintingVisitor.NumberOfFinishedPatches");
+  }
+
   /** Constructor. Everything must be specified in this constructor. (There is no default constructor). */
   InpaintingVisitor(Mask* const mask,
                     std::shared_ptr<TBoundaryNodeQueue> boundaryNodeQueue,
@@ -134,16 +178,12 @@ public:
   {
     this->FullRegion = this->MaskImage->GetLargestPossibleRegion();
 
-    this->CopiedPixelsImage = CopiedPixelsImageType::New();
-    this->CopiedPixelsImage->SetRegions(this->FullRegion);
-    this->CopiedPixelsImage->Allocate();
-    this->CopiedPixelsImage->FillBuffer(false);
+    this->UsedNodesSet.SetRegion(this->FullRegion);
+    this->CopiedPixels.SetRegion(this->FullRegion);
 
     this->SourcePixelMapImage = SourcePixelMapImageType::New();
     this->SourcePixelMapImage->SetRegions(this->FullRegion);
     this->SourcePixelMapImage->Allocate();
-    itk::Index<2> dummyIndex = {{-1, -1}};
-    this->SourcePixelMapImage->FillBuffer(dummyIndex);
 
     // Initialize by setting all valid pixels to their own index
     itk::ImageRegionIteratorWithIndex<SourcePixelMapImageType>
@@ -152,8 +192,12 @@ public:
     {
       if(this->MaskImage->IsValid(sourcePixelMapImageIterator.GetIndex()))
       {
-        this->SourcePixelMapImage->SetPixel(sourcePixelMapImageIterator.GetIndex(),
-                                            sourcePixelMapImageIterator.GetIndex());
+        sourcePixelMapImageIterator.Set(
+              this->SourcePixelMapImage->ComputeOffset(sourcePixelMapImageIterator.GetIndex()));
+      }
+      else
+      {
+        sourcePixelMapImageIterator.Set(SourcePixelMap::InvalidSourcePixel);
       }
 
       ++sourcePixelMapImageIterator;
@@ -209,7 +253,7 @@ public:
     itk::Index<2> indexToFinish = ITKHelpers::CreateIndex(targetNode);
 
     // Mark this node as having been used as a source node.
-    this->UsedNodesSet.insert(indexToFinish);
+    this->UsedNodesSet.Insert(indexToFinish);
 
     itk::ImageRegion<2> regionToFinishFull =
         ITKHelpers::GetRegionInRadiusAroundPixel(indexToFinish, this->PatchHalfWidth);
@@ -234,11 +278,14 @@ public:
     itk::ImageRegionConstIteratorWithIndex<SourcePixelMapImageType> sourcePatchIterator(this->SourcePixelMapImage,
                                                                                         sourceRegion);
     itk::ImageRegionConstIteratorWithIndex<Mask> targetPatchIterator(this->MaskImage, regionToFinish);
+    std::vector<itk::Index<2> > newlyFilledPixels;
     while(!sourcePatchIterator.IsAtEnd())
     {
       if(targetPatchIterator.Get() == this->MaskImage->GetHoleValue())
       {
-        this->CopiedPixelsImage->SetPixel(sourcePatchIterator.GetIndex(), true); // Mark this pixel as used
+        newlyFilledPixels.push_back(targetPatchIterator.GetIndex());
+
+        this->CopiedPixels.Insert(sourcePatchIterator.GetIndex()); // Mark this pixel as used
 
         // Save the location from which this pixel came. We want to use the index value in the SourcePixelMapImage,
         // because the value might not equal the current index in the case where new patches are allowed.
@@ -254,12 +301,13 @@ public:
     {
       if(this->DebugLevel > 1)
       {
-        ITKHelpers::WriteBoolImage(this->CopiedPixelsImage,
-                                   Helpers::GetSequentialFileName("CopiedPixels",
-                                                                  this->NumberOfFinishedPatches, "png", 3));
-        ITKHelpers::WriteImage(this->MaskImage,
-                               Helpers::GetSequentialFileName("Mask_Before",
-                                                              this->NumberOfFinishedPatches, "png", 3));
+        typedef itk::Image<unsigned char, 2> CopiedPixelsImageType;
+        CopiedPixelsImageType::Pointer copiedPixelsImage = CopiedPixelsImageType::New();
+        this->CopiedPixels.CreateImage(copiedPixelsImage);
+        AsyncImageWriter::GetInstance().WriteSequentialImage(copiedPixelsImage.GetPointer(), "CopiedPixels",
+                                                             this->NumberOfFinishedPatches, 3, "png");
+        AsyncImageWriter::GetInstance().WriteSequentialImage(this->MaskImage, "Mask_Before",
+                                                             this->NumberOfFinishedPatches, 3, "png");
       }
     }
 
@@ -299,21 +347,27 @@ public:
 //    std::cout << "InpaintingVisitor::FinishVertex() update priority" << std::endl;
     this->PriorityFunction->Update(sourceNode, targetNode, this->NumberOfFinishedPatches);
 //    std::cout << "InpaintingVisitor::FinishVertex() finish update priority" << std::endl;
-    // Initialize (if requested) all vertices in the newly filled region because they may now be valid source nodes.
+    // Initialize (if requested) the vertices whose patches are now valid source nodes. These are the fully valid
+    // patches that contain a newly filled pixel, which are found with summed area tables rather than by
+    // re-initializing every vertex around the filled region, and they are initialized all at once.
     // (You may not want to do this in some cases (i.e. if the descriptors needed cannot be
     // computed on newly filled regions))
 
     if(this->AllowNewPatches)
     {
 //      std::cout << "Initializing new vertices..." << std::endl;
-      itk::ImageRegionConstIteratorWithIndex<Mask> gridIterator(this->MaskImage, regionToFinish);
-      while(!gridIterator.IsAtEnd())
-      {
-        VertexDescriptorType v = Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(gridIterator.GetIndex());
+      std::vector<itk::Index<2> > newlyValidCenters =
+          NewSourcePatches::GetNewlyValidPatchCenters(this->MaskImage, newlyFilledPixels, this->PatchHalfWidth);
 
-        InitializeVertex(v);
-        ++gridIterator;
+      std::vector<VertexDescriptorType> newSourceNodes;
+      newSourceNodes.reserve(newlyValidCenters.size());
+      for(std::size_t centerId = 0; centerId < newlyValidCenters.size(); ++centerId)
+      {
+        newSourceNodes.push_back(
+              Helpers::ConvertFrom<VertexDescriptorType, itk::Index<2> >(newlyValidCenters[centerId]));
       }
+
+      this->DescriptorVisitor->InitializeVertices(newSourceNodes);
     }
 
     // Add pixels that are on the new boundary to the queue, and mark other pixels as not in the queue.
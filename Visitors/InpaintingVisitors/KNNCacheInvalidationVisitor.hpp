@@ -0,0 +1,61 @@
+/*=========================================================================
+ *
+ *  Copyright David Doria 2012 daviddoria@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef KNNCacheInvalidationVisitor_HPP
+#define KNNCacheInvalidationVisitor_HPP
+
+// Custom
+#include "Visitors/InpaintingVisitors/InpaintingVisitorParent.h"
+
+// Submodules
+#include <ITKHelpers/ITKHelpers.h>
+
+// STL
+#include <memory>
+
+/**
+  * This visitor removes the cached neighbors that are affected by each filled patch from a CachedKNN, so that
+  * they are searched for again.
+  */
+template <typename TGraph, typename TCache>
+struct KNNCacheInvalidationVisitor : public InpaintingVisitorParent<TGraph>
+{
+  typedef InpaintingVisitorParent<TGraph> Superclass;
+  typedef typename Superclass::VertexDescriptorType VertexDescriptorType;
+
+  std::shared_ptr<TCache> Cache;
+
+  unsigned int PatchHalfWidth;
+
+  KNNCacheInvalidationVisitor(std::shared_ptr<TCache> cache, const unsigned int patchHalfWidth,
+                              const std::string& visitorName = "KNNCacheInvalidationVisitor") :
+    InpaintingVisitorParent<TGraph>(visitorName), Cache(cache), PatchHalfWidth(patchHalfWidth)
+  {
+
+  }
+
+  void FinishVertex(VertexDescriptorType targetNode, VertexDescriptorType) override
+  {
+    this->Cache->Invalidate(ITKHelpers::GetRegionInRadiusAroundPixel(ITKHelpers::CreateIndex(targetNode),
+                                                                     this->PatchHalfWidth));
+  }
+
+};
+
+#endif